@@ -135,6 +135,10 @@ static uart_select_args_t **s_registered_selects = NULL;
 static int s_registered_select_num = 0;
 static portMUX_TYPE s_registered_select_lock = portMUX_INITIALIZER_UNLOCKED;
 static int s_uart_select_count[UART_NUM] = {0};
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+// Watches of epoll instances, protected by uart_get_selectlock() like the notification callback
+static esp_vfs_epoll_watch_t *s_uart_epoll_watch[UART_NUM] = {0};
+#endif // CONFIG_VFS_SUPPORT_EPOLL
 
 static esp_err_t uart_end_select(void *end_select_args);
 
@@ -438,6 +442,11 @@ static void select_notif_callback_isr(uart_port_t uart_num, uart_select_notif_t
         }
     }
     portEXIT_CRITICAL_ISR(&s_registered_select_lock);
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+    if (s_uart_epoll_watch[uart_num]) {
+        esp_vfs_epoll_notify_isr(s_uart_epoll_watch[uart_num], task_woken);
+    }
+#endif // CONFIG_VFS_SUPPORT_EPOLL
 }
 
 static esp_err_t uart_start_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
@@ -531,6 +540,55 @@ static esp_err_t uart_end_select(void *end_select_args)
     return ret;
 }
 
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+
+static int uart_epoll_watch(int fd, esp_vfs_epoll_watch_t *watch)
+{
+    if (fd < 0 || fd >= UART_NUM) {
+        errno = EBADF;
+        return -1;
+    }
+    if (watch && !uart_is_driver_installed(fd)) {
+        errno = EPERM;
+        return -1;
+    }
+
+    portENTER_CRITICAL(uart_get_selectlock());
+    if (watch && s_uart_epoll_watch[fd] == NULL) {
+        if (s_uart_select_count[fd] == 0) {
+            uart_set_select_notif_callback(fd, select_notif_callback_isr);
+        }
+        s_uart_select_count[fd]++;
+    } else if (watch == NULL && s_uart_epoll_watch[fd]) {
+        s_uart_select_count[fd]--;
+        if (s_uart_select_count[fd] == 0) {
+            uart_set_select_notif_callback(fd, NULL);
+        }
+    }
+    s_uart_epoll_watch[fd] = watch;
+    portEXIT_CRITICAL(uart_get_selectlock());
+    return 0;
+}
+
+static int uart_epoll_poll(int fd)
+{
+    if (fd < 0 || fd >= UART_NUM) {
+        errno = EBADF;
+        return -1;
+    }
+    // Writes go through the driver and wait for free space in the TX buffer or FIFO
+    int ret = POLLOUT;
+    size_t buffered_size;
+    if (uart_get_buffered_data_len(fd, &buffered_size) != ESP_OK) {
+        ret |= POLLERR;
+    } else if (buffered_size > 0 || s_ctx[fd]->peek_char != NONE) {
+        ret |= POLLIN;
+    }
+    return ret;
+}
+
+#endif // CONFIG_VFS_SUPPORT_EPOLL
+
 #endif // CONFIG_VFS_SUPPORT_SELECT
 
 #ifdef CONFIG_VFS_SUPPORT_TERMIOS
@@ -1001,6 +1059,10 @@ static const esp_vfs_t uart_vfs = {
     .start_select = &uart_start_select,
     .end_select = &uart_end_select,
 #endif // CONFIG_VFS_SUPPORT_SELECT
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+    .epoll_watch = &uart_epoll_watch,
+    .epoll_poll = &uart_epoll_poll,
+#endif // CONFIG_VFS_SUPPORT_EPOLL
 #ifdef CONFIG_VFS_SUPPORT_TERMIOS
     .tcsetattr = &uart_tcsetattr,
     .tcgetattr = &uart_tcgetattr,
@@ -76,6 +76,26 @@ esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
                              event_data, event_data_size, ticks_to_wait);
 }
 
+esp_err_t esp_event_post_many(const esp_event_post_item_t* events, size_t event_count, TickType_t ticks_to_wait)
+{
+    if (s_default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_event_post_many_to(s_default_loop, events, event_count, ticks_to_wait);
+}
+
+esp_err_t esp_event_post_buffer(esp_event_base_t event_base, int32_t event_id,
+                                void* event_data, esp_event_data_release_t release, TickType_t ticks_to_wait)
+{
+    if (s_default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_event_post_buffer_to(s_default_loop, event_base, event_id,
+                                    event_data, release, ticks_to_wait);
+}
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 esp_err_t esp_event_isr_post(esp_event_base_t event_base, int32_t event_id,
                              const void* event_data, size_t event_data_size, BaseType_t* task_unblocked)
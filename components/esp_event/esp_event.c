@@ -22,8 +22,10 @@
 /* ---------------------------- Definitions --------------------------------- */
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-// LOOP @<address, name> rx:<recieved events no.> dr:<dropped events no.>
-#define LOOP_DUMP_FORMAT              "LOOP @%p,%s rx:%" PRIu32 " dr:%" PRIu32 "\n"
+// LOOP @<address, name> rx:<recieved events no.> dr:<dropped events no.> heap:<heap copies no.> pool:<pool copies no.>
+//      buf:<buffer posts no.>
+#define LOOP_DUMP_FORMAT              "LOOP @%p,%s rx:%" PRIu32 " dr:%" PRIu32 " heap:%" PRIu32 " pool:%" PRIu32 \
+                                      " buf:%" PRIu32 "\n"
 // handler @<address> ev:<base, id> inv:<times invoked> time:<runtime>
 #define HANDLER_DUMP_FORMAT           "  HANDLER @%p ev:%s,%s inv:%" PRIu32 " time:%lld us\n"
 
@@ -34,10 +36,15 @@
                                         } while(0);
 #endif
 
+// Rounds a size up so that the event data stored after it is suitably aligned
+#define EVENT_DATA_ALIGN(size)         (((size) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1))
+
 /* ------------------------- Static Variables ------------------------------- */
 
 static const char* TAG = "event";
 static const char* esp_event_any_base = "any";
+// Base of the queued post that carries the events of one esp_event_post_many_to call, never seen by handlers
+static const char esp_event_batch_base[] = "batch";
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
 static SLIST_HEAD(esp_event_loop_instance_list_t, esp_event_loop_instance) s_event_loops =
@@ -87,7 +94,7 @@ static int esp_event_dump_prepare(void)
 
     // Reserve slightly more memory than computed
     int allowance = 3;
-    int size = (((loops + allowance) * (sizeof(LOOP_DUMP_FORMAT) + 10 + 20 + 2 * 11)) +
+    int size = (((loops + allowance) * (sizeof(LOOP_DUMP_FORMAT) + 10 + 20 + 5 * 11)) +
                 ((handlers + allowance) * (sizeof(HANDLER_DUMP_FORMAT) + 10 + 2 * 20 + 11 + 20)));
 
     return size;
@@ -423,18 +430,387 @@ static void loop_node_remove_all_handler(esp_event_loop_node_t* loop_node)
     }
 }
 
-static void inline __attribute__((always_inline)) post_instance_delete(esp_event_post_instance_t* post)
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+
+#define DISPATCH_INDEX_MIN_BUCKETS    8
+
+static inline uint32_t dispatch_index_hash(const void* owner, uint32_t key)
+{
+    uint32_t hash = ((uint32_t)(uintptr_t) owner) ^ (key * 0x9e3779b1);
+    hash ^= hash >> 15;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+static inline esp_event_base_index_bucket_t* dispatch_index_base_bucket(esp_event_dispatch_index_t* index,
+                                                                        esp_event_loop_node_t* loop_node,
+                                                                        esp_event_base_t base)
+{
+    return &(index->base_buckets[dispatch_index_hash(loop_node, (uint32_t)(uintptr_t) base) & (index->base_bucket_count - 1)]);
+}
+
+static inline esp_event_id_index_bucket_t* dispatch_index_id_bucket(esp_event_dispatch_index_t* index,
+                                                                    esp_event_base_node_t* base_node,
+                                                                    int32_t id)
+{
+    return &(index->id_buckets[dispatch_index_hash(base_node, (uint32_t) id) & (index->id_bucket_count - 1)]);
+}
+
+static uint32_t dispatch_index_bucket_count(uint32_t node_count)
+{
+    uint32_t bucket_count = DISPATCH_INDEX_MIN_BUCKETS;
+    while (bucket_count < node_count) {
+        bucket_count <<= 1;
+    }
+    return bucket_count;
+}
+
+static void dispatch_index_free(esp_event_dispatch_index_t* index)
+{
+    free(index->base_buckets);
+    free(index->id_buckets);
+    memset(index, 0, sizeof(*index));
+}
+
+// Rebuilds the index of the loop if handlers have been registered or unregistered since it was built.
+// Returns false if there isn't enough memory for the index, the lists of the loop have to be walked then.
+static bool dispatch_index_update(esp_event_loop_instance_t* loop)
+{
+    esp_event_dispatch_index_t* index = &(loop->index);
+
+    if (index->valid) {
+        return true;
+    }
+
+    esp_event_loop_node_t* loop_node;
+    esp_event_base_node_t* base_node;
+    esp_event_id_node_t* id_node;
+    uint32_t base_count = 0, id_count = 0;
+
+    SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
+        SLIST_FOREACH(base_node, &(loop_node->base_nodes), next) {
+            base_count++;
+            SLIST_FOREACH(id_node, &(base_node->id_nodes), next) {
+                id_count++;
+            }
+        }
+    }
+
+    uint32_t base_bucket_count = dispatch_index_bucket_count(base_count);
+    if (base_bucket_count != index->base_bucket_count) {
+        free(index->base_buckets);
+        index->base_buckets = malloc(base_bucket_count * sizeof(*(index->base_buckets)));
+        index->base_bucket_count = index->base_buckets ? base_bucket_count : 0;
+    }
+
+    uint32_t id_bucket_count = dispatch_index_bucket_count(id_count);
+    if (id_bucket_count != index->id_bucket_count) {
+        free(index->id_buckets);
+        index->id_buckets = malloc(id_bucket_count * sizeof(*(index->id_buckets)));
+        index->id_bucket_count = index->id_buckets ? id_bucket_count : 0;
+    }
+
+    if (!index->base_buckets || !index->id_buckets) {
+        ESP_LOGD(TAG, "alloc for dispatch index of loop %p failed", loop);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < index->base_bucket_count; i++) {
+        STAILQ_INIT(&(index->base_buckets[i]));
+    }
+
+    for (uint32_t i = 0; i < index->id_bucket_count; i++) {
+        SLIST_INIT(&(index->id_buckets[i]));
+    }
+
+    SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
+        SLIST_FOREACH(base_node, &(loop_node->base_nodes), next) {
+            // Insert at the tail, so that base nodes with the same base stay in the order of the loop node list
+            base_node->owner = loop_node;
+            STAILQ_INSERT_TAIL(dispatch_index_base_bucket(index, loop_node, base_node->base), base_node, index_next);
+
+            SLIST_FOREACH(id_node, &(base_node->id_nodes), next) {
+                id_node->owner = base_node;
+                SLIST_INSERT_HEAD(dispatch_index_id_bucket(index, base_node, id_node->id), id_node, index_next);
+            }
+        }
+    }
+
+    index->valid = true;
+
+    return true;
+}
+
+// Returns the first base node of the loop node with the given base following the base node 'after',
+// or the first one of the loop node if 'after' is NULL.
+static esp_event_base_node_t* dispatch_index_find_base(esp_event_loop_instance_t* loop, esp_event_loop_node_t* loop_node,
+                                                       esp_event_base_t base, esp_event_base_node_t* after)
+{
+    esp_event_base_node_t* it;
+
+    if (!dispatch_index_update(loop)) {
+        it = after ? SLIST_NEXT(after, next) : SLIST_FIRST(&(loop_node->base_nodes));
+        for (; it != NULL; it = SLIST_NEXT(it, next)) {
+            if (it->base == base) {
+                return it;
+            }
+        }
+        return NULL;
+    }
+
+    it = after ? STAILQ_NEXT(after, index_next) : STAILQ_FIRST(dispatch_index_base_bucket(&(loop->index), loop_node, base));
+    for (; it != NULL; it = STAILQ_NEXT(it, index_next)) {
+        if (it->owner == loop_node && it->base == base) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static esp_event_id_node_t* dispatch_index_find_id(esp_event_loop_instance_t* loop, esp_event_base_node_t* base_node, int32_t id)
+{
+    esp_event_id_node_t* it;
+
+    if (!dispatch_index_update(loop)) {
+        SLIST_FOREACH(it, &(base_node->id_nodes), next) {
+            if (it->id == id) {
+                return it;
+            }
+        }
+        return NULL;
+    }
+
+    SLIST_FOREACH(it, dispatch_index_id_bucket(&(loop->index), base_node, id), index_next) {
+        if (it->owner == base_node && it->id == id) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+#endif // CONFIG_ESP_EVENT_HASHED_DISPATCH
+
+// The payload pool is a free list of buffer indices. Posting tasks take buffers from it while the loop task returns
+// them, so the list head is updated with compare-and-swap. The head also counts updates, so that a buffer taken and
+// returned by others between reading the head and swapping it is detected.
+#define PAYLOAD_POOL_NONE               UINT16_MAX
+#define PAYLOAD_POOL_HEAD(index, head)  ((((head) + (1 << 16)) & 0xFFFF0000) | (index))
+
+static esp_err_t payload_pool_init(esp_event_payload_pool_t* pool, uint32_t item_count, uint32_t item_size)
+{
+    atomic_init(&pool->free_head, PAYLOAD_POOL_NONE);
+
+    if (item_count == 0) {
+        return ESP_OK;
+    }
+
+    if (item_count >= PAYLOAD_POOL_NONE || item_size == 0 || item_size > UINT16_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t stride = EVENT_DATA_ALIGN(item_size);
+
+    // The free list links are stored after the buffers, so the pool takes a single allocation
+    pool->buffers = malloc(item_count * (stride + sizeof(uint16_t)));
+    if (pool->buffers == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    pool->next_free = (uint16_t*)(pool->buffers + item_count * stride);
+    for (uint32_t i = 0; i < item_count; i++) {
+        pool->next_free[i] = (i + 1 < item_count) ? i + 1 : PAYLOAD_POOL_NONE;
+    }
+
+    pool->item_size = item_size;
+    pool->item_stride = stride;
+    pool->item_count = item_count;
+    atomic_store(&pool->free_head, 0);
+
+    return ESP_OK;
+}
+
+static void* payload_pool_get(esp_event_payload_pool_t* pool)
+{
+    uint32_t head = atomic_load(&pool->free_head);
+    uint32_t new_head;
+    uint16_t index;
+
+    do {
+        index = head & 0xFFFF;
+        if (index == PAYLOAD_POOL_NONE) {
+            return NULL;
+        }
+        new_head = PAYLOAD_POOL_HEAD(pool->next_free[index], head);
+    } while (!atomic_compare_exchange_weak(&pool->free_head, &head, new_head));
+
+    return pool->buffers + index * pool->item_stride;
+}
+
+static inline bool payload_pool_owns(esp_event_payload_pool_t* pool, void* ptr)
+{
+    uintptr_t start = (uintptr_t) pool->buffers;
+    return pool->buffers != NULL && (uintptr_t) ptr >= start &&
+           (uintptr_t) ptr < start + pool->item_count * pool->item_stride;
+}
+
+static inline void payload_pool_put(esp_event_payload_pool_t* pool, void* ptr)
+{
+    uint16_t index = ((uint8_t*) ptr - pool->buffers) / pool->item_stride;
+    uint32_t head = atomic_load(&pool->free_head);
+
+    do {
+        pool->next_free[index] = head & 0xFFFF;
+    } while (!atomic_compare_exchange_weak(&pool->free_head, &head, PAYLOAD_POOL_HEAD(index, head)));
+}
+
+static void payload_release_none(void* event_data)
+{
+    (void) event_data;
+}
+
+static void inline __attribute__((always_inline)) post_instance_delete(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
 {
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
-    if (post->data_allocated && post->data.ptr) {
-        free(post->data.ptr);
+    void* data = post->data_allocated ? post->data.ptr : NULL;
+#else
+    void* data = post->data;
+#endif
+    if (data) {
+        if (post->release) {
+            post->release(data);
+        } else if (payload_pool_owns(&(loop->payload_pool), data)) {
+            payload_pool_put(&(loop->payload_pool), data);
+        } else {
+            free(data);
+        }
     }
+    memset(post, 0, sizeof(*post));
+}
+
+static inline esp_event_post_instance_t* post_batch_events(esp_event_post_instance_t* post)
+{
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+    return (esp_event_post_instance_t*) post->data.ptr;
 #else
-    if (post->data) {
-        free(post->data);
+    return (esp_event_post_instance_t*) post->data;
+#endif
+}
+
+static esp_err_t post_instance_send(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post,
+                                    uint32_t event_count, TickType_t ticks_to_wait)
+{
+    BaseType_t result = pdFALSE;
+
+    // Find the task that currently executes the loop. It is safe to query loop->task since it is
+    // not mutated since loop creation. ENSURE THIS REMAINS TRUE.
+    if (loop->task == NULL) {
+        // The loop has no dedicated task. Find out what task is currently running it.
+        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+
+        if (result == pdTRUE) {
+            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = xQueueSendToBack(loop->queue, post, ticks_to_wait);
+            } else {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = xQueueSendToBack(loop->queue, post, 0);
+            }
+        }
+    } else {
+        // The loop has a dedicated task.
+        if (loop->task != xTaskGetCurrentTaskHandle()) {
+            result = xQueueSendToBack(loop->queue, post, ticks_to_wait);
+        } else {
+            result = xQueueSendToBack(loop->queue, post, 0);
+        }
     }
+
+    if (result != pdTRUE) {
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+        atomic_fetch_add(&loop->events_dropped, event_count);
 #endif
-    memset(post, 0, sizeof(*post));
+        return ESP_ERR_TIMEOUT;
+    }
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+    atomic_fetch_add(&loop->events_recieved, event_count);
+#endif
+
+    return ESP_OK;
+}
+
+static void post_instance_dispatch(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    bool exec = false;
+
+    esp_event_handler_node_t *handler, *temp_handler;
+    esp_event_loop_node_t *loop_node, *temp_node;
+    esp_event_base_node_t *base_node, *temp_base;
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+    esp_event_id_node_t *id_node;
+#else
+    esp_event_id_node_t *id_node, *temp_id_node;
+#endif
+
+    SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
+        // Execute loop level handlers
+        SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
+            handler_execute(loop, handler, *post);
+            exec |= true;
+        }
+
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+        base_node = dispatch_index_find_base(loop, loop_node, post->base, NULL);
+        while (base_node != NULL) {
+            temp_base = dispatch_index_find_base(loop, loop_node, post->base, base_node);
+
+            // Execute base level handlers
+            SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
+                handler_execute(loop, handler, *post);
+                exec |= true;
+            }
+
+            id_node = dispatch_index_find_id(loop, base_node, post->id);
+            if (id_node != NULL) {
+                // Execute id level handlers
+                SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
+                    handler_execute(loop, handler, *post);
+                    exec |= true;
+                }
+            }
+
+            base_node = temp_base;
+        }
+#else
+        SLIST_FOREACH_SAFE(base_node, &(loop_node->base_nodes), next, temp_base) {
+            if (base_node->base == post->base) {
+                // Execute base level handlers
+                SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
+                    handler_execute(loop, handler, *post);
+                    exec |= true;
+                }
+
+                SLIST_FOREACH_SAFE(id_node, &(base_node->id_nodes), next, temp_id_node) {
+                    if (id_node->id == post->id) {
+                        // Execute id level handlers
+                        SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
+                            handler_execute(loop, handler, *post);
+                            exec |= true;
+                        }
+                        // Skip to next base node
+                        break;
+                    }
+                }
+            }
+        }
+#endif
+    }
+
+    if (!exec) {
+        // No handlers were registered, not even loop/base level handlers
+        ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", post->base, post->id, loop);
+    }
 }
 
 /* ---------------------------- Public API --------------------------------- */
@@ -460,6 +836,15 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
         return err;
     }
 
+    err = payload_pool_init(&(loop->payload_pool), event_loop_args->payload_pool_size,
+                            event_loop_args->payload_pool_item_size);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "create event loop payload pool failed");
+        free(loop);
+        return err;
+    }
+    err = ESP_ERR_NO_MEM;
+
     loop->queue = xQueueCreate(event_loop_args->queue_size, sizeof(esp_event_post_instance_t));
     if (loop->queue == NULL) {
         ESP_LOGE(TAG, "create event loop queue failed");
@@ -531,6 +916,7 @@ on_err:
     }
 #endif
 
+    free(loop->payload_pool.buffers);
     free(loop);
 
     return err;
@@ -542,6 +928,8 @@ on_err:
 // indicate that the difference is not that substantial, especially considering the additional
 // pointers per node of rbtrees. Code for the rbtree implementation of the event loop library is archived
 // in feature/esp_event_loop_library_rbtrees if needed.
+// For loops with many registered event bases and ids, CONFIG_ESP_EVENT_HASHED_DISPATCH adds hash tables on top
+// of the lists, so that only the nodes matching the posted event are visited.
 esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t ticks_to_run)
 {
     assert(event_loop);
@@ -563,47 +951,22 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
 
         loop->running_task = xTaskGetCurrentTaskHandle();
 
-        bool exec = false;
-
-        esp_event_handler_node_t *handler, *temp_handler;
-        esp_event_loop_node_t *loop_node, *temp_node;
-        esp_event_base_node_t *base_node, *temp_base;
-        esp_event_id_node_t *id_node, *temp_id_node;
-
-        SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
-            // Execute loop level handlers
-            SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
-                handler_execute(loop, handler, post);
-                exec |= true;
-            }
-
-            SLIST_FOREACH_SAFE(base_node, &(loop_node->base_nodes), next, temp_base) {
-                if (base_node->base == post.base) {
-                    // Execute base level handlers
-                    SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
-                        handler_execute(loop, handler, post);
-                        exec |= true;
-                    }
-
-                    SLIST_FOREACH_SAFE(id_node, &(base_node->id_nodes), next, temp_id_node) {
-                        if (id_node->id == post.id) {
-                            // Execute id level handlers
-                            SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
-                                handler_execute(loop, handler, post);
-                                exec |= true;
-                            }
-                            // Skip to next base node
-                            break;
-                        }
-                    }
+        // Dispatch the events already waiting in the queue under the same lock acquisition, up to the batch size
+        uint32_t dispatched = 0;
+        do {
+            if (post.base == esp_event_batch_base) {
+                esp_event_post_instance_t* batch = post_batch_events(&post);
+                for (int32_t i = 0; i < post.id; i++) {
+                    post_instance_dispatch(loop, &batch[i]);
                 }
+                dispatched += post.id;
+            } else {
+                post_instance_dispatch(loop, &post);
+                dispatched++;
             }
-        }
-
-        esp_event_base_t base = post.base;
-        int32_t id = post.id;
 
-        post_instance_delete(&post);
+            post_instance_delete(loop, &post);
+        } while (dispatched < CONFIG_ESP_EVENT_LOOP_RUN_BATCH_SIZE && xQueueReceive(loop->queue, &post, 0) == pdTRUE);
 
         if (ticks_to_run != portMAX_DELAY) {
             end = xTaskGetTickCount();
@@ -620,11 +983,6 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
         loop->running_task = NULL;
 
         xSemaphoreGiveRecursive(loop->mutex);
-
-        if (!exec) {
-            // No handlers were registered, not even loop/base level handlers
-            ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", base, id, event_loop);
-        }
     }
 
     return ESP_OK;
@@ -663,14 +1021,19 @@ esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop)
         free(it);
     }
 
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+    dispatch_index_free(&(loop->index));
+#endif
+
     // Drop existing posts on the queue
     esp_event_post_instance_t post;
     while (xQueueReceive(loop->queue, &post, 0) == pdTRUE) {
-        post_instance_delete(&post);
+        post_instance_delete(loop, &post);
     }
 
     // Cleanup loop
     vQueueDelete(loop->queue);
+    free(loop->payload_pool.buffers);
     free(loop);
     // Free loop mutex before deleting
     xSemaphoreGiveRecursive(loop_mutex);
@@ -705,6 +1068,10 @@ esp_err_t esp_event_handler_register_with_internal(esp_event_loop_handle_t event
 
     xSemaphoreTakeRecursive(loop->mutex, portMAX_DELAY);
 
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+    loop->index.valid = false;
+#endif
+
     esp_event_loop_node_t *loop_node = NULL, *last_loop_node = NULL;
 
     SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
@@ -778,6 +1145,10 @@ esp_err_t esp_event_handler_unregister_with_internal(esp_event_loop_handle_t eve
 
     xSemaphoreTakeRecursive(loop->mutex, portMAX_DELAY);
 
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+    loop->index.valid = false;
+#endif
+
     esp_event_loop_node_t *it, *temp;
 
     SLIST_FOREACH_SAFE(it, &(loop->loop_nodes), next, temp) {
@@ -830,11 +1201,24 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     memset((void*)(&post), 0, sizeof(post));
 
     if (event_data != NULL && event_data_size != 0) {
-        // Make persistent copy of event data on heap.
-        void* event_data_copy = calloc(1, event_data_size);
+        // Make persistent copy of event data, in the loop's payload pool if it fits there, on heap otherwise.
+        void* event_data_copy = NULL;
+
+        if (event_data_size <= loop->payload_pool.item_size) {
+            event_data_copy = payload_pool_get(&(loop->payload_pool));
+        }
 
         if (event_data_copy == NULL) {
-            return ESP_ERR_NO_MEM;
+            event_data_copy = calloc(1, event_data_size);
+
+            if (event_data_copy == NULL) {
+                return ESP_ERR_NO_MEM;
+            }
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+            atomic_fetch_add(&loop->payloads_heap, 1);
+        } else {
+            atomic_fetch_add(&loop->payloads_pooled, 1);
+#endif
         }
 
         memcpy(event_data_copy, event_data, event_data_size);
@@ -849,46 +1233,121 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     post.base = event_base;
     post.id = event_id;
 
-    BaseType_t result = pdFALSE;
+    esp_err_t err = post_instance_send(loop, &post, 1, ticks_to_wait);
 
-    // Find the task that currently executes the loop. It is safe to query loop->task since it is
-    // not mutated since loop creation. ENSURE THIS REMAINS TRUE.
-    if (loop->task == NULL) {
-        // The loop has no dedicated task. Find out what task is currently running it.
-        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+    if (err != ESP_OK) {
+        post_instance_delete(loop, &post);
+    }
 
-        if (result == pdTRUE) {
-            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-            } else {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, 0);
-            }
+    return err;
+}
+
+esp_err_t esp_event_post_many_to(esp_event_loop_handle_t event_loop, const esp_event_post_item_t* events,
+                                 size_t event_count, TickType_t ticks_to_wait)
+{
+    assert(event_loop);
+
+    if (events == NULL || event_count == 0 || event_count > INT32_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // The events and copies of their data are stored in a single allocation, which is queued as one post
+    size_t size = EVENT_DATA_ALIGN(event_count * sizeof(esp_event_post_instance_t));
+    for (size_t i = 0; i < event_count; i++) {
+        if (events[i].event_base == ESP_EVENT_ANY_BASE || events[i].event_id == ESP_EVENT_ANY_ID) {
+            return ESP_ERR_INVALID_ARG;
         }
-    } else {
-        // The loop has a dedicated task.
-        if (loop->task != xTaskGetCurrentTaskHandle()) {
-            result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-        } else {
-            result = xQueueSendToBack(loop->queue, &post, 0);
+        if (events[i].event_data != NULL) {
+            size += EVENT_DATA_ALIGN(events[i].event_data_size);
         }
     }
 
-    if (result != pdTRUE) {
-        post_instance_delete(&post);
+    esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
 
+    esp_event_post_instance_t* batch = calloc(1, size);
+    if (batch == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-        atomic_fetch_add(&loop->events_dropped, 1);
+    atomic_fetch_add(&loop->payloads_heap, 1);
 #endif
-        return ESP_ERR_TIMEOUT;
+
+    uint8_t* data = (uint8_t*) batch + EVENT_DATA_ALIGN(event_count * sizeof(esp_event_post_instance_t));
+    for (size_t i = 0; i < event_count; i++) {
+        if (events[i].event_data != NULL && events[i].event_data_size != 0) {
+            memcpy(data, events[i].event_data, events[i].event_data_size);
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+            batch[i].data.ptr = data;
+            batch[i].data_allocated = true;
+            batch[i].data_set = true;
+#else
+            batch[i].data = data;
+#endif
+            data += EVENT_DATA_ALIGN(events[i].event_data_size);
+        }
+        batch[i].base = events[i].event_base;
+        batch[i].id = events[i].event_id;
     }
 
+    esp_event_post_instance_t post;
+    memset((void*)(&post), 0, sizeof(post));
+
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+    post.data.ptr = batch;
+    post.data_allocated = true;
+    post.data_set = true;
+#else
+    post.data = batch;
+#endif
+    post.base = esp_event_batch_base;
+    post.id = event_count;
+
+    esp_err_t err = post_instance_send(loop, &post, event_count, ticks_to_wait);
+
+    if (err != ESP_OK) {
+        post_instance_delete(loop, &post);
+    }
+
+    return err;
+}
+
+esp_err_t esp_event_post_buffer_to(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
+                                   void* event_data, esp_event_data_release_t release, TickType_t ticks_to_wait)
+{
+    assert(event_loop);
+
+    if (event_base == ESP_EVENT_ANY_BASE || event_id == ESP_EVENT_ANY_ID) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
+
+    esp_event_post_instance_t post;
+    memset((void*)(&post), 0, sizeof(post));
+
+    if (event_data != NULL) {
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+        post.data.ptr = event_data;
+        post.data_allocated = true;
+        post.data_set = true;
+#else
+        post.data = event_data;
+#endif
+        post.release = release ? release : payload_release_none;
+    }
+    post.base = event_base;
+    post.id = event_id;
+
+    // On failure the caller keeps ownership of event_data, so the post is not deleted
+    esp_err_t err = post_instance_send(loop, &post, 1, ticks_to_wait);
+
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-    atomic_fetch_add(&loop->events_recieved, 1);
+    if (err == ESP_OK) {
+        atomic_fetch_add(&loop->payloads_buffer, 1);
+    }
 #endif
 
-    return ESP_OK;
+    return err;
 }
 
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
@@ -924,7 +1383,7 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
     result = xQueueSendToBackFromISR(loop->queue, &post, task_unblocked);
 
     if (result != pdTRUE) {
-        post_instance_delete(&post);
+        post_instance_delete(loop, &post);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
         atomic_fetch_add(&loop->events_dropped, 1);
@@ -962,13 +1421,16 @@ esp_err_t esp_event_dump(FILE* file)
     portENTER_CRITICAL(&s_event_loops_spinlock);
 
     SLIST_FOREACH(loop_it, &s_event_loops, next) {
-        uint32_t events_recieved, events_dropped;
+        uint32_t events_recieved, events_dropped, payloads_heap, payloads_pooled, payloads_buffer;
 
         events_recieved = atomic_load(&loop_it->events_recieved);
         events_dropped = atomic_load(&loop_it->events_dropped);
+        payloads_heap = atomic_load(&loop_it->payloads_heap);
+        payloads_pooled = atomic_load(&loop_it->payloads_pooled);
+        payloads_buffer = atomic_load(&loop_it->payloads_buffer);
 
         PRINT_DUMP_INFO(dst, sz, LOOP_DUMP_FORMAT, loop_it, loop_it->task != NULL ? loop_it->name : "none",
-                        events_recieved, events_dropped);
+                        events_recieved, events_dropped, payloads_heap, payloads_pooled, payloads_buffer);
 
         int sz_bak = sz;
 
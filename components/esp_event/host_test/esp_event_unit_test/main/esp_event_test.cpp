@@ -8,6 +8,12 @@
 */
 
 #include <stdio.h>
+#include <string.h>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
 #include "esp_event.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -40,6 +46,91 @@ static esp_event_loop_args_t test_event_get_default_loop_args(void)
 
 void dummy_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data) { }
 
+void counting_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    (*static_cast<size_t*>(event_handler_arg))++;
+}
+
+struct ReceivedData {
+    void* data;
+    uint8_t first;
+    uint8_t last;
+};
+
+void recording_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    // the last byte of the event data is only meaningful for the events of size 16 posted by the test case
+    uint8_t* bytes = static_cast<uint8_t*>(event_data);
+    static_cast<std::vector<ReceivedData>*>(event_handler_arg)->push_back({event_data, bytes[0], bytes[event_id]});
+}
+
+std::vector<void*> s_released_data;
+
+void recording_release(void* event_data)
+{
+    s_released_data.push_back(event_data);
+}
+
+std::string s_call_order;
+
+// appends the name passed as handler argument to s_call_order
+void naming_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    s_call_order += static_cast<const char*>(event_handler_arg);
+}
+
+/**
+ * Replaces the mocked event queue by a real FIFO, so that posted events can be dispatched by esp_event_loop_run().
+ */
+struct StubQueue : public CMockFix {
+    StubQueue()
+    {
+        xQueueGenericCreate_Stub(create);
+        xQueueGenericSend_Stub(send);
+        xQueueReceive_Stub(receive);
+    }
+
+    ~StubQueue()
+    {
+        xQueueGenericCreate_Stub(nullptr);
+        xQueueGenericSend_Stub(nullptr);
+        xQueueReceive_Stub(nullptr);
+        items.clear();
+    }
+
+    static QueueHandle_t create(const UBaseType_t queue_length, const UBaseType_t item_size, const uint8_t queue_type, int num_calls)
+    {
+        REQUIRE(item_size <= sizeof(Item));
+        StubQueue::item_size = item_size;
+        return reinterpret_cast<QueueHandle_t>(0xdeadbeef);
+    }
+
+    static BaseType_t send(QueueHandle_t queue, const void* const item, TickType_t ticks_to_wait, const BaseType_t copy_position, int num_calls)
+    {
+        items.emplace_back();
+        memcpy(items.back().data(), item, item_size);
+        return pdTRUE;
+    }
+
+    static BaseType_t receive(QueueHandle_t queue, void* const buffer, TickType_t ticks_to_wait, int num_calls)
+    {
+        if (items.empty()) {
+            return pdFALSE;
+        }
+        memcpy(buffer, items.front().data(), item_size);
+        items.pop_front();
+        return pdTRUE;
+    }
+
+    typedef std::array<uint8_t, 64> Item;
+
+    static size_t item_size;
+    static std::deque<Item> items;
+};
+
+size_t StubQueue::item_size;
+std::deque<StubQueue::Item> StubQueue::items;
+
 }
 
 // TODO: IDF-2693, function definition just to satisfy linker, implement esp_common instead
@@ -149,3 +240,356 @@ TEST_CASE("registering with ANY_BASE but specific ID fails")
                                           dummy_handler,
                                           nullptr) == ESP_ERR_INVALID_ARG);
 }
+
+TEST_CASE("benchmark event dispatch against number of registered handlers")
+{
+    const size_t BASE_COUNT = 40;
+    const size_t EVENT_COUNT = 10000;
+    static const char bases[BASE_COUNT][sizeof("BASE_00")] = {}; // only the addresses identify the bases
+
+    StubQueue queue;
+    MockMutex sem(CreateAnd::IGNORE);
+    xQueueTakeMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xTaskGetTickCount_IgnoreAndReturn(0);
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn(nullptr);
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+
+    for (int32_t ids_per_base : {1, 10, 100, 500}) {
+        esp_event_loop_handle_t loop = nullptr;
+        REQUIRE(ESP_OK == esp_event_loop_create(&loop_args, &loop));
+
+        size_t handled = 0;
+        for (size_t base = 0; base < BASE_COUNT; base++) {
+            for (int32_t id = 0; id < ids_per_base; id++) {
+                REQUIRE(ESP_OK == esp_event_handler_register_with(loop, bases[base], id, counting_handler, &handled));
+            }
+        }
+
+        size_t failed = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < EVENT_COUNT; i++) {
+            failed += esp_event_post_to(loop, bases[i % BASE_COUNT], (i * 7) % ids_per_base, nullptr, 0, 0) != ESP_OK;
+            failed += esp_event_loop_run(loop, portMAX_DELAY) != ESP_OK;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        CHECK(failed == 0);
+        CHECK(handled == EVENT_COUNT);
+        printf("%6d handlers: %10.0f events/s\n", (int) (BASE_COUNT * ids_per_base), EVENT_COUNT / elapsed.count());
+
+        CHECK(ESP_OK == esp_event_loop_delete(loop));
+    }
+
+    xTaskGetCurrentTaskHandle_StopIgnore();
+    xTaskGetTickCount_StopIgnore();
+    xQueueGiveMutexRecursive_StopIgnore();
+    xQueueTakeMutexRecursive_StopIgnore();
+}
+
+TEST_CASE("event data is copied to the payload pool or the heap, posted buffers are released after dispatch")
+{
+    static const char base[] = "BASE";
+    std::vector<ReceivedData> received;
+
+    StubQueue queue;
+    MockMutex sem(CreateAnd::IGNORE);
+    xQueueTakeMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xTaskGetTickCount_IgnoreAndReturn(0);
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn(nullptr);
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+    loop_args.payload_pool_size = 2;
+    loop_args.payload_pool_item_size = 16;
+
+    esp_event_loop_handle_t loop = nullptr;
+    REQUIRE(ESP_OK == esp_event_loop_create(&loop_args, &loop));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base, 0, recording_handler, &received));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base, 15, recording_handler, &received));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base, 16, recording_handler, &received));
+
+    // two fit into the pool, the third is posted while the pool is exhausted, the fourth is too large for it
+    uint8_t data[4][17];
+    for (size_t i = 0; i < 4; i++) {
+        memset(data[i], i + 1, sizeof(data[i]));
+        CHECK(ESP_OK == esp_event_post_to(loop, base, i < 3 ? 15 : 16, data[i], i < 3 ? 16 : 17, 0));
+    }
+    CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+    REQUIRE(received.size() == 4);
+    for (size_t i = 0; i < 4; i++) {
+        CHECK(received[i].first == i + 1);
+        CHECK(received[i].last == i + 1);
+    }
+
+    // the pool buffers are returned after dispatch and reused
+    void* pooled[2] = {received[0].data, received[1].data};
+    CHECK(pooled[0] != pooled[1]);
+    received.clear();
+    CHECK(ESP_OK == esp_event_post_to(loop, base, 15, data[0], 16, 0));
+    CHECK(ESP_OK == esp_event_post_to(loop, base, 15, data[1], 16, 0));
+    CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+    REQUIRE(received.size() == 2);
+    CHECK(received[0].data != received[1].data);
+    CHECK((received[0].data == pooled[0] || received[0].data == pooled[1]));
+    CHECK((received[1].data == pooled[0] || received[1].data == pooled[1]));
+
+    // posted buffers are passed to handlers as they are and released after dispatch or on loop deletion
+    s_released_data.clear();
+    received.clear();
+    uint8_t buffer = 1;
+    CHECK(ESP_OK == esp_event_post_buffer_to(loop, base, 0, &buffer, recording_release, 0));
+    CHECK(s_released_data.empty());
+    CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+    REQUIRE(received.size() == 1);
+    CHECK(received[0].data == &buffer);
+    CHECK((s_released_data == std::vector<void*> {&buffer}));
+
+    CHECK(ESP_OK == esp_event_post_buffer_to(loop, base, 0, &buffer, recording_release, 0));
+    CHECK(ESP_OK == esp_event_loop_delete(loop));
+    CHECK((s_released_data == std::vector<void*> {&buffer, &buffer}));
+
+    xTaskGetCurrentTaskHandle_StopIgnore();
+    xTaskGetTickCount_StopIgnore();
+    xQueueGiveMutexRecursive_StopIgnore();
+    xQueueTakeMutexRecursive_StopIgnore();
+}
+
+TEST_CASE("events posted at once take one queue entry and are dispatched in order")
+{
+    static const char base[] = "BASE";
+    std::vector<ReceivedData> received;
+
+    StubQueue queue;
+    MockMutex sem(CreateAnd::IGNORE);
+    xQueueTakeMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xTaskGetTickCount_IgnoreAndReturn(0);
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn(nullptr);
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+
+    esp_event_loop_handle_t loop = nullptr;
+    REQUIRE(ESP_OK == esp_event_loop_create(&loop_args, &loop));
+    for (int32_t id = 0; id < 3; id++) {
+        REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base, id, recording_handler, &received));
+    }
+
+    uint8_t data[3][16];
+    esp_event_post_item_t events[3];
+    for (int32_t i = 0; i < 3; i++) {
+        memset(data[i], i + 1, sizeof(data[i]));
+        events[i] = {base, 2 - i, data[i], sizeof(data[i])};
+    }
+
+    CHECK(ESP_ERR_INVALID_ARG == esp_event_post_many_to(loop, events, 0, 0));
+    events[1].event_id = ESP_EVENT_ANY_ID;
+    CHECK(ESP_ERR_INVALID_ARG == esp_event_post_many_to(loop, events, 3, 0));
+    CHECK(StubQueue::items.empty());
+    events[1].event_id = 1;
+
+    CHECK(ESP_OK == esp_event_post_many_to(loop, events, 3, 0));
+    CHECK(StubQueue::items.size() == 1);
+
+    // single posts queued behind the batch are dispatched after it, also when the loop dispatches in batches
+    CHECK(ESP_OK == esp_event_post_to(loop, base, 0, data[0], sizeof(data[0]), 0));
+    CHECK(ESP_OK == esp_event_post_to(loop, base, 1, data[1], sizeof(data[1]), 0));
+    CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+
+    REQUIRE(received.size() == 5);
+    const uint8_t expected[5] = {1, 2, 3, 1, 2};
+    for (size_t i = 0; i < 5; i++) {
+        CHECK(received[i].first == expected[i]);
+    }
+
+    CHECK(ESP_OK == esp_event_post_many_to(loop, events, 3, 0));
+    CHECK(ESP_OK == esp_event_loop_delete(loop));
+
+    xTaskGetCurrentTaskHandle_StopIgnore();
+    xTaskGetTickCount_StopIgnore();
+    xQueueGiveMutexRecursive_StopIgnore();
+    xQueueTakeMutexRecursive_StopIgnore();
+}
+
+TEST_CASE("handlers of every level are dispatched in the order of the loop, base and ID node lists")
+{
+    static const char base_x[] = "BASE_X";
+    static const char base_y[] = "BASE_Y";
+
+    StubQueue queue;
+    MockMutex sem(CreateAnd::IGNORE);
+    xQueueTakeMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xTaskGetTickCount_IgnoreAndReturn(0);
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn(nullptr);
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+
+    esp_event_loop_handle_t loop = nullptr;
+    REQUIRE(ESP_OK == esp_event_loop_create(&loop_args, &loop));
+
+    // a loop level handler registered after base or ID level ones starts a new loop node,
+    // a base level handler registered after ID level ones of the same base starts a new base node
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, 1, naming_handler, (void*) "a"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, naming_handler, (void*) "b"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, ESP_EVENT_ANY_ID, naming_handler, (void*) "c"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_y, 1, naming_handler, (void*) "d"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, 1, naming_handler, (void*) "e"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, 2, naming_handler, (void*) "f"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, ESP_EVENT_ANY_ID, naming_handler, (void*) "g"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, naming_handler, (void*) "h"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_y, ESP_EVENT_ANY_ID, naming_handler, (void*) "i"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, 1, naming_handler, (void*) "j"));
+
+    const struct {
+        esp_event_base_t base;
+        int32_t id;
+        const char* order;
+    } posts[] = {
+        {base_x, 1, "abceghj"},
+        {base_x, 2, "bcfgh"},
+        {base_x, 3, "bcgh"},
+        {base_y, 1, "bdhi"},
+    };
+    for (const auto& post : posts) {
+        s_call_order.clear();
+        CHECK(ESP_OK == esp_event_post_to(loop, post.base, post.id, nullptr, 0, 0));
+        CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+        CHECK(s_call_order == post.order);
+    }
+
+    CHECK(ESP_OK == esp_event_loop_delete(loop));
+
+    xTaskGetCurrentTaskHandle_StopIgnore();
+    xTaskGetTickCount_StopIgnore();
+    xQueueGiveMutexRecursive_StopIgnore();
+    xQueueTakeMutexRecursive_StopIgnore();
+}
+
+struct ChangingHandlerArgs {
+    esp_event_loop_handle_t loop;
+    esp_event_base_t base;
+    bool done;
+};
+
+// registers the naming handler "n" for ID 1 of the base of the event and "m" for the other base, once
+void registering_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    ChangingHandlerArgs* args = static_cast<ChangingHandlerArgs*>(event_handler_arg);
+    s_call_order += "r";
+    if (!args->done) {
+        args->done = true;
+        CHECK(ESP_OK == esp_event_handler_register_with(args->loop, event_base, 1, naming_handler, (void*) "n"));
+        CHECK(ESP_OK == esp_event_handler_register_with(args->loop, args->base, 1, naming_handler, (void*) "m"));
+    }
+}
+
+TEST_CASE("handlers registered by a handler during dispatch are found by the following lookups")
+{
+    static const char base_x[] = "BASE_X";
+    static const char base_y[] = "BASE_Y";
+
+    StubQueue queue;
+    MockMutex sem(CreateAnd::IGNORE);
+    xQueueTakeMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xTaskGetTickCount_IgnoreAndReturn(0);
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn(nullptr);
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+
+    esp_event_loop_handle_t loop = nullptr;
+    REQUIRE(ESP_OK == esp_event_loop_create(&loop_args, &loop));
+
+    ChangingHandlerArgs args = {loop, base_y, false};
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, ESP_EVENT_ANY_ID, registering_handler, &args));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, 2, naming_handler, (void*) "a"));
+
+    // the ID nodes of the base node being dispatched are looked up after its base level handlers ran
+    s_call_order.clear();
+    CHECK(ESP_OK == esp_event_post_to(loop, base_x, 1, nullptr, 0, 0));
+    CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+    CHECK(s_call_order == "rn");
+
+    const struct {
+        esp_event_base_t base;
+        int32_t id;
+        const char* order;
+    } posts[] = {
+        {base_x, 1, "rn"},
+        {base_x, 2, "ra"},
+        {base_y, 1, "m"},
+    };
+    for (const auto& post : posts) {
+        s_call_order.clear();
+        CHECK(ESP_OK == esp_event_post_to(loop, post.base, post.id, nullptr, 0, 0));
+        CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+        CHECK(s_call_order == post.order);
+    }
+
+    CHECK(ESP_OK == esp_event_loop_delete(loop));
+
+    xTaskGetCurrentTaskHandle_StopIgnore();
+    xTaskGetTickCount_StopIgnore();
+    xQueueGiveMutexRecursive_StopIgnore();
+    xQueueTakeMutexRecursive_StopIgnore();
+}
+
+// unregisters the naming handler "n" for ID 1 of the base of the event, once
+void unregistering_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    ChangingHandlerArgs* args = static_cast<ChangingHandlerArgs*>(event_handler_arg);
+    s_call_order += "u";
+    if (!args->done) {
+        args->done = true;
+        CHECK(ESP_OK == esp_event_handler_unregister_with(args->loop, event_base, 1, naming_handler));
+    }
+}
+
+TEST_CASE("handlers unregistered by a handler during dispatch are not called")
+{
+    static const char base_x[] = "BASE_X";
+
+    StubQueue queue;
+    MockMutex sem(CreateAnd::IGNORE);
+    xQueueTakeMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+    xTaskGetTickCount_IgnoreAndReturn(0);
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn(nullptr);
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+
+    esp_event_loop_handle_t loop = nullptr;
+    REQUIRE(ESP_OK == esp_event_loop_create(&loop_args, &loop));
+
+    ChangingHandlerArgs args = {loop, base_x, false};
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, ESP_EVENT_ANY_ID, unregistering_handler, &args));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, 1, naming_handler, (void*) "n"));
+    REQUIRE(ESP_OK == esp_event_handler_register_with(loop, base_x, 2, naming_handler, (void*) "a"));
+
+    // the ID node of "n" is removed before it is looked up
+    s_call_order.clear();
+    CHECK(ESP_OK == esp_event_post_to(loop, base_x, 1, nullptr, 0, 0));
+    CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+    CHECK(s_call_order == "u");
+
+    s_call_order.clear();
+    CHECK(ESP_OK == esp_event_post_to(loop, base_x, 1, nullptr, 0, 0));
+    CHECK(ESP_OK == esp_event_post_to(loop, base_x, 2, nullptr, 0, 0));
+    CHECK(ESP_OK == esp_event_loop_run(loop, portMAX_DELAY));
+    CHECK(s_call_order == "uua");
+
+    CHECK(ESP_OK == esp_event_loop_delete(loop));
+
+    xTaskGetCurrentTaskHandle_StopIgnore();
+    xTaskGetTickCount_StopIgnore();
+    xQueueGiveMutexRecursive_StopIgnore();
+    xQueueTakeMutexRecursive_StopIgnore();
+}
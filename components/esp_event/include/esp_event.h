@@ -29,8 +29,29 @@ typedef struct {
     uint32_t task_stack_size;                   /**< stack size of the event loop task, ignored if task name is NULL */
     BaseType_t task_core_id;                    /**< core to which the event loop task is pinned to,
                                                         ignored if task name is NULL */
+    uint32_t payload_pool_size;                 /**< number of event data buffers preallocated for the loop,
+                                                        0 to allocate all event data copies from the heap */
+    uint32_t payload_pool_item_size;            /**< size of each preallocated event data buffer; event data that
+                                                        does not fit, or is posted while all buffers are in use,
+                                                        is copied to the heap instead. Ignored if pool size is 0 */
 } esp_event_loop_args_t;
 
+/**
+ * @brief Function called to release event data passed to esp_event_post_buffer_to, once all handlers have run
+ *
+ * @param event_data the event data buffer posted with the event
+ */
+typedef void (*esp_event_data_release_t)(void *event_data);
+
+/// Event posted together with others by esp_event_post_many_to
+typedef struct {
+    esp_event_base_t event_base;                /**< the event base that identifies the event */
+    int32_t event_id;                           /**< the event ID that identifies the event */
+    const void *event_data;                     /**< the data, specific to the event occurrence, that gets passed
+                                                        to the handler */
+    size_t event_data_size;                     /**< the size of the event data */
+} esp_event_post_item_t;
+
 /**
  * @brief Create a new event loop.
  *
@@ -92,6 +113,9 @@ esp_err_t esp_event_loop_delete_default(void);
  * execution. The guaranteed time of exit is therefore the allotted time + amount of time required to dispatch
  * the last dequeued event.
  *
+ * If CONFIG_ESP_EVENT_LOOP_RUN_BATCH_SIZE is larger than 1, events already waiting in the queue are dispatched
+ * in batches of up to that many events, and the allotted time is only checked after each batch.
+ *
  * In cases where waiting on the queue times out, ESP_OK is returned and not ESP_ERR_TIMEOUT, since it is
  * normal behavior.
  *
@@ -395,6 +419,109 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop,
                             size_t event_data_size,
                             TickType_t ticks_to_wait);
 
+/**
+ * @brief Posts several events to the default event loop at once.
+ *
+ * This function behaves in the same manner as esp_event_post_many_to, except the events are posted to the
+ * default event loop.
+ *
+ * @param[in] events the events to post, in the order in which they get dispatched
+ * @param[in] event_count number of events
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: No events, or invalid combination of event base and event ID
+ *  - ESP_ERR_INVALID_STATE: The default event loop has not been created
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_many(const esp_event_post_item_t *events,
+                              size_t event_count,
+                              TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts several events to the specified event loop at once.
+ *
+ * The events and copies of their data are kept in a single allocation, which takes up a single entry of the
+ * event queue and is enqueued with one queue operation. Either all events are posted or none of them are.
+ * The events are dispatched one after the other, in the order of the array, as if they had been posted by
+ * consecutive calls to esp_event_post_to.
+ *
+ * @param[in] event_loop the event loop to post to, must not be NULL
+ * @param[in] events the events to post, in the order in which they get dispatched
+ * @param[in] event_count number of events
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: No events, or invalid combination of event base and event ID
+ *  - ESP_ERR_NO_MEM: Cannot allocate memory for the events
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_many_to(esp_event_loop_handle_t event_loop,
+                                 const esp_event_post_item_t *events,
+                                 size_t event_count,
+                                 TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts an event to the default event loop, passing ownership of event_data instead of copying it.
+ *
+ * This function behaves in the same manner as esp_event_post_buffer_to, except the event is posted to the
+ * default event loop.
+ *
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] release function that releases event_data after all handlers have run; NULL if the buffer
+ *                    does not need to be released, e.g. if it is statically allocated
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @return
+ *  - ESP_OK: Success, the event loop library owns event_data
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ *  - ESP_ERR_INVALID_STATE: The default event loop has not been created
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_buffer(esp_event_base_t event_base,
+                                int32_t event_id,
+                                void *event_data,
+                                esp_event_data_release_t release,
+                                TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts an event to the specified event loop, passing ownership of event_data instead of copying it.
+ *
+ * Unlike esp_event_post_to, the event loop library does not copy event_data. The handlers receive the
+ * event_data pointer itself, and release is called with it once all handlers have run, or when the event
+ * is dropped because the loop is deleted. This avoids an allocation and a copy for large payloads that the
+ * caller has already built in a buffer of its own.
+ *
+ * @param[in] event_loop the event loop to post to, must not be NULL
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] release function that releases event_data after all handlers have run; NULL if the buffer
+ *                    does not need to be released, e.g. if it is statically allocated
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @note If the event could not be posted, release is not called and the caller keeps ownership of event_data.
+ *
+ * @return
+ *  - ESP_OK: Success, the event loop library owns event_data
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_buffer_to(esp_event_loop_handle_t event_loop,
+                                   esp_event_base_t event_base,
+                                   int32_t event_id,
+                                   void *event_data,
+                                   esp_event_data_release_t release,
+                                   TickType_t ticks_to_wait);
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 /**
  * @brief Special variant of esp_event_post for posting events from interrupt handlers.
@@ -473,12 +600,15 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop,
   where:
 
    event loop
-       format: address,name rx:total_received dr:total_dropped
+       format: address,name rx:total_received dr:total_dropped heap:heap_copies pool:pool_copies buf:buffer_posts
        where:
            address - memory address of the event loop
            name - name of the event loop, 'none' if no dedicated task
            total_received - number of successfully posted events
            total_dropped - number of events unsuccessfully posted due to queue being full
+           heap_copies - number of event data copies allocated from the heap
+           pool_copies - number of event data copies placed in the loop's payload pool
+           buffer_posts - number of events posted with esp_event_post_buffer_to, without a copy
 
    handler
        format: address ev:base,id inv:total_invoked run:total_runtime
@@ -41,6 +41,10 @@ typedef struct esp_event_id_node {
     esp_event_handler_nodes_t handlers;                             /**< list of handlers to be executed when
                                                                             this event is raised */
     SLIST_ENTRY(esp_event_id_node) next;                            /**< pointer to the next event node on the linked list */
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+    struct esp_event_base_node* owner;                              /**< base node this id node belongs to */
+    SLIST_ENTRY(esp_event_id_node) index_next;                      /**< next id node in the same dispatch index bucket */
+#endif
 } esp_event_id_node_t;
 
 typedef SLIST_HEAD(esp_event_id_nodes, esp_event_id_node) esp_event_id_nodes_t;
@@ -51,6 +55,10 @@ typedef struct esp_event_base_node {
                                                                             all events with this base */
     esp_event_id_nodes_t id_nodes;                                  /**< list of event ids with this base */
     SLIST_ENTRY(esp_event_base_node) next;                          /**< pointer to the next base node on the linked list */
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+    struct esp_event_loop_node* owner;                              /**< loop node this base node belongs to */
+    STAILQ_ENTRY(esp_event_base_node) index_next;                   /**< next base node in the same dispatch index bucket */
+#endif
 } esp_event_base_node_t;
 
 typedef SLIST_HEAD(esp_event_base_nodes, esp_event_base_node) esp_event_base_nodes_t;
@@ -65,6 +73,32 @@ typedef struct esp_event_loop_node {
 
 typedef SLIST_HEAD(esp_event_loop_nodes, esp_event_loop_node) esp_event_loop_nodes_t;
 
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+typedef STAILQ_HEAD(esp_event_base_index_bucket, esp_event_base_node) esp_event_base_index_bucket_t;
+typedef SLIST_HEAD(esp_event_id_index_bucket, esp_event_id_node) esp_event_id_index_bucket_t;
+
+/// Hash tables for finding the base nodes of a loop node and the id nodes of a base node without list traversal
+typedef struct esp_event_dispatch_index {
+    esp_event_base_index_bucket_t* base_buckets;                    /**< base nodes hashed by <loop node, base>, in
+                                                                            registration order within each bucket */
+    esp_event_id_index_bucket_t* id_buckets;                        /**< id nodes hashed by <base node, id> */
+    uint32_t base_bucket_count;                                     /**< number of base buckets, power of two */
+    uint32_t id_bucket_count;                                       /**< number of id buckets, power of two */
+    bool valid;                                                     /**< false if the index has to be rebuilt */
+} esp_event_dispatch_index_t;
+#endif
+
+/// Preallocated buffers for copies of posted event data
+typedef struct esp_event_payload_pool {
+    uint8_t* buffers;                                               /**< item_count buffers, item_stride bytes apart */
+    uint16_t* next_free;                                            /**< for each free buffer, index of the next one */
+    size_t item_size;                                               /**< maximum size of event data stored in a buffer */
+    size_t item_stride;                                             /**< item_size rounded up for alignment */
+    uint16_t item_count;                                            /**< number of buffers */
+    atomic_uint_least32_t free_head;                                /**< index of the first free buffer in the low half,
+                                                                            number of updates in the high half */
+} esp_event_payload_pool_t;
+
 /// Event loop
 typedef struct esp_event_loop_instance {
     const char* name;                                               /**< name of this event loop */
@@ -75,9 +109,16 @@ typedef struct esp_event_loop_instance {
     SemaphoreHandle_t mutex;                                        /**< mutex for updating the events linked list */
     esp_event_loop_nodes_t loop_nodes;                              /**< set of linked lists containing the
                                                                             registered handlers for the loop */
+#if CONFIG_ESP_EVENT_HASHED_DISPATCH
+    esp_event_dispatch_index_t index;                               /**< index of loop_nodes used for dispatching */
+#endif
+    esp_event_payload_pool_t payload_pool;                          /**< buffers for copies of event data */
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     atomic_uint_least32_t events_recieved;                          /**< number of events successfully posted to the loop */
     atomic_uint_least32_t events_dropped;                           /**< number of events dropped due to queue being full */
+    atomic_uint_least32_t payloads_heap;                            /**< number of event data copies allocated from heap */
+    atomic_uint_least32_t payloads_pooled;                          /**< number of event data copies placed in the pool */
+    atomic_uint_least32_t payloads_buffer;                          /**< number of events posted without a data copy */
     SemaphoreHandle_t profiling_mutex;                              /**< mutex used for profiliing */
     SLIST_ENTRY(esp_event_loop_instance) next;                      /**< next event loop in the list */
 #endif
@@ -101,6 +142,8 @@ typedef struct esp_event_post_instance {
     esp_event_base_t base;                                           /**< the event base */
     int32_t id;                                                      /**< the event id */
     esp_event_post_data_t data;                                      /**< data associated with the event */
+    esp_event_data_release_t release;                                /**< releases data passed by the poster, NULL if
+                                                                             data is a copy owned by the loop */
 } esp_event_post_instance_t;
 
 #ifdef __cplusplus
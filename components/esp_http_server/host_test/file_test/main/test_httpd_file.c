@@ -0,0 +1,281 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "esp_event.h"
+#include "esp_http_server.h"
+#include "esp_partition.h"
+#include "unity.h"
+
+#define TEST_PORT           8084
+#define TEST_DIR            "/tmp/httpd_file_test"
+#define FILE_SIZE           3000
+#define GZ_FILE_SIZE        100
+#define PART_OFFSET         0x1000
+#define PART_SIZE           100000  /* More than one window of mapped flash */
+#define PART_ETAG           "\"www-1.0\""
+
+typedef struct {
+    int status;
+    char hdrs[1024];
+    char body[PART_SIZE + 1];
+    size_t body_len;
+} response_t;
+
+static response_t s_resp;
+static const esp_partition_t *s_partition;
+
+static uint8_t content_byte(size_t i, int seed)
+{
+    return (uint8_t)((i * 7 + seed) % 251);
+}
+
+static void write_file(const char *path, size_t size, int seed)
+{
+    FILE *f = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    for (size_t i = 0; i < size; i++) {
+        fputc(content_byte(i, seed), f);
+    }
+    fclose(f);
+}
+
+static bool check_content(const char *body, size_t first, size_t len, int seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        if ((uint8_t)body[i] != content_byte(first + i, seed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t file_handler(httpd_req_t *req)
+{
+    const httpd_resp_file_opts_t opts = { .gzip = true };
+    httpd_resp_set_type(req, "application/javascript");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    esp_err_t ret = httpd_resp_send_file(req, (const char *)req->user_ctx, &opts);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        return httpd_resp_send_404(req);
+    }
+    return ret;
+}
+
+static esp_err_t partition_handler(httpd_req_t *req)
+{
+    const httpd_resp_file_opts_t opts = { .etag = PART_ETAG, .gzip = (req->user_ctx != NULL) };
+    return httpd_resp_send_partition(req, s_partition, PART_OFFSET, PART_SIZE, &opts);
+}
+
+static httpd_handle_t start_server(void)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    httpd_handle_t server = NULL;
+    TEST_ESP_OK(httpd_start(&server, &config));
+
+    const httpd_uri_t uris[] = {
+        { .uri = "/app.js", .method = HTTP_GET, .handler = file_handler, .user_ctx = TEST_DIR "/app.js" },
+        { .uri = "/app.js", .method = HTTP_HEAD, .handler = file_handler, .user_ctx = TEST_DIR "/app.js" },
+        { .uri = "/missing.js", .method = HTTP_GET, .handler = file_handler, .user_ctx = TEST_DIR "/missing.js" },
+        { .uri = "/www", .method = HTTP_GET, .handler = partition_handler, .user_ctx = NULL },
+        { .uri = "/www.gz", .method = HTTP_GET, .handler = partition_handler, .user_ctx = (void *)1 },
+    };
+    for (int i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        TEST_ESP_OK(httpd_register_uri_handler(server, &uris[i]));
+    }
+    return server;
+}
+
+/* Sends a request on a new connection and receives the response into s_resp */
+static void request(const char *method, const char *uri, const char *hdrs)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    char req[256];
+    int len = snprintf(req, sizeof(req), "%s %s HTTP/1.1\r\nHost: localhost\r\n%s\r\n", method, uri, hdrs);
+    TEST_ASSERT_EQUAL(len, send(fd, req, len, 0));
+
+    /* Headers */
+    size_t hdrs_len = 0;
+    char *end = NULL;
+    while (end == NULL) {
+        TEST_ASSERT_LESS_THAN(sizeof(s_resp.hdrs) - 1, hdrs_len);
+        ssize_t ret = recv(fd, s_resp.hdrs + hdrs_len, 1, 0);
+        TEST_ASSERT_EQUAL(1, ret);
+        hdrs_len++;
+        s_resp.hdrs[hdrs_len] = '\0';
+        end = strstr(s_resp.hdrs, "\r\n\r\n");
+    }
+    s_resp.status = atoi(s_resp.hdrs + strlen("HTTP/1.1 "));
+
+    /* Content, not sent for HEAD requests and for 304 responses */
+    s_resp.body_len = 0;
+    const char *field = strstr(s_resp.hdrs, "Content-Length: ");
+    if (field && strcmp(method, "HEAD") != 0) {
+        const size_t content_len = strtoul(field + strlen("Content-Length: "), NULL, 10);
+        TEST_ASSERT_LESS_OR_EQUAL(PART_SIZE, content_len);
+        while (s_resp.body_len < content_len) {
+            ssize_t ret = recv(fd, s_resp.body + s_resp.body_len, content_len - s_resp.body_len, 0);
+            TEST_ASSERT_GREATER_THAN(0, ret);
+            s_resp.body_len += ret;
+        }
+    }
+    close(fd);
+}
+
+static bool has_hdr(const char *hdr)
+{
+    return strstr(s_resp.hdrs, hdr) != NULL;
+}
+
+/* Copies the value of the ETag header */
+static void get_etag(char *etag, size_t size)
+{
+    const char *field = strstr(s_resp.hdrs, "ETag: ");
+    TEST_ASSERT_NOT_NULL(field);
+    field += strlen("ETag: ");
+    const size_t len = strcspn(field, "\r");
+    TEST_ASSERT_LESS_THAN(size, len);
+    memcpy(etag, field, len);
+    etag[len] = '\0';
+}
+
+TEST_CASE("file is sent with ranges, entity tags and gzip variant", "[httpd][file]")
+{
+    mkdir(TEST_DIR, 0755);
+    write_file(TEST_DIR "/app.js", FILE_SIZE, 1);
+    write_file(TEST_DIR "/app.js.gz", GZ_FILE_SIZE, 2);
+    httpd_handle_t server = start_server();
+    char etag[64];
+    char hdrs[128];
+
+    request("GET", "/app.js", "");
+    TEST_ASSERT_EQUAL(200, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("Content-Type: application/javascript\r\n"));
+    TEST_ASSERT_TRUE(has_hdr("Accept-Ranges: bytes\r\n"));
+    TEST_ASSERT_TRUE(has_hdr("Vary: Accept-Encoding\r\n"));
+    TEST_ASSERT_TRUE(has_hdr("Cache-Control: no-cache\r\n"));
+    TEST_ASSERT_FALSE(has_hdr("Content-Encoding"));
+    TEST_ASSERT_EQUAL(FILE_SIZE, s_resp.body_len);
+    TEST_ASSERT_TRUE(check_content(s_resp.body, 0, FILE_SIZE, 1));
+    get_etag(etag, sizeof(etag));
+
+    /* Not modified */
+    snprintf(hdrs, sizeof(hdrs), "If-None-Match: \"other\", %s\r\n", etag);
+    request("GET", "/app.js", hdrs);
+    TEST_ASSERT_EQUAL(304, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr(etag));
+    TEST_ASSERT_FALSE(has_hdr("Content-Length"));
+
+    /* Ranges */
+    request("GET", "/app.js", "Range: bytes=1000-1099\r\n");
+    TEST_ASSERT_EQUAL(206, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("Content-Range: bytes 1000-1099/3000\r\n"));
+    TEST_ASSERT_EQUAL(100, s_resp.body_len);
+    TEST_ASSERT_TRUE(check_content(s_resp.body, 1000, 100, 1));
+
+    request("GET", "/app.js", "Range: bytes=-10\r\n");
+    TEST_ASSERT_EQUAL(206, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("Content-Range: bytes 2990-2999/3000\r\n"));
+    TEST_ASSERT_TRUE(check_content(s_resp.body, 2990, 10, 1));
+
+    request("GET", "/app.js", "Range: bytes=2500-\r\n");
+    TEST_ASSERT_EQUAL(206, s_resp.status);
+    TEST_ASSERT_EQUAL(500, s_resp.body_len);
+
+    request("GET", "/app.js", "Range: bytes=3000-\r\n");
+    TEST_ASSERT_EQUAL(416, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("Content-Range: bytes */3000\r\n"));
+
+    /* Several ranges and ranges of another version are sent as the whole file */
+    request("GET", "/app.js", "Range: bytes=0-9,20-29\r\n");
+    TEST_ASSERT_EQUAL(200, s_resp.status);
+    TEST_ASSERT_EQUAL(FILE_SIZE, s_resp.body_len);
+    request("GET", "/app.js", "Range: bytes=0-9\r\nIf-Range: \"other\"\r\n");
+    TEST_ASSERT_EQUAL(200, s_resp.status);
+    snprintf(hdrs, sizeof(hdrs), "Range: bytes=0-9\r\nIf-Range: %s\r\n", etag);
+    request("GET", "/app.js", hdrs);
+    TEST_ASSERT_EQUAL(206, s_resp.status);
+
+    /* The gzip variant has its own entity tag */
+    request("GET", "/app.js", "Accept-Encoding: br, gzip;q=0.8\r\n");
+    TEST_ASSERT_EQUAL(200, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("Content-Encoding: gzip\r\n"));
+    TEST_ASSERT_EQUAL(GZ_FILE_SIZE, s_resp.body_len);
+    TEST_ASSERT_TRUE(check_content(s_resp.body, 0, GZ_FILE_SIZE, 2));
+    TEST_ASSERT_FALSE(has_hdr(etag));
+    request("GET", "/app.js", "Accept-Encoding: gzip;q=0\r\n");
+    TEST_ASSERT_FALSE(has_hdr("Content-Encoding"));
+    TEST_ASSERT_EQUAL(FILE_SIZE, s_resp.body_len);
+
+    request("HEAD", "/app.js", "");
+    TEST_ASSERT_EQUAL(200, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("Content-Length: 3000\r\n"));
+
+    request("GET", "/missing.js", "");
+    TEST_ASSERT_EQUAL(404, s_resp.status);
+
+    TEST_ESP_OK(httpd_stop(server));
+    unlink(TEST_DIR "/app.js");
+    unlink(TEST_DIR "/app.js.gz");
+}
+
+TEST_CASE("partition is sent from mapped flash", "[httpd][file]")
+{
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "www");
+    TEST_ASSERT_NOT_NULL(s_partition);
+    static uint8_t content[PART_SIZE];
+    for (size_t i = 0; i < PART_SIZE; i++) {
+        content[i] = content_byte(i, 3);
+    }
+    TEST_ESP_OK(esp_partition_erase_range(s_partition, 0, s_partition->size));
+    TEST_ESP_OK(esp_partition_write(s_partition, PART_OFFSET, content, PART_SIZE));
+    httpd_handle_t server = start_server();
+
+    request("GET", "/www", "");
+    TEST_ASSERT_EQUAL(200, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("ETag: " PART_ETAG "\r\n"));
+    TEST_ASSERT_EQUAL(PART_SIZE, s_resp.body_len);
+    TEST_ASSERT_TRUE(check_content(s_resp.body, 0, PART_SIZE, 3));
+
+    request("GET", "/www", "If-None-Match: W/" PART_ETAG "\r\n");
+    TEST_ASSERT_EQUAL(304, s_resp.status);
+
+    request("GET", "/www", "Range: bytes=65000-66000\r\n");
+    TEST_ASSERT_EQUAL(206, s_resp.status);
+    TEST_ASSERT_EQUAL(1001, s_resp.body_len);
+    TEST_ASSERT_TRUE(check_content(s_resp.body, 65000, 1001, 3));
+
+    /* Pre-compressed content is only sent to clients accepting gzip */
+    request("GET", "/www.gz", "Accept-Encoding: gzip, deflate\r\n");
+    TEST_ASSERT_EQUAL(200, s_resp.status);
+    TEST_ASSERT_TRUE(has_hdr("Content-Encoding: gzip\r\n"));
+    request("GET", "/www.gz", "Accept-Encoding: identity\r\n");
+    TEST_ASSERT_EQUAL(406, s_resp.status);
+
+    TEST_ESP_OK(httpd_stop(server));
+}
+
+void app_main(void)
+{
+    esp_event_loop_create_default();
+    unity_run_menu();
+}
@@ -0,0 +1,268 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "esp_http_server.h"
+#include "unity.h"
+
+#define TEST_PORT           8085
+#define RUN_TIME_MS         1000
+#define PIPELINE_DEPTH      8
+#define MAX_BODY_LEN        512
+
+static const char s_small_req[] = "GET /small HTTP/1.1\r\nHost: localhost\r\nUser-Agent: test\r\nAccept: */*\r\n\r\n";
+
+/* Client side of a keep-alive connection, responses may arrive together */
+typedef struct {
+    int fd;
+    char buf[2048];
+    size_t len;
+} conn_t;
+
+static uint64_t get_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static esp_err_t small_handler(httpd_req_t *req)
+{
+    return httpd_resp_sendstr(req, "ok");
+}
+
+/* Responds with the URI, the value of the X-Test header and the content */
+static esp_err_t echo_handler(httpd_req_t *req)
+{
+    char hdr[16] = "";
+    char body[16] = "";
+    httpd_req_get_hdr_value_str(req, "X-Test", hdr, sizeof(hdr));
+    if (req->content_len >= sizeof(body)) {
+        return ESP_FAIL;
+    }
+    /* The content may arrive in several pieces */
+    for (size_t received = 0; received < req->content_len;) {
+        int ret = httpd_req_recv(req, body + received, req->content_len - received);
+        if (ret <= 0) {
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+
+    char resp[MAX_BODY_LEN];
+    snprintf(resp, sizeof(resp), "%s|%s|%s", req->uri, hdr, body);
+    return httpd_resp_sendstr(req, resp);
+}
+
+/* Nagle's algorithm would hold back the responses to pipelined requests
+ * after the first one until the client acknowledges it, which it delays */
+static esp_err_t open_session(httpd_handle_t hd, int sockfd)
+{
+    int one = 1;
+    return setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+static httpd_handle_t start_server(void)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+    config.open_fn = open_session;
+    httpd_handle_t server = NULL;
+    TEST_ESP_OK(httpd_start(&server, &config));
+
+    const httpd_uri_t uris[] = {
+        { .uri = "/small", .method = HTTP_GET, .handler = small_handler },
+        { .uri = "/echo*", .method = HTTP_GET, .handler = echo_handler },
+        { .uri = "/echo*", .method = HTTP_POST, .handler = echo_handler },
+    };
+    for (int i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        TEST_ESP_OK(httpd_register_uri_handler(server, &uris[i]));
+    }
+    return server;
+}
+
+static void conn_open(conn_t *conn)
+{
+    conn->fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, conn->fd);
+    conn->len = 0;
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    /* Fail instead of waiting forever for a pipelined request left unprocessed */
+    struct timeval timeout = { .tv_sec = 5 };
+    int one = 1;
+    TEST_ASSERT_EQUAL(0, connect(conn->fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)));
+    TEST_ASSERT_EQUAL(0, setsockopt(conn->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+}
+
+static void conn_send(conn_t *conn, const char *data, size_t len)
+{
+    TEST_ASSERT_EQUAL(len, send(conn->fd, data, len, 0));
+}
+
+/* Receives the next response and copies its content to body, returns the status */
+static int conn_recv_response(conn_t *conn, char *body, size_t body_size)
+{
+    while (true) {
+        conn->buf[conn->len] = '\0';
+        const char *end = strstr(conn->buf, "\r\n\r\n");
+        if (end) {
+            const char *field = strstr(conn->buf, "Content-Length: ");
+            TEST_ASSERT_NOT_NULL(field);
+            const size_t hdrs_len = end + 4 - conn->buf;
+            const size_t content_len = strtoul(field + strlen("Content-Length: "), NULL, 10);
+            TEST_ASSERT_LESS_THAN(body_size, content_len);
+            if (conn->len >= hdrs_len + content_len) {
+                const int status = atoi(conn->buf + strlen("HTTP/1.1 "));
+                memcpy(body, conn->buf + hdrs_len, content_len);
+                body[content_len] = '\0';
+                conn->len -= hdrs_len + content_len;
+                memmove(conn->buf, conn->buf + hdrs_len + content_len, conn->len);
+                return status;
+            }
+        }
+        TEST_ASSERT_LESS_THAN(sizeof(conn->buf) - 1, conn->len);
+        ssize_t ret = recv(conn->fd, conn->buf + conn->len, sizeof(conn->buf) - 1 - conn->len, 0);
+        TEST_ASSERT_GREATER_THAN(0, ret);
+        conn->len += ret;
+    }
+}
+
+/* Mixed requests, the long URI and headers don't fit in the scratch buffer together */
+static char s_long_uri[301];
+static char s_pad[251];
+
+static int build_mixed_requests(char *reqs, size_t size)
+{
+    memset(s_long_uri, 'a', sizeof(s_long_uri) - 1);
+    memcpy(s_long_uri, "/echo/", strlen("/echo/"));
+    memset(s_pad, 'b', sizeof(s_pad) - 1);
+
+    const int len = snprintf(reqs, size,
+                             "GET /echo?a=1 HTTP/1.1\r\nHost: localhost\r\nX-Test: one\r\n\r\n"
+                             "POST /echo HTTP/1.1\r\nContent-Length: 5\r\nX-Test: two\r\n\r\nhello"
+                             "GET /echo HTTP/1.1\r\n\r\n"
+                             "GET %s HTTP/1.1\r\nX-Pad: %s\r\nX-Test: four\r\n\r\n"
+                             "GET /small HTTP/1.1\r\n\r\n",
+                             s_long_uri, s_pad);
+    TEST_ASSERT_LESS_THAN(size, len);
+    return len;
+}
+
+static void check_mixed_responses(conn_t *conn)
+{
+    char body[MAX_BODY_LEN];
+    char expected[MAX_BODY_LEN];
+    TEST_ASSERT_EQUAL(200, conn_recv_response(conn, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("/echo?a=1|one|", body);
+    TEST_ASSERT_EQUAL(200, conn_recv_response(conn, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("/echo|two|hello", body);
+    TEST_ASSERT_EQUAL(200, conn_recv_response(conn, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("/echo||", body);
+    TEST_ASSERT_EQUAL(200, conn_recv_response(conn, body, sizeof(body)));
+    snprintf(expected, sizeof(expected), "%s|four|", s_long_uri);
+    TEST_ASSERT_EQUAL_STRING(expected, body);
+    TEST_ASSERT_EQUAL(200, conn_recv_response(conn, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("ok", body);
+}
+
+TEST_CASE("pipelined requests are processed in order", "[httpd][keepalive]")
+{
+    httpd_handle_t server = start_server();
+    conn_t conn;
+    conn_open(&conn);
+
+    static char reqs[2048];
+    const int len = build_mixed_requests(reqs, sizeof(reqs));
+    conn_send(&conn, reqs, len);
+    check_mixed_responses(&conn);
+
+    close(conn.fd);
+    TEST_ESP_OK(httpd_stop(server));
+}
+
+TEST_CASE("pipelined requests split at random points are processed in order", "[httpd][keepalive]")
+{
+    httpd_handle_t server = start_server();
+    conn_t conn;
+    conn_open(&conn);
+
+    static char reqs[2048];
+    const int len = build_mixed_requests(reqs, sizeof(reqs));
+
+    /* The server is already waiting for each piece, so a request can be partly in the pending
+     * data of the session and partly still in the socket when the previous one is done */
+    srand(1);
+    for (int round = 0; round < 20; round++) {
+        for (int sent = 0; sent < len;) {
+            const int size = 1 + rand() % 64;
+            const int piece = MIN(size, len - sent);
+            conn_send(&conn, reqs + sent, piece);
+            sent += piece;
+            usleep(200);
+        }
+        check_mixed_responses(&conn);
+    }
+
+    close(conn.fd);
+    TEST_ESP_OK(httpd_stop(server));
+}
+
+/* Sends the requests in batches of depth requests, returns the requests per second */
+static double run_small_gets(conn_t *conn, int depth)
+{
+    char batch[sizeof(s_small_req) * PIPELINE_DEPTH];
+    const size_t req_len = strlen(s_small_req);
+    for (int i = 0; i < depth; i++) {
+        memcpy(batch + i * req_len, s_small_req, req_len);
+    }
+
+    char body[16];
+    unsigned count = 0;
+    const uint64_t start = get_time_us();
+    uint64_t now = start;
+    while (now - start < RUN_TIME_MS * 1000) {
+        conn_send(conn, batch, depth * req_len);
+        for (int i = 0; i < depth; i++) {
+            TEST_ASSERT_EQUAL(200, conn_recv_response(conn, body, sizeof(body)));
+        }
+        count += depth;
+        now = get_time_us();
+    }
+    return count * 1e6 / (now - start);
+}
+
+TEST_CASE("keep-alive requests per second for small GETs", "[httpd][benchmark]")
+{
+    httpd_handle_t server = start_server();
+    conn_t conn;
+    conn_open(&conn);
+
+    const double sequential = run_small_gets(&conn, 1);
+    const double pipelined = run_small_gets(&conn, PIPELINE_DEPTH);
+    close(conn.fd);
+    TEST_ESP_OK(httpd_stop(server));
+
+    printf("keep-alive small GETs    req/s\n");
+    printf("sequential          %9.0f\n", sequential);
+    printf("pipelined, depth %d %9.0f\n", PIPELINE_DEPTH, pipelined);
+}
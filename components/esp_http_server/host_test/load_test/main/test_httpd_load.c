@@ -0,0 +1,271 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "esp_event.h"
+#include "esp_http_server.h"
+#include "unity.h"
+
+#define TEST_PORT           8082
+#define CLIENT_COUNT        8
+#define RUN_TIME_MS         2000
+#define MAX_SAMPLES         100000
+#define SLOW_EVERY          8       /* Every 8th request of a client goes to the slow handler */
+#define SLOW_HANDLER_MS     20
+#define MAX_TEST_FD         1024
+
+typedef struct {
+    int index;
+    uint32_t *fast_us;              /* Latency of the requests to the fast handler */
+    size_t fast_count;
+    uint32_t *all_us;               /* Latency of all requests */
+    size_t all_count;
+    int errors;
+} client_t;
+
+typedef struct {
+    double req_per_s;
+    uint32_t p50_fast_us;
+    uint32_t p99_fast_us;
+    uint32_t p99_all_us;
+    int errors;
+} load_result_t;
+
+static atomic_int s_in_handler[MAX_TEST_FD];
+static atomic_int s_overlaps;
+
+static uint64_t get_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Responds with the number of requests received on the session so far */
+static esp_err_t test_handler(httpd_req_t *req)
+{
+    int fd = httpd_req_to_sockfd(req);
+    if (fd < 0 || fd >= MAX_TEST_FD) {
+        return ESP_FAIL;
+    }
+    /* A session must never be processed by two workers at the same time */
+    if (atomic_exchange(&s_in_handler[fd], 1)) {
+        atomic_fetch_add(&s_overlaps, 1);
+    }
+
+    unsigned *count = httpd_sess_get_ctx(req->handle, fd);
+    if (count == NULL) {
+        count = calloc(1, sizeof(unsigned));
+        httpd_sess_set_ctx(req->handle, fd, count, NULL);
+    }
+    (*count)++;
+
+    if (req->user_ctx) {
+        usleep(SLOW_HANDLER_MS * 1000);
+    }
+    char resp[16];
+    snprintf(resp, sizeof(resp), "%u", *count);
+    esp_err_t ret = httpd_resp_sendstr(req, resp);
+
+    atomic_store(&s_in_handler[fd], 0);
+    return ret;
+}
+
+static httpd_handle_t start_server(uint16_t worker_count)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    config.max_open_sockets = CLIENT_COUNT;
+    config.backlog_conn = CLIENT_COUNT;
+    config.worker_count = worker_count;
+    config.worker_pin_per_core = true;
+
+    httpd_handle_t server = NULL;
+    TEST_ESP_OK(httpd_start(&server, &config));
+    const httpd_uri_t fast = { .uri = "/fast", .method = HTTP_GET, .handler = test_handler, .user_ctx = NULL };
+    const httpd_uri_t slow = { .uri = "/slow", .method = HTTP_GET, .handler = test_handler, .user_ctx = (void *)1 };
+    TEST_ESP_OK(httpd_register_uri_handler(server, &fast));
+    TEST_ESP_OK(httpd_register_uri_handler(server, &slow));
+    return server;
+}
+
+/* Receives a response, returns its body as a number or -1 */
+static int recv_response(int fd)
+{
+    char buf[256];
+    size_t len = 0;
+    char *body = NULL;
+    long content_len = -1;
+    while (body == NULL || len < (size_t)(body - buf) + content_len) {
+        if (len == sizeof(buf) - 1) {
+            return -1;
+        }
+        ssize_t ret = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (ret <= 0) {
+            return -1;
+        }
+        len += ret;
+        buf[len] = '\0';
+        if (body == NULL && (body = strstr(buf, "\r\n\r\n")) != NULL) {
+            body += 4;
+            const char *field = strstr(buf, "Content-Length: ");
+            if (field == NULL || field > body) {
+                return -1;
+            }
+            content_len = strtol(field + strlen("Content-Length: "), NULL, 10);
+        }
+    }
+    return atoi(body);
+}
+
+static void *client_task(void *arg)
+{
+    client_t *client = (client_t *)arg;
+    static const char fast_req[] = "GET /fast HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    static const char slow_req[] = "GET /slow HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int one = 1;
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0) {
+        client->errors++;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    const uint64_t end = get_time_us() + RUN_TIME_MS * 1000;
+    for (unsigned i = 0; get_time_us() < end && client->all_count < MAX_SAMPLES; i++) {
+        /* Clients don't send their slow requests at the same time */
+        const bool slow = (i + client->index) % SLOW_EVERY == 0;
+        const char *req = slow ? slow_req : fast_req;
+        const size_t req_len = slow ? sizeof(slow_req) - 1 : sizeof(fast_req) - 1;
+
+        const uint64_t start = get_time_us();
+        if (send(fd, req, req_len, 0) != (ssize_t)req_len) {
+            client->errors++;
+            break;
+        }
+        /* The session context counts the requests of the session */
+        int count = recv_response(fd);
+        if (count != (int)i + 1) {
+            client->errors++;
+            break;
+        }
+        const uint32_t latency = get_time_us() - start;
+        client->all_us[client->all_count++] = latency;
+        if (!slow) {
+            client->fast_us[client->fast_count++] = latency;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(uint32_t *samples, size_t count, int p)
+{
+    if (count == 0) {
+        return 0;
+    }
+    qsort(samples, count, sizeof(uint32_t), cmp_u32);
+    return samples[(count - 1) * p / 100];
+}
+
+static void run_load(uint16_t worker_count, load_result_t *result)
+{
+    httpd_handle_t server = start_server(worker_count);
+    atomic_store(&s_overlaps, 0);
+
+    static client_t clients[CLIENT_COUNT];
+    pthread_t threads[CLIENT_COUNT];
+    uint32_t *fast_us = calloc(CLIENT_COUNT * MAX_SAMPLES, sizeof(uint32_t));
+    uint32_t *all_us = calloc(CLIENT_COUNT * MAX_SAMPLES, sizeof(uint32_t));
+    TEST_ASSERT_NOT_NULL(fast_us);
+    TEST_ASSERT_NOT_NULL(all_us);
+
+    const uint64_t start = get_time_us();
+    for (int i = 0; i < CLIENT_COUNT; i++) {
+        clients[i] = (client_t) {
+            .index = i,
+            .fast_us = fast_us + i * MAX_SAMPLES,
+            .all_us = all_us + i * MAX_SAMPLES,
+        };
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, client_task, &clients[i]));
+    }
+    for (int i = 0; i < CLIENT_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    const double elapsed_s = (get_time_us() - start) / 1e6;
+    TEST_ESP_OK(httpd_stop(server));
+
+    /* Gather the samples at the start of the buffers */
+    size_t fast_count = 0;
+    size_t all_count = 0;
+    result->errors = 0;
+    for (int i = 0; i < CLIENT_COUNT; i++) {
+        memmove(fast_us + fast_count, clients[i].fast_us, clients[i].fast_count * sizeof(uint32_t));
+        fast_count += clients[i].fast_count;
+        memmove(all_us + all_count, clients[i].all_us, clients[i].all_count * sizeof(uint32_t));
+        all_count += clients[i].all_count;
+        result->errors += clients[i].errors;
+    }
+    result->req_per_s = all_count / elapsed_s;
+    result->p50_fast_us = percentile(fast_us, fast_count, 50);
+    result->p99_fast_us = percentile(fast_us, fast_count, 99);
+    result->p99_all_us = percentile(all_us, all_count, 99);
+    free(fast_us);
+    free(all_us);
+}
+
+TEST_CASE("slow handler doesn't stall other sessions with worker tasks", "[httpd][benchmark]")
+{
+    const uint16_t worker_counts[] = { 0, 1, 2, 4 };
+    load_result_t results[4];
+
+    printf("%d keep-alive clients, every %d-th request takes %d ms\n", CLIENT_COUNT, SLOW_EVERY, SLOW_HANDLER_MS);
+    printf(" workers      req/s  p50 fast us  p99 fast us   p99 all us\n");
+    for (int i = 0; i < 4; i++) {
+        run_load(worker_counts[i], &results[i]);
+        printf("%8d %10.0f %12"PRIu32" %12"PRIu32" %12"PRIu32"\n", worker_counts[i], results[i].req_per_s,
+               results[i].p50_fast_us, results[i].p99_fast_us, results[i].p99_all_us);
+        TEST_ASSERT_EQUAL(0, results[i].errors);
+        TEST_ASSERT_EQUAL(0, atomic_load(&s_overlaps));
+    }
+
+    /* With 4 workers, requests to the fast handler don't wait for the slow ones */
+    TEST_ASSERT_LESS_THAN(results[1].p99_fast_us, results[3].p99_fast_us);
+    TEST_ASSERT_GREATER_THAN((int)results[1].req_per_s, (int)results[3].req_per_s);
+}
+
+void app_main(void)
+{
+    esp_event_loop_create_default();
+    unity_run_menu();
+}
@@ -0,0 +1,175 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "esp_http_server.h"
+#include "unity.h"
+
+#define TEST_PORT           8083
+#define REQUEST_COUNT       20
+#define LARGE_BODY_LEN      2048
+
+typedef enum {
+    RESP_SMALL,
+    RESP_HEADERS,
+    RESP_LARGE,
+    RESP_CHUNKED,
+    RESP_KIND_COUNT,
+} resp_kind_t;
+
+static const char *const s_kind_names[RESP_KIND_COUNT] = {
+    "small", "4 headers", "2 KB body", "4 chunks",
+};
+
+/* The server task sends the responses one after the other, no locking needed */
+static resp_kind_t s_current_kind;
+static unsigned s_send_calls[RESP_KIND_COUNT];
+
+static uint64_t get_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int counting_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    s_send_calls[s_current_kind]++;
+    int ret = send(sockfd, buf, buf_len, flags);
+    if (ret < 0) {
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    return ret;
+}
+
+/* Nagle's algorithm is left enabled, it delays a response sent with several send() calls */
+static esp_err_t open_session(httpd_handle_t hd, int sockfd)
+{
+    return httpd_sess_set_send_override(hd, sockfd, counting_send);
+}
+
+static esp_err_t resp_handler(httpd_req_t *req)
+{
+    static char large_body[LARGE_BODY_LEN];
+    static const char json[] = "{\"status\":\"ok\",\"uptime\":12345}";
+
+    s_current_kind = (resp_kind_t)(intptr_t)req->user_ctx;
+    switch (s_current_kind) {
+    case RESP_SMALL:
+        return httpd_resp_sendstr(req, json);
+    case RESP_HEADERS:
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "X-Request-Id", "0123456789abcdef");
+        httpd_resp_set_hdr(req, "Server", "esp_http_server");
+        return httpd_resp_sendstr(req, json);
+    case RESP_LARGE:
+        memset(large_body, 'a', sizeof(large_body));
+        return httpd_resp_send(req, large_body, sizeof(large_body));
+    default:
+        for (int i = 0; i < 4; i++) {
+            if (httpd_resp_sendstr_chunk(req, json) != ESP_OK) {
+                return ESP_FAIL;
+            }
+        }
+        return httpd_resp_sendstr_chunk(req, NULL);
+    }
+}
+
+/* Receives a response with a Content-Length or in chunks */
+static bool recv_response(int fd)
+{
+    static char buf[LARGE_BODY_LEN + 512];
+    size_t len = 0;
+    while (len < sizeof(buf) - 1) {
+        ssize_t ret = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        len += ret;
+        buf[len] = '\0';
+        const char *body = strstr(buf, "\r\n\r\n");
+        if (body == NULL) {
+            continue;
+        }
+        body += 4;
+        const char *field = strstr(buf, "Content-Length: ");
+        if (field && field < body) {
+            if (len >= (size_t)(body - buf) + strtol(field + strlen("Content-Length: "), NULL, 10)) {
+                return true;
+            }
+        } else if (strstr(body, "\r\n0\r\n\r\n") || strncmp(body, "0\r\n\r\n", 5) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("small responses are sent with a single send call", "[httpd][benchmark]")
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    config.max_uri_handlers = RESP_KIND_COUNT;
+    config.open_fn = open_session;
+    httpd_handle_t server = NULL;
+    TEST_ESP_OK(httpd_start(&server, &config));
+
+    static const char *const uris[RESP_KIND_COUNT] = { "/small", "/headers", "/large", "/chunked" };
+    for (int i = 0; i < RESP_KIND_COUNT; i++) {
+        const httpd_uri_t uri = {
+            .uri = uris[i], .method = HTTP_GET, .handler = resp_handler, .user_ctx = (void *)(intptr_t)i
+        };
+        TEST_ESP_OK(httpd_register_uri_handler(server, &uri));
+    }
+    memset(s_send_calls, 0, sizeof(s_send_calls));
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int one = 1;
+    TEST_ASSERT_EQUAL(0, connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)));
+
+    uint64_t latency_us[RESP_KIND_COUNT];
+    for (int k = 0; k < RESP_KIND_COUNT; k++) {
+        char req[64];
+        const int req_len = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", uris[k]);
+        const uint64_t start = get_time_us();
+        for (int i = 0; i < REQUEST_COUNT; i++) {
+            TEST_ASSERT_EQUAL(req_len, send(fd, req, req_len, 0));
+            TEST_ASSERT_TRUE(recv_response(fd));
+        }
+        latency_us[k] = (get_time_us() - start) / REQUEST_COUNT;
+    }
+    close(fd);
+    TEST_ESP_OK(httpd_stop(server));
+
+    printf("response     send calls  latency us\n");
+    for (int k = 0; k < RESP_KIND_COUNT; k++) {
+        printf("%-10s %12.1f %11"PRIu64"\n", s_kind_names[k], (double)s_send_calls[k] / REQUEST_COUNT, latency_us[k]);
+    }
+
+    /* Headers and body share one send call when they fit in the scratch buffer,
+     * a large body follows the headers, each chunk is sent with one call */
+    TEST_ASSERT_EQUAL(REQUEST_COUNT, s_send_calls[RESP_SMALL]);
+    TEST_ASSERT_EQUAL(REQUEST_COUNT, s_send_calls[RESP_HEADERS]);
+    TEST_ASSERT_EQUAL(2 * REQUEST_COUNT, s_send_calls[RESP_LARGE]);
+    TEST_ASSERT_EQUAL(5 * REQUEST_COUNT, s_send_calls[RESP_CHUNKED]);
+}
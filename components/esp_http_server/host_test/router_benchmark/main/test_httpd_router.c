@@ -0,0 +1,234 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_http_server.h"
+#include "httpd_router.h"
+#include "unity.h"
+
+#define MAX_ROUTES          500
+#define MAX_URI_LEN         48
+#define BENCH_LOOKUPS       200000
+
+typedef struct {
+    char uri[MAX_URI_LEN];
+    httpd_method_t method;
+} route_t;
+
+static route_t s_routes[MAX_ROUTES];
+static uint32_t s_seed;
+
+static uint32_t next_random(void)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static double get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Same matching as esp_http_server does without the router: the first handler
+ * in order of registration whose URI and method match */
+static int linear_find(size_t count, bool wildcard, const char *uri, size_t len,
+                       httpd_method_t method, httpd_err_code_t *err)
+{
+    *err = HTTPD_404_NOT_FOUND;
+    for (size_t i = 0; i < count; i++) {
+        const bool match = wildcard ? httpd_uri_match_wildcard(s_routes[i].uri, uri, len) :
+                           (strlen(s_routes[i].uri) == len && strncmp(s_routes[i].uri, uri, len) == 0);
+        if (match) {
+            if (s_routes[i].method == method || s_routes[i].method == HTTP_ANY) {
+                *err = 0;
+                return i;
+            }
+            *err = HTTPD_405_METHOD_NOT_ALLOWED;
+        }
+    }
+    return -1;
+}
+
+static struct httpd_router *create_router(size_t count, bool wildcard)
+{
+    struct httpd_router *router = httpd_router_create(wildcard);
+    TEST_ASSERT_NOT_NULL(router);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ESP_OK(httpd_router_add(router, s_routes[i].uri, s_routes[i].method, i));
+    }
+    return router;
+}
+
+static void random_string(char *str, size_t max_len)
+{
+    /* Few characters, so that the strings share prefixes and contain the special characters */
+    static const char chars[] = "ab/?*";
+    const size_t len = next_random() % (max_len + 1);
+    for (size_t i = 0; i < len; i++) {
+        str[i] = chars[next_random() % (sizeof(chars) - 1)];
+    }
+    str[len] = '\0';
+}
+
+static httpd_method_t random_method(void)
+{
+    static const httpd_method_t methods[] = { HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_ANY };
+    return methods[next_random() % 4];
+}
+
+TEST_CASE("router finds the same handler and error as matching the handlers in order", "[httpd][router]")
+{
+    s_seed = 1;
+    for (int round = 0; round < 200; round++) {
+        const bool wildcard = round % 4 != 0;
+        const size_t count = 1 + next_random() % 20;
+        for (size_t i = 0; i < count; i++) {
+            random_string(s_routes[i].uri, 5);
+            s_routes[i].method = random_method();
+        }
+        struct httpd_router *router = create_router(count, wildcard);
+
+        for (int i = 0; i < 500; i++) {
+            char uri[8];
+            random_string(uri, 6);
+            /* The URI isn't necessarily null terminated */
+            const size_t len = next_random() % (strlen(uri) + 1);
+            const httpd_method_t method = random_method();
+            httpd_err_code_t expected_err;
+            httpd_err_code_t err;
+            const int expected = linear_find(count, wildcard, uri, len, method, &expected_err);
+            const int found = httpd_router_find(router, uri, len, method, &err);
+            if (found != expected || err != expected_err) {
+                printf("URI '%.*s' method %d: expected %d/%d, found %d/%d\n",
+                       (int)len, uri, method, expected, expected_err, found, err);
+            }
+            TEST_ASSERT_EQUAL(expected, found);
+            TEST_ASSERT_EQUAL(expected_err, err);
+        }
+        httpd_router_delete(router);
+    }
+}
+
+TEST_CASE("router reports 404 and 405", "[httpd][router]")
+{
+    struct httpd_router *router = httpd_router_create(true);
+    TEST_ASSERT_NOT_NULL(router);
+    TEST_ESP_OK(httpd_router_add(router, "/api/led", HTTP_GET, 0));
+    TEST_ESP_OK(httpd_router_add(router, "/api/led", HTTP_POST, 1));
+    TEST_ESP_OK(httpd_router_add(router, "/api/files/*", HTTP_GET, 2));
+    TEST_ESP_OK(httpd_router_add(router, "/api/*", HTTP_ANY, 3));
+    TEST_ESP_OK(httpd_router_add(router, "/status/?", HTTP_GET, 4));
+    httpd_err_code_t err;
+
+    TEST_ASSERT_EQUAL(1, httpd_router_find(router, "/api/led", 8, HTTP_POST, &err));
+    TEST_ASSERT_EQUAL(0, err);
+    TEST_ASSERT_EQUAL(2, httpd_router_find(router, "/api/files/a/b", 14, HTTP_GET, &err));
+    /* Earlier handlers for the URI don't accept the method, the catch-all does */
+    TEST_ASSERT_EQUAL(3, httpd_router_find(router, "/api/led", 8, HTTP_DELETE, &err));
+    TEST_ASSERT_EQUAL(3, httpd_router_find(router, "/api/files/a", 12, HTTP_PUT, &err));
+    TEST_ASSERT_EQUAL(4, httpd_router_find(router, "/status/", 8, HTTP_GET, &err));
+
+    TEST_ASSERT_EQUAL(-1, httpd_router_find(router, "/status", 7, HTTP_PUT, &err));
+    TEST_ASSERT_EQUAL(HTTPD_405_METHOD_NOT_ALLOWED, err);
+    TEST_ASSERT_EQUAL(-1, httpd_router_find(router, "/status/x", 9, HTTP_GET, &err));
+    TEST_ASSERT_EQUAL(HTTPD_404_NOT_FOUND, err);
+    TEST_ASSERT_EQUAL(-1, httpd_router_find(router, "/ap", 3, HTTP_GET, &err));
+    TEST_ASSERT_EQUAL(HTTPD_404_NOT_FOUND, err);
+    httpd_router_delete(router);
+}
+
+/* Routes of a REST API: each resource has a status, a configuration with
+ * an optional trailing slash and files under a wildcard path */
+static void init_api_routes(size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        switch (i % 4) {
+        case 0:
+            snprintf(s_routes[i].uri, MAX_URI_LEN, "/api/v1/res%zu/status", i / 4);
+            s_routes[i].method = HTTP_GET;
+            break;
+        case 1:
+            snprintf(s_routes[i].uri, MAX_URI_LEN, "/api/v1/res%zu/config/?", i / 4);
+            s_routes[i].method = HTTP_GET;
+            break;
+        case 2:
+            snprintf(s_routes[i].uri, MAX_URI_LEN, "/api/v1/res%zu/config/?", i / 4);
+            s_routes[i].method = HTTP_POST;
+            break;
+        default:
+            snprintf(s_routes[i].uri, MAX_URI_LEN, "/api/v1/res%zu/files/*", i / 4);
+            s_routes[i].method = HTTP_ANY;
+            break;
+        }
+    }
+}
+
+TEST_CASE("router versus matching the handlers in order with 10, 100 and 500 handlers", "[httpd][benchmark]")
+{
+    static const size_t counts[] = { 10, 100, MAX_ROUTES };
+    static char uris[MAX_ROUTES][MAX_URI_LEN];
+    static httpd_method_t methods[MAX_ROUTES];
+    double linear_ns[3];
+    double router_ns[3];
+
+    printf("handlers  linear ns/lookup  router ns/lookup\n");
+    for (int c = 0; c < 3; c++) {
+        const size_t count = counts[c];
+        init_api_routes(count);
+        struct httpd_router *router = create_router(count, true);
+
+        /* Requests to all handlers, with the URI of the request in its own buffer */
+        for (size_t i = 0; i < count; i++) {
+            strlcpy(uris[i], s_routes[i].uri, MAX_URI_LEN);
+            char *special = strpbrk(uris[i], "?*");
+            if (special && *special == '?') {
+                /* Without the optional trailing slash */
+                special[-1] = '\0';
+            } else if (special) {
+                strlcpy(special, "log.txt", MAX_URI_LEN - (special - uris[i]));
+            }
+            methods[i] = s_routes[i].method == HTTP_ANY ? HTTP_PUT : s_routes[i].method;
+        }
+
+        volatile int sink = 0;
+        httpd_err_code_t err;
+        double start = get_time_ns();
+        for (int i = 0; i < BENCH_LOOKUPS; i++) {
+            const size_t r = i % count;
+            sink += linear_find(count, true, uris[r], strlen(uris[r]), methods[r], &err);
+        }
+        linear_ns[c] = (get_time_ns() - start) / BENCH_LOOKUPS;
+
+        start = get_time_ns();
+        for (int i = 0; i < BENCH_LOOKUPS; i++) {
+            const size_t r = i % count;
+            sink += httpd_router_find(router, uris[r], strlen(uris[r]), methods[r], &err);
+        }
+        router_ns[c] = (get_time_ns() - start) / BENCH_LOOKUPS;
+
+        for (size_t i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL(linear_find(count, true, uris[i], strlen(uris[i]), methods[i], &err),
+                              httpd_router_find(router, uris[i], strlen(uris[i]), methods[i], &err));
+        }
+        httpd_router_delete(router);
+        printf("%8zu %17.1f %17.1f\n", count, linear_ns[c], router_ns[c]);
+    }
+
+    /* The cost of the router depends on the length of the URI, not on the number of handlers */
+    TEST_ASSERT_LESS_THAN(linear_ns[2], router_ns[2]);
+    TEST_ASSERT_LESS_THAN(router_ns[0] * 4, router_ns[2]);
+}
+
+void app_main(void)
+{
+    unity_run_menu();
+}
@@ -16,6 +16,7 @@
 #include <esp_err.h>
 #include <esp_event.h>
 #include <esp_event_base.h>
+#include <esp_partition.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,7 +34,7 @@ typedef enum {
     HTTP_SERVER_EVENT_START,           /*!< This event occurs when HTTP Server is started */
     HTTP_SERVER_EVENT_ON_CONNECTED,    /*!< Once the HTTP Server has been connected to the client, no data exchange has been performed */
     HTTP_SERVER_EVENT_ON_HEADER,       /*!< Occurs when receiving each header sent from the client */
-    HTTP_SERVER_EVENT_HEADERS_SENT,     /*!< After sending all the headers to the client */
+    HTTP_SERVER_EVENT_HEADERS_SENT,     /*!< After sending all the headers to the client, which are sent together with the content */
     HTTP_SERVER_EVENT_ON_DATA,         /*!< Occurs when receiving data from the client */
     HTTP_SERVER_EVENT_SENT_DATA,       /*!< Occurs when an ESP HTTP server session is finished */
     HTTP_SERVER_EVENT_DISCONNECTED,    /*!< The connection has been disconnected */
@@ -55,6 +56,8 @@ initializer that should be kept in sync
         .stack_size         = 4096,                     \
         .core_id            = tskNO_AFFINITY,           \
         .task_caps          = (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),       \
+        .worker_count       = 0,                        \
+        .worker_pin_per_core = false,                   \
         .server_port        = 80,                       \
         .ctrl_port          = ESP_HTTPD_DEF_CTRL_PORT,  \
         .max_open_sockets   = 7,                        \
@@ -173,6 +176,25 @@ typedef struct httpd_config {
     BaseType_t  core_id;            /*!< The core the HTTP server task will run on */
     uint32_t    task_caps;          /*!< The memory capabilities to use when allocating the HTTP server task's stack */
 
+    /**
+     * Number of worker tasks which process the requests.
+     *
+     * If 0, the server task processes the requests itself, one at a time, so a slow URI
+     * handler delays the requests of all other clients. Otherwise the server task only
+     * accepts connections and waits for data, and hands each ready session to one of the
+     * worker tasks, which run the URI handlers concurrently. A session is processed by
+     * one worker task at a time, so the requests of a session are still handled in order.
+     *
+     * Work queued with httpd_queue_work(), including WebSocket frames sent with
+     * httpd_ws_send_data() and httpd_ws_send_data_async(), is still run by the server task,
+     * so it may run while a worker task processes a request of the same session.
+     *
+     * The worker tasks are created with the same task_priority, stack_size and task_caps
+     * as the server task.
+     */
+    uint16_t    worker_count;
+    bool        worker_pin_per_core; /*!< Pin worker task N to core (N % portNUM_PROCESSORS) instead of core_id */
+
     /**
      * TCP Port number for receiving and transmitting HTTP traffic
      */
@@ -824,7 +846,10 @@ esp_err_t httpd_sess_set_pending_override(httpd_handle_t hd, int sockfd, httpd_p
  *          in a request handler to get a request copy that can be used on a async thread.
  *
  * @note
- * - This function is necessary in order to handle multiple requests simultaneously.
+ * - This function is necessary in order to handle multiple requests simultaneously
+ * in the server task. With httpd_config_t::worker_count set, requests of different
+ * sessions are already handled simultaneously by the worker tasks, and this function
+ * is only needed to keep processing a request after its URI handler returns.
  * See examples/async_requests for example usage.
  * - You must call httpd_req_async_handler_complete() when you are done with the request.
  *
@@ -1091,6 +1116,9 @@ bool httpd_uri_match_wildcard(const char *uri_template, const char *uri_to_match
  *  - Once this API is called, all request headers are purged, so
  *    request headers need be copied into separate buffers if
  *    they are required later.
+ *  - The headers and the content are sent with a single call of the
+ *    send function if they fit in the internal buffer of
+ *    HTTPD_MAX_REQ_HDR_LEN or HTTPD_MAX_URI_LEN bytes, whichever is larger.
  *
  * @param[in] r         The request being responded to
  * @param[in] buf       Buffer from where the content is to be fetched
@@ -1130,6 +1158,9 @@ esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
  * - Once this API is called, all request headers are purged, so
  *   request headers need be copied into separate buffers if they
  *   are required later.
+ * - Each chunk, together with the headers for the first one, is sent
+ *   with a single call of the send function if it fits in the same
+ *   internal buffer as for httpd_resp_send().
  *
  * @param[in] r         The request being responded to
  * @param[in] buf       Pointer to a buffer that stores the data
@@ -1186,6 +1217,103 @@ static inline esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str
     return httpd_resp_send_chunk(r, str, (str == NULL) ? 0 : HTTPD_RESP_USE_STRLEN);
 }
 
+/**
+ * @brief   Options of a response sent by httpd_resp_send_file() or httpd_resp_send_partition()
+ */
+typedef struct httpd_resp_file_opts {
+    /**
+     * Entity tag of the content for httpd_resp_send_partition(), including the
+     * double quotes, e.g. "\"v1.2.0\"". NULL to send no ETag. httpd_resp_send_file()
+     * derives the entity tag from the size and modification time of the file and
+     * ignores this member.
+     */
+    const char *etag;
+
+    /**
+     * The content is available gzip compressed. httpd_resp_send_file() sends
+     * the file "<path>.gz" with "Content-Encoding: gzip" instead of the file
+     * "<path>" if it exists and the client accepts gzip. httpd_resp_send_partition()
+     * sends the content of the partition as is with "Content-Encoding: gzip", or
+     * responds with "406 Not Acceptable" if the client doesn't accept gzip.
+     */
+    bool gzip;
+} httpd_resp_file_opts_t;
+
+/**
+ * @brief   API to send a file as the HTTP response
+ *
+ * This API streams the file from the VFS into the socket, through the
+ * internal buffer used for the response headers, without allocating a
+ * buffer for the content. The request headers are taken into account:
+ *  - If-None-Match : "304 Not Modified" is sent if it matches the entity tag
+ *  - Range         : a single byte range is sent with "206 Partial Content",
+ *                    or "416 Range Not Satisfiable" is sent. Requests for
+ *                    several ranges are responded with the whole file.
+ *  - If-Range      : the Range header is only used if it matches the entity tag
+ *  - Accept-Encoding : the gzip variant is sent if enabled in the options
+ *
+ * For HEAD requests, only the headers are sent.
+ *
+ * The content type set with httpd_resp_set_type() and the additional headers
+ * set with httpd_resp_set_hdr() are sent. The status set with httpd_resp_set_status()
+ * is ignored.
+ *
+ * @note
+ *  - This API is supposed to be called only from the context of
+ *    a URI handler where httpd_req_t* request pointer is valid.
+ *  - Once this API has sent the response, all request headers are purged.
+ *  - If the file doesn't exist, nothing is sent, so that the URI handler
+ *    can send a different response.
+ *  - If reading the file fails after the headers have been sent, the URI
+ *    handler should return ESP_FAIL to close the connection.
+ *
+ * @param[in] r     The request being responded to
+ * @param[in] path  Path of the file in the VFS
+ * @param[in] opts  Options, NULL for the defaults
+ *
+ * @return
+ *  - ESP_OK : On successfully sending the response
+ *  - ESP_ERR_INVALID_ARG : Null request pointer or path
+ *  - ESP_ERR_NOT_FOUND   : The file can't be opened, nothing was sent
+ *  - ESP_ERR_HTTPD_RESP_HDR    : Essential headers are too large for internal buffer
+ *  - ESP_ERR_HTTPD_RESP_SEND   : Error in raw send
+ *  - ESP_ERR_HTTPD_INVALID_REQ : Invalid request
+ *  - ESP_FAIL : Error in reading the file after the headers were sent
+ */
+esp_err_t httpd_resp_send_file(httpd_req_t *r, const char *path, const httpd_resp_file_opts_t *opts);
+
+/**
+ * @brief   API to send a region of a flash partition as the HTTP response
+ *
+ * This API memory maps the region and passes the mapped flash directly to
+ * the send function of the session. If the region can't be mapped, e.g.
+ * because the partition is on an external flash chip, it is read through
+ * the internal buffer used for the response headers. The request headers
+ * are taken into account as described for httpd_resp_send_file().
+ *
+ * @note
+ *  - This API is supposed to be called only from the context of
+ *    a URI handler where httpd_req_t* request pointer is valid.
+ *  - Once this API has sent the response, all request headers are purged.
+ *
+ * @param[in] r         The request being responded to
+ * @param[in] partition Partition which contains the content
+ * @param[in] offset    Offset of the content in the partition
+ * @param[in] size      Size of the content
+ * @param[in] opts      Options, NULL for the defaults
+ *
+ * @return
+ *  - ESP_OK : On successfully sending the response
+ *  - ESP_ERR_INVALID_ARG  : Null request pointer or partition
+ *  - ESP_ERR_INVALID_SIZE : The region doesn't fit in the partition
+ *  - ESP_ERR_HTTPD_RESP_HDR    : Essential headers are too large for internal buffer
+ *  - ESP_ERR_HTTPD_RESP_SEND   : Error in raw send
+ *  - ESP_ERR_HTTPD_INVALID_REQ : Invalid request
+ *  - ESP_FAIL : Error in reading the partition after the headers were sent
+ */
+esp_err_t httpd_resp_send_partition(httpd_req_t *r, const esp_partition_t *partition,
+                                    size_t offset, size_t size, const httpd_resp_file_opts_t *opts);
+
 /* Some commonly used status codes */
 #define HTTPD_200      "200 OK"                     /*!< HTTP Response 200 */
 #define HTTPD_204      "204 No Content"             /*!< HTTP Response 204 */
@@ -1649,6 +1777,12 @@ typedef void (*httpd_work_fn_t)(void *arg);
  *          and send it to the persistently opened connection. This facility is for use
  *          by such protocols.
  *
+ * @note    With httpd_config_t::worker_count set, the work function runs in the server
+ *          task while the worker tasks process requests, also requests of the session the
+ *          work is for. It is not ordered with the responses sent by the URI handlers,
+ *          and must not send data on a socket whose URI handler may be sending too,
+ *          as the data could be interleaved.
+ *
  * @param[in] handle    Handle to server returned by httpd_start
  * @param[in] work      Pointer to the function to be executed in the HTTPD's context
  * @param[in] arg       Pointer to the arguments that should be passed to this function
@@ -9,6 +9,7 @@
 #define _HTTPD_PRIV_H_
 
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <sys/socket.h>
 #include <sys/param.h>
 #include <netinet/in.h>
@@ -30,17 +31,23 @@ extern "C" {
 #define NEWLIB_NANO_COMPAT_CAST(size_t_var)  size_t_var
 #endif
 
-/* Size of request data block/chunk (not to be confused with chunked encoded data)
- * that is received and parsed in one turn of the parsing process. This should not
- * exceed the scratch buffer size and should at least be 8 bytes */
-#define PARSER_BLOCK_SIZE  128
-
 /* Calculate the maximum size needed for the scratch buffer */
 #define HTTPD_SCRATCH_BUF  MAX(HTTPD_MAX_REQ_HDR_LEN, HTTPD_MAX_URI_LEN)
 
+/* Size of request data block/chunk (not to be confused with chunked encoded data)
+ * that is received and parsed in one turn of the parsing process. This should not
+ * exceed the scratch buffer size and should at least be 8 bytes. The data of the
+ * last block beyond the headers is kept in the pending buffer of the session,
+ * which has the same size */
+#define PARSER_BLOCK_SIZE  MIN(CONFIG_HTTPD_RECV_BLOCK_LEN, HTTPD_SCRATCH_BUF)
+
 /* Formats a log string to prepend context function name */
 #define LOG_FMT(x)      "%s: " x, __func__
 
+/* Period at which the server task checks for sessions given back by the
+ * worker tasks, in case the message waking it up couldn't be sent */
+#define HTTPD_WAKE_CHECK_MS  100
+
 /**
  * @brief Thread related data for internal use
  */
@@ -54,6 +61,16 @@ struct thread_data {
     } status;           /*!< State of the thread */
 };
 
+/**
+ * @brief State of a session when requests are processed by worker tasks
+ */
+typedef enum {
+    HTTPD_SESS_IDLE = 0,        /*!< Waiting for data, watched by the server task */
+    HTTPD_SESS_BUSY,            /*!< Queued for or being processed by a worker task */
+    HTTPD_SESS_CLOSE_PENDING,   /*!< Same as HTTPD_SESS_BUSY, to be closed once processed */
+    HTTPD_SESS_CLOSE,           /*!< Processed by a worker task, to be closed by the server task */
+} httpd_sess_state_t;
+
 /**
  * @brief A database of all the open sockets in the system.
  */
@@ -68,11 +85,12 @@ struct sock_db {
     httpd_send_func_t send_fn;              /*!< Send function for this socket */
     httpd_recv_func_t recv_fn;              /*!< Receive function for this socket */
     httpd_pending_func_t pending_fn;        /*!< Pending function for this socket */
-    uint64_t lru_counter;                   /*!< LRU Counter indicating when the socket was last used */
+    _Atomic uint64_t lru_counter;           /*!< LRU Counter indicating when the socket was last used, also updated by worker tasks */
     bool lru_socket;                        /*!< Flag indicating LRU socket */
     char pending_data[PARSER_BLOCK_SIZE];   /*!< Buffer for pending data to be received */
     size_t pending_len;                     /*!< Length of pending data to be received */
     bool for_async_req;                     /*!< If true, the socket will not be LRU purged */
+    atomic_int state;                       /*!< Session state (httpd_sess_state_t), owned by a worker task unless HTTPD_SESS_IDLE */
 #ifdef CONFIG_HTTPD_WS_SUPPORT
     bool ws_handshake_done;                 /*!< True if it has done WebSocket handshake (if this socket is a valid WS) */
     bool ws_close;                          /*!< Set to true to close the socket later (when WS Close frame received) */
@@ -93,6 +111,7 @@ struct httpd_req_aux {
     char           *status;                         /*!< HTTP response's status code */
     char           *content_type;                   /*!< HTTP response's content type */
     bool            first_chunk_sent;               /*!< Used to indicate if first chunk sent */
+    size_t          req_hdrs_offset;                /*!< Offset of the request headers in the scratch buffer */
     unsigned        req_hdrs_count;                 /*!< Count of total headers in request packet */
     unsigned        resp_hdrs_count;                /*!< Count of additional headers in response packet */
     struct resp_hdr {
@@ -108,6 +127,17 @@ struct httpd_req_aux {
 #endif
 };
 
+/**
+ * @brief   Context of a task which processes requests: one of the worker
+ *          tasks, or the server task itself if there are no worker tasks
+ */
+struct httpd_worker {
+    struct httpd_data *hd;                  /*!< Server instance data */
+    struct thread_data td;                  /*!< Information for the worker thread */
+    struct httpd_req req;                   /*!< The current HTTPD request */
+    struct httpd_req_aux req_aux;           /*!< Additional data about the HTTPD request kept unexposed */
+};
+
 /**
  * @brief   Server data for each instance. This is exposed publicly as
  *          httpd_handle_t but internal structure/members are kept private.
@@ -124,9 +154,14 @@ struct httpd_data {
     struct sock_db *hd_sd;                  /*!< The socket database */
     int hd_sd_active_count;                 /*!< The number of the active sockets */
     httpd_uri_t **hd_calls;                 /*!< Registered URI handlers */
-    struct httpd_req hd_req;                /*!< The current HTTPD request */
-    struct httpd_req_aux hd_req_aux;        /*!< Additional data about the HTTPD request kept unexposed */
-    uint64_t lru_counter;                   /*!< LRU counter */
+#if CONFIG_HTTPD_URI_ROUTER
+    struct httpd_router *hd_router;         /*!< Radix tree of the registered URI handlers, NULL to scan hd_calls */
+#endif
+    omutex_t hd_uri_lock;                   /*!< Held while looking up handlers or modifying hd_calls and hd_router, as worker tasks look up handlers meanwhile */
+    struct httpd_worker *hd_workers;        /*!< Request processing contexts, one per worker task or one for the server task */
+    oqueue_t hd_work_queue;                 /*!< Sessions ready to be processed by the worker tasks */
+    atomic_bool hd_wake_pending;            /*!< A worker task has sent a control message to wake up the server task */
+    _Atomic uint64_t lru_counter;           /*!< LRU counter, also incremented by worker tasks */
 
     /* Array of registered error handler functions */
     httpd_err_handler_func_t *err_handler_fns;
@@ -201,14 +236,25 @@ esp_err_t httpd_sess_new(struct httpd_data *hd, int newfd);
 /**
  * @brief   Processes incoming HTTP requests
  *
- * @param[in] hd      Server instance data
+ * @param[in] worker  Context of the calling task
  * @param[in] session Session
  *
  * @return
  *  - ESP_OK    : on successfully receiving, parsing and responding to a request
  *  - ESP_FAIL  : in case of failure in any of the stages of processing
  */
-esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session);
+esp_err_t httpd_sess_process(struct httpd_worker *worker, struct sock_db *session);
+
+/**
+ * @brief   Gives a session processed by a worker task back to the server task
+ *
+ * The session is watched by the server task again, or closed by it if
+ * processing failed or the session was closed in the meantime.
+ *
+ * @param[in] session Session in HTTPD_SESS_BUSY or HTTPD_SESS_CLOSE_PENDING state
+ * @param[in] close   True if processing failed and the session must be closed
+ */
+void httpd_sess_release(struct sock_db *session, bool close);
 
 /**
  * @brief   Remove client descriptor from the session / socket database
@@ -235,8 +281,15 @@ void httpd_sess_free_ctx(void **ctx, httpd_free_ctx_fn_t free_fn);
  * @param[in]  hd    Server instance data
  * @param[out] fdset File descriptor set to be updated.
  * @param[out] maxfd Maximum value among all file descriptors.
+ * @param[out] busy  Set if a session is owned by a worker task, and is
+ *                   not watched until the worker task gives it back.
+ *
+ * @return
+ *  - true  : if a session has received its next request already, in which
+ *            case select must not wait for the descriptors
+ *  - false : otherwise
  */
-void httpd_sess_set_descriptors(struct httpd_data *hd, fd_set *fdset, int *maxfd);
+bool httpd_sess_set_descriptors(struct httpd_data *hd, fd_set *fdset, int *maxfd, bool *busy);
 
 /**
  * @brief   Checks if session can accept another connection from new client.
@@ -292,6 +345,18 @@ esp_err_t httpd_sess_close_lru(struct httpd_data *hd);
  */
 void httpd_sess_close_all(struct httpd_data *hd);
 
+/**
+ * @brief   Returns the request processing context of the calling task
+ *
+ * If there are no worker tasks, this is the context of the server task,
+ * regardless of the calling task.
+ *
+ * @param[in] hd  Server instance data
+ *
+ * @return Context of the calling task, or NULL if it isn't a worker task
+ */
+struct httpd_worker *httpd_worker_self(struct httpd_data *hd);
+
 /** End of Group : Session Management
  * @}
  */
@@ -306,13 +371,13 @@ void httpd_sess_close_all(struct httpd_data *hd);
  * @brief   For an HTTP request, searches through all the registered URI handlers
  *          and invokes the appropriate one if found
  *
- * @param[in] hd  Server instance data for which handler needs to be invoked
+ * @param[in] req Parsed HTTP request for which handler needs to be invoked
  *
  * @return
  *  - ESP_OK    : if handler found and executed successfully
  *  - ESP_FAIL  : otherwise
  */
-esp_err_t httpd_uri(struct httpd_data *hd);
+esp_err_t httpd_uri(httpd_req_t *req);
 
 /**
  * @brief   Unregister all URI handlers
@@ -360,26 +425,26 @@ bool httpd_validate_req_ptr(httpd_req_t *r);
  * URI, headers are ready to be fetched from scratch buffer and calling
  * http_recv() after this reads the body of the request.
  *
- * @param[in] hd  Server instance data
- * @param[in] sd  Pointer to socket which is needed for receiving TCP packets.
+ * @param[in] worker  Context of the calling task, which holds the request
+ * @param[in] sd      Pointer to socket which is needed for receiving TCP packets.
  *
  * @return
  *  - ESP_OK    : if request packet is valid
  *  - ESP_FAIL  : otherwise
  */
-esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd);
+esp_err_t httpd_req_new(struct httpd_worker *worker, struct sock_db *sd);
 
 /**
  * @brief   For an HTTP request, resets the resources allocated for it and
  *          purges any data left to be received
  *
- * @param[in] hd  Server instance data
+ * @param[in] r   The request created by httpd_req_new()
  *
  * @return
  *  - ESP_OK    : if request packet deleted and resources cleaned.
  *  - ESP_FAIL  : otherwise.
  */
-esp_err_t httpd_req_delete(struct httpd_data *hd);
+esp_err_t httpd_req_delete(httpd_req_t *r);
 
 /**
  * @brief   For handling HTTP errors by invoking registered
@@ -417,6 +482,70 @@ esp_err_t httpd_req_handle_err(httpd_req_t *req, httpd_err_code_t error);
  */
 int httpd_send(httpd_req_t *req, const char *buf, size_t buf_len);
 
+/**
+ * @brief   For sending out all of the data, calling the send function
+ *          of the session as many times as needed
+ *
+ * @param[in] req     Pointer to the HTTP request for which the response needs to be sent
+ * @param[in] buf     Pointer to the buffer from where the data is taken
+ * @param[in] buf_len Length of the buffer
+ *
+ * @return
+ *  - ESP_OK   : if all of the data was sent
+ *  - ESP_FAIL : if failed
+ */
+esp_err_t httpd_send_all(httpd_req_t *req, const char *buf, size_t buf_len);
+
+/**
+ * @brief   For gathering response data in the scratch buffer of the request,
+ *          so that a small response goes out with a single call of the send
+ *          function
+ *
+ * The gathered data is sent once more data doesn't fit in the scratch buffer
+ * or by httpd_send_flush(). Data which doesn't fit in the scratch buffer at
+ * all is sent directly, after the data gathered so far.
+ *
+ * @param[in] req         Pointer to the HTTP request for which the response needs to be sent
+ * @param[in,out] buffered Length of the data gathered in the scratch buffer so far
+ * @param[in] buf         Pointer to the buffer from where the data is taken
+ * @param[in] buf_len     Length of the buffer
+ *
+ * @return
+ *  - ESP_OK   : if the data was gathered or sent
+ *  - ESP_FAIL : if failed
+ */
+esp_err_t httpd_send_buffered(httpd_req_t *req, size_t *buffered, const char *buf, size_t buf_len);
+
+/**
+ * @brief   For sending out the data gathered by httpd_send_buffered()
+ *
+ * @param[in] req         Pointer to the HTTP request for which the response needs to be sent
+ * @param[in,out] buffered Length of the data gathered in the scratch buffer, set to 0
+ *
+ * @return
+ *  - ESP_OK   : if the data was sent
+ *  - ESP_FAIL : if failed
+ */
+esp_err_t httpd_send_flush(httpd_req_t *req, size_t *buffered);
+
+/**
+ * @brief   For gathering the status line, the additional headers set with
+ *          httpd_resp_set_hdr() and the blank line ending the headers of a
+ *          response with httpd_send_buffered()
+ *
+ * @note    The scratch buffer is overwritten, request headers are no longer available.
+ *
+ * @param[in] req         Pointer to the HTTP request for which the response needs to be sent
+ * @param[out] buffered   Length of the data gathered in the scratch buffer
+ * @param[in] hdr_fmt     printf format of the status line and the essential headers
+ *
+ * @return
+ *  - ESP_OK                  : if the headers were gathered or sent
+ *  - ESP_ERR_HTTPD_RESP_HDR  : if the essential headers don't fit in the scratch buffer
+ *  - ESP_ERR_HTTPD_RESP_SEND : if failed to send
+ */
+esp_err_t httpd_send_resp_hdrs(httpd_req_t *req, size_t *buffered, const char *hdr_fmt, ...);
+
 /**
  * @brief   For receiving HTTP request data
  *
@@ -0,0 +1,462 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <esp_log.h>
+#include <esp_err.h>
+#include <esp_partition.h>
+
+#include <esp_http_server.h>
+#include "esp_httpd_priv.h"
+
+static const char *TAG = "httpd_file";
+
+#define HTTPD_304   "304 Not Modified"
+#define HTTPD_206   "206 Partial Content"
+#define HTTPD_406   "406 Not Acceptable"
+#define HTTPD_416   "416 Range Not Satisfiable"
+
+/* Flash is mapped in windows of this size, so that large content
+ * doesn't need many free MMU pages at once */
+#define HTTPD_FILE_MMAP_WINDOW  0x10000
+
+/* Request headers which select the response, copied out of the scratch
+ * buffer before it is overwritten by the response headers */
+struct httpd_file_req_hdrs {
+    char if_none_match[128];
+    char range[48];
+    char if_range[64];
+    bool has_accept_encoding;
+    bool accepts_gzip;
+};
+
+/* Content of the response */
+struct httpd_file_src {
+    int fd;                             /*!< File to read, or -1 */
+    const esp_partition_t *partition;   /*!< Partition to read if fd is -1 */
+    size_t offset;                      /*!< Offset of the content in the partition */
+    size_t size;                        /*!< Size of the content */
+    const char *etag;                   /*!< Entity tag, NULL if none */
+    bool gzip;                          /*!< Content is gzip compressed */
+    bool vary;                          /*!< Content depends on Accept-Encoding */
+};
+
+static void httpd_file_get_hdr(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    /* Values which don't fit are ignored rather than truncated */
+    if (httpd_req_get_hdr_value_str(r, field, val, val_size) != ESP_OK) {
+        val[0] = '\0';
+    }
+}
+
+/* Checks if a comma separated list of codings contains gzip with a non-zero quality */
+static bool httpd_file_accepts_gzip(const char *codings)
+{
+    const char *token = codings;
+    while (*token) {
+        token += strspn(token, " \t,");
+        const size_t name_len = strcspn(token, " \t;,");
+        if ((name_len == 4 && strncasecmp(token, "gzip", 4) == 0) ||
+                (name_len == 1 && token[0] == '*')) {
+            const char *params = token + name_len;
+            const char *end = params + strcspn(params, ",");
+            const char *q = strstr(params, "q=");
+            if (q == NULL || q > end) {
+                return true;
+            }
+            return strtof(q + 2, NULL) > 0;
+        }
+        token += strcspn(token, ",");
+    }
+    return false;
+}
+
+static void httpd_file_read_req_hdrs(httpd_req_t *r, struct httpd_file_req_hdrs *hdrs)
+{
+    char accept_encoding[96];
+
+    httpd_file_get_hdr(r, "If-None-Match", hdrs->if_none_match, sizeof(hdrs->if_none_match));
+    httpd_file_get_hdr(r, "Range", hdrs->range, sizeof(hdrs->range));
+    httpd_file_get_hdr(r, "If-Range", hdrs->if_range, sizeof(hdrs->if_range));
+    hdrs->has_accept_encoding = httpd_req_get_hdr_value_len(r, "Accept-Encoding") > 0;
+    hdrs->accepts_gzip = false;
+    if (hdrs->has_accept_encoding) {
+        /* A truncated value still lists the usual codings */
+        esp_err_t ret = httpd_req_get_hdr_value_str(r, "Accept-Encoding", accept_encoding, sizeof(accept_encoding));
+        if (ret == ESP_OK || ret == ESP_ERR_HTTPD_RESULT_TRUNC) {
+            hdrs->accepts_gzip = httpd_file_accepts_gzip(accept_encoding);
+        }
+    }
+}
+
+/* Weak comparison of entity tags as required for If-None-Match */
+static bool httpd_file_etag_match(const char *list, const char *etag)
+{
+    if (strncmp(etag, "W/", 2) == 0) {
+        etag += 2;
+    }
+    const size_t etag_len = strlen(etag);
+
+    const char *token = list;
+    while (*token) {
+        token += strspn(token, " \t,");
+        const size_t token_len = strcspn(token, " \t,");
+        if (token_len == 1 && token[0] == '*') {
+            return true;
+        }
+        const char *tag = token;
+        size_t tag_len = token_len;
+        if (tag_len > 2 && strncmp(tag, "W/", 2) == 0) {
+            tag += 2;
+            tag_len -= 2;
+        }
+        if (tag_len == etag_len && strncmp(tag, etag, etag_len) == 0) {
+            return true;
+        }
+        token += token_len;
+    }
+    return false;
+}
+
+/* Parses a single byte range of the Range header.
+ * Returns 1 for a satisfiable range, -1 for an unsatisfiable one
+ * and 0 if the header is to be ignored and the whole content sent */
+static int httpd_file_parse_range(const char *range, size_t size, size_t *first, size_t *last)
+{
+    if (strncasecmp(range, "bytes=", 6) != 0 || strchr(range, ',') != NULL) {
+        /* Other units and several ranges are not supported */
+        return 0;
+    }
+    range += 6;
+    range += strspn(range, " \t");
+
+    char *end;
+    if (*range == '-') {
+        /* Suffix range: the last N bytes */
+        if (range[1] < '0' || range[1] > '9') {
+            return 0;
+        }
+        unsigned long long suffix = strtoull(range + 1, &end, 10);
+        if (*end != '\0' && *end != ' ' && *end != '\t') {
+            return 0;
+        }
+        if (suffix == 0 || size == 0) {
+            return -1;
+        }
+        *first = suffix < size ? size - suffix : 0;
+        *last = size - 1;
+        return 1;
+    }
+
+    if (*range < '0' || *range > '9') {
+        return 0;
+    }
+    unsigned long long start = strtoull(range, &end, 10);
+    if (*end != '-') {
+        return 0;
+    }
+    range = end + 1;
+    unsigned long long stop = ULLONG_MAX;
+    if (*range >= '0' && *range <= '9') {
+        stop = strtoull(range, &end, 10);
+        if (stop < start) {
+            return 0;
+        }
+        range = end;
+    }
+    if (*range != '\0' && *range != ' ' && *range != '\t') {
+        return 0;
+    }
+    if (start >= size) {
+        return -1;
+    }
+    *first = start;
+    *last = stop < size ? stop : size - 1;
+    return 1;
+}
+
+/* Appends a header line, returns false if it doesn't fit */
+static bool httpd_file_add_hdr(char *buf, size_t size, size_t *len, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int ret = vsnprintf(buf + *len, size - *len, fmt, args);
+    va_end(args);
+    if (ret < 0 || ret >= size - *len) {
+        return false;
+    }
+    *len += ret;
+    return true;
+}
+
+/* Sends the headers of a response without content */
+static esp_err_t httpd_file_send_no_content(httpd_req_t *r, const char *status, const char *hdrs)
+{
+    size_t buffered = 0;
+    esp_err_t ret = httpd_send_resp_hdrs(r, &buffered, "HTTP/1.1 %s\r\n%s", status, hdrs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (httpd_send_flush(r, &buffered) != ESP_OK) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+/* Reads the content into the scratch buffer after the data gathered so far, and sends it */
+static esp_err_t httpd_file_send_read(httpd_req_t *r, size_t *buffered, const struct httpd_file_src *src,
+                                      size_t first, size_t len)
+{
+    struct httpd_req_aux *ra = r->aux;
+
+    if (src->fd >= 0 && lseek(src->fd, first, SEEK_SET) < 0) {
+        ESP_LOGW(TAG, LOG_FMT("error in lseek: %d"), errno);
+        return ESP_FAIL;
+    }
+    while (len > 0) {
+        const size_t block = MIN(len, sizeof(ra->scratch) - *buffered);
+        if (src->fd >= 0) {
+            ssize_t nread = read(src->fd, ra->scratch + *buffered, block);
+            if (nread <= 0) {
+                ESP_LOGW(TAG, LOG_FMT("error in read: %d"), errno);
+                return ESP_FAIL;
+            }
+            *buffered += nread;
+            len -= nread;
+            first += nread;
+        } else {
+            if (esp_partition_read(src->partition, src->offset + first, ra->scratch + *buffered, block) != ESP_OK) {
+                ESP_LOGW(TAG, LOG_FMT("error in esp_partition_read"));
+                return ESP_FAIL;
+            }
+            *buffered += block;
+            len -= block;
+            first += block;
+        }
+        if (*buffered == sizeof(ra->scratch) || len == 0) {
+            if (httpd_send_flush(r, buffered) != ESP_OK) {
+                return ESP_ERR_HTTPD_RESP_SEND;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+/* Sends the content from the partition mapped to memory, without copying it
+ * unless it fits in the scratch buffer with the headers. *sent is the length
+ * sent before a window of the partition couldn't be mapped */
+static esp_err_t httpd_file_send_mmap(httpd_req_t *r, size_t *buffered, const struct httpd_file_src *src,
+                                      size_t first, size_t len, size_t *sent)
+{
+    *sent = 0;
+    while (*sent < len) {
+        const size_t block = MIN(len - *sent, HTTPD_FILE_MMAP_WINDOW);
+        const void *ptr;
+        esp_partition_mmap_handle_t handle;
+        if (esp_partition_mmap(src->partition, src->offset + first + *sent, block, ESP_PARTITION_MMAP_DATA,
+                               &ptr, &handle) != ESP_OK) {
+            ESP_LOGD(TAG, LOG_FMT("can't map partition, reading it"));
+            return ESP_OK;
+        }
+        esp_err_t ret = httpd_send_buffered(r, buffered, ptr, block);
+        if (ret == ESP_OK && *sent + block == len) {
+            ret = httpd_send_flush(r, buffered);
+        }
+        esp_partition_munmap(handle);
+        if (ret != ESP_OK) {
+            return ESP_ERR_HTTPD_RESP_SEND;
+        }
+        *sent += block;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t httpd_file_send(httpd_req_t *r, const struct httpd_file_src *src,
+                                 const struct httpd_file_req_hdrs *hdrs)
+{
+    struct httpd_req_aux *ra = r->aux;
+    /* ETag, Vary and Content-Range */
+    char extra[256];
+    size_t extra_len = 0;
+    extra[0] = '\0';
+
+    if ((src->etag && !httpd_file_add_hdr(extra, sizeof(extra), &extra_len, "ETag: %s\r\n", src->etag)) ||
+            (src->vary && !httpd_file_add_hdr(extra, sizeof(extra), &extra_len, "Vary: Accept-Encoding\r\n"))) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+
+    /* Request headers are no longer available */
+    ra->req_hdrs_count = 0;
+
+    if (src->etag && hdrs->if_none_match[0] && httpd_file_etag_match(hdrs->if_none_match, src->etag)) {
+        ESP_LOGD(TAG, LOG_FMT("not modified"));
+        return httpd_file_send_no_content(r, HTTPD_304, extra);
+    }
+
+    size_t first = 0;
+    size_t last = src->size - 1;
+    int range = 0;
+    /* A range of an older version of the content is of no use to the client */
+    if (hdrs->range[0] && (hdrs->if_range[0] == '\0' ||
+                           (src->etag && strncmp(src->etag, "W/", 2) != 0 && strcmp(hdrs->if_range, src->etag) == 0))) {
+        range = httpd_file_parse_range(hdrs->range, src->size, &first, &last);
+    }
+    if (range < 0) {
+        if (!httpd_file_add_hdr(extra, sizeof(extra), &extra_len,
+                                "Content-Range: bytes */%"NEWLIB_NANO_COMPAT_FORMAT"\r\nContent-Length: 0\r\n",
+                                NEWLIB_NANO_COMPAT_CAST(src->size))) {
+            return ESP_ERR_HTTPD_RESP_HDR;
+        }
+        return httpd_file_send_no_content(r, HTTPD_416, extra);
+    }
+    const size_t len = (src->size == 0) ? 0 : last - first + 1;
+    if (range > 0 && !httpd_file_add_hdr(extra, sizeof(extra), &extra_len,
+                                         "Content-Range: bytes %"NEWLIB_NANO_COMPAT_FORMAT"-%"NEWLIB_NANO_COMPAT_FORMAT
+                                         "/%"NEWLIB_NANO_COMPAT_FORMAT"\r\n", NEWLIB_NANO_COMPAT_CAST(first),
+                                         NEWLIB_NANO_COMPAT_CAST(last), NEWLIB_NANO_COMPAT_CAST(src->size))) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+
+    size_t buffered = 0;
+    esp_err_t ret = httpd_send_resp_hdrs(r, &buffered,
+                                         "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %"NEWLIB_NANO_COMPAT_FORMAT"\r\n"
+                                         "Accept-Ranges: bytes\r\n%s%s",
+                                         range > 0 ? HTTPD_206 : HTTPD_200, ra->content_type,
+                                         NEWLIB_NANO_COMPAT_CAST(len),
+                                         src->gzip ? "Content-Encoding: gzip\r\n" : "", extra);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (r->method == HTTP_HEAD || len == 0) {
+        ret = (httpd_send_flush(r, &buffered) == ESP_OK) ? ESP_OK : ESP_ERR_HTTPD_RESP_SEND;
+    } else {
+        size_t sent = 0;
+        if (src->fd < 0) {
+            ret = httpd_file_send_mmap(r, &buffered, src, first, len, &sent);
+        }
+        if (ret == ESP_OK && sent < len) {
+            ret = httpd_file_send_read(r, &buffered, src, first + sent, len - sent);
+        }
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    esp_http_server_dispatch_event(HTTP_SERVER_EVENT_HEADERS_SENT, &(ra->sd->fd), sizeof(int));
+
+    esp_http_server_event_data evt_data = {
+        .fd = ra->sd->fd,
+        .data_len = (r->method == HTTP_HEAD) ? 0 : len,
+    };
+    esp_http_server_dispatch_event(HTTP_SERVER_EVENT_SENT_DATA, &evt_data, sizeof(esp_http_server_event_data));
+    return ESP_OK;
+}
+
+/* Opens the file, or its gzip variant */
+static int httpd_file_open(const char *path, bool try_gzip, bool *gzip)
+{
+    *gzip = false;
+    if (try_gzip) {
+        const size_t path_len = strlen(path);
+        char *gz_path = malloc(path_len + sizeof(".gz"));
+        if (gz_path) {
+            memcpy(gz_path, path, path_len);
+            memcpy(gz_path + path_len, ".gz", sizeof(".gz"));
+            int fd = open(gz_path, O_RDONLY);
+            free(gz_path);
+            if (fd >= 0) {
+                *gzip = true;
+                return fd;
+            }
+        }
+    }
+    return open(path, O_RDONLY);
+}
+
+esp_err_t httpd_resp_send_file(httpd_req_t *r, const char *path, const httpd_resp_file_opts_t *opts)
+{
+    if (r == NULL || path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!httpd_valid_req(r)) {
+        return ESP_ERR_HTTPD_INVALID_REQ;
+    }
+
+    struct httpd_file_req_hdrs hdrs;
+    httpd_file_read_req_hdrs(r, &hdrs);
+
+    struct httpd_file_src src = {
+        .vary = opts && opts->gzip,
+    };
+    src.fd = httpd_file_open(path, opts && opts->gzip && hdrs.accepts_gzip, &src.gzip);
+    if (src.fd < 0) {
+        ESP_LOGD(TAG, LOG_FMT("can't open %s: %d"), path, errno);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    struct stat st;
+    if (fstat(src.fd, &st) != 0) {
+        close(src.fd);
+        return ESP_ERR_NOT_FOUND;
+    }
+    src.size = st.st_size;
+
+    /* Entity tag derived from the file, which differs between the variants */
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"%" PRIx32 "-%" PRIx32 "%s\"", (uint32_t) st.st_mtime, (uint32_t) st.st_size,
+             src.gzip ? "-gz" : "");
+    src.etag = etag;
+
+    esp_err_t ret = httpd_file_send(r, &src, &hdrs);
+    close(src.fd);
+    return ret;
+}
+
+esp_err_t httpd_resp_send_partition(httpd_req_t *r, const esp_partition_t *partition,
+                                    size_t offset, size_t size, const httpd_resp_file_opts_t *opts)
+{
+    if (r == NULL || partition == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!httpd_valid_req(r)) {
+        return ESP_ERR_HTTPD_INVALID_REQ;
+    }
+
+    if (offset > partition->size || size > partition->size - offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    struct httpd_file_req_hdrs hdrs;
+    httpd_file_read_req_hdrs(r, &hdrs);
+
+    struct httpd_file_src src = {
+        .fd = -1,
+        .partition = partition,
+        .offset = offset,
+        .size = size,
+        .etag = opts ? opts->etag : NULL,
+        .gzip = opts && opts->gzip,
+    };
+
+    /* No Accept-Encoding means that any coding is acceptable */
+    if (src.gzip && hdrs.has_accept_encoding && !hdrs.accepts_gzip) {
+        struct httpd_req_aux *ra = r->aux;
+        ra->req_hdrs_count = 0;
+        return httpd_file_send_no_content(r, HTTPD_406, "Content-Length: 0\r\n");
+    }
+    return httpd_file_send(r, &src, &hdrs);
+}
@@ -137,6 +137,7 @@ struct httpd_ctrl_data {
     enum httpd_ctrl_msg {
         HTTPD_CTRL_SHUTDOWN,
         HTTPD_CTRL_WORK,
+        HTTPD_CTRL_WAKE,
     } hc_msg;
     httpd_work_fn_t hc_work;
     void *hc_work_arg;
@@ -235,6 +236,13 @@ static void httpd_process_ctrl_msg(struct httpd_data *hd)
         ESP_LOGD(TAG, LOG_FMT("shutdown"));
         hd->hd_td.status = THREAD_STOPPING;
         break;
+    case HTTPD_CTRL_WAKE:
+        /* Sessions given back by the worker tasks are picked up
+         * when enumerating the sessions after this message.
+         * The semaphore isn't taken for this message. */
+        ESP_LOGD(TAG, LOG_FMT("wake"));
+        atomic_store(&hd->hd_wake_pending, false);
+        return;
     default:
         break;
     }
@@ -254,23 +262,141 @@ static int httpd_process_session(struct sock_db *session, void *context)
         return 1;
     }
 
+    process_session_context_t *ctx = (process_session_context_t *)context;
+    struct httpd_data *hd = ctx->hd;
+
+    // session given back by a worker task to be closed, or busy in a worker task
+    int state = atomic_load(&session->state);
+    if (state == HTTPD_SESS_CLOSE) {
+        httpd_sess_delete(hd, session);
+        return 1;
+    }
+    if (state != HTTPD_SESS_IDLE) {
+        return 1;
+    }
+
     // session is busy in an async task, do not process here.
     if (session->for_async_req) {
         return 1;
     }
 
-    process_session_context_t *ctx = (process_session_context_t *)context;
     int fd = session->fd;
 
-    if (FD_ISSET(fd, ctx->fdset) || httpd_sess_pending(ctx->hd, session)) {
+    if (FD_ISSET(fd, ctx->fdset) || httpd_sess_pending(hd, session)) {
+        if (hd->config.worker_count) {
+            ESP_LOGD(TAG, LOG_FMT("dispatching socket %d"), fd);
+            atomic_store(&session->lru_counter, atomic_fetch_add(&hd->lru_counter, 1) + 1);
+            atomic_store(&session->state, HTTPD_SESS_BUSY);
+            /* The queue has room for all sessions, each of them
+             * being queued at most once, so this doesn't fail */
+            if (httpd_os_queue_send(hd->hd_work_queue, session) != OS_SUCCESS) {
+                ESP_LOGE(TAG, LOG_FMT("failed to dispatch socket %d"), fd);
+                httpd_sess_delete(hd, session);
+            }
+            return 1;
+        }
         ESP_LOGD(TAG, LOG_FMT("processing socket %d"), fd);
-        if (httpd_sess_process(ctx->hd, session) != ESP_OK) {
-            httpd_sess_delete(ctx->hd, session); // Delete session
+        if (httpd_sess_process(&hd->hd_workers[0], session) != ESP_OK) {
+            httpd_sess_delete(hd, session); // Delete session
+        } else {
+            atomic_store(&session->lru_counter, atomic_fetch_add(&hd->lru_counter, 1) + 1);
         }
     }
     return 1;
 }
 
+struct httpd_worker *httpd_worker_self(struct httpd_data *hd)
+{
+    if (hd->config.worker_count == 0) {
+        return &hd->hd_workers[0];
+    }
+    othread_t self = httpd_os_thread_handle();
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        if (hd->hd_workers[i].td.handle == self) {
+            return &hd->hd_workers[i];
+        }
+    }
+    return NULL;
+}
+
+/* Wakes up the main HTTPD thread so that it watches the sessions given back
+ * by the worker threads again */
+static void httpd_wake(struct httpd_data *hd)
+{
+    /* A single pending message is enough */
+    if (atomic_exchange(&hd->hd_wake_pending, true)) {
+        return;
+    }
+    struct httpd_ctrl_data msg = {
+        .hc_msg = HTTPD_CTRL_WAKE,
+    };
+    if (cs_send_to_ctrl_sock(hd->msg_fd, hd->config.ctrl_port, &msg, sizeof(msg)) < 0) {
+        /* The server task picks up the session within HTTPD_WAKE_CHECK_MS */
+        ESP_LOGW(TAG, LOG_FMT("failed to wake up server"));
+        atomic_store(&hd->hd_wake_pending, false);
+    }
+}
+
+/* The HTTPD worker threads, process the sessions dispatched by the main thread */
+static void httpd_worker_thread(void *arg)
+{
+    struct httpd_worker *worker = (struct httpd_worker *) arg;
+    struct httpd_data *hd = worker->hd;
+    worker->td.status = THREAD_RUNNING;
+
+    void *item;
+    while (httpd_os_queue_receive(hd->hd_work_queue, &item) == OS_SUCCESS && item) {
+        struct sock_db *session = (struct sock_db *) item;
+        ESP_LOGD(TAG, LOG_FMT("processing socket %d"), session->fd);
+        esp_err_t ret = httpd_sess_process(worker, session);
+        httpd_sess_release(session, ret != ESP_OK);
+        httpd_wake(hd);
+    }
+
+    worker->td.status = THREAD_STOPPED;
+    httpd_os_thread_delete();
+}
+
+/* Stops the first count worker threads, waiting for the request they process */
+static void httpd_stop_workers(struct httpd_data *hd, int count)
+{
+    for (int i = 0; i < count; i++) {
+        httpd_os_queue_send(hd->hd_work_queue, NULL);
+    }
+    for (int i = 0; i < count; i++) {
+        while (hd->hd_workers[i].td.status != THREAD_STOPPED) {
+            httpd_os_thread_sleep(10);
+        }
+    }
+}
+
+static esp_err_t httpd_start_workers(struct httpd_data *hd)
+{
+    if (hd->config.worker_count == 0) {
+        return ESP_OK;
+    }
+    /* Room for every session plus the stop requests */
+    if (httpd_os_queue_create(&hd->hd_work_queue,
+                              hd->config.max_open_sockets + hd->config.worker_count) != OS_SUCCESS) {
+        ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP worker queue"));
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        BaseType_t core_id = hd->config.worker_pin_per_core ? (i % portNUM_PROCESSORS) : hd->config.core_id;
+        if (httpd_os_thread_create(&hd->hd_workers[i].td.handle, "httpd_worker",
+                                   hd->config.stack_size,
+                                   hd->config.task_priority,
+                                   httpd_worker_thread, &hd->hd_workers[i],
+                                   core_id,
+                                   hd->config.task_caps) != ESP_OK) {
+            ESP_LOGE(TAG, LOG_FMT("Failed to launch HTTP worker task %d"), i);
+            httpd_stop_workers(hd, i);
+            return ESP_ERR_HTTPD_TASK;
+        }
+    }
+    return ESP_OK;
+}
+
 /* Manage in-coming connection or data requests */
 static esp_err_t httpd_server(struct httpd_data *hd)
 {
@@ -285,13 +411,23 @@ static esp_err_t httpd_server(struct httpd_data *hd)
     FD_SET(hd->ctrl_fd, &read_set);
 
     int tmp_max_fd;
-    httpd_sess_set_descriptors(hd, &read_set, &tmp_max_fd);
+    bool busy;
+    bool pipelined = httpd_sess_set_descriptors(hd, &read_set, &tmp_max_fd, &busy);
     int maxfd = MAX(hd->listen_fd, tmp_max_fd);
     tmp_max_fd = maxfd;
     maxfd = MAX(hd->ctrl_fd, tmp_max_fd);
 
+    /* Requests pipelined by a client are processed one per pass,
+     * don't wait for other descriptors while some are pending.
+     * While worker tasks own sessions, don't rely on the message
+     * waking up this task alone to watch them again. */
+    struct timeval timeout = { 0 };
+    if (!pipelined) {
+        timeout.tv_sec = HTTPD_WAKE_CHECK_MS / 1000;
+        timeout.tv_usec = (HTTPD_WAKE_CHECK_MS % 1000) * 1000;
+    }
     ESP_LOGD(TAG, LOG_FMT("doing select maxfd+1 = %d"), maxfd + 1);
-    int active_cnt = select(maxfd + 1, &read_set, NULL, NULL, NULL);
+    int active_cnt = select(maxfd + 1, &read_set, NULL, NULL, (pipelined || busy) ? &timeout : NULL);
     if (active_cnt < 0) {
         ESP_LOGE(TAG, LOG_FMT("error in select (%d)"), errno);
         httpd_sess_delete_invalid(hd);
@@ -333,6 +469,11 @@ static void httpd_thread(void *arg)
     int ret;
     struct httpd_data *hd = (struct httpd_data *) arg;
     hd->hd_td.status = THREAD_RUNNING;
+    if (hd->config.worker_count == 0) {
+        /* Requests are processed by this thread */
+        hd->hd_workers[0].td.handle = httpd_os_thread_handle();
+        hd->hd_workers[0].td.status = THREAD_RUNNING;
+    }
 
     ESP_LOGD(TAG, LOG_FMT("web server started"));
     while (1) {
@@ -343,6 +484,7 @@ static void httpd_thread(void *arg)
     }
 
     ESP_LOGD(TAG, LOG_FMT("web server exiting"));
+    httpd_stop_workers(hd, hd->config.worker_count);
     close(hd->msg_fd);
     cs_free_ctrl_sock(hd->ctrl_fd);
     httpd_sess_close_all(hd);
@@ -422,6 +564,8 @@ static esp_err_t httpd_server_init(struct httpd_data *hd)
     return ESP_OK;
 }
 
+static void httpd_delete(struct httpd_data *hd);
+
 static struct httpd_data *httpd_create(const httpd_config_t *config)
 {
     /* Allocate memory for httpd instance data */
@@ -443,19 +587,9 @@ static struct httpd_data *httpd_create(const httpd_config_t *config)
         free(hd);
         return NULL;
     }
-    struct httpd_req_aux *ra = &hd->hd_req_aux;
-    ra->resp_hdrs = calloc(config->max_resp_headers, sizeof(struct resp_hdr));
-    if (!ra->resp_hdrs) {
-        ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP response headers"));
-        free(hd->hd_sd);
-        free(hd->hd_calls);
-        free(hd);
-        return NULL;
-    }
     hd->err_handler_fns = calloc(HTTPD_ERR_CODE_MAX, sizeof(httpd_err_handler_func_t));
     if (!hd->err_handler_fns) {
         ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP error handlers"));
-        free(ra->resp_hdrs);
         free(hd->hd_sd);
         free(hd->hd_calls);
         free(hd);
@@ -463,19 +597,52 @@ static struct httpd_data *httpd_create(const httpd_config_t *config)
     }
     /* Save the configuration for this instance */
     hd->config = *config;
+
+    /* One request processing context per worker thread, or one for the main thread */
+    hd->hd_workers = calloc(MAX(1, config->worker_count), sizeof(struct httpd_worker));
+    if (!hd->hd_workers) {
+        ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP workers"));
+        httpd_delete(hd);
+        return NULL;
+    }
+    for (int i = 0; i < MAX(1, config->worker_count); i++) {
+        struct httpd_worker *worker = &hd->hd_workers[i];
+        worker->hd = hd;
+        worker->req_aux.resp_hdrs = calloc(config->max_resp_headers, sizeof(struct resp_hdr));
+        if (!worker->req_aux.resp_hdrs) {
+            ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP response headers"));
+            httpd_delete(hd);
+            return NULL;
+        }
+    }
+    if (httpd_os_mutex_create(&hd->hd_uri_lock) != OS_SUCCESS) {
+        ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP URI handlers lock"));
+        httpd_delete(hd);
+        return NULL;
+    }
     return hd;
 }
 
 static void httpd_delete(struct httpd_data *hd)
 {
-    struct httpd_req_aux *ra = &hd->hd_req_aux;
     /* Free memory of httpd instance data */
+    if (hd->hd_workers) {
+        for (int i = 0; i < MAX(1, hd->config.worker_count); i++) {
+            free(hd->hd_workers[i].req_aux.resp_hdrs);
+        }
+        free(hd->hd_workers);
+    }
+    if (hd->hd_work_queue) {
+        httpd_os_queue_delete(hd->hd_work_queue);
+    }
     free(hd->err_handler_fns);
-    free(ra->resp_hdrs);
     free(hd->hd_sd);
 
     /* Free registered URI handlers */
     httpd_unregister_all_uri_handlers(hd);
+    if (hd->hd_uri_lock) {
+        httpd_os_mutex_delete(hd->hd_uri_lock);
+    }
     free(hd->hd_calls);
     free(hd);
 }
@@ -527,6 +694,11 @@ esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
     }
 
     httpd_sess_init(hd);
+    esp_err_t err = httpd_start_workers(hd);
+    if (err != ESP_OK) {
+        httpd_delete(hd);
+        return err;
+    }
     if (httpd_os_thread_create(&hd->hd_td.handle, "httpd",
                                hd->config.stack_size,
                                hd->config.task_priority,
@@ -534,6 +706,7 @@ esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
                                hd->config.core_id,
                                hd->config.task_caps) != ESP_OK) {
         /* Failed to launch task */
+        httpd_stop_workers(hd, hd->config.worker_count);
         httpd_delete(hd);
         return ESP_ERR_HTTPD_TASK;
     }
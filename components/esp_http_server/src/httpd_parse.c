@@ -20,9 +20,6 @@
 static const char *TAG = "httpd_parse";
 
 typedef struct {
-    /* Parser settings for http_parser_execute() */
-    http_parser_settings settings;
-
     /* Request being parsed */
     struct httpd_req *req;
 
@@ -50,7 +47,6 @@ typedef struct {
 
     /* State variables */
     bool   paused;          /*!< Parser is paused */
-    size_t pre_parsed;      /*!< Length of data to be skipped while parsing */
     size_t raw_datalen;     /*!< Full length of the raw data in scratch buffer */
 } parser_data_t;
 
@@ -162,34 +158,14 @@ static esp_err_t pause_parsing(http_parser *parser, const char* at)
         return ESP_FAIL;
     }
 
-    /* Signal http_parser to pause execution and save the maximum
-     * possible length, of the yet un-parsed data, that may get
-     * parsed before http_parser_execute() returns. This pre_parsed
-     * length will be updated then to reflect the actual length
-     * that got parsed, and must be skipped when parsing resumes */
-    parser_data->pre_parsed = unparsed;
+    /* Signal http_parser to pause execution. Parsing isn't resumed,
+     * the un-parsed data is parsed by the parser of the next request */
     http_parser_pause(parser, 1);
     parser_data->paused = true;
     ESP_LOGD(TAG, LOG_FMT("paused"));
     return ESP_OK;
 }
 
-static size_t continue_parsing(http_parser *parser, size_t length)
-{
-    parser_data_t *data = (parser_data_t *) parser->data;
-
-    /* Part of the received data may have been parsed earlier
-     * so we must skip that before parsing resumes */
-    length = MIN(length, data->pre_parsed);
-    data->pre_parsed -= length;
-    ESP_LOGD(TAG, LOG_FMT("skip pre-parsed data of size = %"NEWLIB_NANO_COMPAT_FORMAT), NEWLIB_NANO_COMPAT_CAST(length));
-
-    http_parser_pause(parser, 0);
-    data->paused = false;
-    ESP_LOGD(TAG, LOG_FMT("un-paused"));
-    return length;
-}
-
 /* http_parser callback on header field in HTTP request
  * May be invoked ATLEAST once every header field
  */
@@ -210,18 +186,12 @@ static esp_err_t cb_header_field(http_parser *parser, const char *at, size_t len
         }
 
         ESP_LOGD(TAG, LOG_FMT("headers begin"));
-        /* Last at is set to start of scratch where headers
-         * will be received next */
-        parser_data->last.at     = ra->scratch;
+        /* Headers are parsed in place, right after the
+         * request line in the scratch buffer */
+        ra->req_hdrs_offset      = at - ra->scratch;
+        parser_data->last.at     = at;
         parser_data->last.length = 0;
         parser_data->status      = PARSING_HDR_FIELD;
-
-        /* Stop parsing for now and give control to process */
-        if (pause_parsing(parser, at) != ESP_OK) {
-            parser_data->error = HTTPD_500_INTERNAL_SERVER_ERROR;
-            parser_data->status = PARSING_FAILED;
-            return ESP_FAIL;
-        }
     } else if (parser_data->status == PARSING_HDR_VALUE) {
         /* Overwrite terminator (CRLFs) following last header
          * (key: value) pair with null characters */
@@ -312,54 +282,59 @@ static esp_err_t cb_headers_complete(http_parser *parser)
             parser_data->status = PARSING_FAILED;
             return ESP_FAIL;
         }
-    } else if (parser_data->status == PARSING_HDR_VALUE) {
-        /* Locate end of last header */
-        char *at = (char *)parser_data->last.at + parser_data->last.length;
-
-        /* Check if there is data left to parse. This value should
-         * at least be equal to the number of line terminators, i.e. 2 */
-        ssize_t remaining_length = parser_data->raw_datalen - (at - ra->scratch);
-        if (remaining_length < 2) {
-            ESP_LOGE(TAG, LOG_FMT("invalid length of data remaining to be parsed"));
-            parser_data->error = HTTPD_500_INTERNAL_SERVER_ERROR;
-            parser_data->status = PARSING_FAILED;
-            return ESP_FAIL;
-        }
+    } else if (parser_data->status != PARSING_HDR_VALUE) {
+        ESP_LOGE(TAG, LOG_FMT("unexpected state transition"));
+        parser_data->error = HTTPD_500_INTERNAL_SERVER_ERROR;
+        parser_data->status = PARSING_FAILED;
+        return ESP_FAIL;
+    }
 
-        /* Locate end of headers section by skipping the remaining
-         * two line terminators. No assumption is made here about the
-         * termination sequence used apart from the necessity that it
-         * must end with an LF, because:
-         *      1) some clients may send non standard LFs instead of
-         *         CRLFs for indicating termination.
-         *      2) it is the responsibility of http_parser to check
-         *         that the termination is either CRLF or LF and
-         *         not any other sequence */
-        unsigned short remaining_terminators = 2;
-        while (remaining_length-- && remaining_terminators) {
-            if (*at == '\n') {
-                remaining_terminators--;
-            }
-            /* Overwrite termination characters with null */
-            *(at++) = '\0';
-        }
-        if (remaining_terminators) {
-            ESP_LOGE(TAG, LOG_FMT("incomplete termination of headers"));
-            parser_data->error = HTTPD_400_BAD_REQUEST;
-            parser_data->status = PARSING_FAILED;
-            return ESP_FAIL;
+    /* Locate end of last header, or of the URL if there are no headers */
+    char *at = (char *)parser_data->last.at + parser_data->last.length;
+
+    /* Check if there is data left to parse. This value should
+     * at least be equal to the number of line terminators, i.e. 2 */
+    ssize_t remaining_length = parser_data->raw_datalen - (at - ra->scratch);
+    if (remaining_length < 2) {
+        ESP_LOGE(TAG, LOG_FMT("invalid length of data remaining to be parsed"));
+        parser_data->error = HTTPD_500_INTERNAL_SERVER_ERROR;
+        parser_data->status = PARSING_FAILED;
+        return ESP_FAIL;
+    }
+
+    /* Locate end of headers section by skipping the remaining
+     * two line terminators. No assumption is made here about the
+     * termination sequence used apart from the necessity that it
+     * must end with an LF, because:
+     *      1) some clients may send non standard LFs instead of
+     *         CRLFs for indicating termination.
+     *      2) it is the responsibility of http_parser to check
+     *         that the termination is either CRLF or LF and
+     *         not any other sequence
+     * Without headers, the HTTP version following the URL is
+     * overwritten as well, the URL has been copied already */
+    unsigned short remaining_terminators = 2;
+    while (remaining_length-- && remaining_terminators) {
+        if (*at == '\n') {
+            remaining_terminators--;
         }
+        /* Overwrite termination characters with null */
+        *(at++) = '\0';
+    }
+    if (remaining_terminators) {
+        ESP_LOGE(TAG, LOG_FMT("incomplete termination of headers"));
+        parser_data->error = HTTPD_400_BAD_REQUEST;
+        parser_data->status = PARSING_FAILED;
+        return ESP_FAIL;
+    }
 
-        /* Place the parser ptr right after the end of headers section */
-        parser_data->last.at = at;
+    /* Place the parser ptr right after the end of headers section,
+     * where the content or the next pipelined request starts */
+    parser_data->last.at = at;
 
+    if (parser_data->status == PARSING_HDR_VALUE) {
         /* Increment header count */
         ra->req_hdrs_count++;
-    } else {
-        ESP_LOGE(TAG, LOG_FMT("unexpected state transition"));
-        parser_data->error = HTTPD_500_INTERNAL_SERVER_ERROR;
-        parser_data->status = PARSING_FAILED;
-        return ESP_FAIL;
     }
 
     /* In absence of body/chunked encoding, http_parser sets content_len to -1 */
@@ -480,6 +455,16 @@ static esp_err_t cb_no_body(http_parser *parser)
     return ESP_OK;
 }
 
+/* Parser callbacks, the same for all requests */
+static const http_parser_settings parser_settings = {
+    .on_url              = cb_url,
+    .on_header_field     = cb_header_field,
+    .on_header_value     = cb_header_value,
+    .on_headers_complete = cb_headers_complete,
+    .on_body             = cb_on_body,
+    .on_message_complete = cb_no_body,
+};
+
 static int read_block(httpd_req_t *req, size_t offset, size_t length)
 {
     struct httpd_req_aux *raux  = req->aux;
@@ -551,18 +536,8 @@ static int parse_block(http_parser *parser, size_t offset, size_t length)
         return -1;
     }
 
-    /* Un-pause the parsing if paused */
-    if (data->paused) {
-        nparsed = continue_parsing(parser, length);
-        length -= nparsed;
-        offset += nparsed;
-        if (!length) {
-            return nparsed;
-        }
-    }
-
     /* Execute http_parser */
-    nparsed = http_parser_execute(parser, &data->settings,
+    nparsed = http_parser_execute(parser, &parser_settings,
                                   raux->scratch + offset, length);
 
     /* Check state */
@@ -572,12 +547,8 @@ static int parse_block(http_parser *parser, size_t offset, size_t length)
         ESP_LOGW(TAG, LOG_FMT("parsing failed"));
         return -1;
     } else if (data->paused) {
-        /* Update the value of pre_parsed which was set when
-         * pause_parsing() was called. (length - nparsed) is
-         * the length of the data that will need to be parsed
-         * again later and hence must be deducted from the
-         * pre_parsed length */
-        data->pre_parsed -= (length - nparsed);
+        /* The request is complete, the remaining data
+         * has been pushed back by pause_parsing() */
         return 0;
     } else if (nparsed != length) {
         /* http_parser error */
@@ -594,43 +565,45 @@ static int parse_block(http_parser *parser, size_t offset, size_t length)
     return offset + nparsed;
 }
 
-static void parse_init(httpd_req_t *r, http_parser *parser, parser_data_t *data)
+/* Moves the headers parsed so far to the start of the full scratch buffer,
+ * so that the request line and the headers don't have to fit in it together.
+ * Returns the new offset of the end of the received data */
+static size_t move_headers(parser_data_t *data, size_t offset)
 {
-    /* Initialize parser data */
-    memset(data, 0, sizeof(parser_data_t));
-    data->req = r;
+    struct httpd_req_aux *raux = data->req->aux;
+    const size_t hdrs_offset = raux->req_hdrs_offset;
 
-    /* Initialize parser */
-    http_parser_init(parser, HTTP_REQUEST);
-    parser->data = (void *)data;
-
-    /* Initialize parser settings */
-    http_parser_settings_init(&data->settings);
-
-    /* Set parser callbacks */
-    data->settings.on_url              = cb_url;
-    data->settings.on_header_field     = cb_header_field;
-    data->settings.on_header_value     = cb_header_value;
-    data->settings.on_headers_complete = cb_headers_complete;
-    data->settings.on_body             = cb_on_body;
-    data->settings.on_message_complete = cb_no_body;
+    if (hdrs_offset == 0 || offset < sizeof(raux->scratch) ||
+            (data->status != PARSING_HDR_FIELD && data->status != PARSING_HDR_VALUE)) {
+        return offset;
+    }
+    ESP_LOGD(TAG, LOG_FMT("moving headers by %"NEWLIB_NANO_COMPAT_FORMAT), NEWLIB_NANO_COMPAT_CAST(hdrs_offset));
+    memmove(raux->scratch, raux->scratch + hdrs_offset, offset - hdrs_offset);
+    data->last.at -= hdrs_offset;
+    raux->req_hdrs_offset = 0;
+    return offset - hdrs_offset;
 }
 
 /* Function that receives TCP data and runs parser on it
  */
-static esp_err_t httpd_parse_req(struct httpd_data *hd)
+static esp_err_t httpd_parse_req(httpd_req_t *r)
 {
-    httpd_req_t *r = &hd->hd_req;
     int blk_len,  offset;
-    http_parser   parser = {};
-    parser_data_t parser_data = {};
+    http_parser   parser;
+    parser_data_t parser_data = {
+        .req = r,
+    };
 
     /* Initialize parser */
-    parse_init(r, &parser, &parser_data);
+    http_parser_init(&parser, HTTP_REQUEST);
+    parser.data = (void *)&parser_data;
 
     /* Set offset to start of scratch buffer */
     offset = 0;
     do {
+        /* Make room for the rest of the headers if the buffer is full */
+        offset = move_headers(&parser_data, offset);
+
         /* Read block into scratch buffer */
         if ((blk_len = read_block(r, offset, PARSER_BLOCK_SIZE)) < 0) {
             if (blk_len == HTTPD_SOCK_ERR_TIMEOUT) {
@@ -660,14 +633,17 @@ static esp_err_t httpd_parse_req(struct httpd_data *hd)
     } while (parser_data.status != PARSING_COMPLETE);
 
     ESP_LOGD(TAG, LOG_FMT("parsing complete"));
-    return httpd_uri(hd);
+    return httpd_uri(r);
 }
 
+/* The request and its auxiliary data are reset in place for every request
+ * of a session. The buffers are only read as far as they are filled in for
+ * the current request, so they aren't cleared */
 static void init_req(httpd_req_t *r, httpd_config_t *config)
 {
     r->handle = 0;
     r->method = 0;
-    memset((char*)r->uri, 0, sizeof(r->uri));
+    ((char *)r->uri)[0] = '\0';
     r->content_len = 0;
     r->aux = 0;
     r->user_ctx = 0;
@@ -679,17 +655,16 @@ static void init_req(httpd_req_t *r, httpd_config_t *config)
 static void init_req_aux(struct httpd_req_aux *ra, httpd_config_t *config)
 {
     ra->sd = 0;
-    memset(ra->scratch, 0, sizeof(ra->scratch));
     ra->remaining_len = 0;
     ra->status = 0;
     ra->content_type = 0;
     ra->first_chunk_sent = 0;
+    ra->req_hdrs_offset = 0;
     ra->req_hdrs_count = 0;
     ra->resp_hdrs_count = 0;
 #if CONFIG_HTTPD_WS_SUPPORT
     ra->ws_handshake_detect = false;
 #endif
-    memset(ra->resp_hdrs, 0, config->max_resp_headers * sizeof(struct resp_hdr));
 }
 
 static void httpd_req_cleanup(httpd_req_t *r)
@@ -724,13 +699,14 @@ static void httpd_req_cleanup(httpd_req_t *r)
 /* Function that processes incoming TCP data and
  * updates the http request data httpd_req_t
  */
-esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd)
+esp_err_t httpd_req_new(struct httpd_worker *worker, struct sock_db *sd)
 {
-    httpd_req_t *r = &hd->hd_req;
+    struct httpd_data *hd = worker->hd;
+    httpd_req_t *r = &worker->req;
     init_req(r, &hd->config);
-    init_req_aux(&hd->hd_req_aux, &hd->config);
+    init_req_aux(&worker->req_aux, &hd->config);
     r->handle = hd;
-    r->aux = &hd->hd_req_aux;
+    r->aux = &worker->req_aux;
 
     /* Associate the request to the socket */
     struct httpd_req_aux *ra = r->aux;
@@ -788,7 +764,7 @@ esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd)
 #endif
 
     /* Parse request */
-    ret = httpd_parse_req(hd);
+    ret = httpd_parse_req(r);
     if (ret != ESP_OK) {
         httpd_req_cleanup(r);
     }
@@ -797,9 +773,8 @@ esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd)
 
 /* Function that resets the http request data
  */
-esp_err_t httpd_req_delete(struct httpd_data *hd)
+esp_err_t httpd_req_delete(httpd_req_t *r)
 {
-    httpd_req_t *r = &hd->hd_req;
     struct httpd_req_aux *ra = r->aux;
 
     /* Finish off reading any pending/leftover data */
@@ -839,8 +814,9 @@ bool httpd_validate_req_ptr(httpd_req_t *r)
         struct httpd_data *hd = (struct httpd_data *) r->handle;
         if (hd) {
             /* Check if this function is running in the context of
-             * the correct httpd server thread */
-            if (httpd_os_thread_handle() == hd->hd_td.handle) {
+             * the httpd thread which processes the request */
+            struct httpd_worker *worker = httpd_worker_self(hd);
+            if (worker && httpd_os_thread_handle() == worker->td.handle) {
                 return true;
             }
         }
@@ -968,7 +944,7 @@ size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field)
     }
 
     struct httpd_req_aux *ra = r->aux;
-    const char   *hdr_ptr = ra->scratch;         /*!< Request headers are kept in scratch buffer */
+    const char   *hdr_ptr = ra->scratch + ra->req_hdrs_offset; /*!< Request headers are kept in scratch buffer */
     unsigned      count   = ra->req_hdrs_count;  /*!< Count set during parsing  */
 
     while (count--) {
@@ -1023,7 +999,7 @@ esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *v
     }
 
     struct httpd_req_aux *ra = r->aux;
-    const char   *hdr_ptr = ra->scratch;         /*!< Request headers are kept in scratch buffer */
+    const char   *hdr_ptr = ra->scratch + ra->req_hdrs_offset; /*!< Request headers are kept in scratch buffer */
     unsigned     count    = ra->req_hdrs_count;  /*!< Count set during parsing  */
     const size_t buf_len  = val_size;
 
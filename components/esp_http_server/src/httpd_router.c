@@ -0,0 +1,276 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <esp_err.h>
+
+#include <esp_http_server.h>
+#include "httpd_router.h"
+
+/* Handler which matches the URIs ending at a node (exact) or the URIs
+ * starting with the path to a node (prefix) */
+struct router_route {
+    uint16_t index;                     /*!< Index of the handler, lower ones take precedence */
+    httpd_method_t method;              /*!< Method of the handler */
+};
+
+struct router_routes {
+    struct router_route *routes;        /*!< Handlers in increasing order of index */
+    uint16_t count;                     /*!< Number of handlers */
+    uint64_t methods;                   /*!< Bitmap of the methods of the handlers */
+};
+
+struct router_node {
+    char *label;                        /*!< Part of the URI leading from the parent to this node */
+    uint16_t label_len;                 /*!< Length of the label */
+    uint16_t child_count;               /*!< Number of children */
+    struct router_node **children;      /*!< Children, sorted by the first character of their label */
+    struct router_routes exact;         /*!< Handlers matching the URI ending at this node */
+    struct router_routes prefix;        /*!< Handlers matching any URI starting with the path to this node */
+};
+
+struct httpd_router {
+    bool wildcard;                      /*!< Templates are interpreted like httpd_uri_match_wildcard() */
+    struct router_node root;            /*!< Node of the empty URI */
+};
+
+/* Methods which don't fit in the bitmap are only matched by scanning the handlers */
+#define METHOD_BITS         64
+#define METHOD_BIT(m)       ((m) >= 0 && (m) < METHOD_BITS ? (1ULL << (m)) : 0)
+
+static void router_node_free(struct router_node *node)
+{
+    for (int i = 0; i < node->child_count; i++) {
+        router_node_free(node->children[i]);
+        free(node->children[i]);
+    }
+    free(node->children);
+    free(node->label);
+    free(node->exact.routes);
+    free(node->prefix.routes);
+}
+
+/* Returns the position of the child whose label starts with c, or
+ * the position at which such a child must be inserted */
+static int router_child_pos(const struct router_node *node, unsigned char c, bool *found)
+{
+    int lo = 0;
+    int hi = node->child_count;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const unsigned char first = node->children[mid]->label[0];
+        if (first == c) {
+            *found = true;
+            return mid;
+        }
+        if (first < c) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = false;
+    return lo;
+}
+
+static esp_err_t router_child_insert(struct router_node *node, int pos, struct router_node *child)
+{
+    struct router_node **children = realloc(node->children, (node->child_count + 1) * sizeof(*children));
+    if (children == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memmove(&children[pos + 1], &children[pos], (node->child_count - pos) * sizeof(*children));
+    children[pos] = child;
+    node->children = children;
+    node->child_count++;
+    return ESP_OK;
+}
+
+static esp_err_t router_routes_add(struct router_routes *list, httpd_method_t method, uint16_t index)
+{
+    struct router_route *routes = realloc(list->routes, (list->count + 1) * sizeof(*routes));
+    if (routes == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    routes[list->count].index = index;
+    routes[list->count].method = method;
+    list->routes = routes;
+    list->count++;
+    list->methods |= (method == HTTP_ANY) ? UINT64_MAX : METHOD_BIT(method);
+    return ESP_OK;
+}
+
+/* Returns the node at which the URI key ends, creating the missing nodes */
+static struct router_node *router_node_get(struct router_node *node, const char *key, size_t len)
+{
+    while (len > 0) {
+        bool found;
+        const int pos = router_child_pos(node, key[0], &found);
+        if (!found) {
+            struct router_node *leaf = calloc(1, sizeof(struct router_node));
+            if (leaf == NULL || len > UINT16_MAX || (leaf->label = malloc(len)) == NULL) {
+                free(leaf);
+                return NULL;
+            }
+            memcpy(leaf->label, key, len);
+            leaf->label_len = len;
+            if (router_child_insert(node, pos, leaf) != ESP_OK) {
+                router_node_free(leaf);
+                free(leaf);
+                return NULL;
+            }
+            return leaf;
+        }
+
+        struct router_node *child = node->children[pos];
+        size_t common = 1;
+        while (common < child->label_len && common < len && child->label[common] == key[common]) {
+            common++;
+        }
+        if (common < child->label_len) {
+            /* Split the child, the new node takes the common part of the label */
+            struct router_node *split = calloc(1, sizeof(struct router_node));
+            struct router_node **children = malloc(sizeof(*children));
+            char *label = malloc(common);
+            if (split == NULL || children == NULL || label == NULL) {
+                free(split);
+                free(children);
+                free(label);
+                return NULL;
+            }
+            memcpy(label, child->label, common);
+            memmove(child->label, child->label + common, child->label_len - common);
+            child->label_len -= common;
+            children[0] = child;
+            split->label = label;
+            split->label_len = common;
+            split->children = children;
+            split->child_count = 1;
+            node->children[pos] = split;
+            child = split;
+        }
+        node = child;
+        key += common;
+        len -= common;
+    }
+    return node;
+}
+
+static esp_err_t router_insert(struct httpd_router *router, const char *key, size_t len, bool prefix,
+                               httpd_method_t method, uint16_t index)
+{
+    struct router_node *node = router_node_get(&router->root, key, len);
+    if (node == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    return router_routes_add(prefix ? &node->prefix : &node->exact, method, index);
+}
+
+struct httpd_router *httpd_router_create(bool wildcard)
+{
+    struct httpd_router *router = calloc(1, sizeof(struct httpd_router));
+    if (router) {
+        router->wildcard = wildcard;
+    }
+    return router;
+}
+
+void httpd_router_delete(struct httpd_router *router)
+{
+    if (router) {
+        router_node_free(&router->root);
+        free(router);
+    }
+}
+
+esp_err_t httpd_router_add(struct httpd_router *router, const char *uri, httpd_method_t method, uint16_t index)
+{
+    const size_t tpl_len = strlen(uri);
+    if (!router->wildcard) {
+        return router_insert(router, uri, tpl_len, false, method, index);
+    }
+
+    /* Same interpretation of the template as in httpd_uri_match_wildcard() */
+    const char last = (const char) (tpl_len > 0 ? uri[tpl_len - 1] : 0);
+    const char prevlast = (const char) (tpl_len > 1 ? uri[tpl_len - 2] : 0);
+    const bool asterisk = last == '*' || (prevlast == '*' && last == '?');
+    const bool quest = last == '?' || (prevlast == '?' && last == '*');
+
+    if (tpl_len < asterisk + quest * 2) {
+        /* Invalid template, never matches */
+        return ESP_OK;
+    }
+    const size_t exact_match_chars = tpl_len - (asterisk + quest * 2);
+
+    if (!quest) {
+        return router_insert(router, uri, exact_match_chars, asterisk, method, index);
+    }
+    /* The optional character may be absent, or present and followed by anything if asterisk is used */
+    esp_err_t ret = router_insert(router, uri, exact_match_chars, false, method, index);
+    if (ret == ESP_OK) {
+        ret = router_insert(router, uri, exact_match_chars + 1, asterisk, method, index);
+    }
+    return ret;
+}
+
+/* Updates the lowest index of the handlers matching the method */
+static void router_routes_match(const struct router_routes *list, httpd_method_t method,
+                                int *best, bool *uri_found)
+{
+    if (list->count == 0) {
+        return;
+    }
+    *uri_found = true;
+    if (METHOD_BIT(method) && !(list->methods & METHOD_BIT(method))) {
+        return;
+    }
+    for (int i = 0; i < list->count; i++) {
+        const struct router_route *route = &list->routes[i];
+        if (*best >= 0 && route->index >= *best) {
+            return;
+        }
+        if (route->method == method || route->method == HTTP_ANY) {
+            *best = route->index;
+            return;
+        }
+    }
+}
+
+int httpd_router_find(const struct httpd_router *router, const char *uri, size_t len,
+                      httpd_method_t method, httpd_err_code_t *err)
+{
+    const struct router_node *node = &router->root;
+    int best = -1;
+    bool uri_found = false;
+    size_t pos = 0;
+
+    while (true) {
+        router_routes_match(&node->prefix, method, &best, &uri_found);
+        if (pos == len) {
+            router_routes_match(&node->exact, method, &best, &uri_found);
+            break;
+        }
+        bool found;
+        const int child_pos = router_child_pos(node, uri[pos], &found);
+        if (!found) {
+            break;
+        }
+        const struct router_node *child = node->children[child_pos];
+        if (len - pos < child->label_len || memcmp(child->label, uri + pos, child->label_len) != 0) {
+            break;
+        }
+        pos += child->label_len;
+        node = child;
+    }
+
+    if (err) {
+        *err = best >= 0 ? 0 : (uri_found ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND);
+    }
+    return best;
+}
@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * \file httpd_router.h
+ * \brief Radix tree of the registered URI handlers
+ *
+ * Each URI template is reduced to the URIs it matches exactly and the
+ * prefixes of the URIs it matches, which are stored in a radix tree.
+ * A lookup walks the tree once along the requested URI, so its cost
+ * depends on the length of the URI rather than on the number of
+ * registered handlers. The result is the same as the one of matching
+ * the handlers in order of registration with httpd_uri_match_wildcard()
+ * or with plain string comparison.
+ */
+#ifndef _HTTPD_ROUTER_H_
+#define _HTTPD_ROUTER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <esp_err.h>
+#include <esp_http_server.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct httpd_router;
+
+/**
+ * @brief Create an empty router
+ *
+ * @param[in] wildcard  true to interpret the URI templates like httpd_uri_match_wildcard(),
+ *                      false to match them as plain strings
+ *
+ * @return  - the router
+ *          - NULL if there is not enough memory
+ */
+struct httpd_router *httpd_router_create(bool wildcard);
+
+/**
+ * @brief Delete a router
+ *
+ * @param[in] router the router, can be NULL
+ */
+void httpd_router_delete(struct httpd_router *router);
+
+/**
+ * @brief Add a URI handler to the router
+ *
+ *      Handlers must be added in increasing order of index. On lookup,
+ *      the matching handler with the lowest index is returned.
+ *
+ * @param[in] router    the router
+ * @param[in] uri       URI template of the handler
+ * @param[in] method    method of the handler, HTTP_ANY to match any method
+ * @param[in] index     index of the handler in the array of registered handlers
+ *
+ * @return  - ESP_OK if the handler was added
+ *          - ESP_ERR_NO_MEM if there is not enough memory, the router
+ *            must not be used anymore
+ */
+esp_err_t httpd_router_add(struct httpd_router *router, const char *uri, httpd_method_t method, uint16_t index);
+
+/**
+ * @brief Find the URI handler for a request
+ *
+ * @param[in] router    the router
+ * @param[in] uri       requested URI, not necessarily null terminated
+ * @param[in] len       length of the requested URI
+ * @param[in] method    requested method
+ * @param[out] err      set to 0 if a handler is found, otherwise to HTTPD_405_METHOD_NOT_ALLOWED
+ *                      if some handler matches the URI but not the method, or to HTTPD_404_NOT_FOUND.
+ *                      Can be NULL.
+ *
+ * @return  - index of the handler
+ *          - -1 if no handler matches
+ */
+int httpd_router_find(const struct httpd_router *router, const char *uri, size_t len,
+                      httpd_method_t method, httpd_err_code_t *err);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ! _HTTPD_ROUTER_H_ */
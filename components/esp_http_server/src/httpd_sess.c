@@ -32,6 +32,8 @@ typedef struct {
     int fd;
     fd_set *fdset;
     int max_fd;
+    bool pipelined;
+    bool busy;
     struct httpd_data *hd;
     uint64_t lru_counter;
     struct sock_db    *session;
@@ -60,6 +62,21 @@ static int fd_is_valid(int fd)
     return fcntl(fd, F_GETFD) != -1 || errno != EBADF;
 }
 
+/* Checks if data for the next request of the session has been received
+ * already, and the session can go on with it */
+static bool httpd_sess_has_pipelined(struct sock_db *session)
+{
+    if (session->pending_len == 0 || session->for_async_req) {
+        return false;
+    }
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    if (session->ws_close) {
+        return false;
+    }
+#endif
+    return true;
+}
+
 static int enum_function(struct sock_db *session, void *context)
 {
     if ((!session) || (!context)) {
@@ -88,16 +105,23 @@ static int enum_function(struct sock_db *session, void *context)
         break;
     // Set descriptor
     case HTTPD_TASK_SET_DESCRIPTOR:
-        if (session->fd != -1 && !session->for_async_req) {
+        if (session->fd != -1 && !session->for_async_req &&
+                atomic_load(&session->state) == HTTPD_SESS_IDLE) {
             FD_SET(session->fd, ctx->fdset);
             if (session->fd > ctx->max_fd) {
                 ctx->max_fd = session->fd;
             }
+            if (httpd_sess_has_pipelined(session)) {
+                ctx->pipelined = true;
+            }
+        } else if (session->fd != -1 && atomic_load(&session->state) != HTTPD_SESS_IDLE) {
+            ctx->busy = true;
         }
         break;
     // Delete invalid session
     case HTTPD_TASK_DELETE_INVALID:
-        if (!fd_is_valid(session->fd)) {
+        // Sessions owned by a worker task are closed once given back
+        if (atomic_load(&session->state) == HTTPD_SESS_IDLE && !fd_is_valid(session->fd)) {
             ESP_LOGW(TAG, LOG_FMT("Closing invalid socket %d"), session->fd);
             httpd_sess_delete(ctx->hd, session);
         }
@@ -109,10 +133,11 @@ static int enum_function(struct sock_db *session, void *context)
             return 0;
         }
         // Only close sockets that are not in use
-        if (session->for_async_req == false) {
+        if (session->for_async_req == false && atomic_load(&session->state) == HTTPD_SESS_IDLE) {
             // Check/update lowest lru
-            if (session->lru_counter < ctx->lru_counter) {
-                ctx->lru_counter = session->lru_counter;
+            uint64_t lru_counter = atomic_load(&session->lru_counter);
+            if (lru_counter < ctx->lru_counter) {
+                ctx->lru_counter = lru_counter;
                 ctx->session = session;
             }
         }
@@ -140,11 +165,19 @@ static void httpd_sess_close(void *arg)
         return;
     }
 
-    if (!sock_db->lru_counter && !sock_db->lru_socket) {
+    if (!atomic_load(&sock_db->lru_counter) && !sock_db->lru_socket) {
         ESP_LOGD(TAG, "Skipping session close for %d as it seems to be a race condition", sock_db->fd);
         return;
     }
     sock_db->lru_socket = false;
+
+    // Let the worker task which processes the session close it once done
+    int state = HTTPD_SESS_BUSY;
+    if (atomic_compare_exchange_strong(&sock_db->state, &state, HTTPD_SESS_CLOSE_PENDING) ||
+            state != HTTPD_SESS_IDLE) {
+        ESP_LOGD(TAG, "Deferring session close for %d until processed", sock_db->fd);
+        return;
+    }
     struct httpd_data *hd = (struct httpd_data *) sock_db->handle;
     httpd_sess_delete(hd, sock_db);
 }
@@ -174,8 +207,9 @@ struct sock_db *httpd_sess_get(struct httpd_data *hd, int sockfd)
 
     // Check if called inside a request handler, and the session sockfd in use is same as the parameter
     // => Just return the pointer to the sock_db corresponding to the request
-    if ((hd->hd_req_aux.sd) && (hd->hd_req_aux.sd->fd == sockfd)) {
-        return hd->hd_req_aux.sd;
+    struct httpd_worker *worker = httpd_worker_self(hd);
+    if ((worker) && (worker->req_aux.sd) && (worker->req_aux.sd->fd == sockfd)) {
+        return worker->req_aux.sd;
     }
 
     enum_context_t context = {
@@ -268,9 +302,9 @@ void *httpd_sess_get_ctx(httpd_handle_t handle, int sockfd)
     // Check if the function has been called from inside a
     // request handler, in which case fetch the context from
     // the httpd_req_t structure
-    struct httpd_data *hd = (struct httpd_data *) handle;
-    if (hd->hd_req_aux.sd == session) {
-        return hd->hd_req.sess_ctx;
+    struct httpd_worker *worker = httpd_worker_self((struct httpd_data *) handle);
+    if (worker && worker->req_aux.sd == session) {
+        return worker->req.sess_ctx;
     }
     return session->ctx;
 }
@@ -285,17 +319,18 @@ void httpd_sess_set_ctx(httpd_handle_t handle, int sockfd, void *ctx, httpd_free
     // Check if the function has been called from inside a
     // request handler, in which case set the context inside
     // the httpd_req_t structure
-    struct httpd_data *hd = (struct httpd_data *) handle;
-    if (hd->hd_req_aux.sd == session) {
-        if (hd->hd_req.sess_ctx != ctx) {
+    struct httpd_worker *worker = httpd_worker_self((struct httpd_data *) handle);
+    if (worker && worker->req_aux.sd == session) {
+        httpd_req_t *r = &worker->req;
+        if (r->sess_ctx != ctx) {
             // Don't free previous context if it is in sockdb
             // as it will be freed inside httpd_req_cleanup()
-            if (session->ctx != hd->hd_req.sess_ctx) {
-                httpd_sess_free_ctx(&hd->hd_req.sess_ctx, hd->hd_req.free_ctx); // Free previous context
+            if (session->ctx != r->sess_ctx) {
+                httpd_sess_free_ctx(&r->sess_ctx, r->free_ctx); // Free previous context
             }
-            hd->hd_req.sess_ctx = ctx;
+            r->sess_ctx = ctx;
         }
-        hd->hd_req.free_ctx = free_fn;
+        r->free_ctx = free_fn;
         return;
     }
 
@@ -329,7 +364,7 @@ void httpd_sess_set_transport_ctx(httpd_handle_t handle, int sockfd, void *ctx,
     session->free_transport_ctx = free_fn;
 }
 
-void httpd_sess_set_descriptors(struct httpd_data *hd, fd_set *fdset, int *maxfd)
+bool httpd_sess_set_descriptors(struct httpd_data *hd, fd_set *fdset, int *maxfd, bool *busy)
 {
     enum_context_t context = {
         .task = HTTPD_TASK_SET_DESCRIPTOR,
@@ -340,6 +375,10 @@ void httpd_sess_set_descriptors(struct httpd_data *hd, fd_set *fdset, int *maxfd
     if (maxfd) {
         *maxfd = context.max_fd;
     }
+    if (busy) {
+        *busy = context.busy;
+    }
+    return context.pipelined;
 }
 
 void httpd_sess_delete_invalid(struct httpd_data *hd)
@@ -386,7 +425,7 @@ void httpd_sess_delete(struct httpd_data *hd, struct sock_db *session)
     hd->hd_sd_active_count--;
     ESP_LOGD(TAG, LOG_FMT("active sockets: %d"), hd->hd_sd_active_count);
     if (!hd->hd_sd_active_count) {
-        hd->lru_counter = 0;
+        atomic_store(&hd->lru_counter, 0);
     }
 }
 
@@ -417,25 +456,37 @@ bool httpd_sess_pending(struct httpd_data *hd, struct sock_db *session)
  * value is returned, everything related to this socket will be
  * cleaned up and the socket will be closed.
  */
-esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session)
+esp_err_t httpd_sess_process(struct httpd_worker *worker, struct sock_db *session)
 {
-    if ((!hd) || (!session)) {
+    if ((!worker) || (!session)) {
         return ESP_FAIL;
     }
 
+    /* Only one request is processed at a time, so that a client
+     * pipelining requests doesn't hold up the other sessions. The
+     * next request, if received already, is processed on the next
+     * pass of the server loop, which doesn't wait in select() then */
     ESP_LOGD(TAG, LOG_FMT("httpd_req_new"));
-    if (httpd_req_new(hd, session) != ESP_OK) {
+    if (httpd_req_new(worker, session) != ESP_OK) {
         return ESP_FAIL;
     }
     ESP_LOGD(TAG, LOG_FMT("httpd_req_delete"));
-    if (httpd_req_delete(hd) != ESP_OK) {
+    if (httpd_req_delete(&worker->req) != ESP_OK) {
         return ESP_FAIL;
     }
     ESP_LOGD(TAG, LOG_FMT("success"));
-    session->lru_counter = ++hd->lru_counter;
     return ESP_OK;
 }
 
+void httpd_sess_release(struct sock_db *session, bool close)
+{
+    // The server task may have requested to close the session in the meantime
+    int state = HTTPD_SESS_BUSY;
+    if (close || !atomic_compare_exchange_strong(&session->state, &state, HTTPD_SESS_IDLE)) {
+        atomic_store(&session->state, HTTPD_SESS_CLOSE);
+    }
+}
+
 esp_err_t httpd_sess_update_lru_counter(httpd_handle_t handle, int sockfd)
 {
     if (handle == NULL) {
@@ -450,7 +501,8 @@ esp_err_t httpd_sess_update_lru_counter(httpd_handle_t handle, int sockfd)
     };
     httpd_sess_enum(hd, enum_function, &context);
     if (context.session) {
-        context.session->lru_counter = ++hd->lru_counter;
+        // may be called by URI handlers in worker tasks
+        atomic_store(&context.session->lru_counter, atomic_fetch_add(&hd->lru_counter, 1) + 1);
         return ESP_OK;
     }
     return ESP_ERR_NOT_FOUND;
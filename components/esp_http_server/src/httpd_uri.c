@@ -12,6 +12,7 @@
 
 #include <esp_http_server.h>
 #include "esp_httpd_priv.h"
+#include "httpd_router.h"
 
 static const char *TAG = "httpd_uri";
 
@@ -80,13 +81,94 @@ bool httpd_uri_match_wildcard(const char *template, const char *uri, size_t len)
     }
 }
 
+#if CONFIG_HTTPD_URI_ROUTER
+/* Take the radix tree out of use, called with hd_uri_lock held */
+static struct httpd_router *httpd_router_detach(struct httpd_data *hd)
+{
+    struct httpd_router *router = hd->hd_router;
+    hd->hd_router = NULL;
+    return router;
+}
+
+/* Replace the radix tree. The worker tasks may be looking up
+ * handlers meanwhile, so the old tree is freed once unused */
+static void httpd_router_replace(struct httpd_data *hd, struct httpd_router *router)
+{
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    struct httpd_router *old = hd->hd_router;
+    hd->hd_router = router;
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+    httpd_router_delete(old);
+}
+
+/* Rebuild the radix tree from the registered handlers. If it fails,
+ * the handlers are matched one by one until the next rebuild */
+static void httpd_router_rebuild(struct httpd_data *hd)
+{
+    /* The tree can only reproduce the built-in URI matching functions */
+    const bool wildcard = hd->config.uri_match_fn == httpd_uri_match_wildcard;
+    if (hd->config.uri_match_fn && !wildcard) {
+        return;
+    }
+    struct httpd_router *router = httpd_router_create(wildcard);
+    if (router == NULL) {
+        ESP_LOGW(TAG, LOG_FMT("no memory for URI router"));
+        httpd_router_replace(hd, NULL);
+        return;
+    }
+    for (int i = 0; i < hd->config.max_uri_handlers; i++) {
+        if (!hd->hd_calls[i]) {
+            break;
+        }
+        if (httpd_router_add(router, hd->hd_calls[i]->uri, hd->hd_calls[i]->method, i) != ESP_OK) {
+            ESP_LOGW(TAG, LOG_FMT("no memory for URI router"));
+            httpd_router_delete(router);
+            httpd_router_replace(hd, NULL);
+            return;
+        }
+    }
+    httpd_router_replace(hd, router);
+}
+
+/* Add the newly registered handler to the radix tree */
+static void httpd_router_update(struct httpd_data *hd, int index)
+{
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    struct httpd_router *router = hd->hd_router;
+    esp_err_t ret = ESP_OK;
+    if (router) {
+        /* The tree is modified in place, not while it is looked up */
+        ret = httpd_router_add(router, hd->hd_calls[index]->uri, hd->hd_calls[index]->method, index);
+        if (ret != ESP_OK) {
+            hd->hd_router = NULL;
+        }
+    }
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+
+    if (router == NULL) {
+        httpd_router_rebuild(hd);
+    } else if (ret != ESP_OK) {
+        ESP_LOGW(TAG, LOG_FMT("no memory for URI router"));
+        httpd_router_delete(router);
+    }
+}
+#endif
+
 /* Find handler with matching URI and method, and set
- * appropriate error code if URI or method not found */
-static httpd_uri_t* httpd_find_uri_handler(struct httpd_data *hd,
-                                           const char *uri, size_t uri_len,
-                                           httpd_method_t method,
-                                           httpd_err_code_t *err)
+ * appropriate error code if URI or method not found.
+ * Called with hd_uri_lock held */
+static httpd_uri_t* httpd_find_uri_handler_locked(struct httpd_data *hd,
+                                                  const char *uri, size_t uri_len,
+                                                  httpd_method_t method,
+                                                  httpd_err_code_t *err)
 {
+#if CONFIG_HTTPD_URI_ROUTER
+    if (hd->hd_router) {
+        int i = httpd_router_find(hd->hd_router, uri, uri_len, method, err);
+        return (i < 0) ? NULL : hd->hd_calls[i];
+    }
+#endif
+
     if (err) {
         *err = HTTPD_404_NOT_FOUND;
     }
@@ -123,6 +205,17 @@ static httpd_uri_t* httpd_find_uri_handler(struct httpd_data *hd,
     return NULL;
 }
 
+static httpd_uri_t* httpd_find_uri_handler(struct httpd_data *hd,
+                                           const char *uri, size_t uri_len,
+                                           httpd_method_t method,
+                                           httpd_err_code_t *err)
+{
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    httpd_uri_t *handler = httpd_find_uri_handler_locked(hd, uri, uri_len, method, err);
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+    return handler;
+}
+
 esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
                                      const httpd_uri_t *uri_handler)
 {
@@ -146,34 +239,41 @@ esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
 
     for (int i = 0; i < hd->config.max_uri_handlers; i++) {
         if (hd->hd_calls[i] == NULL) {
-            hd->hd_calls[i] = malloc(sizeof(httpd_uri_t));
-            if (hd->hd_calls[i] == NULL) {
+            httpd_uri_t *handler = malloc(sizeof(httpd_uri_t));
+            if (handler == NULL) {
                 /* Failed to allocate memory */
                 return ESP_ERR_HTTPD_ALLOC_MEM;
             }
 
             /* Copy URI string */
-            hd->hd_calls[i]->uri = strdup(uri_handler->uri);
-            if (hd->hd_calls[i]->uri == NULL) {
+            handler->uri = strdup(uri_handler->uri);
+            if (handler->uri == NULL) {
                 /* Failed to allocate memory */
-                free(hd->hd_calls[i]);
+                free(handler);
                 return ESP_ERR_HTTPD_ALLOC_MEM;
             }
 
             /* Copy remaining members */
-            hd->hd_calls[i]->method   = uri_handler->method;
-            hd->hd_calls[i]->handler  = uri_handler->handler;
-            hd->hd_calls[i]->user_ctx = uri_handler->user_ctx;
+            handler->method   = uri_handler->method;
+            handler->handler  = uri_handler->handler;
+            handler->user_ctx = uri_handler->user_ctx;
 #ifdef CONFIG_HTTPD_WS_SUPPORT
-            hd->hd_calls[i]->is_websocket = uri_handler->is_websocket;
-            hd->hd_calls[i]->handle_ws_control_frames = uri_handler->handle_ws_control_frames;
+            handler->is_websocket = uri_handler->is_websocket;
+            handler->handle_ws_control_frames = uri_handler->handle_ws_control_frames;
             if (uri_handler->supported_subprotocol) {
-                hd->hd_calls[i]->supported_subprotocol = strdup(uri_handler->supported_subprotocol);
+                handler->supported_subprotocol = strdup(uri_handler->supported_subprotocol);
             } else {
-                hd->hd_calls[i]->supported_subprotocol = NULL;
+                handler->supported_subprotocol = NULL;
             }
 #endif
+            /* Only add the handler once complete, requests may be looking it up */
+            httpd_os_mutex_lock(hd->hd_uri_lock);
+            hd->hd_calls[i] = handler;
+            httpd_os_mutex_unlock(hd->hd_uri_lock);
             ESP_LOGD(TAG, LOG_FMT("[%d] installed %s"), i, uri_handler->uri);
+#if CONFIG_HTTPD_URI_ROUTER
+            httpd_router_update(hd, i);
+#endif
             return ESP_OK;
         }
         ESP_LOGD(TAG, LOG_FMT("[%d] exists %s"), i, hd->hd_calls[i]->uri);
@@ -190,6 +290,7 @@ esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle,
     }
 
     struct httpd_data *hd = (struct httpd_data *) handle;
+    httpd_os_mutex_lock(hd->hd_uri_lock);
     for (int i = 0; i < hd->config.max_uri_handlers; i++) {
         if (!hd->hd_calls[i]) {
             break;
@@ -212,9 +313,20 @@ esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle,
             }
             /* Nullify the following non null entry */
             hd->hd_calls[i-1] = NULL;
+#if CONFIG_HTTPD_URI_ROUTER
+            /* Indices of the following handlers have changed, the
+             * handlers are matched one by one until the tree is rebuilt */
+            struct httpd_router *router = httpd_router_detach(hd);
+            httpd_os_mutex_unlock(hd->hd_uri_lock);
+            httpd_router_delete(router);
+            httpd_router_rebuild(hd);
+#else
+            httpd_os_mutex_unlock(hd->hd_uri_lock);
+#endif
             return ESP_OK;
         }
     }
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
     ESP_LOGW(TAG, LOG_FMT("handler %s with method %d not found"), uri, method);
     return ESP_ERR_NOT_FOUND;
 }
@@ -229,6 +341,7 @@ esp_err_t httpd_unregister_uri(httpd_handle_t handle, const char *uri)
     bool found = false;
 
     int i = 0, j = 0; // For keeping count of removed entries
+    httpd_os_mutex_lock(hd->hd_uri_lock);
     for (; i < hd->config.max_uri_handlers; i++) {
         if (!hd->hd_calls[i]) {
             break;
@@ -254,9 +367,21 @@ esp_err_t httpd_unregister_uri(httpd_handle_t handle, const char *uri)
     }
 
     if (!found) {
+        httpd_os_mutex_unlock(hd->hd_uri_lock);
         ESP_LOGW(TAG, LOG_FMT("no handler found for URI %s"), uri);
+        return ESP_ERR_NOT_FOUND;
     }
-    return (found ? ESP_OK : ESP_ERR_NOT_FOUND);
+#if CONFIG_HTTPD_URI_ROUTER
+    /* Indices of the remaining handlers have changed, the
+     * handlers are matched one by one until the tree is rebuilt */
+    struct httpd_router *router = httpd_router_detach(hd);
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+    httpd_router_delete(router);
+    httpd_router_rebuild(hd);
+#else
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+#endif
+    return ESP_OK;
 }
 
 void httpd_unregister_all_uri_handlers(struct httpd_data *hd)
@@ -271,13 +396,18 @@ void httpd_unregister_all_uri_handlers(struct httpd_data *hd)
         free(hd->hd_calls[i]);
         hd->hd_calls[i] = NULL;
     }
+#if CONFIG_HTTPD_URI_ROUTER
+    /* Only called once the server has stopped */
+    httpd_router_delete(hd->hd_router);
+    hd->hd_router = NULL;
+#endif
 }
 
-esp_err_t httpd_uri(struct httpd_data *hd)
+esp_err_t httpd_uri(httpd_req_t *req)
 {
+    struct httpd_data      *hd  = (struct httpd_data *) req->handle;
     httpd_uri_t            *uri = NULL;
-    httpd_req_t            *req = &hd->hd_req;
-    struct http_parser_url *res = &hd->hd_req_aux.url_parse_res;
+    struct http_parser_url *res = &((struct httpd_req_aux *) req->aux)->url_parse_res;
 
     /* For conveying URI not found/method not allowed */
     httpd_err_code_t err = 0;
@@ -313,7 +443,7 @@ esp_err_t httpd_uri(struct httpd_data *hd)
     struct httpd_req_aux   *aux = req->aux;
     if (uri->is_websocket && aux->ws_handshake_detect && uri->method == HTTP_GET) {
         ESP_LOGD(TAG, LOG_FMT("Responding WS handshake to sock %d"), aux->sd->fd);
-        esp_err_t ret = httpd_ws_respond_server_handshake(&hd->hd_req, uri->supported_subprotocol);
+        esp_err_t ret = httpd_ws_respond_server_handshake(req, uri->supported_subprotocol);
         if (ret != ESP_OK) {
             return ret;
         }
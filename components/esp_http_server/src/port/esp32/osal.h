@@ -9,6 +9,8 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <esp_timer.h>
@@ -21,6 +23,8 @@ extern "C" {
 #define OS_FAIL    ESP_FAIL
 
 typedef TaskHandle_t othread_t;
+typedef QueueHandle_t oqueue_t;
+typedef SemaphoreHandle_t omutex_t;
 
 static inline int httpd_os_thread_create(othread_t *thread,
                                  const char *name, uint16_t stacksize, int prio,
@@ -50,6 +54,63 @@ static inline othread_t httpd_os_thread_handle(void)
     return xTaskGetCurrentTaskHandle();
 }
 
+/* Queue of pointers */
+static inline int httpd_os_queue_create(oqueue_t *queue, size_t length)
+{
+    *queue = xQueueCreate(length, sizeof(void *));
+    if (*queue) {
+        return OS_SUCCESS;
+    }
+    return OS_FAIL;
+}
+
+static inline void httpd_os_queue_delete(oqueue_t queue)
+{
+    vQueueDelete(queue);
+}
+
+/* Doesn't block, fails if the queue is full */
+static inline int httpd_os_queue_send(oqueue_t queue, void *item)
+{
+    if (xQueueSend(queue, &item, 0) == pdTRUE) {
+        return OS_SUCCESS;
+    }
+    return OS_FAIL;
+}
+
+/* Blocks until an item is available */
+static inline int httpd_os_queue_receive(oqueue_t queue, void **item)
+{
+    if (xQueueReceive(queue, item, portMAX_DELAY) == pdTRUE) {
+        return OS_SUCCESS;
+    }
+    return OS_FAIL;
+}
+
+static inline int httpd_os_mutex_create(omutex_t *mutex)
+{
+    *mutex = xSemaphoreCreateMutex();
+    if (*mutex) {
+        return OS_SUCCESS;
+    }
+    return OS_FAIL;
+}
+
+static inline void httpd_os_mutex_delete(omutex_t mutex)
+{
+    vSemaphoreDelete(mutex);
+}
+
+static inline void httpd_os_mutex_lock(omutex_t mutex)
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+static inline void httpd_os_mutex_unlock(omutex_t mutex)
+{
+    xSemaphoreGive(mutex);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,7 @@
 
 #include <unistd.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <pthread.h>
 
 #ifdef __cplusplus
@@ -18,6 +19,17 @@ extern "C" {
 
 typedef TaskHandle_t othread_t;
 
+struct httpd_os_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    size_t length;
+    size_t head;
+    size_t count;
+    void *items[];
+};
+typedef struct httpd_os_queue *oqueue_t;
+typedef pthread_mutex_t *omutex_t;
+
 static inline int httpd_os_thread_create(othread_t *thread,
                                  const char *name, uint16_t stacksize, int prio,
                                  void (*thread_routine)(void *arg), void *arg,
@@ -50,6 +62,81 @@ static inline othread_t httpd_os_thread_handle(void)
     return (othread_t)pthread_self();
 }
 
+/* Queue of pointers */
+static inline int httpd_os_queue_create(oqueue_t *queue, size_t length)
+{
+    oqueue_t q = calloc(1, sizeof(struct httpd_os_queue) + length * sizeof(void *));
+    if (q == NULL) {
+        return OS_FAIL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    q->length = length;
+    *queue = q;
+    return OS_SUCCESS;
+}
+
+static inline void httpd_os_queue_delete(oqueue_t queue)
+{
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
+
+/* Doesn't block, fails if the queue is full */
+static inline int httpd_os_queue_send(oqueue_t queue, void *item)
+{
+    int ret = OS_FAIL;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count < queue->length) {
+        queue->items[(queue->head + queue->count++) % queue->length] = item;
+        pthread_cond_signal(&queue->not_empty);
+        ret = OS_SUCCESS;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ret;
+}
+
+/* Blocks until an item is available */
+static inline int httpd_os_queue_receive(oqueue_t queue, void **item)
+{
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+    *item = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_mutex_unlock(&queue->lock);
+    return OS_SUCCESS;
+}
+
+static inline int httpd_os_mutex_create(omutex_t *mutex)
+{
+    *mutex = malloc(sizeof(pthread_mutex_t));
+    if (*mutex == NULL) {
+        return OS_FAIL;
+    }
+    pthread_mutex_init(*mutex, NULL);
+    return OS_SUCCESS;
+}
+
+static inline void httpd_os_mutex_delete(omutex_t mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+}
+
+static inline void httpd_os_mutex_lock(omutex_t mutex)
+{
+    pthread_mutex_lock(mutex);
+}
+
+static inline void httpd_os_mutex_unlock(omutex_t mutex)
+{
+    pthread_mutex_unlock(mutex);
+}
+
 #ifdef __cplusplus
 }
 #endif
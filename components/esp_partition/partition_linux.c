@@ -14,6 +14,7 @@
 #include <unistd.h>
 #include <limits.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include "sdkconfig.h"
 #include "esp_partition.h"
 #include "esp_flash_partitions.h"
@@ -34,12 +35,13 @@ static esp_partition_file_mmap_ctrl_t s_esp_partition_file_mmap_ctrl_act = {0};
 
 #ifdef CONFIG_ESP_PARTITION_ENABLE_STATS
 // variables holding stats and controlling power-off emulation
-static size_t s_esp_partition_stat_read_ops = 0;
-static size_t s_esp_partition_stat_write_ops = 0;
-static size_t s_esp_partition_stat_read_bytes = 0;
-static size_t s_esp_partition_stat_write_bytes = 0;
-static size_t s_esp_partition_stat_erase_ops = 0;
-static size_t s_esp_partition_stat_total_time = 0;
+// the stats are atomic, as several threads can access the emulated flash (e.g. NVS parallel page load)
+static _Atomic size_t s_esp_partition_stat_read_ops = 0;
+static _Atomic size_t s_esp_partition_stat_write_ops = 0;
+static _Atomic size_t s_esp_partition_stat_read_bytes = 0;
+static _Atomic size_t s_esp_partition_stat_write_bytes = 0;
+static _Atomic size_t s_esp_partition_stat_erase_ops = 0;
+static _Atomic size_t s_esp_partition_stat_total_time = 0;
 static size_t s_esp_partition_emulated_power_off_counter = SIZE_MAX;
 static uint8_t s_esp_partition_emulated_power_off_mode = 0;
 
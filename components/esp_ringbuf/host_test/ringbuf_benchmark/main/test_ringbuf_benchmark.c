@@ -0,0 +1,273 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/ringbuf.h"
+#include "unity.h"
+
+#define TEST_TASK_STACK_SIZE        4096
+#define TEST_TASK_PRIORITY          5
+#define TEST_TIMEOUT_TICKS          pdMS_TO_TICKS(1000)
+
+#define BENCH_BUFFER_SIZE           8192
+#define BENCH_TOTAL_BYTES           (4 * 1024 * 1024)
+#define BENCH_MAX_ITEM_SIZE         1024
+#define BENCH_BATCH_SIZE            16
+
+typedef struct {
+    RingbufHandle_t buffer;
+    RingbufferType_t type;
+    size_t item_size;           //Size of each item. 0 for random sizes between 1 and max_item_size
+    size_t max_item_size;
+    size_t item_count;
+    UBaseType_t batch_size;     //Number of items received and returned at once by the consumer. 0 to receive one at a time
+    size_t bytes_received;
+    bool check_data;
+    bool failed;
+    SemaphoreHandle_t done;
+} test_args_t;
+
+static const char *type_names[RINGBUF_TYPE_MAX] = {
+    [RINGBUF_TYPE_NOSPLIT] = "no-split",
+    [RINGBUF_TYPE_ALLOWSPLIT] = "allow-split",
+    [RINGBUF_TYPE_BYTEBUF] = "byte buffer",
+    [RINGBUF_TYPE_NOSPLIT_SPSC] = "no-split SPSC",
+    [RINGBUF_TYPE_BYTEBUF_SPSC] = "byte buffer SPSC",
+};
+
+static inline bool is_byte_buffer(RingbufferType_t type)
+{
+    return type == RINGBUF_TYPE_BYTEBUF || type == RINGBUF_TYPE_BYTEBUF_SPSC;
+}
+
+static size_t next_item_size(test_args_t *args, uint32_t *seed)
+{
+    if (args->item_size != 0) {
+        return args->item_size;
+    }
+    *seed = *seed * 1103515245 + 12345;
+    return 1 + (*seed >> 8) % args->max_item_size;
+}
+
+static void producer_task(void *arg)
+{
+    test_args_t *args = (test_args_t *)arg;
+    static uint8_t item[BENCH_MAX_ITEM_SIZE];
+    uint32_t seed = 1;
+    size_t byte_pos = 0;
+
+    for (size_t i = 0; i < args->item_count; i++) {
+        size_t size = next_item_size(args, &seed);
+        if (args->check_data) {
+            //Every byte is the low byte of its position in the whole data stream
+            for (size_t j = 0; j < size; j++) {
+                item[j] = (uint8_t)(byte_pos + j);
+            }
+        }
+        byte_pos += size;
+        if (xRingbufferSend(args->buffer, item, size, TEST_TIMEOUT_TICKS) != pdTRUE) {
+            args->failed = true;
+            break;
+        }
+    }
+    xSemaphoreGive(args->done);
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *arg)
+{
+    test_args_t *args = (test_args_t *)arg;
+    uint32_t seed = 1;
+    size_t total = 0;
+    void *held_item = NULL;
+
+    for (size_t i = 0; i < args->item_count; i++) {
+        total += next_item_size(args, &seed);
+    }
+
+    while (args->batch_size > 0 && args->bytes_received < total) {
+        void *items[BENCH_BATCH_SIZE];
+        size_t sizes[BENCH_BATCH_SIZE];
+        UBaseType_t count = xRingbufferReceiveMultiple(args->buffer, items, sizes, args->batch_size, TEST_TIMEOUT_TICKS);
+        if (count == 0) {
+            args->failed = true;
+            break;
+        }
+        for (UBaseType_t i = 0; i < count; i++) {
+            if (args->check_data) {
+                for (size_t j = 0; j < sizes[i]; j++) {
+                    if (((uint8_t *)items[i])[j] != (uint8_t)(args->bytes_received + j)) {
+                        args->failed = true;
+                    }
+                }
+            }
+            args->bytes_received += sizes[i];
+        }
+        vRingbufferReturnMultiple(args->buffer, items, count);
+    }
+    while (args->batch_size == 0 && args->bytes_received < total) {
+        size_t size;
+        uint8_t *data = (uint8_t *)xRingbufferReceive(args->buffer, &size, TEST_TIMEOUT_TICKS);
+        if (data == NULL) {
+            args->failed = true;
+            break;
+        }
+        if (args->check_data) {
+            for (size_t j = 0; j < size; j++) {
+                if (data[j] != (uint8_t)(args->bytes_received + j)) {
+                    args->failed = true;
+                }
+            }
+        }
+        args->bytes_received += size;
+        if (is_byte_buffer(args->type) || !args->check_data) {
+            vRingbufferReturnItem(args->buffer, data);
+        } else if (held_item == NULL) {
+            //Keep every other item a bit longer, so that items are returned out of order
+            held_item = data;
+        } else {
+            vRingbufferReturnItem(args->buffer, data);
+            vRingbufferReturnItem(args->buffer, held_item);
+            held_item = NULL;
+        }
+    }
+    if (held_item != NULL) {
+        vRingbufferReturnItem(args->buffer, held_item);
+    }
+    xSemaphoreGive(args->done);
+    vTaskDelete(NULL);
+}
+
+static void run_producer_consumer(test_args_t *args)
+{
+    args->done = xSemaphoreCreateCounting(2, 0);
+    TEST_ASSERT_NOT_NULL(args->done);
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(consumer_task, "consumer", TEST_TASK_STACK_SIZE, args, TEST_TASK_PRIORITY, NULL));
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(producer_task, "producer", TEST_TASK_STACK_SIZE, args, TEST_TASK_PRIORITY, NULL));
+    xSemaphoreTake(args->done, portMAX_DELAY);
+    xSemaphoreTake(args->done, portMAX_DELAY);
+    vSemaphoreDelete(args->done);
+}
+
+TEST_CASE("SPSC ring buffers deliver data in order across wrap-around", "[esp_ringbuf]")
+{
+    const RingbufferType_t types[] = { RINGBUF_TYPE_NOSPLIT_SPSC, RINGBUF_TYPE_BYTEBUF_SPSC };
+
+    for (int i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        //A small buffer makes both tasks block often and wraps around every few items
+        RingbufHandle_t buffer = xRingbufferCreate(256, types[i]);
+        TEST_ASSERT_NOT_NULL(buffer);
+        test_args_t args = {
+            .buffer = buffer,
+            .type = types[i],
+            //Leave room for the next item while the consumer holds on to one
+            .max_item_size = xRingbufferGetMaxItemSize(buffer) / 2,
+            .item_count = 20000,
+            .check_data = true,
+        };
+        run_producer_consumer(&args);
+        TEST_ASSERT_FALSE(args.failed);
+
+        if (types[i] == RINGBUF_TYPE_NOSPLIT_SPSC) {
+            //Same again, receiving and returning several items at once
+            args.bytes_received = 0;
+            args.batch_size = BENCH_BATCH_SIZE;
+            run_producer_consumer(&args);
+            TEST_ASSERT_FALSE(args.failed);
+        }
+
+        UBaseType_t items_waiting;
+        vRingbufferGetInfo(buffer, NULL, NULL, NULL, NULL, &items_waiting);
+        TEST_ASSERT_EQUAL(0, items_waiting);
+        vRingbufferDelete(buffer);
+    }
+}
+
+TEST_CASE("SPSC ring buffers time out and report free size", "[esp_ringbuf]")
+{
+    uint8_t item[16] = { 0 };
+    size_t size;
+    RingbufHandle_t buffer = xRingbufferCreate(64, RINGBUF_TYPE_NOSPLIT_SPSC);
+    TEST_ASSERT_NOT_NULL(buffer);
+
+    TEST_ASSERT_NULL(xRingbufferReceive(buffer, &size, 2));
+    TEST_ASSERT_EQUAL(xRingbufferGetMaxItemSize(buffer), xRingbufferGetCurFreeSize(buffer));
+    while (xRingbufferSend(buffer, item, sizeof(item), 0) == pdTRUE) {
+    }
+    TEST_ASSERT_EQUAL(pdFALSE, xRingbufferSend(buffer, item, sizeof(item), 2));
+    TEST_ASSERT_LESS_THAN(sizeof(item), xRingbufferGetCurFreeSize(buffer));
+
+    void *data = xRingbufferReceive(buffer, &size, 0);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(sizeof(item), size);
+    vRingbufferReturnItem(buffer, data);
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSend(buffer, item, sizeof(item), 0));
+
+    //Queue sets are not supported
+    QueueSetHandle_t queue_set = xQueueCreateSet(1);
+    TEST_ASSERT_NOT_NULL(queue_set);
+    TEST_ASSERT_EQUAL(pdFALSE, xRingbufferAddToQueueSetRead(buffer, queue_set));
+    vQueueDelete(queue_set);
+    vRingbufferDelete(buffer);
+}
+
+static double get_time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+TEST_CASE("Ring buffer throughput", "[esp_ringbuf][benchmark]")
+{
+    const struct {
+        RingbufferType_t type;
+        UBaseType_t batch_size;
+    } configs[] = {
+        { RINGBUF_TYPE_NOSPLIT, 0 },
+        { RINGBUF_TYPE_NOSPLIT, BENCH_BATCH_SIZE },
+        { RINGBUF_TYPE_NOSPLIT_SPSC, 0 },
+        { RINGBUF_TYPE_NOSPLIT_SPSC, BENCH_BATCH_SIZE },
+        { RINGBUF_TYPE_BYTEBUF, 0 },
+        { RINGBUF_TYPE_BYTEBUF_SPSC, 0 },
+    };
+    const size_t item_sizes[] = { 4, 16, 64, 256, BENCH_MAX_ITEM_SIZE };
+
+    printf("%-18s %6s %10s %14s %14s\n", "type", "batch", "item size", "items/s", "bytes/s");
+    for (int i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        for (int j = 0; j < sizeof(item_sizes) / sizeof(item_sizes[0]); j++) {
+            RingbufHandle_t buffer = xRingbufferCreate(BENCH_BUFFER_SIZE, configs[i].type);
+            TEST_ASSERT_NOT_NULL(buffer);
+            test_args_t args = {
+                .buffer = buffer,
+                .type = configs[i].type,
+                .item_size = item_sizes[j],
+                .item_count = BENCH_TOTAL_BYTES / item_sizes[j],
+                .batch_size = configs[i].batch_size,
+            };
+
+            double start = get_time_s();
+            run_producer_consumer(&args);
+            double elapsed = get_time_s() - start;
+            TEST_ASSERT_FALSE(args.failed);
+
+            printf("%-18s %6u %10zu %14.0f %14.0f\n", type_names[configs[i].type], (unsigned)configs[i].batch_size,
+                   item_sizes[j], args.item_count / elapsed, args.bytes_received / elapsed);
+            vRingbufferDelete(buffer);
+        }
+    }
+}
+
+void app_main(void)
+{
+    unity_run_menu();
+}
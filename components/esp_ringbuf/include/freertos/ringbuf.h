@@ -41,6 +41,23 @@ typedef enum {
      * time.
      */
     RINGBUF_TYPE_BYTEBUF,
+    /**
+     * Single-producer/single-consumer variant of RINGBUF_TYPE_NOSPLIT. Items
+     * are stored the same way, but the send path and the receive/return path
+     * only synchronize through atomic read/write offsets and do not take the
+     * ring buffer's spinlock unless a task has to be blocked or woken up.
+     *
+     * Only one task (or ISR) may send to the buffer, and only one task (or ISR)
+     * may receive items from the buffer and return them. Acquiring buffers with
+     * xRingbufferSendAcquire() and adding the buffer to a queue set are not
+     * supported.
+     */
+    RINGBUF_TYPE_NOSPLIT_SPSC,
+    /**
+     * Single-producer/single-consumer variant of RINGBUF_TYPE_BYTEBUF, with the
+     * same restrictions as RINGBUF_TYPE_NOSPLIT_SPSC.
+     */
+    RINGBUF_TYPE_BYTEBUF_SPSC,
     RINGBUF_TYPE_MAX,
 } RingbufferType_t;
 
@@ -61,10 +78,19 @@ typedef struct xSTATIC_RINGBUFFER {
     BaseType_t xDummy4;
     StaticList_t xDummy5[2];
     void * pvDummy6;
+    size_t xDummy7[4];
     portMUX_TYPE muxDummy;
     /** @endcond */
 } StaticRingbuffer_t;
 
+/**
+ * @brief Struct that describes one part of an item sent with xRingbufferSendv()
+ */
+typedef struct {
+    const void *pvData;     /**< Pointer to the data of this part. NULL is allowed if xLen is 0. */
+    size_t xLen;            /**< Length of this part in bytes */
+} RingbufferIOVec_t;
+
 /**
  * @brief       Create a ring buffer
  *
@@ -168,6 +194,32 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
                                   size_t xItemSize,
                                   BaseType_t *pxHigherPriorityTaskWoken);
 
+/**
+ * @brief       Insert an item gathered from several parts into the ring buffer
+ *
+ * Attempt to insert the concatenation of the parts described by pxIOV into the
+ * ring buffer as a single item. The parts are copied directly into the ring
+ * buffer, so that they do not have to be assembled in a temporary buffer first.
+ * This function will block until enough free space is available or until it
+ * times out.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to insert the item into
+ * @param[in]   pxIOV           Array of parts that make up the item
+ * @param[in]   uxIOVCount      Number of parts in pxIOV
+ * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
+ *
+ * @note    The size of the item is the sum of the lengths of all parts. The
+ *          same notes as for xRingbufferSend() apply to it.
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ *      - pdFALSE on time-out or when the data is larger than the maximum permissible size of the buffer
+ */
+BaseType_t xRingbufferSendv(RingbufHandle_t xRingbuffer,
+                            const RingbufferIOVec_t *pxIOV,
+                            UBaseType_t uxIOVCount,
+                            TickType_t xTicksToWait);
+
 /**
  * @brief Acquire memory from the ring buffer to be written to by an external
  *        source and to be sent later.
@@ -362,6 +414,32 @@ void *xRingbufferReceiveUpTo(RingbufHandle_t xRingbuffer,
  */
 void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemSize, size_t xMaxSize);
 
+/**
+ * @brief   Retrieve multiple items from a no-split ring buffer
+ *
+ * Attempt to retrieve up to uxMaxItems items from the ring buffer at once. This
+ * function will block until at least one item is available or until it times
+ * out. It then retrieves all items that are available, up to uxMaxItems, in
+ * the order in which they were sent.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to retrieve the items from
+ * @param[out]  ppvItems        Array of at least uxMaxItems elements to which pointers to the retrieved items will be written
+ * @param[out]  pxItemSizes     Array of at least uxMaxItems elements to which the sizes of the retrieved items will be written
+ * @param[in]   uxMaxItems      Maximum number of items to retrieve
+ * @param[in]   xTicksToWait    Ticks to wait for items in the ring buffer.
+ *
+ * @note    Only applicable to no-split ring buffers (RINGBUF_TYPE_NOSPLIT and RINGBUF_TYPE_NOSPLIT_SPSC)
+ * @note    The retrieved items can be returned with a single call to vRingbufferReturnMultiple(),
+ *          or one by one with vRingbufferReturnItem().
+ *
+ * @return  Number of items retrieved, 0 on timeout.
+ */
+UBaseType_t xRingbufferReceiveMultiple(RingbufHandle_t xRingbuffer,
+                                       void **ppvItems,
+                                       size_t *pxItemSizes,
+                                       UBaseType_t uxMaxItems,
+                                       TickType_t xTicksToWait);
+
 /**
  * @brief   Return a previously-retrieved item to the ring buffer
  *
@@ -384,6 +462,18 @@ void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem);
  */
 void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, BaseType_t *pxHigherPriorityTaskWoken);
 
+/**
+ * @brief   Return multiple previously-retrieved items to the ring buffer
+ *
+ * Equivalent to calling vRingbufferReturnItem() for each item, but tasks
+ * waiting for space to send are only woken up once all items have been returned.
+ *
+ * @param[in]   xRingbuffer     Ring buffer the items were retrieved from
+ * @param[in]   ppvItems        Array of items that were received earlier
+ * @param[in]   uxItemCount     Number of items in ppvItems
+ */
+void vRingbufferReturnMultiple(RingbufHandle_t xRingbuffer, void *const *ppvItems, UBaseType_t uxItemCount);
+
 /**
  * @brief   Delete a ring buffer
  *
@@ -444,6 +534,8 @@ size_t xRingbufferGetCurFreeSize(RingbufHandle_t xRingbuffer);
  * @param[in]   xRingbuffer     Ring buffer to add to the queue set
  * @param[in]   xQueueSet       Queue set to add the ring buffer to
  *
+ * @note    Single-producer/single-consumer ring buffers cannot be added to a queue set.
+ *
  * @return
  *      - pdTRUE on success, pdFALSE otherwise
  */
@@ -496,6 +588,9 @@ BaseType_t xRingbufferRemoveFromQueueSetRead(RingbufHandle_t xRingbuffer, QueueS
  * @param[out]  uxWrite         Pointer use to store write pointer position
  * @param[out]  uxAcquire       Pointer use to store acquire pointer position
  * @param[out]  uxItemsWaiting  Pointer use to store number of items (bytes for byte buffer) waiting to be retrieved
+ *
+ * @note    For single-producer/single-consumer ring buffers, uxItemsWaiting is the number of bytes (including item
+ *          headers) that have been sent but not yet retrieved.
  */
 void vRingbufferGetInfo(RingbufHandle_t xRingbuffer,
                         UBaseType_t *uxFree,
@@ -7,6 +7,7 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/list.h"
 #include "freertos/task.h"
@@ -27,6 +28,7 @@
 #define rbBUFFER_FULL_FLAG          ( ( UBaseType_t ) 4 )   //The ring buffer is currently full (write pointer == free pointer)
 #define rbBUFFER_STATIC_FLAG        ( ( UBaseType_t ) 8 )   //The ring buffer is statically allocated
 #define rbUSING_QUEUE_SET           ( ( UBaseType_t ) 16 )  //The ring buffer has been added to a queue set
+#define rbSPSC_FLAG                 ( ( UBaseType_t ) 32 )  //The ring buffer has a single producer and a single consumer
 
 //Item flags
 #define rbITEM_FREE_FLAG            ( ( UBaseType_t ) 1 )   //Item has been retrieved and returned by application, free to overwrite
@@ -34,6 +36,10 @@
 #define rbITEM_SPLIT_FLAG           ( ( UBaseType_t ) 4 )   //Valid for RINGBUF_TYPE_ALLOWSPLIT, indicating that rest of the data is wrapped around
 #define rbITEM_WRITTEN_FLAG         ( ( UBaseType_t ) 8 )   //Item has been written to by the application, thus can be read
 
+//Waiting flags of single-producer/single-consumer ring buffers
+#define rbSPSC_RECEIVER_WAITING     ( ( size_t ) 1 )        //The consumer is blocked (or about to block) on xTasksWaitingToReceive
+#define rbSPSC_SENDER_WAITING       ( ( size_t ) 2 )        //The producer is blocked (or about to block) on xTasksWaitingToSend
+
 typedef struct {
     //This size of this structure must be 32-bit aligned
     size_t xItemLen;
@@ -43,7 +49,7 @@ typedef struct {
 #define rbHEADER_SIZE     sizeof(ItemHeader_t)
 typedef struct RingbufferDefinition Ringbuffer_t;
 typedef BaseType_t (*CheckItemFitsFunction_t)(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
-typedef void (*CopyItemFunction_t)(Ringbuffer_t *pxRingbuffer, const uint8_t *pcItem, size_t xItemSize);
+typedef void (*CopyItemFunction_t)(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize);
 typedef BaseType_t (*CheckItemAvailFunction_t)(Ringbuffer_t *pxRingbuffer);
 typedef void *(*GetItemFunction_t)(Ringbuffer_t *pxRingbuffer, BaseType_t *pxIsSplit, size_t xMaxSize, size_t *pxItemSize);
 typedef void (*ReturnItemFunction_t)(Ringbuffer_t *pxRingbuffer, uint8_t *pvItem);
@@ -72,6 +78,16 @@ typedef struct RingbufferDefinition {
     List_t xTasksWaitingToReceive;              //List of tasks that are blocked waiting to receive from this ring buffer. Stored in priority order.
     QueueSetHandle_t xQueueSet;                 //Ring buffer's read queue set handle.
 
+    /*
+     * Single-producer/single-consumer ring buffers use the following offsets instead of the pointers above. The
+     * offsets count from 0 to (2 * xSize - 1), so that a full buffer can be told apart from an empty one without
+     * a flag shared by the producer and the consumer.
+     */
+    atomic_size_t xSpscWrite;                   //Offset of the next item to write. Only updated by the producer
+    atomic_size_t xSpscFree;                    //Offset of the oldest item not yet returned. Only updated by the consumer
+    size_t xSpscRead;                           //Offset of the next item to read. Only accessed by the consumer
+    atomic_size_t xSpscWaiting;                 //rbSPSC_xxx_WAITING flags of the tasks blocked on the ring buffer
+
     portMUX_TYPE mux;                           //Spinlock required for SMP
 } Ringbuffer_t;
 
@@ -112,7 +128,7 @@ Exit:
     - pucAcquire and pucWrite updated.
     - Dummy item added if necessary
 */
-static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize);
 
 /*
 Copies an item to a allow-split ring buffer
@@ -123,10 +139,10 @@ Exit:
     - pucAcquire and pucWrite updated
     - Item may be split
 */
-static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize);
 
 //Copies an item to a byte buffer. Only call this function  after calling prvCheckItemFitsByteBuffer()
-static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize);
 
 //Retrieve item from no-split/allow-split ring buffer. *pxIsSplit is set to pdTRUE if the retrieved item is split
 /*
@@ -171,11 +187,11 @@ static size_t prvGetCurMaxSizeByteBuf(Ringbuffer_t *pxRingbuffer);
 
 /*
 Generic function used to send or acquire an item/buffer.
-- If sending, set ppvItem to NULL. pvItem remains unchanged on failure.
-- If acquiring, set pvItem to NULL. ppvItem remains unchanged on failure.
+- If sending, set ppvItem to NULL. The item is gathered from the parts in pxIOV.
+- If acquiring, set pxIOV to NULL. ppvItem remains unchanged on failure.
 */
 static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
-                                        const void *pvItem,
+                                        const RingbufferIOVec_t *pxIOV,
                                         void **ppvItem,
                                         size_t xItemSize,
                                         TickType_t xTicksToWait);
@@ -185,6 +201,10 @@ Generic function used to retrieve an item/data from ring buffers. If called on
 an allow-split buffer, and pvItem2 and xItemSize2 are not NULL, both parts of
 a split item will be retrieved. xMaxSize will only take effect if called on
 byte buffers. xItemSize must remain unchanged if no item is retrieved.
+If puxItemCount is not NULL (no-split buffers only), pvItem1 and xItemSize1 are
+arrays of *puxItemCount elements, and as many items as are available (up to
+*puxItemCount) are retrieved. *puxItemCount is then set to the number of items
+retrieved.
 */
 static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
                                     void **pvItem1,
@@ -192,7 +212,8 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
                                     size_t *xItemSize1,
                                     size_t *xItemSize2,
                                     size_t xMaxSize,
-                                    TickType_t xTicksToWait);
+                                    TickType_t xTicksToWait,
+                                    UBaseType_t *puxItemCount);
 
 //From ISR version of prvReceiveGeneric()
 static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
@@ -202,8 +223,101 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
                                            size_t *xItemSize2,
                                            size_t xMaxSize);
 
+/*
+ * The following functions implement single-producer/single-consumer ring
+ * buffers. Unlike the functions above, they are called outside of critical
+ * sections. The prvSpscCheckItemFits() and prvSpscCopyItem() functions must
+ * only be called by the producer, prvSpscCheckItemAvail(), prvSpscGetItem()
+ * and prvSpscReturnItem() only by the consumer.
+ */
+
+//Checks if an item will currently fit in a single-producer/single-consumer ring buffer
+static BaseType_t prvSpscCheckItemFits(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
+
+/*
+Copies an item to a single-producer/single-consumer ring buffer
+Entry:
+    - Must have already guaranteed there is sufficient space for item by calling prvSpscCheckItemFits()
+Exit:
+    - New item copied into ring buffer and made visible to the consumer by updating xSpscWrite
+    - Dummy item added if necessary (no-split)
+*/
+static void prvSpscCopyItem(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize);
+
+//Checks if an item/data is currently available for retrieval from a single-producer/single-consumer ring buffer
+static BaseType_t prvSpscCheckItemAvail(Ringbuffer_t *pxRingbuffer);
+
+//Retrieve an item (or up to xMaxSize bytes of data) from a single-producer/single-consumer ring buffer. Only call this function after calling prvSpscCheckItemAvail()
+static void *prvSpscGetItem(Ringbuffer_t *pxRingbuffer, size_t xMaxSize, size_t *pxItemSize);
+
+//Return an item/data to a single-producer/single-consumer ring buffer, then advance xSpscFree as far as possible
+static void prvSpscReturnItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
+//Get the maximum size an item that can currently have if sent to a single-producer/single-consumer ring buffer
+static size_t prvSpscGetCurMaxSize(Ringbuffer_t *pxRingbuffer);
+
+//Unblock a task waiting on pxTasksWaiting if the other side has set xWaitingFlag. Returns pdTRUE if a context switch is required
+static BaseType_t prvSpscUnblock(Ringbuffer_t *pxRingbuffer, List_t *pxTasksWaiting, size_t xWaitingFlag, BaseType_t xFromISR);
+
+//Send function of single-producer/single-consumer ring buffers. Only blocks (using the spinlock) if the ring buffer is full
+static BaseType_t prvSpscSend(Ringbuffer_t *pxRingbuffer,
+                              const RingbufferIOVec_t *pxIOV,
+                              size_t xItemSize,
+                              TickType_t xTicksToWait);
+
+//Receive function of single-producer/single-consumer ring buffers. Only blocks (using the spinlock) if the ring buffer is empty
+static BaseType_t prvSpscReceive(Ringbuffer_t *pxRingbuffer,
+                                 void **pvItem,
+                                 size_t *xItemSize,
+                                 size_t xMaxSize,
+                                 TickType_t xTicksToWait,
+                                 UBaseType_t *puxItemCount);
+
 // ------------------------------------------------ Static Functions ---------------------------------------------------
 
+//Copy the next xLen bytes of an item that is made up of several parts. *ppxIOV and *pxOffset track the current position
+static inline void prvCopyFromIOV(uint8_t *pucDest, size_t xLen, const RingbufferIOVec_t **ppxIOV, size_t *pxOffset)
+{
+    while (xLen > 0) {
+        const RingbufferIOVec_t *pxIOV = *ppxIOV;
+        size_t xCopyLen = pxIOV->xLen - *pxOffset;
+        if (xCopyLen > xLen) {
+            xCopyLen = xLen;
+        }
+        memcpy(pucDest, (const uint8_t *)pxIOV->pvData + *pxOffset, xCopyLen);
+        pucDest += xCopyLen;
+        xLen -= xCopyLen;
+        *pxOffset += xCopyLen;
+        if (*pxOffset == pxIOV->xLen) {
+            //Move on to the next part
+            (*ppxIOV)++;
+            *pxOffset = 0;
+        }
+    }
+}
+
+//Advance a single-producer/single-consumer offset by xLen bytes
+static inline size_t prvSpscAdvance(Ringbuffer_t *pxRingbuffer, size_t xOffset, size_t xLen)
+{
+    xOffset += xLen;
+    if (xOffset >= 2 * pxRingbuffer->xSize) {
+        xOffset -= 2 * pxRingbuffer->xSize;
+    }
+    return xOffset;
+}
+
+//Number of bytes from offset xFrom up to offset xTo
+static inline size_t prvSpscUsed(Ringbuffer_t *pxRingbuffer, size_t xFrom, size_t xTo)
+{
+    return (xTo >= xFrom) ? xTo - xFrom : xTo + 2 * pxRingbuffer->xSize - xFrom;
+}
+
+//Position in the storage area of a single-producer/single-consumer offset
+static inline size_t prvSpscPos(Ringbuffer_t *pxRingbuffer, size_t xOffset)
+{
+    return (xOffset >= pxRingbuffer->xSize) ? xOffset - pxRingbuffer->xSize : xOffset;
+}
+
 static void prvInitializeNewRingbuffer(size_t xBufferSize,
                                        RingbufferType_t xBufferType,
                                        Ringbuffer_t *pxNewRingbuffer,
@@ -219,6 +333,16 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
     pxNewRingbuffer->pucAcquire = pucRingbufferStorage;
     pxNewRingbuffer->xItemsWaiting = 0;
     pxNewRingbuffer->uxRingbufferFlags = 0;
+    atomic_init(&pxNewRingbuffer->xSpscWrite, 0);
+    atomic_init(&pxNewRingbuffer->xSpscFree, 0);
+    pxNewRingbuffer->xSpscRead = 0;
+    atomic_init(&pxNewRingbuffer->xSpscWaiting, 0);
+
+    //Single-producer/single-consumer buffers store items in the same format as no-split buffers and byte buffers
+    if (xBufferType == RINGBUF_TYPE_NOSPLIT_SPSC || xBufferType == RINGBUF_TYPE_BYTEBUF_SPSC) {
+        pxNewRingbuffer->uxRingbufferFlags |= rbSPSC_FLAG;
+        xBufferType = (xBufferType == RINGBUF_TYPE_NOSPLIT_SPSC) ? RINGBUF_TYPE_NOSPLIT : RINGBUF_TYPE_BYTEBUF;
+    }
 
     //Initialize type dependent values and function pointers
     if (xBufferType == RINGBUF_TYPE_NOSPLIT) {
@@ -251,6 +375,9 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
         pxNewRingbuffer->xMaxItemSize = pxNewRingbuffer->xSize;
         pxNewRingbuffer->xGetCurMaxSize = prvGetCurMaxSizeByteBuf;
     }
+    if (pxNewRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        pxNewRingbuffer->xGetCurMaxSize = prvSpscGetCurMaxSize;
+    }
 
     vListInitialise(&pxNewRingbuffer->xTasksWaitingToSend);
     vListInitialise(&pxNewRingbuffer->xTasksWaitingToReceive);
@@ -262,7 +389,11 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
 static size_t prvGetFreeSize(Ringbuffer_t *pxRingbuffer)
 {
     size_t xReturn;
-    if (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG) {
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        xReturn = pxRingbuffer->xSize - prvSpscUsed(pxRingbuffer,
+                                                    atomic_load_explicit(&pxRingbuffer->xSpscFree, memory_order_acquire),
+                                                    atomic_load_explicit(&pxRingbuffer->xSpscWrite, memory_order_acquire));
+    } else if (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG) {
         xReturn =  0;
     } else {
         BaseType_t xFreeSize = pxRingbuffer->pucFree - pxRingbuffer->pucAcquire;
@@ -405,15 +536,17 @@ static void prvSendItemDoneNoSplit(Ringbuffer_t *pxRingbuffer, uint8_t* pucItem)
     }
 }
 
-static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize)
 {
+    size_t xOffset = 0;
     uint8_t* item_addr = prvAcquireItemNoSplit(pxRingbuffer, xItemSize);
-    memcpy(item_addr, pucItem, xItemSize);
+    prvCopyFromIOV(item_addr, xItemSize, &pxIOV, &xOffset);
     prvSendItemDoneNoSplit(pxRingbuffer, item_addr);
 }
 
-static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize)
 {
+    size_t xOffset = 0;
     //Check arguments and buffer state
     size_t xAlignedItemSize = rbALIGN_SIZE(xItemSize);                  //Rounded up aligned item size
     size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;    //Length from pucAcquire until end of buffer
@@ -430,10 +563,9 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
         pxRingbuffer->pucAcquire += rbHEADER_SIZE;            //Advance pucAcquire past header
         xRemLen -= rbHEADER_SIZE;
         if (xRemLen > 0) {
-            memcpy(pxRingbuffer->pucAcquire, pucItem, xRemLen);
+            prvCopyFromIOV(pxRingbuffer->pucAcquire, xRemLen, &pxIOV, &xOffset);
             pxRingbuffer->xItemsWaiting++;
             //Update item arguments to account for data already copied
-            pucItem += xRemLen;
             xItemSize -= xRemLen;
             xAlignedItemSize -= xRemLen;
             pxFirstHeader->uxItemFlags |= rbITEM_SPLIT_FLAG;        //There must be more data
@@ -449,7 +581,7 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
     pxSecondHeader->xItemLen = xItemSize;
     pxSecondHeader->uxItemFlags = 0;
     pxRingbuffer->pucAcquire += rbHEADER_SIZE;     //Advance acquire pointer past header
-    memcpy(pxRingbuffer->pucAcquire, pucItem, xItemSize);
+    prvCopyFromIOV(pxRingbuffer->pucAcquire, xItemSize, &pxIOV, &xOffset);
     pxRingbuffer->xItemsWaiting++;
     pxRingbuffer->pucAcquire += xAlignedItemSize;  //Advance pucAcquire past item to next aligned address
 
@@ -467,23 +599,23 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
     pxRingbuffer->pucWrite = pxRingbuffer->pucAcquire;
 }
 
-static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize)
 {
+    size_t xOffset = 0;
     //Check arguments and buffer state
     configASSERT(pxRingbuffer->pucAcquire >= pxRingbuffer->pucHead && pxRingbuffer->pucAcquire < pxRingbuffer->pucTail);    //Check acquire pointer is within bounds
 
     size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;    //Length from pucAcquire until end of buffer
     if (xRemLen < xItemSize) {
         //Copy as much as possible into remaining length
-        memcpy(pxRingbuffer->pucAcquire, pucItem, xRemLen);
+        prvCopyFromIOV(pxRingbuffer->pucAcquire, xRemLen, &pxIOV, &xOffset);
         pxRingbuffer->xItemsWaiting += xRemLen;
         //Update item arguments to account for data already written
-        pucItem += xRemLen;
         xItemSize -= xRemLen;
         pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;     //Reset acquire pointer to start of buffer
     }
     //Copy all or remaining portion of the item
-    memcpy(pxRingbuffer->pucAcquire, pucItem, xItemSize);
+    prvCopyFromIOV(pxRingbuffer->pucAcquire, xItemSize, &pxIOV, &xOffset);
     pxRingbuffer->xItemsWaiting += xItemSize;
     pxRingbuffer->pucAcquire += xItemSize;
 
@@ -743,7 +875,7 @@ static size_t prvGetCurMaxSizeByteBuf(Ringbuffer_t *pxRingbuffer)
 }
 
 static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
-                                        const void *pvItem,
+                                        const RingbufferIOVec_t *pxIOV,
                                         void **ppvItem,
                                         size_t xItemSize,
                                         TickType_t xTicksToWait)
@@ -763,7 +895,7 @@ static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
                 *ppvItem = prvAcquireItemNoSplit(pxRingbuffer, xItemSize);
             } else {
                 //Copy item into buffer
-                pxRingbuffer->vCopyItem(pxRingbuffer, pvItem, xItemSize);
+                pxRingbuffer->vCopyItem(pxRingbuffer, pxIOV, xItemSize);
                 if (pxRingbuffer->xQueueSet) {
                     //If ring buffer was added to a queue set, notify the queue set
                     xNotifyQueueSet = pdTRUE;
@@ -815,7 +947,8 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
                                     size_t *xItemSize1,
                                     size_t *xItemSize2,
                                     size_t xMaxSize,
-                                    TickType_t xTicksToWait)
+                                    TickType_t xTicksToWait,
+                                    UBaseType_t *puxItemCount)
 {
     BaseType_t xReturn = pdFALSE;
     BaseType_t xExitLoop = pdFALSE;
@@ -824,6 +957,10 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
 
     ESP_STATIC_ANALYZER_CHECK(!pvItem1 || !pvItem2 || !xItemSize1 || !xItemSize2, pdFALSE);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSpscReceive(pxRingbuffer, pvItem1, xItemSize1, xMaxSize, xTicksToWait, puxItemCount);
+    }
+
     while (xExitLoop == pdFALSE) {
         portENTER_CRITICAL(&pxRingbuffer->mux);
         if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
@@ -846,6 +983,15 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
                     *pvItem2 = NULL;
                 }
             }
+            //Retrieve all further items that are available, up to the requested number
+            if (puxItemCount != NULL) {
+                UBaseType_t uxCount = 1;
+                while (uxCount < *puxItemCount && prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+                    pvItem1[uxCount] = pxRingbuffer->pvGetItem(pxRingbuffer, &xIsSplit, 0, &xItemSize1[uxCount]);
+                    uxCount++;
+                }
+                *puxItemCount = uxCount;
+            }
             xReturn = pdTRUE;
             xExitLoop = pdTRUE;
             goto loop_end;
@@ -885,6 +1031,14 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
 
     ESP_STATIC_ANALYZER_CHECK(!pvItem1 || !pvItem2 || !xItemSize1 || !xItemSize2, pdFALSE);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        if (prvSpscCheckItemAvail(pxRingbuffer) == pdFALSE) {
+            return pdFALSE;
+        }
+        *pvItem1 = prvSpscGetItem(pxRingbuffer, xMaxSize, xItemSize1);
+        return pdTRUE;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
         BaseType_t xIsSplit = pdFALSE;
@@ -914,6 +1068,311 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
     return xReturn;
 }
 
+static BaseType_t prvSpscCheckItemFits(Ringbuffer_t *pxRingbuffer, size_t xItemSize)
+{
+    size_t xWrite = atomic_load_explicit(&pxRingbuffer->xSpscWrite, memory_order_relaxed);
+    //Acquire ensures the consumer is done with the returned space before it is overwritten
+    size_t xFree = atomic_load_explicit(&pxRingbuffer->xSpscFree, memory_order_acquire);
+    size_t xFreeSize = pxRingbuffer->xSize - prvSpscUsed(pxRingbuffer, xFree, xWrite);
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        return (xItemSize <= xFreeSize) ? pdTRUE : pdFALSE;
+    }
+    size_t xTotalItemSize = rbALIGN_SIZE(xItemSize) + rbHEADER_SIZE;    //Rounded up aligned item size with header
+    size_t xRemLen = pxRingbuffer->xSize - prvSpscPos(pxRingbuffer, xWrite);
+    if (xTotalItemSize <= xRemLen) {
+        return (xTotalItemSize <= xFreeSize) ? pdTRUE : pdFALSE;    //Item fits without wrapping around
+    }
+    //The remaining length until the end of the storage area is skipped
+    return (xRemLen + xTotalItemSize <= xFreeSize) ? pdTRUE : pdFALSE;
+}
+
+static void prvSpscCopyItem(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxIOV, size_t xItemSize)
+{
+    size_t xOffset = 0;
+    size_t xWrite = atomic_load_explicit(&pxRingbuffer->xSpscWrite, memory_order_relaxed);
+    size_t xPos = prvSpscPos(pxRingbuffer, xWrite);
+    size_t xRemLen = pxRingbuffer->xSize - xPos;    //Length from the write position until end of buffer
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        if (xRemLen < xItemSize) {
+            //Copy as much as possible into remaining length, then the rest to the start of the buffer
+            prvCopyFromIOV(pxRingbuffer->pucHead + xPos, xRemLen, &pxIOV, &xOffset);
+            prvCopyFromIOV(pxRingbuffer->pucHead, xItemSize - xRemLen, &pxIOV, &xOffset);
+        } else {
+            prvCopyFromIOV(pxRingbuffer->pucHead + xPos, xItemSize, &pxIOV, &xOffset);
+        }
+        xWrite = prvSpscAdvance(pxRingbuffer, xWrite, xItemSize);
+    } else {
+        configASSERT(rbCHECK_ALIGNED(xPos));
+        size_t xTotalItemSize = rbALIGN_SIZE(xItemSize) + rbHEADER_SIZE;
+        if (xRemLen < xTotalItemSize) {
+            //Skip the remaining length. Mark it as dummy data if there is room for a header
+            if (xRemLen >= rbHEADER_SIZE) {
+                ItemHeader_t *pxDummy = (ItemHeader_t *)(pxRingbuffer->pucHead + xPos);
+                pxDummy->uxItemFlags = rbITEM_DUMMY_DATA_FLAG;
+                pxDummy->xItemLen = 0;
+            }
+            xWrite = prvSpscAdvance(pxRingbuffer, xWrite, xRemLen);
+            xPos = 0;
+        }
+        ItemHeader_t *pxHeader = (ItemHeader_t *)(pxRingbuffer->pucHead + xPos);
+        pxHeader->xItemLen = xItemSize;
+        pxHeader->uxItemFlags = rbITEM_WRITTEN_FLAG;
+        prvCopyFromIOV(pxRingbuffer->pucHead + xPos + rbHEADER_SIZE, xItemSize, &pxIOV, &xOffset);
+        xWrite = prvSpscAdvance(pxRingbuffer, xWrite, xTotalItemSize);
+    }
+    //Release makes the item's data visible to the consumer before the new write offset
+    atomic_store_explicit(&pxRingbuffer->xSpscWrite, xWrite, memory_order_release);
+}
+
+static BaseType_t prvSpscCheckItemAvail(Ringbuffer_t *pxRingbuffer)
+{
+    size_t xRead = pxRingbuffer->xSpscRead;
+    if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xRead != atomic_load_explicit(&pxRingbuffer->xSpscFree, memory_order_relaxed)) {
+        return pdFALSE;     //Byte buffers do not allow multiple retrievals before return
+    }
+    return (xRead != atomic_load_explicit(&pxRingbuffer->xSpscWrite, memory_order_acquire)) ? pdTRUE : pdFALSE;
+}
+
+static void *prvSpscGetItem(Ringbuffer_t *pxRingbuffer, size_t xMaxSize, size_t *pxItemSize)
+{
+    size_t xRead = pxRingbuffer->xSpscRead;
+    size_t xPos = prvSpscPos(pxRingbuffer, xRead);
+    size_t xRemLen = pxRingbuffer->xSize - xPos;    //Length from the read position until end of buffer
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        //Return contiguous data from the read position, up to xMaxSize bytes if xMaxSize is not 0
+        size_t xLen = prvSpscUsed(pxRingbuffer, xRead, atomic_load_explicit(&pxRingbuffer->xSpscWrite, memory_order_acquire));
+        configASSERT(xLen > 0);
+        if (xLen > xRemLen) {
+            xLen = xRemLen;
+        }
+        if (xMaxSize != 0 && xLen > xMaxSize) {
+            xLen = xMaxSize;
+        }
+        *pxItemSize = xLen;
+        pxRingbuffer->xSpscRead = prvSpscAdvance(pxRingbuffer, xRead, xLen);
+        return (void *)(pxRingbuffer->pucHead + xPos);
+    }
+
+    ItemHeader_t *pxHeader = (ItemHeader_t *)(pxRingbuffer->pucHead + xPos);
+    //The producer skipped the rest of the buffer (no room for a header, or dummy data). The item is at the start
+    if (xRemLen < rbHEADER_SIZE || (pxHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG)) {
+        xRead = prvSpscAdvance(pxRingbuffer, xRead, xRemLen);
+        pxHeader = (ItemHeader_t *)pxRingbuffer->pucHead;
+    }
+    configASSERT(pxHeader->uxItemFlags & rbITEM_WRITTEN_FLAG);
+    configASSERT(pxHeader->xItemLen <= pxRingbuffer->xMaxItemSize);
+    *pxItemSize = pxHeader->xItemLen;
+    pxRingbuffer->xSpscRead = prvSpscAdvance(pxRingbuffer, xRead, rbHEADER_SIZE + rbALIGN_SIZE(pxHeader->xItemLen));
+    return (void *)((uint8_t *)pxHeader + rbHEADER_SIZE);
+}
+
+static void prvSpscReturnItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    //Check pointer points to address inside buffer. Inclusive of pucTail in the case of zero length item at the very end
+    configASSERT(pucItem >= pxRingbuffer->pucHead);
+    configASSERT(pucItem <= pxRingbuffer->pucTail);
+
+    size_t xFree;
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        //Byte buffers do not allow multiple outstanding reads, simply free everything up to the read offset
+        xFree = pxRingbuffer->xSpscRead;
+    } else {
+        ItemHeader_t *pxCurHeader = (ItemHeader_t *)(pucItem - rbHEADER_SIZE);
+        configASSERT(rbCHECK_ALIGNED(pucItem));
+        configASSERT((pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) == 0); //Dummy items should never have been read
+        configASSERT((pxCurHeader->uxItemFlags & rbITEM_FREE_FLAG) == 0);       //Indicates item has already been returned before
+        pxCurHeader->uxItemFlags |= rbITEM_FREE_FLAG;
+
+        //Items might not be returned in the order they were retrieved. Skip over freed items and dummy data up to the read offset
+        xFree = atomic_load_explicit(&pxRingbuffer->xSpscFree, memory_order_relaxed);
+        while (xFree != pxRingbuffer->xSpscRead) {
+            size_t xPos = prvSpscPos(pxRingbuffer, xFree);
+            size_t xRemLen = pxRingbuffer->xSize - xPos;
+            pxCurHeader = (ItemHeader_t *)(pxRingbuffer->pucHead + xPos);
+            if (xRemLen < rbHEADER_SIZE || (pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG)) {
+                xFree = prvSpscAdvance(pxRingbuffer, xFree, xRemLen);
+            } else if (pxCurHeader->uxItemFlags & rbITEM_FREE_FLAG) {
+                xFree = prvSpscAdvance(pxRingbuffer, xFree, rbHEADER_SIZE + rbALIGN_SIZE(pxCurHeader->xItemLen));
+            } else {
+                break;
+            }
+        }
+    }
+    //Release ensures we are done with the returned space before the producer can see it as free
+    atomic_store_explicit(&pxRingbuffer->xSpscFree, xFree, memory_order_release);
+}
+
+static size_t prvSpscGetCurMaxSize(Ringbuffer_t *pxRingbuffer)
+{
+    size_t xWrite = atomic_load_explicit(&pxRingbuffer->xSpscWrite, memory_order_acquire);
+    size_t xFree = atomic_load_explicit(&pxRingbuffer->xSpscFree, memory_order_acquire);
+    size_t xFreeSize = pxRingbuffer->xSize - prvSpscUsed(pxRingbuffer, xFree, xWrite);
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        return xFreeSize;
+    }
+    //No-split items require contiguous space, select the largest contiguous free space
+    size_t xRemLen = pxRingbuffer->xSize - prvSpscPos(pxRingbuffer, xWrite);
+    if (xFreeSize > xRemLen) {
+        xFreeSize = (xRemLen > xFreeSize - xRemLen) ? xRemLen : xFreeSize - xRemLen;
+    }
+    //No-split ring buffer items need space for a header
+    if (xFreeSize < rbHEADER_SIZE) {
+        return 0;
+    }
+    xFreeSize -= rbHEADER_SIZE;
+    return (xFreeSize > pxRingbuffer->xMaxItemSize) ? pxRingbuffer->xMaxItemSize : xFreeSize;
+}
+
+static BaseType_t prvSpscUnblock(Ringbuffer_t *pxRingbuffer, List_t *pxTasksWaiting, size_t xWaitingFlag, BaseType_t xFromISR)
+{
+    BaseType_t xReturn = pdFALSE;
+
+    /*
+     * Pairs with the fence in prvSpscSend()/prvSpscReceive(): either the
+     * blocking task sees our update of the offsets when checking again, or we
+     * see its waiting flag here.
+     */
+    atomic_thread_fence(memory_order_seq_cst);
+    if ((atomic_load_explicit(&pxRingbuffer->xSpscWaiting, memory_order_relaxed) & xWaitingFlag) == 0) {
+        return pdFALSE;
+    }
+
+    if (xFromISR) {
+        portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+    }
+    if (listLIST_IS_EMPTY(pxTasksWaiting) == pdFALSE) {
+        xReturn = xTaskRemoveFromEventList(pxTasksWaiting);
+    }
+    if (listLIST_IS_EMPTY(pxTasksWaiting) == pdTRUE) {
+        //The flag is set again by the task if it has to block again
+        atomic_fetch_and_explicit(&pxRingbuffer->xSpscWaiting, ~xWaitingFlag, memory_order_relaxed);
+    }
+    if (xFromISR) {
+        portEXIT_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+    return xReturn;
+}
+
+static BaseType_t prvSpscSend(Ringbuffer_t *pxRingbuffer,
+                              const RingbufferIOVec_t *pxIOV,
+                              size_t xItemSize,
+                              TickType_t xTicksToWait)
+{
+    BaseType_t xReturn = pdFALSE;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (1) {
+        if (prvSpscCheckItemFits(pxRingbuffer, xItemSize) == pdTRUE) {
+            //xItemSize will fit. Copy the item without entering a critical section
+            prvSpscCopyItem(pxRingbuffer, pxIOV, xItemSize);
+            xReturn = pdTRUE;
+            break;
+        } else if (xTicksToWait == (TickType_t) 0) {
+            //No block time. Return immediately.
+            break;
+        }
+
+        BaseType_t xTimedOut = pdFALSE;
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        //Announce that we are about to block, then check again in case the consumer has returned items in the meantime
+        atomic_fetch_or_explicit(&pxRingbuffer->xSpscWaiting, rbSPSC_SENDER_WAITING, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (prvSpscCheckItemFits(pxRingbuffer, xItemSize) == pdFALSE) {
+            if (xEntryTimeSet == pdFALSE) {
+                //This is our first block. Set entry time
+                vTaskInternalSetTimeOutState(&xTimeOut);
+                xEntryTimeSet = pdTRUE;
+            }
+            if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE) {
+                //Not timed out yet. Block the current task
+                vTaskPlaceOnEventList(&pxRingbuffer->xTasksWaitingToSend, xTicksToWait);
+                portYIELD_WITHIN_API();
+            } else {
+                xTimedOut = pdTRUE;
+            }
+        }
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+        if (xTimedOut == pdTRUE) {
+            break;
+        }
+    }
+
+    //If the consumer is waiting for data to arrive on the ring buffer, unblock it
+    if (xReturn == pdTRUE && prvSpscUnblock(pxRingbuffer, &pxRingbuffer->xTasksWaitingToReceive, rbSPSC_RECEIVER_WAITING, pdFALSE) == pdTRUE) {
+        //The unblocked task will preempt us. Trigger a yield here.
+        portYIELD_WITHIN_API();
+    }
+    return xReturn;
+}
+
+static BaseType_t prvSpscReceive(Ringbuffer_t *pxRingbuffer,
+                                 void **pvItem,
+                                 size_t *xItemSize,
+                                 size_t xMaxSize,
+                                 TickType_t xTicksToWait,
+                                 UBaseType_t *puxItemCount)
+{
+    BaseType_t xReturn = pdFALSE;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (1) {
+        if (prvSpscCheckItemAvail(pxRingbuffer) == pdTRUE) {
+            //Item/data is available for retrieval
+            *pvItem = prvSpscGetItem(pxRingbuffer, xMaxSize, xItemSize);
+            //Retrieve all further items that are available, up to the requested number
+            if (puxItemCount != NULL) {
+                UBaseType_t uxCount = 1;
+                while (uxCount < *puxItemCount && prvSpscCheckItemAvail(pxRingbuffer) == pdTRUE) {
+                    pvItem[uxCount] = prvSpscGetItem(pxRingbuffer, 0, &xItemSize[uxCount]);
+                    uxCount++;
+                }
+                *puxItemCount = uxCount;
+            }
+            xReturn = pdTRUE;
+            break;
+        } else if (xTicksToWait == (TickType_t) 0) {
+            //No block time. Return immediately.
+            break;
+        }
+
+        BaseType_t xTimedOut = pdFALSE;
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        //Announce that we are about to block, then check again in case the producer has sent an item in the meantime
+        atomic_fetch_or_explicit(&pxRingbuffer->xSpscWaiting, rbSPSC_RECEIVER_WAITING, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (prvSpscCheckItemAvail(pxRingbuffer) == pdFALSE) {
+            if (xEntryTimeSet == pdFALSE) {
+                //This is our first block. Set entry time
+                vTaskInternalSetTimeOutState(&xTimeOut);
+                xEntryTimeSet = pdTRUE;
+            }
+            if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE) {
+                //Not timed out yet. Block the current task
+                vTaskPlaceOnEventList(&pxRingbuffer->xTasksWaitingToReceive, xTicksToWait);
+                portYIELD_WITHIN_API();
+            } else {
+                xTimedOut = pdTRUE;
+            }
+        }
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+        if (xTimedOut == pdTRUE) {
+            break;
+        }
+    }
+
+    return xReturn;
+}
+
 // ------------------------------------------------ Public Functions ---------------------------------------------------
 
 RingbufHandle_t xRingbufferCreate(size_t xBufferSize, RingbufferType_t xBufferType)
@@ -922,7 +1381,7 @@ RingbufHandle_t xRingbufferCreate(size_t xBufferSize, RingbufferType_t xBufferTy
     configASSERT(xBufferType < RINGBUF_TYPE_MAX);
 
     //Allocate memory
-    if (xBufferType != RINGBUF_TYPE_BYTEBUF) {
+    if (xBufferType != RINGBUF_TYPE_BYTEBUF && xBufferType != RINGBUF_TYPE_BYTEBUF_SPSC) {
         xBufferSize = rbALIGN_SIZE(xBufferSize);    //xBufferSize is rounded up for no-split/allow-split buffers
     }
     Ringbuffer_t *pxNewRingbuffer = calloc(1, sizeof(Ringbuffer_t));
@@ -955,7 +1414,7 @@ RingbufHandle_t xRingbufferCreateStatic(size_t xBufferSize,
     configASSERT(xBufferSize > 0);
     configASSERT(xBufferType < RINGBUF_TYPE_MAX);
     configASSERT(pucRingbufferStorage != NULL && pxStaticRingbuffer != NULL);
-    if (xBufferType != RINGBUF_TYPE_BYTEBUF) {
+    if (xBufferType != RINGBUF_TYPE_BYTEBUF && xBufferType != RINGBUF_TYPE_BYTEBUF_SPSC) {
         //No-split/allow-split buffer sizes must be 32-bit aligned
         configASSERT(rbCHECK_ALIGNED(xBufferSize));
     }
@@ -973,7 +1432,7 @@ BaseType_t xRingbufferSendAcquire(RingbufHandle_t xRingbuffer, void **ppvItem, s
     //Check arguments
     configASSERT(pxRingbuffer);
     configASSERT(ppvItem != NULL);
-    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0); //Send acquire currently only supported in NoSplit buffers
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG | rbSPSC_FLAG)) == 0); //Send acquire currently only supported in NoSplit buffers
 
     *ppvItem = NULL;
     if (xItemSize > pxRingbuffer->xMaxItemSize) {
@@ -994,7 +1453,7 @@ BaseType_t xRingbufferSendComplete(RingbufHandle_t xRingbuffer, void *pvItem)
     //Check arguments
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
-    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG | rbSPSC_FLAG)) == 0);
 
     portENTER_CRITICAL(&pxRingbuffer->mux);
     prvSendItemDoneNoSplit(pxRingbuffer, pvItem);
@@ -1024,6 +1483,7 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
                            TickType_t xTicksToWait)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    RingbufferIOVec_t xIOV = { .pvData = pvItem, .xLen = xItemSize };
 
     //Check arguments
     configASSERT(pxRingbuffer);
@@ -1034,8 +1494,39 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
     if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSpscSend(pxRingbuffer, &xIOV, xItemSize, xTicksToWait);
+    }
 
-    return prvSendAcquireGeneric(pxRingbuffer, pvItem, NULL, xItemSize, xTicksToWait);
+    return prvSendAcquireGeneric(pxRingbuffer, &xIOV, NULL, xItemSize, xTicksToWait);
+}
+
+BaseType_t xRingbufferSendv(RingbufHandle_t xRingbuffer,
+                            const RingbufferIOVec_t *pxIOV,
+                            UBaseType_t uxIOVCount,
+                            TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    size_t xItemSize = 0;
+
+    //Check arguments
+    configASSERT(pxRingbuffer);
+    configASSERT(pxIOV != NULL || uxIOVCount == 0);
+    for (UBaseType_t i = 0; i < uxIOVCount; i++) {
+        configASSERT(pxIOV[i].pvData != NULL || pxIOV[i].xLen == 0);
+        if (pxIOV[i].xLen > pxRingbuffer->xMaxItemSize - xItemSize) {
+            return pdFALSE;     //Data will never ever fit in the queue.
+        }
+        xItemSize += pxIOV[i].xLen;
+    }
+    if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
+        return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
+    }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSpscSend(pxRingbuffer, pxIOV, xItemSize, xTicksToWait);
+    }
+
+    return prvSendAcquireGeneric(pxRingbuffer, pxIOV, NULL, xItemSize, xTicksToWait);
 }
 
 BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
@@ -1044,6 +1535,7 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
                                   BaseType_t *pxHigherPriorityTaskWoken)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    RingbufferIOVec_t xIOV = { .pvData = pvItem, .xLen = xItemSize };
     BaseType_t xNotifyQueueSet = pdFALSE;
     BaseType_t xReturn;
 
@@ -1056,10 +1548,21 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
     if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        if (prvSpscCheckItemFits(pxRingbuffer, xItemSize) == pdFALSE) {
+            return pdFALSE;
+        }
+        prvSpscCopyItem(pxRingbuffer, &xIOV, xItemSize);
+        //If the consumer is waiting for data to arrive on the ring buffer, unblock it
+        if (prvSpscUnblock(pxRingbuffer, &pxRingbuffer->xTasksWaitingToReceive, rbSPSC_RECEIVER_WAITING, pdTRUE) == pdTRUE && pxHigherPriorityTaskWoken != NULL) {
+            *pxHigherPriorityTaskWoken = pdTRUE;
+        }
+        return pdTRUE;
+    }
 
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     if (pxRingbuffer->xCheckItemFits(xRingbuffer, xItemSize) == pdTRUE) {
-        pxRingbuffer->vCopyItem(xRingbuffer, pvItem, xItemSize);
+        pxRingbuffer->vCopyItem(xRingbuffer, &xIOV, xItemSize);
         if (pxRingbuffer->xQueueSet) {
             //If ring buffer was added to a queue set, notify the queue set
             xNotifyQueueSet = pdTRUE;
@@ -1095,7 +1598,7 @@ void *xRingbufferReceive(RingbufHandle_t xRingbuffer, size_t *pxItemSize, TickTy
 
     //Attempt to retrieve an item
     void *pvTempItem;
-    if (prvReceiveGeneric(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, 0, xTicksToWait) == pdTRUE) {
+    if (prvReceiveGeneric(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, 0, xTicksToWait, NULL) == pdTRUE) {
         return pvTempItem;
     } else {
         return NULL;
@@ -1131,7 +1634,7 @@ BaseType_t xRingbufferReceiveSplit(RingbufHandle_t xRingbuffer,
     configASSERT(pxRingbuffer && ppvHeadItem && ppvTailItem && pxHeadItemSize && pxTailItemSize);
     configASSERT(pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG);
 
-    return prvReceiveGeneric(pxRingbuffer, ppvHeadItem, ppvTailItem, pxHeadItemSize, pxTailItemSize, 0, xTicksToWait);
+    return prvReceiveGeneric(pxRingbuffer, ppvHeadItem, ppvTailItem, pxHeadItemSize, pxTailItemSize, 0, xTicksToWait, NULL);
 }
 
 BaseType_t xRingbufferReceiveSplitFromISR(RingbufHandle_t xRingbuffer,
@@ -1165,7 +1668,7 @@ void *xRingbufferReceiveUpTo(RingbufHandle_t xRingbuffer,
     }
     //Attempt to retrieve up to xMaxSize bytes
     void *pvTempItem;
-    if (prvReceiveGeneric(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, xMaxSize, xTicksToWait) == pdTRUE) {
+    if (prvReceiveGeneric(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, xMaxSize, xTicksToWait, NULL) == pdTRUE) {
         return pvTempItem;
     } else {
         return NULL;
@@ -1192,12 +1695,46 @@ void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemS
     }
 }
 
+UBaseType_t xRingbufferReceiveMultiple(RingbufHandle_t xRingbuffer,
+                                       void **ppvItems,
+                                       size_t *pxItemSizes,
+                                       UBaseType_t uxMaxItems,
+                                       TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+
+    //Check arguments
+    configASSERT(pxRingbuffer && ppvItems && pxItemSizes);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbALLOW_SPLIT_FLAG | rbBYTE_BUFFER_FLAG)) == 0);    //This function should only be called for no-split buffers
+
+    if (uxMaxItems == 0) {
+        return 0;
+    }
+    //Attempt to retrieve up to uxMaxItems items
+    UBaseType_t uxItemCount = uxMaxItems;
+    if (prvReceiveGeneric(pxRingbuffer, ppvItems, NULL, pxItemSizes, NULL, 0, xTicksToWait, &uxItemCount) == pdTRUE) {
+        return uxItemCount;
+    } else {
+        return 0;
+    }
+}
+
 void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvSpscReturnItem(pxRingbuffer, (uint8_t *)pvItem);
+        //If the producer is waiting for space to send, unblock it
+        if (prvSpscUnblock(pxRingbuffer, &pxRingbuffer->xTasksWaitingToSend, rbSPSC_SENDER_WAITING, pdFALSE) == pdTRUE) {
+            //The unblocked task will preempt us. Trigger a yield here.
+            portYIELD_WITHIN_API();
+        }
+        return;
+    }
+
     portENTER_CRITICAL(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1216,6 +1753,15 @@ void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, Bas
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvSpscReturnItem(pxRingbuffer, (uint8_t *)pvItem);
+        //If the producer is waiting for space to send, unblock it
+        if (prvSpscUnblock(pxRingbuffer, &pxRingbuffer->xTasksWaitingToSend, rbSPSC_SENDER_WAITING, pdTRUE) == pdTRUE && pxHigherPriorityTaskWoken != NULL) {
+            *pxHigherPriorityTaskWoken = pdTRUE;
+        }
+        return;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1230,6 +1776,44 @@ void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, Bas
     portEXIT_CRITICAL_ISR(&pxRingbuffer->mux);
 }
 
+void vRingbufferReturnMultiple(RingbufHandle_t xRingbuffer, void *const *ppvItems, UBaseType_t uxItemCount)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL || uxItemCount == 0);
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        for (UBaseType_t i = 0; i < uxItemCount; i++) {
+            configASSERT(ppvItems[i] != NULL);
+            prvSpscReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+        }
+        //If the producer is waiting for space to send, unblock it
+        if (uxItemCount > 0 && prvSpscUnblock(pxRingbuffer, &pxRingbuffer->xTasksWaitingToSend, rbSPSC_SENDER_WAITING, pdFALSE) == pdTRUE) {
+            //The unblocked task will preempt us. Trigger a yield here.
+            portYIELD_WITHIN_API();
+        }
+        return;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+    portENTER_CRITICAL(&pxRingbuffer->mux);
+    for (UBaseType_t i = 0; i < uxItemCount; i++) {
+        configASSERT(ppvItems[i] != NULL);
+        pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+    }
+    //Unblock as many tasks waiting for space to send as vRingbufferReturnItem() would have for each item
+    for (UBaseType_t i = 0; i < uxItemCount && listLIST_IS_EMPTY(&pxRingbuffer->xTasksWaitingToSend) == pdFALSE; i++) {
+        if (xTaskRemoveFromEventList(&pxRingbuffer->xTasksWaitingToSend) == pdTRUE) {
+            xYieldRequired = pdTRUE;
+        }
+    }
+    if (xYieldRequired == pdTRUE) {
+        //An unblocked task will preempt us. Trigger a yield here.
+        portYIELD_WITHIN_API();
+    }
+    portEXIT_CRITICAL(&pxRingbuffer->mux);
+}
+
 void vRingbufferDelete(RingbufHandle_t xRingbuffer)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
@@ -1268,6 +1852,10 @@ BaseType_t xRingbufferAddToQueueSetRead(RingbufHandle_t xRingbuffer, QueueSetHan
 
     configASSERT(pxRingbuffer && xQueueSet);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return pdFALSE;     //Single-producer/single-consumer ring buffers do not notify queue sets
+    }
+
     portENTER_CRITICAL(&pxRingbuffer->mux);
     if (pxRingbuffer->xQueueSet != NULL || prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
         /*
@@ -1319,6 +1907,29 @@ void vRingbufferGetInfo(RingbufHandle_t xRingbuffer,
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        //There is no separate acquire position, and the number of bytes is reported instead of the number of items
+        size_t xFree = atomic_load_explicit(&pxRingbuffer->xSpscFree, memory_order_acquire);
+        size_t xRead = pxRingbuffer->xSpscRead;
+        size_t xWrite = atomic_load_explicit(&pxRingbuffer->xSpscWrite, memory_order_acquire);
+        if (uxFree != NULL) {
+            *uxFree = (UBaseType_t)prvSpscPos(pxRingbuffer, xFree);
+        }
+        if (uxRead != NULL) {
+            *uxRead = (UBaseType_t)prvSpscPos(pxRingbuffer, xRead);
+        }
+        if (uxWrite != NULL) {
+            *uxWrite = (UBaseType_t)prvSpscPos(pxRingbuffer, xWrite);
+        }
+        if (uxAcquire != NULL) {
+            *uxAcquire = (UBaseType_t)prvSpscPos(pxRingbuffer, xWrite);
+        }
+        if (uxItemsWaiting != NULL) {
+            *uxItemsWaiting = (UBaseType_t)prvSpscUsed(pxRingbuffer, xRead, xWrite);
+        }
+        return;
+    }
+
     portENTER_CRITICAL(&pxRingbuffer->mux);
     if (uxFree != NULL) {
         *uxFree = (UBaseType_t)(pxRingbuffer->pucFree - pxRingbuffer->pucHead);
@@ -1342,6 +1953,14 @@ void xRingbufferPrintInfo(RingbufHandle_t xRingbuffer)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        printf("Rb size:%" PRId32 "\tfree: %" PRId32 "\trptr: %" PRId32 "\tfreeptr: %" PRId32 "\twptr: %" PRId32 " (spsc)\n",
+               (int32_t)pxRingbuffer->xSize, (int32_t)prvGetFreeSize(pxRingbuffer),
+               (int32_t)prvSpscPos(pxRingbuffer, pxRingbuffer->xSpscRead),
+               (int32_t)prvSpscPos(pxRingbuffer, atomic_load(&pxRingbuffer->xSpscFree)),
+               (int32_t)prvSpscPos(pxRingbuffer, atomic_load(&pxRingbuffer->xSpscWrite)));
+        return;
+    }
     printf("Rb size:%" PRId32 "\tfree: %" PRId32 "\trptr: %" PRId32 "\tfreeptr: %" PRId32 "\twptr: %" PRId32 ", aptr: %" PRId32 "\n",
            (int32_t)pxRingbuffer->xSize, (int32_t)prvGetFreeSize(pxRingbuffer),
            (int32_t)(pxRingbuffer->pucRead - pxRingbuffer->pucHead),
@@ -7,6 +7,7 @@
 #include "sdkconfig.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -860,7 +861,7 @@ static void read_from_buffer(RingbufHandle_t buffer, RingbufferType_t buf_type,
             char *item_data, *item_data2;
 
             //Select appropriate receive function for type of ring buffer
-            if (buf_type ==  RINGBUF_TYPE_NOSPLIT) {
+            if (buf_type == RINGBUF_TYPE_NOSPLIT || buf_type == RINGBUF_TYPE_NOSPLIT_SPSC) {
                 item_data = (char *)xRingbufferReceive(buffer, &item_size, TIMEOUT_TICKS);
             } else if (buf_type == RINGBUF_TYPE_ALLOWSPLIT) {
                 BaseType_t ret = xRingbufferReceiveSplit(buffer, (void **)&item_data, (void **)&item_data2, &item_size, &item_size2, TIMEOUT_TICKS);
@@ -871,7 +872,7 @@ static void read_from_buffer(RingbufHandle_t buffer, RingbufferType_t buf_type,
 
             //Check received item and return it
             TEST_ASSERT_MESSAGE(item_data != NULL, "Failed to receive an item");
-            if (buf_type == RINGBUF_TYPE_BYTEBUF) {
+            if (buf_type == RINGBUF_TYPE_BYTEBUF || buf_type == RINGBUF_TYPE_BYTEBUF_SPSC) {
                 TEST_ASSERT_MESSAGE(item_size <= max_rec_size, "Received data exceeds max size");
             }
             for (int i = 0; i < item_size; i++) {
@@ -945,7 +946,7 @@ static void cleanup(void)
 TEST_CASE("Test ring buffer SMP", "[esp_ringbuf]")
 {
     setup();
-    //Iterate through buffer types (No split, split, then byte buff)
+    //Iterate through buffer types (No split, split, byte buff, then their SPSC variants)
     for (RingbufferType_t buf_type = 0; buf_type < RINGBUF_TYPE_MAX; buf_type++) {
         //Create buffer
         task_args_t task_args;
@@ -977,7 +978,7 @@ TEST_CASE("Test ring buffer SMP", "[esp_ringbuf]")
 TEST_CASE("Test static ring buffer SMP", "[esp_ringbuf]")
 {
     setup();
-    //Iterate through buffer types (No split, split, then byte buff)
+    //Iterate through buffer types (No split, split, byte buff, then their SPSC variants)
     for (RingbufferType_t buf_type = 0; buf_type < RINGBUF_TYPE_MAX; buf_type++) {
         StaticRingbuffer_t *buffer_struct;
         uint8_t *buffer_storage;
@@ -1123,3 +1124,101 @@ TEST_CASE("Test ringbuffer with caps", "[esp_ringbuf]")
     // Free the ring buffer
     vRingbufferDeleteWithCaps(rb_handle);
 }
+
+/* ------------- Test ring buffer vectored send and multiple receive ----------
+ * The following test cases test the following APIs:
+ *
+ * - xRingbufferSendv() on all ring buffer types. The parts of an item are
+ *   received as a single item, even if the item wraps around or is split.
+ * - xRingbufferReceiveMultiple() and vRingbufferReturnMultiple() on no-split
+ *   ring buffers
+ */
+
+TEST_CASE("Test ringbuffer vectored send", "[esp_ringbuf]")
+{
+    //Send the small item and the large item as one item, with an empty part in between
+    const RingbufferIOVec_t iov[] = {
+        { .pvData = small_item, .xLen = SMALL_ITEM_SIZE },
+        { .pvData = NULL, .xLen = 0 },
+        { .pvData = large_item, .xLen = LARGE_ITEM_SIZE },
+    };
+    uint8_t expected[SMALL_ITEM_SIZE + LARGE_ITEM_SIZE];
+    memcpy(expected, small_item, SMALL_ITEM_SIZE);
+    memcpy(expected + SMALL_ITEM_SIZE, large_item, LARGE_ITEM_SIZE);
+
+    for (RingbufferType_t buf_type = 0; buf_type < RINGBUF_TYPE_MAX; buf_type++) {
+        RingbufHandle_t buffer = xRingbufferCreate(BUFFER_SIZE, buf_type);
+        TEST_ASSERT_MESSAGE(buffer != NULL, "Failed to create ring buffer");
+
+        //Offset the items so that they wrap around (or are split) in the middle of a part
+        send_item_and_check(buffer, large_item, MEDIUM_ITEM_SIZE, TIMEOUT_TICKS, false);
+        if (buf_type == RINGBUF_TYPE_ALLOWSPLIT) {
+            receive_check_and_return_item_allow_split(buffer, large_item, MEDIUM_ITEM_SIZE, TIMEOUT_TICKS, false);
+        } else if (buf_type == RINGBUF_TYPE_BYTEBUF || buf_type == RINGBUF_TYPE_BYTEBUF_SPSC) {
+            receive_check_and_return_item_byte_buffer(buffer, large_item, MEDIUM_ITEM_SIZE, TIMEOUT_TICKS, false);
+        } else {
+            receive_check_and_return_item_no_split(buffer, large_item, MEDIUM_ITEM_SIZE, TIMEOUT_TICKS, false);
+        }
+
+        for (int i = 0; i < 2 * BUFFER_SIZE / sizeof(expected); i++) {
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendv(buffer, iov, sizeof(iov) / sizeof(iov[0]), TIMEOUT_TICKS));
+            if (buf_type == RINGBUF_TYPE_ALLOWSPLIT) {
+                receive_check_and_return_item_allow_split(buffer, expected, sizeof(expected), TIMEOUT_TICKS, false);
+            } else if (buf_type == RINGBUF_TYPE_BYTEBUF || buf_type == RINGBUF_TYPE_BYTEBUF_SPSC) {
+                receive_check_and_return_item_byte_buffer(buffer, expected, sizeof(expected), TIMEOUT_TICKS, false);
+            } else {
+                receive_check_and_return_item_no_split(buffer, expected, sizeof(expected), TIMEOUT_TICKS, false);
+            }
+        }
+
+        //Items larger than the maximum item size in total are rejected
+        const RingbufferIOVec_t too_large_iov[] = {
+            { .pvData = NULL, .xLen = 0 },
+            { .pvData = small_item, .xLen = 1 },
+            { .pvData = large_item, .xLen = xRingbufferGetMaxItemSize(buffer) },
+        };
+        TEST_ASSERT_EQUAL(pdFALSE, xRingbufferSendv(buffer, too_large_iov, sizeof(too_large_iov) / sizeof(too_large_iov[0]), 0));
+        vRingbufferDelete(buffer);
+    }
+}
+
+TEST_CASE("Test ringbuffer receive multiple items", "[esp_ringbuf]")
+{
+    const RingbufferType_t buf_types[] = { RINGBUF_TYPE_NOSPLIT, RINGBUF_TYPE_NOSPLIT_SPSC };
+    void *items[4];
+    size_t item_sizes[4];
+
+    for (int i = 0; i < sizeof(buf_types) / sizeof(buf_types[0]); i++) {
+        RingbufHandle_t buffer = xRingbufferCreate(BUFFER_SIZE, buf_types[i]);
+        TEST_ASSERT_MESSAGE(buffer != NULL, "Failed to create ring buffer");
+
+        //Timeout on an empty buffer
+        TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(buffer, items, item_sizes, 4, TIMEOUT_TICKS));
+
+        //Repeat often enough for the items to wrap around
+        for (int iter = 0; iter < 2 * BUFFER_SIZE / (3 * (ITEM_HDR_SIZE + SMALL_ITEM_SIZE)); iter++) {
+            send_item_and_check(buffer, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+            send_item_and_check(buffer, large_item, LARGE_ITEM_SIZE, TIMEOUT_TICKS, false);
+            send_item_and_check(buffer, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+
+            //Only the requested number of items is retrieved
+            TEST_ASSERT_EQUAL(2, xRingbufferReceiveMultiple(buffer, items, item_sizes, 2, TIMEOUT_TICKS));
+            TEST_ASSERT_EQUAL(SMALL_ITEM_SIZE, item_sizes[0]);
+            TEST_ASSERT_EQUAL_MEMORY(small_item, items[0], SMALL_ITEM_SIZE);
+            TEST_ASSERT_EQUAL(LARGE_ITEM_SIZE, item_sizes[1]);
+            TEST_ASSERT_EQUAL_MEMORY(large_item, items[1], LARGE_ITEM_SIZE);
+
+            //Only the available items are retrieved
+            TEST_ASSERT_EQUAL(1, xRingbufferReceiveMultiple(buffer, &items[2], &item_sizes[2], 2, TIMEOUT_TICKS));
+            TEST_ASSERT_EQUAL(SMALL_ITEM_SIZE, item_sizes[2]);
+            TEST_ASSERT_EQUAL_MEMORY(small_item, items[2], SMALL_ITEM_SIZE);
+            TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(buffer, &items[3], &item_sizes[3], 1, 0));
+
+            //Items do not have to be returned in order
+            vRingbufferReturnMultiple(buffer, &items[1], 2);
+            vRingbufferReturnMultiple(buffer, items, 1);
+            TEST_ASSERT_EQUAL(xRingbufferGetMaxItemSize(buffer), xRingbufferGetCurFreeSize(buffer));
+        }
+        vRingbufferDelete(buffer);
+    }
+}
@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "sdkconfig.h"
+#include "esp_timer_storage.h"
+#include "unity.h"
+
+#define TEST_MAX_TIMERS         1000
+#define BENCH_DISPATCH_COUNT    100000
+#define BENCH_REPEAT            20
+
+#if CONFIG_ESP_TIMER_STORAGE_HEAP
+#define STORAGE_NAME "pairing heap"
+#else
+#define STORAGE_NAME "sorted list"
+#endif
+
+static struct esp_timer s_timers[TEST_MAX_TIMERS];
+static uint32_t s_seed;
+
+static uint32_t next_random(void)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static void init_timers(size_t count, uint32_t max_alarm)
+{
+    memset(s_timers, 0, sizeof(s_timers));
+    for (size_t i = 0; i < count; i++) {
+        s_timers[i].alarm = next_random() % max_alarm;
+        s_timers[i].period = 1 + next_random() % 1000;
+    }
+}
+
+static size_t count_armed(void)
+{
+    size_t count = 0;
+    for (esp_timer_handle_t it = esp_timer_storage_first(ESP_TIMER_TASK); it != NULL; it = esp_timer_storage_next(it)) {
+        TEST_ASSERT_LESS_OR_EQUAL(TEST_MAX_TIMERS, ++count);
+    }
+    return count;
+}
+
+TEST_CASE("armed timers are dispatched in order of alarm time, then in order of arming", "[esp_timer]")
+{
+    s_seed = 1;
+    // Few different alarm times, so that many timers have the same alarm time
+    init_timers(TEST_MAX_TIMERS, 50);
+    bool armed[TEST_MAX_TIMERS] = { 0 };
+    size_t armed_count = 0;
+
+    // Arm all timers and stop some of them in between
+    for (size_t i = 0; i < TEST_MAX_TIMERS; i++) {
+        esp_timer_storage_insert(&s_timers[i]);
+        armed[i] = true;
+        armed_count++;
+        if (next_random() % 4 == 0) {
+            size_t stop = next_random() % (i + 1);
+            if (armed[stop]) {
+                esp_timer_storage_remove(&s_timers[stop]);
+                armed[stop] = false;
+                armed_count--;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(armed_count, count_armed());
+
+    // The earliest timer has to be removed first. Timers were armed in order of their index.
+    esp_timer_handle_t prev = NULL;
+    esp_timer_handle_t it;
+    while ((it = esp_timer_storage_first(ESP_TIMER_TASK)) != NULL) {
+        TEST_ASSERT_TRUE(armed[it - s_timers]);
+        if (prev != NULL) {
+            TEST_ASSERT_TRUE(prev->alarm <= it->alarm);
+            if (prev->alarm == it->alarm) {
+                TEST_ASSERT_TRUE(prev < it);
+            }
+        }
+        esp_timer_storage_remove(it);
+        armed[it - s_timers] = false;
+        armed_count--;
+        prev = it;
+    }
+    TEST_ASSERT_EQUAL(0, armed_count);
+}
+
+TEST_CASE("timers skipping unhandled events do not wake up the CPU", "[esp_timer]")
+{
+    s_seed = 2;
+    init_timers(TEST_MAX_TIMERS, 1000000);
+    TEST_ASSERT_NULL(esp_timer_storage_first_wakeup(ESP_TIMER_TASK));
+
+    for (size_t i = 0; i < TEST_MAX_TIMERS; i++) {
+        if (next_random() % 8 != 0) {
+            s_timers[i].flags |= FL_SKIP_UNHANDLED_EVENTS;
+        }
+        esp_timer_storage_insert(&s_timers[i]);
+    }
+    for (size_t i = 0; i < TEST_MAX_TIMERS; i++) {
+        esp_timer_handle_t expected = NULL;
+        for (size_t j = 0; j < TEST_MAX_TIMERS; j++) {
+            esp_timer_handle_t t = &s_timers[j];
+            if (t->alarm != UINT64_MAX && (t->flags & FL_SKIP_UNHANDLED_EVENTS) == 0 &&
+                    (expected == NULL || t->alarm < expected->alarm)) {
+                expected = t;
+            }
+        }
+        esp_timer_handle_t wakeup = esp_timer_storage_first_wakeup(ESP_TIMER_TASK);
+        if (expected == NULL) {
+            TEST_ASSERT_NULL(wakeup);
+        } else {
+            TEST_ASSERT_NOT_NULL(wakeup);
+            TEST_ASSERT_EQUAL(expected->alarm, wakeup->alarm);
+        }
+        // UINT64_MAX marks removed timers
+        esp_timer_handle_t first = esp_timer_storage_first(ESP_TIMER_TASK);
+        esp_timer_storage_remove(first);
+        first->alarm = UINT64_MAX;
+    }
+    TEST_ASSERT_NULL(esp_timer_storage_first(ESP_TIMER_TASK));
+}
+
+static double get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+TEST_CASE("esp_timer storage arm/cancel/dispatch cost", "[esp_timer][benchmark]")
+{
+    const size_t timer_counts[] = { 10, 100, TEST_MAX_TIMERS };
+    esp_timer_handle_t order[TEST_MAX_TIMERS];
+
+    printf("storage: %s\n", STORAGE_NAME);
+    printf("%8s %14s %14s %14s\n", "timers", "arm ns/op", "cancel ns/op", "dispatch ns/op");
+    for (int i = 0; i < sizeof(timer_counts) / sizeof(timer_counts[0]); i++) {
+        const size_t n = timer_counts[i];
+        double arm_ns = 0;
+        double cancel_ns = 0;
+        s_seed = 3;
+
+        for (int r = 0; r < BENCH_REPEAT; r++) {
+            init_timers(n, 1000000);
+            // Cancel timers in a random order
+            for (size_t j = 0; j < n; j++) {
+                order[j] = &s_timers[j];
+            }
+            for (size_t j = n - 1; j > 0; j--) {
+                size_t k = next_random() % (j + 1);
+                esp_timer_handle_t tmp = order[j];
+                order[j] = order[k];
+                order[k] = tmp;
+            }
+
+            double start = get_time_ns();
+            for (size_t j = 0; j < n; j++) {
+                esp_timer_storage_insert(&s_timers[j]);
+            }
+            arm_ns += get_time_ns() - start;
+
+            start = get_time_ns();
+            for (size_t j = 0; j < n; j++) {
+                esp_timer_storage_remove(order[j]);
+            }
+            cancel_ns += get_time_ns() - start;
+            TEST_ASSERT_NULL(esp_timer_storage_first(ESP_TIMER_TASK));
+        }
+
+        // Dispatch: remove the earliest timer and re-arm it for its next period, as done for periodic timers
+        init_timers(n, 1000000);
+        for (size_t j = 0; j < n; j++) {
+            esp_timer_storage_insert(&s_timers[j]);
+        }
+        uint64_t last_alarm = 0;
+        double start = get_time_ns();
+        for (size_t j = 0; j < BENCH_DISPATCH_COUNT; j++) {
+            esp_timer_handle_t it = esp_timer_storage_first(ESP_TIMER_TASK);
+            esp_timer_storage_remove(it);
+            TEST_ASSERT_TRUE(last_alarm <= it->alarm);
+            last_alarm = it->alarm;
+            it->alarm += it->period;
+            esp_timer_storage_insert(it);
+        }
+        double dispatch_ns = get_time_ns() - start;
+        for (size_t j = 0; j < n; j++) {
+            esp_timer_storage_remove(&s_timers[j]);
+        }
+
+        printf("%8zu %14.1f %14.1f %14.1f\n", n, arm_ns / (n * BENCH_REPEAT), cancel_ns / (n * BENCH_REPEAT),
+               dispatch_ns / BENCH_DISPATCH_COUNT);
+    }
+}
+
+void app_main(void)
+{
+    unity_run_menu();
+}
@@ -65,6 +65,23 @@ typedef enum {
     ESP_TIMER_MAX,      //!< Sentinel value for the number of callback dispatch methods
 } esp_timer_dispatch_t;
 
+/**
+ * @brief Task which dispatches the callback of an ESP_TIMER_TASK timer
+ *
+ * Callbacks of timers in the same queue are executed one after another.
+ * A slow callback only delays the callbacks of timers in its own queue.
+ */
+typedef enum {
+    ESP_TIMER_QUEUE_DEFAULT,    //!< Callback is dispatched from the esp_timer task
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS || __DOXYGEN__
+    ESP_TIMER_QUEUE_CPU0,       //!< Callback is dispatched from the esp_timer task pinned to CPU0
+#if CONFIG_FREERTOS_NUMBER_OF_CORES > 1 || __DOXYGEN__
+    ESP_TIMER_QUEUE_CPU1,       //!< Callback is dispatched from the esp_timer task pinned to CPU1
+#endif
+#endif
+    ESP_TIMER_QUEUE_MAX,        //!< Sentinel value for the number of dispatch queues
+} esp_timer_dispatch_queue_t;
+
 /**
  * @brief Timer configuration passed to esp_timer_create()
  */
@@ -76,6 +93,11 @@ typedef struct {
     //                                !< `CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD`
     const char* name;               //!< Timer name, used in esp_timer_dump() function
     bool skip_unhandled_events;     //!< Setting to skip unhandled events in light sleep for periodic timers
+    esp_timer_dispatch_queue_t dispatch_queue;  //!< Task which dispatches the callback if dispatch_method is ESP_TIMER_TASK;
+    //                                !< if not specified, esp_timer task is used; for per-core tasks, also set
+    //                                !< Kconfig option `CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS`
+    uint32_t slack_us;              //!< Maximum time in microseconds the callback may be delayed, so that the alarm
+    //                                !< can be shared with other timers; 0 to dispatch at the exact time
 } esp_timer_create_args_t;
 
 /**
@@ -279,6 +301,9 @@ esp_err_t esp_timer_get_expiry_time(esp_timer_handle_t timer, uint64_t *expiry);
  * - Period — period of timer in microseconds, or 0 for one-shot timer
  * - Alarm - time of the next alarm in microseconds since boot, or 0 if the timer is not started
  *
+ * Active timers are printed in the order of their alarm time, unless `CONFIG_ESP_TIMER_STORAGE_HEAP`
+ * is enabled, in which case the order is not specified.
+ *
  * To print the list of all created timers, enable Kconfig option `CONFIG_ESP_TIMER_PROFILING`.
  * In this case, the output format is:
  *
@@ -292,6 +317,11 @@ esp_err_t esp_timer_get_expiry_time(esp_timer_handle_t timer, uint64_t *expiry);
  * - Times_skipped - number of times the callback was skipped
  * - Callback_exec_time - total time taken by callback to execute, across all calls
  *
+ * With profiling enabled, the number of alarms programmed and the number of timers dispatched on the alarm
+ * of another timer (coalesced) are printed after the list of timers, one line for each dispatch method.
+ * They are followed by a histogram of the dispatch lateness (time between the requested alarm time of a
+ * timer and the start of its callback), one line for each dispatch queue.
+ *
  * @param stream stream (such as stdout) to which to dump the information
  * @return
  *      - ESP_OK on success
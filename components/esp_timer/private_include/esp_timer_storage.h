@@ -0,0 +1,130 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+/**
+ * @file private_include/esp_timer_storage.h
+ *
+ * @brief Interface between esp_timer.c and the data structure holding armed timers.
+ *
+ * Armed timers are kept in one data structure per dispatch method, ordered
+ * by their alarm time. Which data structure is used is selected in menuconfig:
+ * - esp_timer_storage_list.c: sorted list. Arming is O(n), cancelling and getting the first timer O(1).
+ * - esp_timer_storage_heap.c: pairing heap. Arming is O(1), cancelling O(log n) amortized,
+ *   getting the first timer O(1).
+ *
+ * Timers with the same alarm time are dispatched in the order they were armed in.
+ *
+ * All functions in this header have to be called with the lock of the timer's
+ * dispatch method held. They are placed into IRAM.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+
+#ifdef CONFIG_ESP_TIMER_PROFILING
+#define WITH_PROFILING 1
+#endif
+
+#ifndef NDEBUG
+// Enable built-in checks in queue.h in debug builds
+#define INVARIANTS
+#endif
+#include "sys/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    FL_ISR_DISPATCH_METHOD   = (1 << 0),  //!< 0=Callback is called from timer task, 1=Callback is called from timer ISR
+    FL_SKIP_UNHANDLED_EVENTS = (1 << 1),  //!< 0=NOT skip unhandled events for periodic timers, 1=Skip unhandled events for periodic timers
+} flags_t;
+
+struct esp_timer {
+    uint64_t alarm;
+    uint64_t period: 56;
+    flags_t flags: 8;
+    union {
+        esp_timer_cb_t callback;
+        uint32_t event_id;
+    };
+    void* arg;
+    uint32_t slack;                 //!< Maximum delay of the alarm, to share it with other timers
+    uint32_t slack_offset;          //!< Delay of the current alarm, alarm - slack_offset is the requested alarm time
+#if WITH_PROFILING
+    const char* name;
+    size_t times_triggered;
+    size_t times_armed;
+    size_t times_skipped;
+    uint64_t total_callback_run_time;
+#endif // WITH_PROFILING
+#if CONFIG_ESP_TIMER_STORAGE_HEAP
+    struct esp_timer* heap_child;   //!< First child in the heap
+    struct esp_timer* heap_next;    //!< Next sibling in the heap
+    struct esp_timer* heap_prev;    //!< Previous sibling, or parent if this is the first child. NULL for the root
+    uint32_t heap_seq;              //!< Sequence number, orders timers with the same alarm time
+#endif // CONFIG_ESP_TIMER_STORAGE_HEAP
+#if CONFIG_ESP_TIMER_STORAGE_LIST || WITH_PROFILING
+    LIST_ENTRY(esp_timer) list_entry;
+#endif
+    TAILQ_ENTRY(esp_timer) pending_entry;   //!< Entry in the list of its dispatch queue while pending_runs > 0
+    uint8_t pending_runs;           //!< Number of expired alarms whose callback has not been executed yet
+    uint8_t dispatch_queue;         //!< esp_timer_dispatch_queue_t of the timer
+#if WITH_PROFILING
+    uint64_t pending_alarm;         //!< Alarm time of the first pending run, to measure the dispatch lateness
+#endif
+};
+
+/**
+ * @brief Get the armed timer with the earliest alarm time
+ *
+ * @param dispatch_method dispatch method of the timers
+ * @return earliest timer, or NULL if no timer is armed
+ */
+esp_timer_handle_t esp_timer_storage_first(esp_timer_dispatch_t dispatch_method);
+
+/**
+ * @brief Add a timer to the armed timers of its dispatch method
+ *
+ * @param timer timer to add, timer->alarm has to be set
+ */
+void esp_timer_storage_insert(esp_timer_handle_t timer);
+
+/**
+ * @brief Remove a timer from the armed timers of its dispatch method
+ *
+ * @param timer armed timer to remove
+ */
+void esp_timer_storage_remove(esp_timer_handle_t timer);
+
+/**
+ * @brief Get the next armed timer when iterating over all armed timers
+ *
+ * Iteration starts at esp_timer_storage_first(). The order of the timers is
+ * only sorted by alarm time for the sorted list.
+ *
+ * @param timer current timer
+ * @return next timer, or NULL at the end
+ */
+esp_timer_handle_t esp_timer_storage_next(esp_timer_handle_t timer);
+
+/**
+ * @brief Get the armed timer with the earliest alarm time that does not skip unhandled events
+ *
+ * Timers with the FL_SKIP_UNHANDLED_EVENTS flag do not wake up the CPU from sleep.
+ *
+ * @param dispatch_method dispatch method of the timers
+ * @return earliest timer without FL_SKIP_UNHANDLED_EVENTS, or NULL if there is none
+ */
+esp_timer_handle_t esp_timer_storage_first_wakeup(esp_timer_dispatch_t dispatch_method);
+
+#ifdef __cplusplus
+}
+#endif
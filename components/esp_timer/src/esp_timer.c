@@ -6,6 +6,7 @@
 
 #include <sys/param.h>
 #include <string.h>
+#include <inttypes.h>
 #include "soc/soc.h"
 #include "esp_types.h"
 #include "esp_attr.h"
@@ -18,6 +19,7 @@
 #include "esp_ipc.h"
 #include "esp_timer.h"
 #include "esp_timer_impl.h"
+#include "esp_timer_storage.h"
 #include "esp_compiler.h"
 
 #include "esp_private/startup_internal.h"
@@ -47,46 +49,31 @@
 
 #include "sdkconfig.h"
 
-#ifdef CONFIG_ESP_TIMER_PROFILING
-#define WITH_PROFILING 1
-#endif
+#define EVENT_ID_DELETE_TIMER   0xF0DE1E1E
 
-#ifndef NDEBUG
-// Enable built-in checks in queue.h in debug builds
-#define INVARIANTS
+#ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+// expired ISR timers are kept in one more queue after the queues of ESP_TIMER_TASK timers
+#define QUEUE_ISR               ESP_TIMER_QUEUE_MAX
+#define QUEUE_COUNT             (ESP_TIMER_QUEUE_MAX + 1)
+// functions which dispatch callbacks are called from the timer ISR
+#define DISPATCH_ATTR           IRAM_ATTR
+#else
+#define QUEUE_COUNT             ESP_TIMER_QUEUE_MAX
+#define DISPATCH_ATTR
 #endif
-#include "sys/queue.h"
 
-#define EVENT_ID_DELETE_TIMER   0xF0DE1E1E
-
-typedef enum {
-    FL_ISR_DISPATCH_METHOD   = (1 << 0),  //!< 0=Callback is called from timer task, 1=Callback is called from timer ISR
-    FL_SKIP_UNHANDLED_EVENTS = (1 << 1),  //!< 0=NOT skip unhandled events for periodic timers, 1=Skip unhandled events for periodic timers
-} flags_t;
-
-struct esp_timer {
-    uint64_t alarm;
-    uint64_t period: 56;
-    flags_t flags: 8;
-    union {
-        esp_timer_cb_t callback;
-        uint32_t event_id;
-    };
-    void* arg;
 #if WITH_PROFILING
-    const char* name;
-    size_t times_triggered;
-    size_t times_armed;
-    size_t times_skipped;
-    uint64_t total_callback_run_time;
-#endif // WITH_PROFILING
-    LIST_ENTRY(esp_timer) list_entry;
-};
+// buckets of the dispatch lateness histogram: < 10 us, < 100 us, < 1 ms, < 10 ms, < 100 ms, >= 100 ms
+#define LATENESS_BUCKETS        6
+#endif
 
 static inline bool is_initialized(void);
 static esp_err_t timer_insert(esp_timer_handle_t timer, bool without_update_alarm);
 static esp_err_t timer_remove(esp_timer_handle_t timer);
 static bool timer_armed(esp_timer_handle_t timer);
+static void timer_set_alarm(esp_timer_handle_t timer, uint64_t alarm);
+static void timer_program_alarm(uint64_t alarm, esp_timer_dispatch_t dispatch_method);
+static unsigned timer_queue(esp_timer_handle_t timer);
 static void timer_list_lock(esp_timer_dispatch_t timer_type);
 static void timer_list_unlock(esp_timer_dispatch_t timer_type);
 
@@ -97,21 +84,34 @@ static void timer_remove_inactive(esp_timer_handle_t timer);
 
 __attribute__((unused)) static const char* TAG = "esp_timer";
 
-// lists of currently armed timers for two dispatch methods: ISR and TASK
-static LIST_HEAD(esp_timer_list, esp_timer) s_timers[ESP_TIMER_MAX] = {
-    [0 ...(ESP_TIMER_MAX - 1)] = LIST_HEAD_INITIALIZER(s_timers)
-};
+// currently armed timers of the two dispatch methods, ISR and TASK, are kept in esp_timer_storage_*.c
 #if WITH_PROFILING
 // lists of unarmed timers for two dispatch methods: ISR and TASK,
 // used only to be able to dump statistics about all the timers
 static LIST_HEAD(esp_inactive_timer_list, esp_timer) s_inactive_timers[ESP_TIMER_MAX] = {
-    [0 ...(ESP_TIMER_MAX - 1)] = LIST_HEAD_INITIALIZER(s_timers)
+    [0 ...(ESP_TIMER_MAX - 1)] = LIST_HEAD_INITIALIZER(s_inactive_timers)
 };
 #endif
 // task used to dispatch timer callbacks
 static TaskHandle_t s_timer_task;
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
+// tasks used to dispatch the callbacks of the per-core queues, ESP_TIMER_QUEUE_DEFAULT is dispatched by s_timer_task
+static TaskHandle_t s_queue_tasks[ESP_TIMER_QUEUE_MAX];
+#endif
+// lists of expired timers whose callbacks are not executed yet, one per dispatch queue,
+// protected by the lock of the dispatch method of the queue
+static TAILQ_HEAD(esp_timer_pending_list, esp_timer) s_pending_timers[QUEUE_COUNT];
+#if WITH_PROFILING
+// histograms of the time between the alarm of a timer and the start of its callback, one per dispatch queue
+static uint32_t s_lateness_hist[QUEUE_COUNT][LATENESS_BUCKETS];
+// last alarm time programmed, number of different alarm times programmed and number of timers which
+// were dispatched on the alarm of another timer, for two dispatch methods: ISR and TASK
+static uint64_t s_last_programmed_alarm[ESP_TIMER_MAX];
+static uint32_t s_alarms_programmed[ESP_TIMER_MAX];
+static uint32_t s_timers_coalesced[ESP_TIMER_MAX];
+#endif
 
-// lock protecting s_timers, s_inactive_timers
+// lock protecting the armed timers, s_inactive_timers
 static portMUX_TYPE s_timer_lock[ESP_TIMER_MAX] = {
     [0 ...(ESP_TIMER_MAX - 1)] = portMUX_INITIALIZER_UNLOCKED
 };
@@ -128,7 +128,9 @@ esp_err_t esp_timer_create(const esp_timer_create_args_t* args,
         return ESP_ERR_INVALID_STATE;
     }
     if (args == NULL || args->callback == NULL || out_handle == NULL ||
-            args->dispatch_method < 0 || args->dispatch_method >= ESP_TIMER_MAX) {
+            args->dispatch_method < 0 || args->dispatch_method >= ESP_TIMER_MAX ||
+            args->dispatch_queue < 0 || args->dispatch_queue >= ESP_TIMER_QUEUE_MAX ||
+            (args->dispatch_method != ESP_TIMER_TASK && args->dispatch_queue != ESP_TIMER_QUEUE_DEFAULT)) {
         return ESP_ERR_INVALID_ARG;
     }
     esp_timer_handle_t result = (esp_timer_handle_t) heap_caps_calloc(1, sizeof(*result), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
@@ -139,6 +141,8 @@ esp_err_t esp_timer_create(const esp_timer_create_args_t* args,
     result->arg = args->arg;
     result->flags = (args->dispatch_method ? FL_ISR_DISPATCH_METHOD : 0) |
                     (args->skip_unhandled_events ? FL_SKIP_UNHANDLED_EVENTS : 0);
+    result->dispatch_queue = args->dispatch_queue;
+    result->slack = args->slack_us;
 #if WITH_PROFILING
     result->name = args->name;
     esp_timer_dispatch_t dispatch_method = result->flags & FL_ISR_DISPATCH_METHOD;
@@ -186,11 +190,11 @@ esp_err_t IRAM_ATTR esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout
         if (period != 0) {
             /* Remove function got rid of the alarm and period fields, restore them */
             const uint64_t new_period = MAX(timeout_us, esp_timer_impl_get_min_period_us());
-            timer->alarm = now + new_period;
+            timer_set_alarm(timer, now + new_period);
             timer->period = new_period;
         } else {
             /* The new one-shot alarm shall be triggered timeout_us after the current time */
-            timer->alarm = now + timeout_us;
+            timer_set_alarm(timer, now + timeout_us);
             timer->period = 0;
         }
         ret = timer_insert(timer, false);
@@ -218,12 +222,12 @@ esp_err_t IRAM_ATTR esp_timer_start_once(esp_timer_handle_t timer, uint64_t time
     /* Check if the timer is armed once the list is locked.
      * Otherwise another task may arm the timer between the checks
      * and us locking the list, resulting in us inserting the
-     * timer to s_timers a second time. This will create a loop
-     * in s_timers. */
+     * timer to the armed timers a second time. This will corrupt
+     * them. */
     if (timer_armed(timer)) {
         err = ESP_ERR_INVALID_STATE;
     } else {
-        timer->alarm = alarm;
+        timer_set_alarm(timer, alarm);
         timer->period = 0;
 #if WITH_PROFILING
         timer->times_armed++;
@@ -252,7 +256,7 @@ esp_err_t IRAM_ATTR esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t
     if (timer_armed(timer)) {
         err = ESP_ERR_INVALID_STATE;
     } else {
-        timer->alarm = alarm;
+        timer_set_alarm(timer, alarm);
         timer->period = period_us;
 #if WITH_PROFILING
         timer->times_armed++;
@@ -302,7 +306,7 @@ esp_err_t esp_timer_delete(esp_timer_handle_t timer)
         err = ESP_ERR_INVALID_STATE;
     } else {
         // A case for the timer with ESP_TIMER_ISR:
-        // This ISR timer was removed from the ISR list in esp_timer_stop() or in timer_process_alarm() -> LIST_REMOVE(it, list_entry)
+        // This ISR timer was removed from the ISR list in esp_timer_stop() or in timer_process_alarm() -> esp_timer_storage_remove(it)
         // and here this timer will be added to another the TASK list, see below.
         // We do this because we want to free memory of the timer in a task context instead of an isr context.
         timer->flags &= ~FL_ISR_DISPATCH_METHOD;
@@ -320,25 +324,10 @@ static IRAM_ATTR esp_err_t timer_insert(esp_timer_handle_t timer, bool without_u
 #if WITH_PROFILING
     timer_remove_inactive(timer);
 #endif
-    esp_timer_handle_t it, last = NULL;
     esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
-    if (LIST_FIRST(&s_timers[dispatch_method]) == NULL) {
-        LIST_INSERT_HEAD(&s_timers[dispatch_method], timer, list_entry);
-    } else {
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            if (timer->alarm < it->alarm) {
-                LIST_INSERT_BEFORE(it, timer, list_entry);
-                break;
-            }
-            last = it;
-        }
-        if (it == NULL) {
-            assert(last);
-            LIST_INSERT_AFTER(last, timer, list_entry);
-        }
-    }
-    if (without_update_alarm == false && timer == LIST_FIRST(&s_timers[dispatch_method])) {
-        esp_timer_impl_set_alarm_id(timer->alarm, dispatch_method);
+    esp_timer_storage_insert(timer);
+    if (without_update_alarm == false && timer == esp_timer_storage_first(dispatch_method)) {
+        timer_program_alarm(timer->alarm, dispatch_method);
     }
     return ESP_OK;
 }
@@ -347,21 +336,29 @@ static IRAM_ATTR esp_err_t timer_remove(esp_timer_handle_t timer)
 {
     esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
     timer_list_lock(dispatch_method);
-    esp_timer_handle_t first_timer = LIST_FIRST(&s_timers[dispatch_method]);
-    LIST_REMOVE(timer, list_entry);
-    timer->alarm = 0;
-    timer->period = 0;
-    if (timer == first_timer) { // if this timer was the first in the list.
-        uint64_t next_timestamp = UINT64_MAX;
-        first_timer = LIST_FIRST(&s_timers[dispatch_method]);
-        if (first_timer) { // if after removing the timer from the list, this list is not empty.
-            next_timestamp = first_timer->alarm;
+    if (timer->pending_runs > 0) {
+        // the alarm has expired but the callback was not executed yet, cancel it
+        TAILQ_REMOVE(&s_pending_timers[timer_queue(timer)], timer, pending_entry);
+        timer->pending_runs = 0;
+    }
+    // one-shot timers are not in the armed timers any more once they are pending
+    if (timer->alarm > 0) {
+        esp_timer_handle_t first_timer = esp_timer_storage_first(dispatch_method);
+        esp_timer_storage_remove(timer);
+        timer->alarm = 0;
+        if (timer == first_timer) { // if this timer was the first in the list.
+            uint64_t next_timestamp = UINT64_MAX;
+            first_timer = esp_timer_storage_first(dispatch_method);
+            if (first_timer) { // if after removing the timer from the list, this list is not empty.
+                next_timestamp = first_timer->alarm;
+            }
+            timer_program_alarm(next_timestamp, dispatch_method);
         }
-        esp_timer_impl_set_alarm_id(next_timestamp, dispatch_method);
-    }
 #if WITH_PROFILING
-    timer_insert_inactive(timer);
+        timer_insert_inactive(timer);
 #endif
+    }
+    timer->period = 0;
     timer_list_unlock(dispatch_method);
     return ESP_OK;
 }
@@ -394,7 +391,46 @@ static IRAM_ATTR void timer_remove_inactive(esp_timer_handle_t timer)
 
 static IRAM_ATTR bool timer_armed(esp_timer_handle_t timer)
 {
-    return timer->alarm > 0;
+    // a timer whose callback is pending counts as armed, as it was before its alarm was processed
+    return timer->alarm > 0 || timer->pending_runs > 0;
+}
+
+/* Sets the alarm time of the timer, delayed by up to timer->slack microseconds.
+ * Of all times in [alarm, alarm + slack], the one with the most trailing zero bits is chosen.
+ * Timers whose windows overlap thus tend to get the same alarm time and are dispatched together.
+ */
+static IRAM_ATTR void timer_set_alarm(esp_timer_handle_t timer, uint64_t alarm)
+{
+    uint64_t alarm_with_slack = alarm;
+    const uint64_t limit = alarm + timer->slack;
+    if (limit != alarm) {
+        // limit has a 1 at the highest bit in which it differs from alarm, clear all lower bits
+        const int bit = 63 - __builtin_clzll(limit ^ alarm);
+        alarm_with_slack = limit & ~((1ULL << bit) - 1);
+    }
+    timer->alarm = alarm_with_slack;
+    timer->slack_offset = alarm_with_slack - alarm;
+}
+
+static IRAM_ATTR void timer_program_alarm(uint64_t alarm, esp_timer_dispatch_t dispatch_method)
+{
+#if WITH_PROFILING
+    if (alarm != UINT64_MAX && alarm != s_last_programmed_alarm[dispatch_method]) {
+        s_last_programmed_alarm[dispatch_method] = alarm;
+        s_alarms_programmed[dispatch_method]++;
+    }
+#endif
+    esp_timer_impl_set_alarm_id(alarm, dispatch_method);
+}
+
+static IRAM_ATTR unsigned timer_queue(esp_timer_handle_t timer)
+{
+#ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    if (timer->flags & FL_ISR_DISPATCH_METHOD) {
+        return QUEUE_ISR;
+    }
+#endif
+    return timer->dispatch_queue;
 }
 
 static IRAM_ATTR void timer_list_lock(esp_timer_dispatch_t timer_type)
@@ -407,74 +443,163 @@ static IRAM_ATTR void timer_list_unlock(esp_timer_dispatch_t timer_type)
     portEXIT_CRITICAL_SAFE(&s_timer_lock[timer_type]);
 }
 
-#ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
-static IRAM_ATTR bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
-#else
-static bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
-#endif
+#if WITH_PROFILING
+static DISPATCH_ATTR void timer_record_lateness(unsigned queue, int64_t lateness_us)
+{
+    unsigned bucket = 0;
+    for (int64_t bound = 10; bucket < LATENESS_BUCKETS - 1 && lateness_us >= bound; bound *= 10) {
+        ++bucket;
+    }
+    s_lateness_hist[queue][bucket]++;
+}
+#endif // WITH_PROFILING
+
+/* Moves all expired timers of the dispatch method to the pending lists of their queues
+ * and sets the next alarm. Must be called with the lock of the dispatch method held.
+ * Returns a bit mask of the queues which have pending timers.
+ */
+static DISPATCH_ATTR uint32_t timer_collect_expired(esp_timer_dispatch_t dispatch_method)
 {
-    timer_list_lock(dispatch_method);
     bool processed = false;
+    uint32_t queues = 0;
+#if WITH_PROFILING
+    uint32_t expired = 0;
+#endif
     esp_timer_handle_t it;
+    int64_t now = esp_timer_impl_get_time();
     while (1) {
-        it = LIST_FIRST(&s_timers[dispatch_method]);
-        int64_t now = esp_timer_impl_get_time();
+        it = esp_timer_storage_first(dispatch_method);
         ESP_COMPILER_DIAGNOSTIC_PUSH_IGNORE("-Wanalyzer-use-after-free") // False-positive detection. TODO GCC-366
         if (it == NULL || it->alarm > now) {
             break;
         }
         ESP_COMPILER_DIAGNOSTIC_POP("-Wanalyzer-use-after-free")
         processed = true;
-        LIST_REMOVE(it, list_entry);
+        esp_timer_storage_remove(it);
+        unsigned queue = timer_queue(it);
         if (it->event_id == EVENT_ID_DELETE_TIMER) {
             // It is handled only by ESP_TIMER_TASK (see esp_timer_delete()).
             // All the ESP_TIMER_ISR timers which should be deleted are moved by esp_timer_delete() to the ESP_TIMER_TASK list.
             // We want to free memory of the timer in a task context instead of an isr context.
-            free(it);
+            if (queue == ESP_TIMER_QUEUE_DEFAULT) {
+                free(it);
+            } else {
+                // The callback of the timer may still run in the task of its queue, that task frees the timer.
+                it->alarm = 0;
+                it->pending_runs = 1;
+                TAILQ_INSERT_TAIL(&s_pending_timers[queue], it, pending_entry);
+                queues |= BIT(queue);
+            }
             it = NULL;
-        } else {
-            if (it->period > 0) {
-                int skipped = (now - it->alarm) / it->period;
-                if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) && (skipped > 1)) {
-                    it->alarm = now + it->period;
+            continue;
+        }
+        if (it->pending_runs == 0) {
+            TAILQ_INSERT_TAIL(&s_pending_timers[queue], it, pending_entry);
 #if WITH_PROFILING
-                    it->times_skipped += skipped;
+            it->pending_alarm = it->alarm - it->slack_offset;
 #endif
-                } else {
-                    it->alarm += it->period;
-                }
-                timer_insert(it, true);
-            } else {
-                it->alarm = 0;
+        }
+#if WITH_PROFILING
+        if (expired++ > 0) {
+            // dispatched on the same alarm as the previous expired timers
+            s_timers_coalesced[dispatch_method]++;
+        }
+#endif
+        queues |= BIT(queue);
+        if (it->period > 0) {
+            // the next alarm is based on the alarm time before the slack was applied
+            const uint64_t alarm = it->alarm - it->slack_offset;
+            int skipped = (now - alarm) / it->period;
+            if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) && (skipped > 1)) {
+                timer_set_alarm(it, now + it->period);
 #if WITH_PROFILING
-                timer_insert_inactive(it);
+                it->times_skipped += skipped;
 #endif
+            } else {
+                timer_set_alarm(it, alarm + it->period);
             }
+            // The timer is not in the inactive list, don't use timer_insert(). The alarm is set below.
+            esp_timer_storage_insert(it);
+        } else {
+            it->alarm = 0;
 #if WITH_PROFILING
-            uint64_t callback_start = now;
+            timer_insert_inactive(it);
 #endif
-            esp_timer_cb_t callback = it->callback;
-            void* arg = it->arg;
-            timer_list_unlock(dispatch_method);
-            (*callback)(arg);
-            timer_list_lock(dispatch_method);
+        }
+        if (it->pending_runs == UINT8_MAX || (it->pending_runs > 0 && (it->flags & FL_SKIP_UNHANDLED_EVENTS))) {
+            // the callback for the previous alarm is still pending
 #if WITH_PROFILING
-            it->times_triggered++;
-            it->total_callback_run_time += esp_timer_impl_get_time() - callback_start;
+            it->times_skipped++;
 #endif
+        } else {
+            it->pending_runs++;
         }
     } // while(1)
     if (it) {
         if (dispatch_method == ESP_TIMER_TASK || (dispatch_method != ESP_TIMER_TASK && processed == true)) {
-            esp_timer_impl_set_alarm_id(it->alarm, dispatch_method);
+            timer_program_alarm(it->alarm, dispatch_method);
         }
     } else {
         if (processed) {
-            esp_timer_impl_set_alarm_id(UINT64_MAX, dispatch_method);
+            timer_program_alarm(UINT64_MAX, dispatch_method);
+        }
+    }
+    return queues;
+}
+
+/* Executes the callbacks of the pending timers of the queue, in the order their alarms expired. */
+static DISPATCH_ATTR void timer_dispatch_pending(esp_timer_dispatch_t dispatch_method, unsigned queue)
+{
+    timer_list_lock(dispatch_method);
+    esp_timer_handle_t it;
+    while ((it = TAILQ_FIRST(&s_pending_timers[queue])) != NULL) {
+        if (--it->pending_runs == 0) {
+            TAILQ_REMOVE(&s_pending_timers[queue], it, pending_entry);
         }
+        if (it->event_id == EVENT_ID_DELETE_TIMER) {
+            // see timer_collect_expired()
+            free(it);
+            continue;
+        }
+#if WITH_PROFILING
+        int64_t callback_start = esp_timer_impl_get_time();
+        timer_record_lateness(queue, callback_start - it->pending_alarm);
+        it->pending_alarm += it->period;
+#endif
+        esp_timer_cb_t callback = it->callback;
+        void* arg = it->arg;
+        timer_list_unlock(dispatch_method);
+        (*callback)(arg);
+        timer_list_lock(dispatch_method);
+#if WITH_PROFILING
+        it->times_triggered++;
+        it->total_callback_run_time += esp_timer_impl_get_time() - callback_start;
+#endif
     }
     timer_list_unlock(dispatch_method);
-    return processed;
+}
+
+/* Collects all expired timers of the dispatch method under one lock, then executes the callbacks
+ * of the given queue. Returns true if any timer has expired.
+ */
+static DISPATCH_ATTR bool timer_process_alarm(esp_timer_dispatch_t dispatch_method, unsigned queue)
+{
+    timer_list_lock(dispatch_method);
+    uint32_t queues = timer_collect_expired(dispatch_method);
+    timer_list_unlock(dispatch_method);
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
+    // Only ESP_TIMER_TASK timers can be in the per-core queues.
+    // Wake up their tasks first, so that they don't wait for the callbacks of this queue.
+    for (unsigned q = ESP_TIMER_QUEUE_CPU0; q < ESP_TIMER_QUEUE_MAX; q++) {
+        if (queues & BIT(q)) {
+            xTaskNotifyGive(s_queue_tasks[q]);
+        }
+    }
+#endif
+    if (queues & BIT(queue)) {
+        timer_dispatch_pending(dispatch_method, queue);
+    }
+    return queues != 0;
 }
 
 static void timer_task(void* arg)
@@ -482,9 +607,20 @@ static void timer_task(void* arg)
     while (true) {
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         // all deferred events are processed at a time
-        timer_process_alarm(ESP_TIMER_TASK);
+        timer_process_alarm(ESP_TIMER_TASK, ESP_TIMER_QUEUE_DEFAULT);
+    }
+}
+
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
+static void timer_queue_task(void* arg)
+{
+    const unsigned queue = (uintptr_t) arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        timer_dispatch_pending(ESP_TIMER_TASK, queue);
     }
 }
+#endif // CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
 
 #ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
 IRAM_ATTR void esp_timer_isr_dispatch_need_yield(void)
@@ -502,7 +638,7 @@ static void IRAM_ATTR timer_alarm_handler(void* arg)
 #ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
     esp_timer_impl_try_to_set_next_alarm();
     // process timers with ISR dispatch method
-    isr_timers_processed = timer_process_alarm(ESP_TIMER_ISR);
+    isr_timers_processed = timer_process_alarm(ESP_TIMER_ISR, QUEUE_ISR);
     xHigherPriorityTaskWoken = s_isr_dispatch_need_yield;
     s_isr_dispatch_need_yield = pdFALSE;
 #endif
@@ -520,6 +656,8 @@ static IRAM_ATTR inline bool is_initialized(void)
     return s_timer_task != NULL;
 }
 
+static void deinit_timer_task(void);
+
 static esp_err_t init_timer_task(void)
 {
     esp_err_t err = ESP_OK;
@@ -527,6 +665,9 @@ static esp_err_t init_timer_task(void)
         ESP_EARLY_LOGE(TAG, "Task is already initialized");
         err = ESP_ERR_INVALID_STATE;
     } else {
+        for (unsigned queue = 0; queue < QUEUE_COUNT; queue++) {
+            TAILQ_INIT(&s_pending_timers[queue]);
+        }
         int ret = xTaskCreatePinnedToCore(
                       &timer_task, "esp_timer",
                       ESP_TASK_TIMER_STACK, NULL, ESP_TASK_TIMER_PRIO,
@@ -535,12 +676,36 @@ static esp_err_t init_timer_task(void)
             ESP_EARLY_LOGE(TAG, "Not enough memory to create timer task");
             err = ESP_ERR_NO_MEM;
         }
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
+        for (unsigned queue = ESP_TIMER_QUEUE_CPU0; err == ESP_OK && queue < ESP_TIMER_QUEUE_MAX; queue++) {
+            const BaseType_t core_id = queue - ESP_TIMER_QUEUE_CPU0;
+            char name[configMAX_TASK_NAME_LEN];
+            snprintf(name, sizeof(name), "esp_timer_cpu%d", (int) core_id);
+            ret = xTaskCreatePinnedToCore(
+                      &timer_queue_task, name,
+                      ESP_TASK_TIMER_STACK, (void*)(uintptr_t) queue, ESP_TASK_TIMER_PRIO,
+                      &s_queue_tasks[queue], core_id);
+            if (ret != pdPASS) {
+                ESP_EARLY_LOGE(TAG, "Not enough memory to create timer task");
+                err = ESP_ERR_NO_MEM;
+                deinit_timer_task();
+            }
+        }
+#endif
     }
     return err;
 }
 
 static void deinit_timer_task(void)
 {
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
+    for (unsigned queue = ESP_TIMER_QUEUE_CPU0; queue < ESP_TIMER_QUEUE_MAX; queue++) {
+        if (s_queue_tasks[queue]) {
+            vTaskDelete(s_queue_tasks[queue]);
+            s_queue_tasks[queue] = NULL;
+        }
+    }
+#endif
     if (s_timer_task) {
         vTaskDelete(s_timer_task);
         s_timer_task = NULL;
@@ -599,7 +764,12 @@ esp_err_t esp_timer_deinit(void)
 
     /* Check if there are any active timers */
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
-        if (!LIST_EMPTY(&s_timers[dispatch_method])) {
+        if (esp_timer_storage_first(dispatch_method) != NULL) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    for (unsigned queue = 0; queue < QUEUE_COUNT; queue++) {
+        if (!TAILQ_EMPTY(&s_pending_timers[queue])) {
             return ESP_ERR_INVALID_STATE;
         }
     }
@@ -643,6 +813,57 @@ static void print_timer_info(esp_timer_handle_t t, char** dst, size_t* dst_size)
     *dst_size -= cb;
 }
 
+#if WITH_PROFILING
+static void print_dispatch_stats(FILE* stream)
+{
+    uint32_t hist[QUEUE_COUNT][LATENESS_BUCKETS];
+    uint32_t alarms_programmed[ESP_TIMER_MAX];
+    uint32_t timers_coalesced[ESP_TIMER_MAX];
+
+    timer_list_lock(ESP_TIMER_TASK);
+    memcpy(hist, s_lateness_hist, ESP_TIMER_QUEUE_MAX * sizeof(hist[0]));
+    alarms_programmed[ESP_TIMER_TASK] = s_alarms_programmed[ESP_TIMER_TASK];
+    timers_coalesced[ESP_TIMER_TASK] = s_timers_coalesced[ESP_TIMER_TASK];
+    timer_list_unlock(ESP_TIMER_TASK);
+#ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    timer_list_lock(ESP_TIMER_ISR);
+    memcpy(hist[QUEUE_ISR], s_lateness_hist[QUEUE_ISR], sizeof(hist[0]));
+    alarms_programmed[ESP_TIMER_ISR] = s_alarms_programmed[ESP_TIMER_ISR];
+    timers_coalesced[ESP_TIMER_ISR] = s_timers_coalesced[ESP_TIMER_ISR];
+    timer_list_unlock(ESP_TIMER_ISR);
+#endif
+
+    fprintf(stream, "Alarms:\n");
+    fprintf(stream, "%-20s  %-12s  %-12s\n", "Dispatch", "Programmed", "Coalesced");
+    for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
+        fprintf(stream, "%-20s  %-12"PRIu32"  %-12"PRIu32"\n", dispatch_method == ESP_TIMER_TASK ? "task" : "isr",
+                alarms_programmed[dispatch_method], timers_coalesced[dispatch_method]);
+    }
+
+    fprintf(stream, "Dispatch lateness:\n");
+    fprintf(stream, "%-20s  %-10s  %-10s  %-10s  %-10s  %-10s  %-10s\n",
+            "Queue", "<10us", "<100us", "<1ms", "<10ms", "<100ms", ">=100ms");
+    for (unsigned queue = 0; queue < QUEUE_COUNT; queue++) {
+        char name[21] = "task";
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
+        if (queue >= ESP_TIMER_QUEUE_CPU0 && queue < ESP_TIMER_QUEUE_MAX) {
+            snprintf(name, sizeof(name), "task_cpu%u", queue - ESP_TIMER_QUEUE_CPU0);
+        }
+#endif
+#ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+        if (queue == QUEUE_ISR) {
+            snprintf(name, sizeof(name), "isr");
+        }
+#endif
+        fprintf(stream, "%-20s", name);
+        for (unsigned bucket = 0; bucket < LATENESS_BUCKETS; bucket++) {
+            fprintf(stream, "  %-10"PRIu32, hist[queue][bucket]);
+        }
+        fprintf(stream, "\n");
+    }
+}
+#endif // WITH_PROFILING
+
 esp_err_t esp_timer_dump(FILE* stream)
 {
     /* Since timer lock is a critical section, we don't want to print directly
@@ -657,7 +878,7 @@ esp_err_t esp_timer_dump(FILE* stream)
     size_t timer_count = 0;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
+        for (it = esp_timer_storage_first(dispatch_method); it != NULL; it = esp_timer_storage_next(it)) {
             ++timer_count;
         }
 #if WITH_PROFILING
@@ -683,7 +904,7 @@ esp_err_t esp_timer_dump(FILE* stream)
     char* pos = print_buf;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
+        for (it = esp_timer_storage_first(dispatch_method); it != NULL; it = esp_timer_storage_next(it)) {
             print_timer_info(it, &pos, &buf_size);
         }
 #if WITH_PROFILING
@@ -705,6 +926,9 @@ esp_err_t esp_timer_dump(FILE* stream)
 
         /* Print the buffer */
         fputs(print_buf, stream);
+#if WITH_PROFILING
+        print_dispatch_stats(stream);
+#endif
     }
 
     free(print_buf);
@@ -716,7 +940,7 @@ int64_t IRAM_ATTR esp_timer_get_next_alarm(void)
     int64_t next_alarm = INT64_MAX;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        esp_timer_handle_t it = LIST_FIRST(&s_timers[dispatch_method]);
+        esp_timer_handle_t it = esp_timer_storage_first(dispatch_method);
         if (it) {
             if (next_alarm > it->alarm) {
                 next_alarm = it->alarm;
@@ -732,14 +956,11 @@ int64_t IRAM_ATTR esp_timer_get_next_alarm_for_wake_up(void)
     int64_t next_alarm = INT64_MAX;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        esp_timer_handle_t it = NULL;
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            // timers with the SKIP_UNHANDLED_EVENTS flag do not want to wake up CPU from a sleep mode.
-            if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
-                if (next_alarm > it->alarm) {
-                    next_alarm = it->alarm;
-                }
-                break;
+        // timers with the SKIP_UNHANDLED_EVENTS flag do not want to wake up CPU from a sleep mode.
+        esp_timer_handle_t it = esp_timer_storage_first_wakeup(dispatch_method);
+        if (it) {
+            if (next_alarm > it->alarm) {
+                next_alarm = it->alarm;
             }
         }
         timer_list_unlock(dispatch_method);
@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Armed timers are kept in a pairing heap per dispatch method. The heap is
+ * stored in the timers themselves: every timer points to its first child,
+ * its next sibling and its previous sibling (or its parent, if it is the first
+ * child). No memory is allocated when arming a timer.
+ *
+ * - Arming a timer melds it with the root: O(1).
+ * - Removing a timer detaches its subtree, merges the children of the timer
+ *   pairwise and melds the result with the root: O(log n) amortized.
+ */
+
+#include <stddef.h>
+#include "esp_attr.h"
+#include "esp_timer_storage.h"
+
+// roots of the heaps of currently armed timers for two dispatch methods: ISR and TASK
+static esp_timer_handle_t s_heap_root[ESP_TIMER_MAX];
+// sequence number given to the next armed timer, to keep timers with equal alarm time in FIFO order
+static uint32_t s_heap_seq[ESP_TIMER_MAX];
+
+static IRAM_ATTR bool timer_before(esp_timer_handle_t a, esp_timer_handle_t b)
+{
+    if (a->alarm != b->alarm) {
+        return a->alarm < b->alarm;
+    }
+    return (int32_t)(a->heap_seq - b->heap_seq) < 0;
+}
+
+/* Meld two heaps. Both roots must not have siblings. Returns the new root. */
+static IRAM_ATTR esp_timer_handle_t heap_meld(esp_timer_handle_t a, esp_timer_handle_t b)
+{
+    if (a == NULL) {
+        return b;
+    }
+    if (b == NULL) {
+        return a;
+    }
+    if (timer_before(b, a)) {
+        esp_timer_handle_t tmp = a;
+        a = b;
+        b = tmp;
+    }
+    // b becomes the first child of a
+    b->heap_prev = a;
+    b->heap_next = a->heap_child;
+    if (a->heap_child) {
+        a->heap_child->heap_prev = b;
+    }
+    a->heap_child = b;
+    return a;
+}
+
+/* Merge a list of siblings into a single heap (two-pass pairing). Returns the new root. */
+static IRAM_ATTR esp_timer_handle_t heap_merge_pairs(esp_timer_handle_t first)
+{
+    // First pass, left to right: meld pairs of siblings. The results are linked in reverse order via heap_next.
+    esp_timer_handle_t pairs = NULL;
+    while (first) {
+        esp_timer_handle_t a = first;
+        esp_timer_handle_t b = a->heap_next;
+        first = b ? b->heap_next : NULL;
+        a->heap_prev = a->heap_next = NULL;
+        if (b) {
+            b->heap_prev = b->heap_next = NULL;
+        }
+        a = heap_meld(a, b);
+        a->heap_next = pairs;
+        pairs = a;
+    }
+    // Second pass, right to left: meld all pairs into one heap
+    esp_timer_handle_t root = NULL;
+    while (pairs) {
+        esp_timer_handle_t next = pairs->heap_next;
+        pairs->heap_next = NULL;
+        root = heap_meld(root, pairs);
+        pairs = next;
+    }
+    return root;
+}
+
+/* Pre-order traversal of a heap. Children of the timer are skipped if descend is false. */
+static IRAM_ATTR esp_timer_handle_t heap_next(esp_timer_handle_t timer, bool descend)
+{
+    if (descend && timer->heap_child) {
+        return timer->heap_child;
+    }
+    while (timer) {
+        if (timer->heap_next) {
+            return timer->heap_next;
+        }
+        // Go back to the first sibling, its heap_prev is the parent
+        while (timer->heap_prev && timer->heap_prev->heap_child != timer) {
+            timer = timer->heap_prev;
+        }
+        timer = timer->heap_prev;
+    }
+    return NULL;
+}
+
+IRAM_ATTR esp_timer_handle_t esp_timer_storage_first(esp_timer_dispatch_t dispatch_method)
+{
+    return s_heap_root[dispatch_method];
+}
+
+IRAM_ATTR void esp_timer_storage_insert(esp_timer_handle_t timer)
+{
+    esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
+    timer->heap_child = NULL;
+    timer->heap_next = NULL;
+    timer->heap_prev = NULL;
+    timer->heap_seq = s_heap_seq[dispatch_method]++;
+    s_heap_root[dispatch_method] = heap_meld(s_heap_root[dispatch_method], timer);
+}
+
+IRAM_ATTR void esp_timer_storage_remove(esp_timer_handle_t timer)
+{
+    esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
+    esp_timer_handle_t children = heap_merge_pairs(timer->heap_child);
+    if (timer == s_heap_root[dispatch_method]) {
+        s_heap_root[dispatch_method] = children;
+    } else {
+        // Unlink the subtree of the timer from its parent or previous sibling
+        if (timer->heap_prev->heap_child == timer) {
+            timer->heap_prev->heap_child = timer->heap_next;
+        } else {
+            timer->heap_prev->heap_next = timer->heap_next;
+        }
+        if (timer->heap_next) {
+            timer->heap_next->heap_prev = timer->heap_prev;
+        }
+        s_heap_root[dispatch_method] = heap_meld(s_heap_root[dispatch_method], children);
+    }
+    timer->heap_child = NULL;
+    timer->heap_next = NULL;
+    timer->heap_prev = NULL;
+}
+
+IRAM_ATTR esp_timer_handle_t esp_timer_storage_next(esp_timer_handle_t timer)
+{
+    return heap_next(timer, true);
+}
+
+IRAM_ATTR esp_timer_handle_t esp_timer_storage_first_wakeup(esp_timer_dispatch_t dispatch_method)
+{
+    esp_timer_handle_t best = NULL;
+    esp_timer_handle_t it = s_heap_root[dispatch_method];
+    while (it) {
+        // Timers in the subtree of a timer are never earlier than the timer itself, so the
+        // subtree only has to be searched if the timer is earlier than the best timer so far
+        // but skips unhandled events (i.e. does not want to wake up the CPU from a sleep mode).
+        bool descend = false;
+        if (best == NULL || it->alarm < best->alarm) {
+            if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
+                best = it;
+            } else {
+                descend = true;
+            }
+        }
+        it = heap_next(it, descend);
+    }
+    return best;
+}
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2017-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <assert.h>
+#include "esp_attr.h"
+#include "esp_timer_storage.h"
+
+// lists of currently armed timers for two dispatch methods: ISR and TASK, sorted by alarm time
+static LIST_HEAD(esp_timer_list, esp_timer) s_timers[ESP_TIMER_MAX] = {
+    [0 ...(ESP_TIMER_MAX - 1)] = LIST_HEAD_INITIALIZER(s_timers)
+};
+
+IRAM_ATTR esp_timer_handle_t esp_timer_storage_first(esp_timer_dispatch_t dispatch_method)
+{
+    return LIST_FIRST(&s_timers[dispatch_method]);
+}
+
+IRAM_ATTR void esp_timer_storage_insert(esp_timer_handle_t timer)
+{
+    esp_timer_handle_t it, last = NULL;
+    esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
+    if (LIST_FIRST(&s_timers[dispatch_method]) == NULL) {
+        LIST_INSERT_HEAD(&s_timers[dispatch_method], timer, list_entry);
+    } else {
+        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
+            if (timer->alarm < it->alarm) {
+                LIST_INSERT_BEFORE(it, timer, list_entry);
+                break;
+            }
+            last = it;
+        }
+        if (it == NULL) {
+            assert(last);
+            LIST_INSERT_AFTER(last, timer, list_entry);
+        }
+    }
+}
+
+IRAM_ATTR void esp_timer_storage_remove(esp_timer_handle_t timer)
+{
+    LIST_REMOVE(timer, list_entry);
+}
+
+IRAM_ATTR esp_timer_handle_t esp_timer_storage_next(esp_timer_handle_t timer)
+{
+    return LIST_NEXT(timer, list_entry);
+}
+
+IRAM_ATTR esp_timer_handle_t esp_timer_storage_first_wakeup(esp_timer_dispatch_t dispatch_method)
+{
+    esp_timer_handle_t it;
+    LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
+        // timers with the SKIP_UNHANDLED_EVENTS flag do not want to wake up CPU from a sleep mode.
+        if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
+            break;
+        }
+    }
+    return it;
+}
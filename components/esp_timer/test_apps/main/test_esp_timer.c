@@ -69,8 +69,15 @@ TEST_CASE("esp_timer orders timers correctly", "[esp_timer]")
 #if WITH_PROFILING
         int timer_id;
         sscanf(line, "timer%d", &timer_id);
-        TEST_ASSERT_EQUAL(indices[timer_id], i);
+#if CONFIG_ESP_TIMER_STORAGE_HEAP
+        // the heap does not dump timers in order, only check that each timer is dumped once
+        TEST_ASSERT_LESS_THAN(num_timers, timer_id);
+        TEST_ASSERT_NOT_EQUAL(SIZE_MAX, indices[timer_id]);
+        indices[timer_id] = SIZE_MAX;
 #else
+        TEST_ASSERT_EQUAL(indices[timer_id], i);
+#endif
+#elif !CONFIG_ESP_TIMER_STORAGE_HEAP
         intptr_t timer_ptr;
         sscanf(line, "timer@0x%x", &timer_ptr);
         for (size_t j = 0; j < num_timers; ++j) {
@@ -1299,3 +1306,115 @@ TEST_CASE("Test ISR dispatch callbacks are not blocked even if TASK callbacks ta
 }
 
 #endif // CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+
+typedef struct {
+    uint64_t earliest;      // timeout after the time before esp_timer_start_once
+    uint64_t latest;        // timeout and slack after the time esp_timer_start_once returned
+    uint64_t dispatched;
+} test_slack_args_t;
+
+static void test_slack_cb(void *arg)
+{
+    test_slack_args_t* args = (test_slack_args_t*) arg;
+    args->dispatched = esp_timer_get_time();
+}
+
+TEST_CASE("esp_timer slack lets timers share an alarm", "[esp_timer]")
+{
+    const int num_timers = 10;
+    const uint32_t timeout_us = 5000;
+    const uint32_t slack_us = 20000;
+    esp_timer_handle_t timers[num_timers];
+    test_slack_args_t args[num_timers];
+    uint64_t expiry[num_timers];
+
+    for (int i = 0; i < num_timers; ++i) {
+        const esp_timer_create_args_t create_args = {
+            .callback = &test_slack_cb,
+            .arg = &args[i],
+            .name = "slack",
+            .slack_us = slack_us,
+        };
+        TEST_ESP_OK(esp_timer_create(&create_args, &timers[i]));
+    }
+    for (int i = 0; i < num_timers; ++i) {
+        // the task can be preempted around the call, so the expiry is only known within a range
+        args[i].dispatched = 0;
+        args[i].earliest = esp_timer_get_time() + timeout_us;
+        TEST_ESP_OK(esp_timer_start_once(timers[i], timeout_us));
+        args[i].latest = esp_timer_get_time() + timeout_us + slack_us;
+        TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &expiry[i]));
+        TEST_ASSERT_GREATER_OR_EQUAL(args[i].earliest, expiry[i]);
+        TEST_ASSERT_LESS_OR_EQUAL(args[i].latest, expiry[i]);
+    }
+    // the windows of all timers overlap, they get at most a few different alarm times
+    int different_alarms = 1;
+    for (int i = 1; i < num_timers; ++i) {
+        if (expiry[i] != expiry[i - 1]) {
+            ++different_alarms;
+        }
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(2, different_alarms);
+
+    vTaskDelay((timeout_us + slack_us) / 1000 / portTICK_PERIOD_MS + 10);
+    for (int i = 0; i < num_timers; ++i) {
+        TEST_ASSERT_NOT_EQUAL(0, args[i].dispatched);
+        TEST_ASSERT_GREATER_OR_EQUAL(args[i].earliest, args[i].dispatched);
+        TEST_ASSERT_LESS_OR_EQUAL(args[i].latest + 1000, args[i].dispatched);
+    }
+    TEST_ESP_OK(esp_timer_dump(stdout));
+    for (int i = 0; i < num_timers; ++i) {
+        TEST_ESP_OK(esp_timer_delete(timers[i]));
+    }
+    vTaskDelay(3); // wait for the esp_timer task to delete all timers
+}
+
+#if CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
+static void slow_queue_cb(void *arg)
+{
+    vTaskDelay(100 / portTICK_PERIOD_MS);  // very long callback, blocks its dispatch queue
+}
+
+static void fast_queue_cb(void *arg)
+{
+    int* count = (int*) arg;
+    (*count)++;
+}
+
+TEST_CASE("Slow callback does not delay timers in other dispatch queues", "[esp_timer]")
+{
+    int fast_count = 0;
+    esp_timer_handle_t slow_timer;
+    esp_timer_handle_t fast_timer;
+
+    const esp_timer_create_args_t slow_timer_args = {
+        .callback = &slow_queue_cb,
+        .name = "slow_timer",
+    };
+    const esp_timer_create_args_t fast_timer_args = {
+        .callback = &fast_queue_cb,
+        .arg = &fast_count,
+        .name = "fast_timer",
+        .dispatch_queue = ESP_TIMER_QUEUE_CPU0,
+    };
+    esp_timer_create_args_t bad_args = fast_timer_args;
+    bad_args.dispatch_queue = ESP_TIMER_QUEUE_MAX;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_timer_create(&bad_args, &fast_timer));
+
+    TEST_ESP_OK(esp_timer_create(&slow_timer_args, &slow_timer));
+    TEST_ESP_OK(esp_timer_create(&fast_timer_args, &fast_timer));
+    TEST_ESP_OK(esp_timer_start_periodic(slow_timer, 10000));
+    TEST_ESP_OK(esp_timer_start_periodic(fast_timer, 10000));
+
+    vTaskDelay(500 / portTICK_PERIOD_MS);
+
+    TEST_ESP_OK(esp_timer_stop(slow_timer));
+    TEST_ESP_OK(esp_timer_stop(fast_timer));
+    TEST_ESP_OK(esp_timer_dump(stdout));
+    // the fast timer runs every 10 ms, although the esp_timer task is blocked by the slow callback most of the time
+    TEST_ASSERT_INT_WITHIN(5, 50, fast_count);
+    TEST_ESP_OK(esp_timer_delete(slow_timer));
+    TEST_ESP_OK(esp_timer_delete(fast_timer));
+    vTaskDelay(3); // wait for the esp_timer tasks to delete all timers
+}
+#endif // CONFIG_ESP_TIMER_PER_CORE_DISPATCH_TASKS
@@ -6,6 +6,7 @@ from pytest_embedded import Dut
 CONFIGS = [
     pytest.param('general', marks=[pytest.mark.supported_targets]),
     pytest.param('release', marks=[pytest.mark.supported_targets]),
+    pytest.param('storage_heap', marks=[pytest.mark.supported_targets]),
     pytest.param('single_core', marks=[pytest.mark.esp32]),
     pytest.param('freertos_compliance', marks=[pytest.mark.esp32]),
     pytest.param('isr_dispatch_esp32', marks=[pytest.mark.esp32]),
@@ -14,6 +15,7 @@ CONFIGS = [
     pytest.param('any_cpu_esp32', marks=[pytest.mark.esp32]),
     pytest.param('cpu1_esp32s3', marks=[pytest.mark.esp32s3]),
     pytest.param('any_cpu_esp32s3', marks=[pytest.mark.esp32s3]),
+    pytest.param('per_core_dispatch_esp32', marks=[pytest.mark.esp32]),
 ]
 
 
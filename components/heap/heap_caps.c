@@ -262,6 +262,17 @@ HEAP_IRAM_ATTR void *heap_caps_calloc( size_t n, size_t size, uint32_t caps)
     return ptr;
 }
 
+/*
+Blocks held by the per-core caches of small allocations are free memory to the application.
+Return them to their heaps before reporting the free memory of the heaps or walking their blocks.
+*/
+static inline void flush_per_core_cache(void)
+{
+#if CONFIG_HEAP_PER_CORE_CACHE
+    heap_caps_cache_flush();
+#endif
+}
+
 size_t heap_caps_get_total_size(uint32_t caps)
 {
     size_t total_size = 0;
@@ -278,6 +289,7 @@ size_t heap_caps_get_free_size( uint32_t caps )
 {
     size_t ret = 0;
     heap_t *heap;
+    flush_per_core_cache();
     SLIST_FOREACH(heap, &registered_heaps, next) {
         if (heap_caps_match(heap, caps)) {
             ret += multi_heap_free_size(heap->heap);
@@ -367,6 +379,7 @@ esp_err_t heap_caps_monitor_local_minimum_free_size_stop(void)
 void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps )
 {
     memset(info, 0, sizeof(multi_heap_info_t));
+    flush_per_core_cache();
 
     heap_t *heap;
     SLIST_FOREACH(heap, &registered_heaps, next) {
@@ -392,6 +405,7 @@ void heap_caps_print_heap_info( uint32_t caps )
 {
     multi_heap_info_t info;
     printf("Heap summary for capabilities 0x%08"PRIX32":\n", caps);
+    flush_per_core_cache();
     heap_t *heap;
     SLIST_FOREACH(heap, &registered_heaps, next) {
         if (heap_caps_match(heap, caps)) {
@@ -590,6 +604,7 @@ void heap_caps_walk(uint32_t caps, heap_caps_walker_cb_t walker_func, void *user
 
     bool all_heaps = caps & MALLOC_CAP_INVALID;
     heap_t *heap;
+    flush_per_core_cache();
     SLIST_FOREACH(heap, &registered_heaps, next) {
         if (heap->heap != NULL
             && (all_heaps || (get_all_caps(heap) & caps) == caps)) {
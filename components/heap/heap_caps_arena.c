@@ -0,0 +1,196 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Arena allocator on top of heap_caps_malloc().
+ *
+ * An arena is a list of chunks allocated with heap_caps_malloc(). Allocations
+ * advance a pointer in the current chunk; when it is full, a new chunk becomes
+ * the current one. Allocations bigger than half a chunk which don't fit get a
+ * chunk of their own, so that the rest of the current chunk isn't wasted.
+ *
+ * The arena structure is stored in its first chunk, behind the chunk header.
+ * Resetting the arena frees all other chunks.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/param.h>
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_arena.h"
+
+#define ARENA_ALIGNMENT 8
+#define ARENA_ALIGN_UP(x) (((x) + ARENA_ALIGNMENT - 1) & ~(uintptr_t)(ARENA_ALIGNMENT - 1))
+
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t size;                    // size of the chunk, including this header
+} arena_chunk_t;
+
+struct heap_caps_arena {
+    arena_chunk_t *chunks;          // all chunks, the current one first
+    uint8_t *ptr;                   // next free byte in the current chunk
+    uint8_t *end;                   // end of the current chunk
+    size_t chunk_size;
+    uint32_t caps;
+    size_t total_size;
+    size_t total_allocated_bytes;
+    size_t peak_allocated_bytes;
+    size_t allocated_blocks;
+    size_t chunks_count;
+};
+
+#define CHUNK_HEADER_SIZE ARENA_ALIGN_UP(sizeof(arena_chunk_t))
+#define ARENA_HEADER_SIZE ARENA_ALIGN_UP(sizeof(struct heap_caps_arena))
+// heap_caps_malloc() aligns to at least 4 bytes, the data of a chunk may need this much padding
+#define CHUNK_MAX_PADDING (ARENA_ALIGNMENT - 4)
+
+static arena_chunk_t *first_chunk(heap_caps_arena_handle_t arena)
+{
+    return (arena_chunk_t *)((uint8_t *)arena - CHUNK_HEADER_SIZE);
+}
+
+static arena_chunk_t *alloc_chunk(heap_caps_arena_handle_t arena, size_t size)
+{
+    arena_chunk_t *chunk = heap_caps_malloc(size, arena->caps);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->size = size;
+    arena->total_size += size;
+    arena->chunks_count++;
+    return chunk;
+}
+
+heap_caps_arena_handle_t heap_caps_arena_create(size_t initial_size, uint32_t caps)
+{
+    const size_t min_size = CHUNK_HEADER_SIZE + ARENA_HEADER_SIZE + CHUNK_MAX_PADDING + ARENA_ALIGNMENT;
+    if (initial_size < min_size) {
+        initial_size = min_size;
+    }
+
+    arena_chunk_t *chunk = heap_caps_malloc(initial_size, caps);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->size = initial_size;
+
+    // Chunks are at least 4-byte aligned, the arena structure doesn't need more
+    heap_caps_arena_handle_t arena = (heap_caps_arena_handle_t)((uint8_t *)chunk + CHUNK_HEADER_SIZE);
+    *arena = (struct heap_caps_arena) {
+        .chunks = chunk,
+        .ptr = (uint8_t *)arena + ARENA_HEADER_SIZE,
+        .end = (uint8_t *)chunk + initial_size,
+        .chunk_size = initial_size,
+        .caps = caps,
+        .total_size = initial_size,
+        .chunks_count = 1,
+    };
+    return arena;
+}
+
+void *heap_caps_arena_alloc(heap_caps_arena_handle_t arena, size_t size)
+{
+    if (size == 0 || size > SIZE_MAX - CHUNK_HEADER_SIZE - CHUNK_MAX_PADDING) {
+        return NULL;
+    }
+
+    uint8_t *ret = (uint8_t *)ARENA_ALIGN_UP((uintptr_t)arena->ptr);
+    if (ret > arena->end || size > (size_t)(arena->end - ret)) {
+        const size_t needed = CHUNK_HEADER_SIZE + CHUNK_MAX_PADDING + size;
+        if (needed > arena->chunk_size / 2) {
+            // Allocations this big get a chunk of their own, behind the current chunk
+            arena_chunk_t *chunk = alloc_chunk(arena, needed);
+            if (chunk == NULL) {
+                return NULL;
+            }
+            chunk->next = arena->chunks->next;
+            arena->chunks->next = chunk;
+            ret = (uint8_t *)ARENA_ALIGN_UP((uintptr_t)chunk + CHUNK_HEADER_SIZE);
+            arena->total_allocated_bytes += size;
+        } else {
+            arena_chunk_t *chunk = alloc_chunk(arena, arena->chunk_size);
+            if (chunk == NULL) {
+                return NULL;
+            }
+            chunk->next = arena->chunks;
+            arena->chunks = chunk;
+            arena->end = (uint8_t *)chunk + chunk->size;
+            ret = (uint8_t *)ARENA_ALIGN_UP((uintptr_t)chunk + CHUNK_HEADER_SIZE);
+            arena->ptr = ret + size;
+            arena->total_allocated_bytes += size;
+        }
+    } else {
+        arena->total_allocated_bytes += (ret - arena->ptr) + size;
+        arena->ptr = ret + size;
+    }
+
+    arena->allocated_blocks++;
+    arena->peak_allocated_bytes = MAX(arena->peak_allocated_bytes, arena->total_allocated_bytes);
+    return ret;
+}
+
+void *heap_caps_arena_calloc(heap_caps_arena_handle_t arena, size_t n, size_t size)
+{
+    size_t size_bytes;
+
+    if (__builtin_mul_overflow(n, size, &size_bytes)) {
+        return NULL;
+    }
+
+    void *ret = heap_caps_arena_alloc(arena, size_bytes);
+    if (ret != NULL) {
+        memset(ret, 0, size_bytes);
+    }
+    return ret;
+}
+
+void heap_caps_arena_reset(heap_caps_arena_handle_t arena)
+{
+    arena_chunk_t *first = first_chunk(arena);
+    arena_chunk_t *chunk = arena->chunks;
+
+    while (chunk != NULL) {
+        arena_chunk_t *next = chunk->next;
+        if (chunk != first) {
+            heap_caps_free(chunk);
+        }
+        chunk = next;
+    }
+    first->next = NULL;
+
+    arena->chunks = first;
+    arena->ptr = (uint8_t *)arena + ARENA_HEADER_SIZE;
+    arena->end = (uint8_t *)first + first->size;
+    arena->total_size = first->size;
+    arena->total_allocated_bytes = 0;
+    arena->allocated_blocks = 0;
+    arena->chunks_count = 1;
+}
+
+void heap_caps_arena_destroy(heap_caps_arena_handle_t arena)
+{
+    if (arena == NULL) {
+        return;
+    }
+    heap_caps_arena_reset(arena);
+    heap_caps_free(first_chunk(arena));
+}
+
+void heap_caps_arena_get_info(heap_caps_arena_handle_t arena, heap_caps_arena_info_t *info)
+{
+    const uint8_t *next = (const uint8_t *)ARENA_ALIGN_UP((uintptr_t)arena->ptr);
+
+    *info = (heap_caps_arena_info_t) {
+        .total_size = arena->total_size,
+        .total_allocated_bytes = arena->total_allocated_bytes,
+        .total_free_bytes = next < arena->end ? arena->end - next : 0,
+        .peak_allocated_bytes = arena->peak_allocated_bytes,
+        .allocated_blocks = arena->allocated_blocks,
+        .chunks = arena->chunks_count,
+    };
+}
@@ -57,7 +57,8 @@ HEAP_IRAM_ATTR void heap_caps_free( void *ptr)
         return;
     }
 
-    if (esp_ptr_in_diram_iram(ptr)) {
+    bool iram_alias = esp_ptr_in_diram_iram(ptr);
+    if (iram_alias) {
         //Memory allocated here is actually allocated in the DRAM alias region and
         //cannot be de-allocated as usual. dram_alloc_to_iram_addr stores a pointer to
         //the equivalent DRAM address, though; free that.
@@ -67,6 +68,14 @@ HEAP_IRAM_ATTR void heap_caps_free( void *ptr)
     void *block_owner_ptr = MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr);
     heap_t *heap = find_containing_heap(block_owner_ptr);
     assert(heap != NULL && "free() target pointer is outside heap areas");
+#if CONFIG_HEAP_PER_CORE_CACHE
+    if (!iram_alias && heap_caps_cache_free(heap, ptr)) {
+        CALL_HOOK(esp_heap_trace_free_hook, ptr);
+        return;
+    }
+#else
+    (void)iram_alias;
+#endif
     multi_heap_free(heap->heap, block_owner_ptr);
 
     CALL_HOOK(esp_heap_trace_free_hook, ptr);
@@ -80,6 +89,194 @@ HEAP_IRAM_ATTR static inline void *aligned_or_unaligned_alloc(multi_heap_handle_
     }
 }
 
+/* Number of caps masks in the lookup table */
+#define HEAP_CAPS_LOOKUP_ENTRIES 8
+
+/* Caps masks of malloc() and of other common allocations, added to the lookup table when it is rebuilt */
+static const uint32_t s_lookup_common_caps[] = {
+    MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL,
+    MALLOC_CAP_DEFAULT | MALLOC_CAP_SPIRAM,
+    MALLOC_CAP_DEFAULT,
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+};
+
+/* Entries are only appended while the generation stays the same, so the first
+   s_lookup_count entries can be searched without taking the lock. */
+static heap_caps_lookup_t s_lookup[HEAP_CAPS_LOOKUP_ENTRIES];
+static uint32_t s_lookup_count;
+static uint32_t s_lookup_generation;
+static multi_heap_lock_t s_lookup_lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER;
+
+/* Fill a lookup table entry with the heaps which can serve caps, in the order of
+   their priority for caps. A heap having the caps at several priorities is only
+   added for the first one. */
+HEAP_IRAM_ATTR static void build_lookup_entry(heap_caps_lookup_t *entry, uint32_t caps)
+{
+    uint32_t num_heaps = 0;
+
+    for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS && num_heaps != UINT32_MAX; prio++) {
+        heap_t *heap;
+        SLIST_FOREACH(heap, &registered_heaps, next) {
+            //Heap has at least one of the caps requested at this prio, and all of them at some prio
+            if ((heap->caps[prio] & caps) == 0 || (get_all_caps(heap) & caps) != caps) {
+                continue;
+            }
+            bool added = false;
+            for (uint32_t i = 0; i < num_heaps; i++) {
+                added |= (entry->heaps[i] == heap);
+            }
+            if (added) {
+                continue;
+            }
+            if (num_heaps == HEAP_CAPS_LOOKUP_MAX_HEAPS) {
+                num_heaps = UINT32_MAX;
+                break;
+            }
+            entry->heaps[num_heaps++] = heap;
+        }
+    }
+    entry->caps = caps;
+    entry->num_heaps = num_heaps;
+}
+
+HEAP_IRAM_ATTR const heap_caps_lookup_t *heap_caps_lookup(uint32_t caps, uint32_t *generation)
+{
+    const heap_caps_lookup_t *entry = NULL;
+    *generation = __atomic_load_n(&s_lookup_generation, __ATOMIC_ACQUIRE);
+    uint32_t count = __atomic_load_n(&s_lookup_count, __ATOMIC_ACQUIRE);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (s_lookup[i].caps == caps) {
+            entry = &s_lookup[i];
+            break;
+        }
+    }
+
+    if (entry == NULL && count < HEAP_CAPS_LOOKUP_ENTRIES) {
+        MULTI_HEAP_LOCK(&s_lookup_lock);
+        if (s_lookup_generation == *generation) {
+            //Another core may have added the caps meanwhile
+            for (; count < s_lookup_count && entry == NULL; count++) {
+                if (s_lookup[count].caps == caps) {
+                    entry = &s_lookup[count];
+                }
+            }
+            if (entry == NULL && count < HEAP_CAPS_LOOKUP_ENTRIES) {
+                heap_caps_lookup_t *new_entry = &s_lookup[count];
+                build_lookup_entry(new_entry, caps);
+                __atomic_store_n(&s_lookup_count, count + 1, __ATOMIC_RELEASE);
+                entry = new_entry;
+            }
+        }
+        MULTI_HEAP_UNLOCK(&s_lookup_lock);
+    }
+
+    if (entry == NULL || entry->num_heaps == UINT32_MAX) {
+        return NULL;
+    }
+    return entry;
+}
+
+HEAP_IRAM_ATTR uint32_t heap_caps_lookup_generation(void)
+{
+    return __atomic_load_n(&s_lookup_generation, __ATOMIC_ACQUIRE);
+}
+
+void heap_caps_lookup_reset(void)
+{
+    MULTI_HEAP_LOCK(&s_lookup_lock);
+    __atomic_store_n(&s_lookup_count, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_lookup_generation, s_lookup_generation + 1, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < sizeof(s_lookup_common_caps) / sizeof(s_lookup_common_caps[0]); i++) {
+        build_lookup_entry(&s_lookup[i], s_lookup_common_caps[i]);
+    }
+    __atomic_store_n(&s_lookup_count, sizeof(s_lookup_common_caps) / sizeof(s_lookup_common_caps[0]), __ATOMIC_RELEASE);
+    MULTI_HEAP_UNLOCK(&s_lookup_lock);
+}
+
+/* Allocate from a heap which has all of the requested caps */
+HEAP_IRAM_ATTR static void *aligned_alloc_from_heap(heap_t *heap, size_t alignment, size_t size, uint32_t caps)
+{
+    void *ret = NULL;
+
+    // If MALLOC_CAP_EXEC is requested but the DRAM and IRAM are on the same addresses (like on esp32c6)
+    // proceed as for a default allocation.
+    if ((caps & MALLOC_CAP_EXEC) && !esp_dram_match_iram() && esp_ptr_in_diram_dram((void *)heap->start)) {
+        //This is special, insofar that what we're going to get back is a DRAM address. If so,
+        //we need to 'invert' it (lowest address in DRAM == highest address in IRAM and vice-versa) and
+        //add a pointer to the DRAM equivalent before the address we're going to return.
+        ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size) + 4,
+                                        alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());  // int overflow checked above
+        if (ret != NULL) {
+            MULTI_HEAP_SET_BLOCK_OWNER(ret);
+            ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
+            uint32_t *iptr = dram_alloc_to_iram_addr(ret, size + 4);  // int overflow checked above
+            CALL_HOOK(esp_heap_trace_alloc_hook, iptr, size, caps);
+            return iptr;
+        }
+    } else {
+        //Just try to alloc, nothing special.
+        ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size),
+                                        alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());
+        if (ret != NULL) {
+            MULTI_HEAP_SET_BLOCK_OWNER(ret);
+            ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
+            CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
+            return ret;
+        }
+    }
+    return NULL;
+}
+
+/* Allocate from the first heap, in order of priority, that has the requested caps */
+HEAP_IRAM_ATTR static void *aligned_alloc_from_heaps(size_t alignment, size_t size, uint32_t caps)
+{
+    void *ret = NULL;
+    uint32_t generation;
+
+    const heap_caps_lookup_t *lookup = heap_caps_lookup(caps, &generation);
+    if (lookup != NULL) {
+        for (uint32_t i = 0; i < lookup->num_heaps && i < HEAP_CAPS_LOOKUP_MAX_HEAPS; i++) {
+            heap_t *heap = lookup->heaps[i];
+            //The entry may be rebuilt while we use it, only allocate from heaps which really have the caps
+            if (heap != NULL && (get_all_caps(heap) & caps) == caps) {
+                ret = aligned_alloc_from_heap(heap, alignment, size, caps);
+                if (ret != NULL) {
+                    return ret;
+                }
+            }
+        }
+        if (heap_caps_lookup_generation() == generation) {
+            return NULL;
+        }
+        //Heaps were registered meanwhile, search all of them.
+    }
+
+    for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS; prio++) {
+        //Iterate over heaps and check capabilities at this priority
+        heap_t *heap;
+        SLIST_FOREACH(heap, &registered_heaps, next) {
+            if (heap->heap == NULL) {
+                continue;
+            }
+            if ((heap->caps[prio] & caps) != 0) {
+                //Heap has at least one of the caps requested. If caps has other bits set that this prio
+                //doesn't cover, see if they're available in other prios.
+                if ((get_all_caps(heap) & caps) == caps) {
+                    //This heap can satisfy all the requested capabilities. See if we can grab some memory using it.
+                    ret = aligned_alloc_from_heap(heap, alignment, size, caps);
+                    if (ret != NULL) {
+                        return ret;
+                    }
+                }
+            }
+        }
+    }
+
+    //Nothing usable found.
+    return NULL;
+}
+
 /*
 This function should not be called directly as it does not check for failure / call heap_caps_alloc_failed()
 Note that this function does 'unaligned' alloc calls if alignment <= UNALIGNED_MEM_ALIGNMENT_BYTES (=4) as the
@@ -118,51 +315,26 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
         size = (size + 3) & (~3); // int overflow checked above
     }
 
-    for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS; prio++) {
-        //Iterate over heaps and check capabilities at this priority
-        heap_t *heap;
-        SLIST_FOREACH(heap, &registered_heaps, next) {
-            if (heap->heap == NULL) {
-                continue;
-            }
-            if ((heap->caps[prio] & caps) != 0) {
-                //Heap has at least one of the caps requested. If caps has other bits set that this prio
-                //doesn't cover, see if they're available in other prios.
-                if ((get_all_caps(heap) & caps) == caps) {
-                    //This heap can satisfy all the requested capabilities. See if we can grab some memory using it.
-                    // If MALLOC_CAP_EXEC is requested but the DRAM and IRAM are on the same addresses (like on esp32c6)
-                    // proceed as for a default allocation.
-                    if ((caps & MALLOC_CAP_EXEC) && !esp_dram_match_iram() && esp_ptr_in_diram_dram((void *)heap->start)) {
-                        //This is special, insofar that what we're going to get back is a DRAM address. If so,
-                        //we need to 'invert' it (lowest address in DRAM == highest address in IRAM and vice-versa) and
-                        //add a pointer to the DRAM equivalent before the address we're going to return.
-                        ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size) + 4,
-                                                        alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());  // int overflow checked above
-                        if (ret != NULL) {
-                            MULTI_HEAP_SET_BLOCK_OWNER(ret);
-                            ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
-                            uint32_t *iptr = dram_alloc_to_iram_addr(ret, size + 4);  // int overflow checked above
-                            CALL_HOOK(esp_heap_trace_alloc_hook, iptr, size, caps);
-                            return iptr;
-                        }
-                    } else {
-                        //Just try to alloc, nothing special.
-                        ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size),
-                                                        alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());
-                        if (ret != NULL) {
-                            MULTI_HEAP_SET_BLOCK_OWNER(ret);
-                            ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
-                            CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
-                            return ret;
-                        }
-                    }
-                }
-            }
+#if CONFIG_HEAP_PER_CORE_CACHE
+    if (alignment <= UNALIGNED_MEM_ALIGNMENT_BYTES) {
+        ret = heap_caps_cache_alloc(size, caps);
+        if (ret != NULL) {
+            CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
+            return ret;
         }
     }
+#endif
+
+    ret = aligned_alloc_from_heaps(alignment, size, caps);
+
+#if CONFIG_HEAP_PER_CORE_CACHE
+    if (ret == NULL && heap_caps_cache_flush()) {
+        //Blocks held by the per-core caches are back in their heaps, try again.
+        ret = aligned_alloc_from_heaps(alignment, size, caps);
+    }
+#endif
 
-    //Nothing usable found.
-    return NULL;
+    return ret;
 }
 
 //Wrapper for heap_caps_aligned_alloc_base as that can also do unaligned allocs.
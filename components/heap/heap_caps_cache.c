@@ -0,0 +1,251 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Per-core cache of small allocations in internal memory.
+ *
+ * Every CPU core has one freelist per size class. heap_caps_malloc() of a small
+ * block in internal memory pops a block from the freelist of the current core,
+ * heap_caps_free() pushes it back. The freelists are refilled from, and
+ * returned to, the TLSF heaps CONFIG_HEAP_PER_CORE_CACHE_BATCH blocks at a time
+ * while holding the heap lock once. Cached blocks stay allocated in their TLSF
+ * heap, so they keep their block owner and poisoning headers; a cached block is
+ * linked into its freelist through the first word of its data.
+ *
+ * Each freelist is protected by a lock of its own core. It is normally only
+ * taken by the owning core, so it does not contend with the other core like the
+ * lock of the heap does. It also allows heap_caps_cache_flush() to empty the
+ * caches of all cores.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "multi_heap.h"
+#include "heap_private.h"
+
+// Allocations which may be served from the cache have to ask for internal memory and no other caps than these
+#define CACHE_CAPS (MALLOC_CAP_8BIT | MALLOC_CAP_32BIT | MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL)
+
+#define CACHE_BATCH CONFIG_HEAP_PER_CORE_CACHE_BATCH
+// A freelist holding more blocks than this returns CACHE_BATCH of them to the heap
+#define CACHE_MAX_BLOCKS (2 * CACHE_BATCH)
+
+#define CACHE_CLASS_NUM 10
+
+// Size classes are multiples of 4 bytes, as required by MALLOC_CAP_32BIT
+static const DRAM_ATTR uint16_t s_class_size[CACHE_CLASS_NUM] = { 8, 16, 24, 32, 48, 64, 96, 128, 192, 256 };
+
+// Smallest size class for an allocation of up to 8 * n bytes, indexed by n
+static const DRAM_ATTR uint8_t s_class_index[] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+    8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9,
+};
+
+#define CLASS_FOR_SIZE(size) (s_class_index[((size) + 7) / 8])
+// Largest size class served by the cache
+#define CACHE_LAST_CLASS CLASS_FOR_SIZE(CONFIG_HEAP_PER_CORE_CACHE_MAX_SIZE)
+
+typedef struct {
+    multi_heap_lock_t lock;
+    void *blocks[CACHE_CLASS_NUM];      // freelist of each size class
+    uint8_t count[CACHE_CLASS_NUM];     // number of blocks in each freelist
+} heap_cache_t;
+
+static heap_cache_t s_cache[portNUM_PROCESSORS] = {
+    [0 ... portNUM_PROCESSORS - 1] = {
+        .lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER,
+    }
+};
+
+#define NEXT_BLOCK(block) (*(void **)(block))
+
+/* Return a list of cached blocks to their heaps. Consecutive blocks of the same heap are freed under one lock. */
+HEAP_IRAM_ATTR static void release_blocks(void *block)
+{
+    heap_t *locked_heap = NULL;
+    while (block != NULL) {
+        void *next = NEXT_BLOCK(block);
+        void *block_owner_ptr = MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(block);
+        heap_t *heap = find_containing_heap(block_owner_ptr);
+        assert(heap != NULL);
+        if (heap != locked_heap) {
+            if (locked_heap != NULL) {
+                MULTI_HEAP_UNLOCK(&locked_heap->heap_mux);
+            }
+            MULTI_HEAP_LOCK(&heap->heap_mux);
+            locked_heap = heap;
+        }
+        multi_heap_free(heap->heap, block_owner_ptr);
+        block = next;
+    }
+    if (locked_heap != NULL) {
+        MULTI_HEAP_UNLOCK(&locked_heap->heap_mux);
+    }
+}
+
+/* Allocate up to CACHE_BATCH blocks of size from a heap under one lock, linked from *first to *last. Returns their number. */
+HEAP_IRAM_ATTR static int alloc_blocks(heap_t *heap, size_t size, void **first, void **last)
+{
+    int count;
+    MULTI_HEAP_LOCK(&heap->heap_mux);
+    for (count = 0; count < CACHE_BATCH; count++) {
+        void *block = multi_heap_malloc(heap->heap, size);
+        if (block == NULL) {
+            break;
+        }
+        block = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(block);
+        if (count == 0) {
+            *first = block;
+        } else {
+            NEXT_BLOCK(*last) = block;
+        }
+        *last = block;
+    }
+    MULTI_HEAP_UNLOCK(&heap->heap_mux);
+    return count;
+}
+
+/* Allocate a batch of blocks of a size class. The first block is returned, the others are added to the cache. */
+HEAP_IRAM_ATTR static void *refill_class(heap_cache_t *cache, int size_class)
+{
+    const size_t size = MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(s_class_size[size_class]);
+    void *first = NULL;
+    void *last = NULL;
+    int count = 0;
+    uint32_t generation;
+
+    // Same heap selection as heap_caps_aligned_alloc_base() for CACHE_CAPS, but all blocks come from one heap
+    const heap_caps_lookup_t *lookup = heap_caps_lookup(CACHE_CAPS, &generation);
+    if (lookup != NULL) {
+        for (uint32_t i = 0; i < lookup->num_heaps && i < HEAP_CAPS_LOOKUP_MAX_HEAPS && count == 0; i++) {
+            heap_t *heap = lookup->heaps[i];
+            if (heap != NULL && (get_all_caps(heap) & CACHE_CAPS) == CACHE_CAPS) {
+                count = alloc_blocks(heap, size, &first, &last);
+            }
+        }
+        if (count == 0 && heap_caps_lookup_generation() == generation) {
+            return NULL;
+        }
+    }
+    for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS && count == 0; prio++) {
+        heap_t *heap;
+        SLIST_FOREACH(heap, &registered_heaps, next) {
+            if (heap->heap == NULL || (heap->caps[prio] & CACHE_CAPS) == 0 ||
+                    (get_all_caps(heap) & CACHE_CAPS) != CACHE_CAPS) {
+                continue;
+            }
+            count = alloc_blocks(heap, size, &first, &last);
+            if (count > 0) {
+                break;
+            }
+        }
+    }
+
+    if (count > 1) {
+        MULTI_HEAP_LOCK(&cache->lock);
+        NEXT_BLOCK(last) = cache->blocks[size_class];
+        cache->blocks[size_class] = NEXT_BLOCK(first);
+        cache->count[size_class] += count - 1;
+        MULTI_HEAP_UNLOCK(&cache->lock);
+    }
+    return first;
+}
+
+HEAP_IRAM_ATTR void *heap_caps_cache_alloc(size_t size, uint32_t caps)
+{
+    if (size > CONFIG_HEAP_PER_CORE_CACHE_MAX_SIZE || (caps & ~CACHE_CAPS) != 0 || (caps & MALLOC_CAP_INTERNAL) == 0) {
+        return NULL;
+    }
+    const int size_class = CLASS_FOR_SIZE(size);
+    heap_cache_t *cache = &s_cache[esp_cpu_get_core_id()];
+
+    MULTI_HEAP_LOCK(&cache->lock);
+    void *block = cache->blocks[size_class];
+    if (block != NULL) {
+        cache->blocks[size_class] = NEXT_BLOCK(block);
+        cache->count[size_class]--;
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+
+    if (block == NULL) {
+        block = refill_class(cache, size_class);
+        if (block == NULL) {
+            return NULL;
+        }
+    }
+    MULTI_HEAP_SET_BLOCK_OWNER(MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(block));
+    return block;
+}
+
+HEAP_IRAM_ATTR bool heap_caps_cache_free(heap_t *heap, void *ptr)
+{
+    if ((get_all_caps(heap) & CACHE_CAPS) != CACHE_CAPS) {
+        return false;
+    }
+    // With heap poisoning, this also verifies the canaries of the block
+    size_t size = multi_heap_get_allocated_size(heap->heap, MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr));
+    size = MULTI_HEAP_REMOVE_BLOCK_OWNER_SIZE(size);
+    if (size < s_class_size[0] || size > s_class_size[CACHE_LAST_CLASS]) {
+        return false;
+    }
+    // The block is big enough for any allocation of the largest class not bigger than the block
+    int size_class = CLASS_FOR_SIZE(size);
+    if (s_class_size[size_class] > size) {
+        size_class--;
+    }
+    heap_cache_t *cache = &s_cache[esp_cpu_get_core_id()];
+    void *release = NULL;
+
+    MULTI_HEAP_LOCK(&cache->lock);
+    NEXT_BLOCK(ptr) = cache->blocks[size_class];
+    cache->blocks[size_class] = ptr;
+    if (++cache->count[size_class] > CACHE_MAX_BLOCKS) {
+        // Keep the block just freed, detach the CACHE_BATCH blocks after it
+        void *last = ptr;
+        release = NEXT_BLOCK(ptr);
+        for (int i = 0; i < CACHE_BATCH; i++) {
+            last = NEXT_BLOCK(last);
+        }
+        NEXT_BLOCK(ptr) = NEXT_BLOCK(last);
+        NEXT_BLOCK(last) = NULL;
+        cache->count[size_class] -= CACHE_BATCH;
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+
+    if (release != NULL) {
+        release_blocks(release);
+    }
+    return true;
+}
+
+HEAP_IRAM_ATTR bool heap_caps_cache_flush(void)
+{
+    bool released = false;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        heap_cache_t *cache = &s_cache[core];
+        void *blocks[CACHE_CLASS_NUM];
+
+        MULTI_HEAP_LOCK(&cache->lock);
+        for (int size_class = 0; size_class < CACHE_CLASS_NUM; size_class++) {
+            blocks[size_class] = cache->blocks[size_class];
+            cache->blocks[size_class] = NULL;
+            cache->count[size_class] = 0;
+        }
+        MULTI_HEAP_UNLOCK(&cache->lock);
+
+        for (int size_class = 0; size_class < CACHE_CLASS_NUM; size_class++) {
+            if (blocks[size_class] != NULL) {
+                release_blocks(blocks[size_class]);
+                released = true;
+            }
+        }
+    }
+    return released;
+}
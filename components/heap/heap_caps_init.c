@@ -50,6 +50,7 @@ void heap_caps_enable_nonos_stack_heaps(void)
             }
         }
     }
+    heap_caps_lookup_reset();
 }
 
 /* Initialize the heap allocator to use all of the memory not
@@ -160,6 +161,9 @@ void heap_caps_init(void)
             SLIST_INSERT_AFTER(&heaps_array[i-1], &heaps_array[i], next);
         }
     }
+
+    /* Precompute which heaps can serve the most common caps */
+    heap_caps_lookup_reset();
 }
 
 esp_err_t heap_caps_add_region(intptr_t start, intptr_t end)
@@ -260,6 +264,9 @@ esp_err_t heap_caps_add_region_with_caps(const uint32_t caps[], intptr_t start,
     SLIST_INSERT_HEAD(&registered_heaps, p_new, next);
     MULTI_HEAP_UNLOCK(&registered_heaps_write_lock);
 
+    /* The new heap may serve caps which are already in the lookup table */
+    heap_caps_lookup_reset();
+
     err = ESP_OK;
 
  done:
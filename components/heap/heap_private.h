@@ -7,6 +7,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include "sdkconfig.h"
 #include <soc/soc_memory_layout.h>
 #include "multi_heap.h"
 #include "multi_heap_platform.h"
@@ -74,6 +75,32 @@ FORCE_INLINE_ATTR heap_t *find_containing_heap(void *ptr )
     return NULL;
 }
 
+/* Lookup table from caps to the heaps which can serve them, see heap_caps_base.c */
+
+#define HEAP_CAPS_LOOKUP_MAX_HEAPS 8
+
+typedef struct {
+    uint32_t caps;
+    uint32_t num_heaps;                                 ///< Number of heaps, or UINT32_MAX if more than HEAP_CAPS_LOOKUP_MAX_HEAPS heaps have the caps
+    heap_t *heaps[HEAP_CAPS_LOOKUP_MAX_HEAPS];          ///< Heaps having all of caps, in the order allocations try them
+} heap_caps_lookup_t;
+
+/* Get the heaps which can serve an allocation with 'caps', adding them to the lookup table if they are not in it yet.
+
+   Returns NULL if the table is full or too many heaps have the caps, the heaps have to be searched then.
+   *generation is set to the generation of the table, see heap_caps_lookup_generation().
+
+   The entry is not locked. It is rebuilt if heaps are registered while it is used, so the caps of each
+   heap have to be checked again before allocating from it.
+*/
+const heap_caps_lookup_t *heap_caps_lookup(uint32_t caps, uint32_t *generation);
+
+/* Get the generation of the lookup table, which changes whenever the table is rebuilt */
+uint32_t heap_caps_lookup_generation(void);
+
+/* Rebuild the lookup table, has to be called after heaps are registered */
+void heap_caps_lookup_reset(void);
+
 /*
  Because we don't want to add _another_ known allocation method to the stack of functions to trace wrt memory tracing,
  these are declared private. The newlib malloc()/realloc() implementation also calls these, so they are declared
@@ -87,6 +114,21 @@ void *heap_caps_calloc_base(size_t n, size_t size, uint32_t caps);
 void *heap_caps_malloc_base(size_t size, uint32_t caps);
 void *heap_caps_aligned_alloc_base(size_t alignment, size_t size, uint32_t caps);
 
+#if CONFIG_HEAP_PER_CORE_CACHE
+/* Per-core cache of small allocations, see heap_caps_cache.c */
+
+/* Allocate a block from the cache of the current core. Returns NULL if the
+   allocation can't be served from the cache, e.g. because of its caps. */
+void *heap_caps_cache_alloc(size_t size, uint32_t caps);
+
+/* Put a block of 'heap' into the cache of the current core. Returns false if
+   the block can't be cached and has to be freed in its heap. */
+bool heap_caps_cache_free(heap_t *heap, void *ptr);
+
+/* Return the blocks cached by all cores to their heaps. Returns true if any block was returned. */
+bool heap_caps_cache_flush(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
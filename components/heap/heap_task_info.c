@@ -31,6 +31,11 @@ size_t heap_caps_get_per_task_info(heap_task_info_params_t *params)
     size_t count = *params->num_totals;
     size_t remaining = params->max_blocks;
 
+#if CONFIG_HEAP_PER_CORE_CACHE
+    // Blocks in the per-core caches are not owned by any task
+    heap_caps_cache_flush();
+#endif
+
     // Clear out totals for any prepopulated tasks.
     if (params->totals) {
         for (size_t i = 0; i < count; ++i) {
@@ -0,0 +1,263 @@
+#!/usr/bin/env python
+#
+# Converts a profile printed by heap_trace_sampling_dump() to the pprof format.
+#
+# The profile is extracted from a console log, its addresses are symbolized with
+# addr2line from the toolchain and the samples are scaled to estimate the real
+# number of allocations. The result is a gzipped profile.proto file, which can be
+# opened with 'pprof' or 'go tool pprof'.
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import argparse
+import gzip
+import math
+import re
+import struct
+import subprocess
+import sys
+from typing import Dict
+from typing import List
+from typing import Optional
+from typing import Tuple
+
+PROFILE_START = '====== Heap Trace Sampling Profile ======'
+PROFILE_END = '====== Heap Trace Sampling Summary ======'
+
+HEADER_RE = re.compile(r'heap profile:\s*(\d+):\s*(\d+)\s*\[\s*(\d+):\s*(\d+)\s*\]\s*@\s*heap_v2/(\d+)')
+SAMPLE_RE = re.compile(r'(\d+):\s*(\d+)\s*\[\s*(\d+):\s*(\d+)\s*\]\s*@((?:\s+0x[0-9a-fA-F]+)*)')
+
+EM_XTENSA = 94
+EM_RISCV = 243
+
+
+class Sample(object):
+    def __init__(self, inuse_count: int, inuse_bytes: int, alloc_count: int, alloc_bytes: int,
+                 stack: List[int]) -> None:
+        self.inuse_count = inuse_count
+        self.inuse_bytes = inuse_bytes
+        self.alloc_count = alloc_count
+        self.alloc_bytes = alloc_bytes
+        self.stack = stack
+
+
+class Frame(object):
+    def __init__(self, function: str, filename: str, line: int) -> None:
+        self.function = function
+        self.filename = filename
+        self.line = line
+
+
+def parse_log(lines: List[str]) -> Tuple[int, List[Sample]]:
+    """ Return the sampling interval and the samples of the last profile in a console log """
+    profile = None  # type: Optional[Tuple[int, List[Sample]]]
+    interval = None  # type: Optional[int]
+    samples = []  # type: List[Sample]
+    for line in lines:
+        if PROFILE_START in line:
+            interval = None
+            samples = []
+        elif PROFILE_END in line and interval is not None:
+            profile = (interval, samples)
+            interval = None
+        elif interval is None:
+            header = HEADER_RE.search(line)
+            if header:
+                interval = int(header.group(5))
+        else:
+            sample = SAMPLE_RE.search(line)
+            if sample:
+                stack = [int(addr, 16) for addr in sample.group(5).split()]
+                samples.append(Sample(int(sample.group(1)), int(sample.group(2)),
+                                      int(sample.group(3)), int(sample.group(4)), stack))
+    if profile is None:
+        raise RuntimeError('No complete heap trace sampling profile found in the log')
+    return profile
+
+
+def scale(count: int, size: int, interval: int) -> Tuple[int, int]:
+    """ Estimate the real number and size of allocations from the samples, like pprof does for heap_v2 profiles:
+        an allocation of N bytes is sampled with probability 1 - exp(-N / interval) """
+    if count == 0 or size == 0:
+        return 0, 0
+    if interval <= 1:
+        return count, size
+    avg_size = size / count
+    factor = 1 / (1 - math.exp(-avg_size / interval))
+    return int(count * factor), int(size * factor)
+
+
+def toolchain_prefix(elf_path: str) -> str:
+    with open(elf_path, 'rb') as f:
+        header = f.read(20)
+    if header[:4] != b'\x7fELF':
+        raise RuntimeError('{} is not an ELF file'.format(elf_path))
+    machine = struct.unpack('<H', header[18:20])[0]
+    if machine == EM_XTENSA:
+        return 'xtensa-esp-elf-'
+    if machine == EM_RISCV:
+        return 'riscv32-esp-elf-'
+    raise RuntimeError('Unknown architecture of {}, use --toolchain-prefix'.format(elf_path))
+
+
+def symbolize(addresses: List[int], elf_path: str, prefix: str) -> Dict[int, List[Frame]]:
+    """ Return the frames of each address, the innermost inlined function first """
+    frames = {}  # type: Dict[int, List[Frame]]
+    if not addresses:
+        return frames
+    # The addresses are return addresses, look up the call instruction before them
+    cmd = [prefix + 'addr2line', '-e', elf_path, '-a', '-f', '-i', '-C'] + ['0x{:x}'.format(a - 1) for a in addresses]
+    output = subprocess.check_output(cmd).decode('utf-8', errors='replace').splitlines()
+    lookup = {a - 1: a for a in addresses}
+    current = None  # type: Optional[List[Frame]]
+    i = 0
+    while i < len(output):
+        line = output[i].strip()
+        if re.match(r'^0x[0-9a-fA-F]+$', line) and int(line, 16) in lookup:
+            current = frames.setdefault(lookup[int(line, 16)], [])
+            i += 1
+            continue
+        if current is not None and i + 1 < len(output):
+            function = line
+            location = output[i + 1].strip()
+            filename, _, line_no = location.rpartition(':')
+            line_no = line_no.split(' ')[0]
+            current.append(Frame(function, filename, int(line_no) if line_no.isdigit() else 0))
+        i += 2
+    return frames
+
+
+class Proto(object):
+    """ Minimal protobuf encoder """
+    def __init__(self) -> None:
+        self.data = bytearray()
+
+    @staticmethod
+    def varint(value: int) -> bytes:
+        value &= (1 << 64) - 1
+        out = bytearray()
+        while True:
+            byte = value & 0x7f
+            value >>= 7
+            if value:
+                out.append(byte | 0x80)
+            else:
+                out.append(byte)
+                return bytes(out)
+
+    def add_int(self, field: int, value: int) -> None:
+        if value:
+            self.data += self.varint(field << 3) + self.varint(value)
+
+    def add_bytes(self, field: int, value: bytes) -> None:
+        self.data += self.varint((field << 3) | 2) + self.varint(len(value)) + value
+
+    def add_message(self, field: int, message: 'Proto') -> None:
+        self.add_bytes(field, bytes(message.data))
+
+    def add_packed(self, field: int, values: List[int]) -> None:
+        if values:
+            self.add_bytes(field, b''.join(self.varint(v) for v in values))
+
+
+def build_profile(interval: int, samples: List[Sample], frames: Dict[int, List[Frame]], elf_path: str) -> bytes:
+    """ Encode a profile.proto message, see https://github.com/google/pprof/blob/main/proto/profile.proto """
+    strings = {'': 0}  # type: Dict[str, int]
+
+    def string(s: str) -> int:
+        return strings.setdefault(s, len(strings))
+
+    def value_type(type_name: str, unit: str) -> Proto:
+        vt = Proto()
+        vt.add_int(1, string(type_name))
+        vt.add_int(2, string(unit))
+        return vt
+
+    profile = Proto()
+    for type_name, unit in (('alloc_objects', 'count'), ('alloc_space', 'bytes'),
+                            ('inuse_objects', 'count'), ('inuse_space', 'bytes')):
+        profile.add_message(1, value_type(type_name, unit))
+
+    locations = {}  # type: Dict[int, int]
+    functions = {}  # type: Dict[Tuple[str, str], int]
+    for sample in samples:
+        alloc_count, alloc_bytes = scale(sample.alloc_count, sample.alloc_bytes, interval)
+        inuse_count, inuse_bytes = scale(sample.inuse_count, sample.inuse_bytes, interval)
+        for address in sample.stack:
+            locations.setdefault(address, len(locations) + 1)
+        s = Proto()
+        s.add_packed(1, [locations[a] for a in sample.stack])
+        s.add_packed(2, [alloc_count, alloc_bytes, inuse_count, inuse_bytes])
+        profile.add_message(2, s)
+
+    mapping = Proto()
+    mapping.add_int(1, 1)
+    mapping.add_int(3, 0xffffffff)
+    mapping.add_int(5, string(elf_path))
+    for field in range(7, 11):  # has_functions, has_filenames, has_line_numbers, has_inline_frames
+        mapping.add_int(field, 1)
+    profile.add_message(3, mapping)
+
+    function_messages = []  # type: List[Proto]
+    for address, location_id in locations.items():
+        location = Proto()
+        location.add_int(1, location_id)
+        location.add_int(2, 1)
+        location.add_int(3, address)
+        for frame in frames.get(address, []):
+            key = (frame.function, frame.filename)
+            if key not in functions:
+                functions[key] = len(functions) + 1
+                function = Proto()
+                function.add_int(1, functions[key])
+                function.add_int(2, string(frame.function))
+                function.add_int(3, string(frame.function))
+                function.add_int(4, string(frame.filename))
+                function_messages.append(function)
+            line = Proto()
+            line.add_int(1, functions[key])
+            line.add_int(2, frame.line)
+            location.add_message(4, line)
+        profile.add_message(4, location)
+    for function in function_messages:
+        profile.add_message(5, function)
+
+    period_type = value_type('space', 'bytes')
+    for s in strings:  # dict keeps the insertion order, which is the index of each string
+        profile.add_bytes(6, s.encode('utf-8'))
+    profile.add_message(11, period_type)
+    profile.add_int(12, interval)
+    return bytes(profile.data)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Convert a heap trace sampling profile from a console log to pprof format')
+    parser.add_argument('elf', help='ELF file of the application')
+    parser.add_argument('log', help='Console log containing the output of heap_trace_sampling_dump(), - for stdin')
+    parser.add_argument('-o', '--output', default='heap.pb.gz', help='Output file (default: %(default)s)')
+    parser.add_argument('--toolchain-prefix', help='Prefix of the toolchain binaries, e.g. xtensa-esp-elf-. '
+                        'Derived from the architecture of the ELF file by default.')
+    args = parser.parse_args()
+
+    if args.log == '-':
+        lines = sys.stdin.read().splitlines()
+    else:
+        with open(args.log, 'r', errors='replace') as f:
+            lines = f.read().splitlines()
+
+    try:
+        interval, samples = parse_log(lines)
+        prefix = args.toolchain_prefix if args.toolchain_prefix is not None else toolchain_prefix(args.elf)
+        addresses = sorted({a for sample in samples for a in sample.stack})
+        frames = symbolize(addresses, args.elf, prefix)
+    except (RuntimeError, OSError, subprocess.CalledProcessError) as e:
+        print('Error: {}'.format(e), file=sys.stderr)
+        sys.exit(1)
+
+    with gzip.open(args.output, 'wb') as f:
+        f.write(build_profile(interval, samples, frames, args.elf))
+    print('{} call stacks, sampling interval {} bytes, written to {}'.format(len(samples), interval, args.output))
+
+
+if __name__ == '__main__':
+    main()
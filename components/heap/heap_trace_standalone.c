@@ -16,7 +16,9 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_memory_utils.h"
+#include "esp_cpu.h"
 #include "sys/queue.h"
+#include "sys/param.h"
 
 static __attribute__((unused)) const char* TAG = "heaptrace";
 
@@ -34,6 +36,9 @@ typedef enum {
 static portMUX_TYPE trace_mux = portMUX_INITIALIZER_UNLOCKED;
 static tracing_state_t tracing = TRACING_UNKNOWN;
 static heap_trace_mode_t mode;
+#if CONFIG_HEAP_TRACE_SAMPLING
+static volatile bool sampling; // sampling profiler is running, see heap_trace_sampling_start()
+#endif
 
 /* Define struct: linked list of records */
 TAILQ_HEAD(heap_trace_record_list_struct_t, heap_trace_record_t);
@@ -202,6 +207,11 @@ esp_err_t heap_trace_start(heap_trace_mode_t mode_param)
     if (records.buffer == NULL || records.capacity == 0) {
         return ESP_ERR_INVALID_STATE;
     }
+#if CONFIG_HEAP_TRACE_SAMPLING
+    if (sampling) {
+        return ESP_ERR_INVALID_STATE;
+    }
+#endif
 
     portENTER_CRITICAL(&trace_mux);
 
@@ -660,6 +670,380 @@ static HEAP_IRAM_ATTR void list_find_and_remove(void* p)
     }
 }
 
+#if CONFIG_HEAP_TRACE_SAMPLING
+
+/* Sampling heap profiler
+
+   Instead of recording every allocation, one allocation is sampled every 'interval' bytes on
+   average. Each core counts down the bytes allocated on it and samples the allocation which makes
+   the count reach zero. The distance to the next sample is drawn from an exponential distribution,
+   so the samples are a Poisson process over the allocated bytes and periodic allocation patterns
+   don't bias the profile. An allocation of 'size' bytes is sampled with probability
+   1 - exp(-size / interval), which is what pprof assumes when it scales a heap_v2 profile.
+
+   Samples are aggregated by call stack in an open-addressed table. Sampled allocations which are
+   still alive are kept in a second table (linear probing, backward shift deletion), so that frees
+   can be accounted to the in-use part of the profile. Frees look an address up in that table
+   without taking the lock first, as almost all freed blocks were not sampled.
+*/
+
+#define SAMPLING_STACKS CONFIG_HEAP_TRACE_SAMPLING_STACKS
+#define SAMPLING_LIVE CONFIG_HEAP_TRACE_SAMPLING_LIVE
+// The live table is not filled beyond 3/4 to keep probe sequences short
+#define SAMPLING_LIVE_MAX (SAMPLING_LIVE * 3 / 4)
+
+typedef struct {
+    uint64_t alloc_bytes;
+    uint64_t inuse_bytes;
+    uint32_t alloc_samples;
+    uint32_t inuse_samples;
+    uint32_t hash;              // hash of 'callers', 0 if the entry is unused
+    void *callers[STACK_DEPTH];
+} sample_stack_t;
+
+typedef struct {
+    void *address;              // NULL if the entry is unused
+    uint32_t size;
+    uint32_t stack;             // index in sample_stacks
+} sample_live_t;
+
+static sample_stack_t *sample_stacks;
+static sample_live_t *sample_live;
+static size_t sample_stacks_count;
+static size_t sample_live_count;
+static size_t sample_interval;
+static size_t sample_total;
+static size_t sample_dropped;
+static size_t sample_inuse_dropped;
+static int32_t sample_countdown[portNUM_PROCESSORS];
+static uint32_t sample_rng[portNUM_PROCESSORS];
+
+static HEAP_IRAM_ATTR uint32_t sample_random(int core)
+{
+    // xorshift32, the state is never 0
+    uint32_t x = sample_rng[core];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sample_rng[core] = x;
+    return x;
+}
+
+/* Number of bytes until the next sample: interval * -ln(U) with U uniform in (0, 1).
+
+   Computed in 16.16 fixed point, as allocations can happen in ISRs where floats can't be used.
+   -log2(U) is the position of the leading one of a random 32-bit number plus a table lookup
+   of the logarithm of its mantissa.
+*/
+static HEAP_IRAM_ATTR int32_t sample_next_distance(int core)
+{
+    // log2(1 + (i + 0.5) / 64) in 16.16 fixed point
+    static const uint16_t log2_mantissa[64] = {
+        736, 2190, 3623, 5034, 6425, 7795, 9146, 10477,
+        11791, 13086, 14363, 15624, 16868, 18096, 19308, 20505,
+        21687, 22854, 24007, 25146, 26272, 27384, 28484, 29571,
+        30645, 31707, 32758, 33797, 34825, 35841, 36847, 37842,
+        38827, 39802, 40767, 41722, 42667, 43603, 44530, 45448,
+        46357, 47258, 48150, 49034, 49909, 50776, 51636, 52488,
+        53332, 54169, 54998, 55820, 56635, 57443, 58245, 59039,
+        59827, 60609, 61384, 62152, 62915, 63671, 64421, 65166,
+    };
+    static const uint32_t ln2 = 45426; // ln(2) in 16.16 fixed point
+
+    const uint32_t r = sample_random(core);
+    const int zeros = __builtin_clz(r);
+    const uint32_t mantissa = ((r << zeros) >> 25) & 63;
+    const uint32_t neg_log2 = ((uint32_t)(zeros + 1) << 16) - log2_mantissa[mantissa];
+    const uint64_t neg_ln = ((uint64_t)neg_log2 * ln2) >> 16;
+    const uint64_t distance = ((uint64_t)sample_interval * neg_ln) >> 16;
+    return (int32_t)MIN(distance, INT32_MAX);
+}
+
+/* Return true if an allocation of 'size' bytes is to be sampled */
+static HEAP_IRAM_ATTR bool sample_allocation(size_t size)
+{
+    // A task switch between reading and writing the countdown only skews the distance to the next sample
+    const int core = xPortGetCoreID();
+    const int32_t countdown = sample_countdown[core] - (int32_t)MIN(size, INT32_MAX);
+    if (countdown > 0) {
+        sample_countdown[core] = countdown;
+        return false;
+    }
+    sample_countdown[core] = sample_next_distance(core);
+    return true;
+}
+
+static HEAP_IRAM_ATTR uint32_t stack_hash(void **callers)
+{
+    uint32_t hash = 2166136261UL; // FNV-1a
+    for (int i = 0; i < STACK_DEPTH; i++) {
+        hash = (hash ^ (uint32_t)callers[i]) * 16777619UL;
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+static HEAP_IRAM_ATTR sample_stack_t *stack_find_or_add(uint32_t hash, void **callers)
+{
+    size_t idx = hash % SAMPLING_STACKS;
+    for (size_t i = 0; i < SAMPLING_STACKS; i++) {
+        sample_stack_t *stack = &sample_stacks[idx];
+        if (stack->hash == 0) {
+            stack->hash = hash;
+            memcpy(stack->callers, callers, sizeof(void *) * STACK_DEPTH);
+            sample_stacks_count++;
+            return stack;
+        }
+        if (stack->hash == hash && memcmp(stack->callers, callers, sizeof(void *) * STACK_DEPTH) == 0) {
+            return stack;
+        }
+        idx = (idx + 1) % SAMPLING_STACKS;
+    }
+    return NULL;
+}
+
+static HEAP_IRAM_ATTR size_t live_idx(void *p)
+{
+    return (((uint32_t)p >> 3) * 2654435761UL) % SAMPLING_LIVE;
+}
+
+/* Return the index of the live entry of 'p', or -1. May miss the entry if called without the lock
+   while the entry is being moved by live_remove(). */
+static HEAP_IRAM_ATTR int live_find(void *p)
+{
+    size_t idx = live_idx(p);
+    for (size_t i = 0; i < SAMPLING_LIVE; i++) {
+        void *address = sample_live[idx].address;
+        if (address == p) {
+            return idx;
+        }
+        if (address == NULL) {
+            break;
+        }
+        idx = (idx + 1) % SAMPLING_LIVE;
+    }
+    return -1;
+}
+
+static HEAP_IRAM_ATTR void live_remove(size_t idx)
+{
+    const sample_live_t *live = &sample_live[idx];
+    sample_stack_t *stack = &sample_stacks[live->stack];
+    stack->inuse_samples--;
+    stack->inuse_bytes -= live->size;
+    sample_live_count--;
+
+    // Move the following entries of the probe sequence up, unless that would put them before their home slot
+    size_t hole = idx;
+    size_t next = (hole + 1) % SAMPLING_LIVE;
+    while (sample_live[next].address != NULL) {
+        const size_t home = live_idx(sample_live[next].address);
+        const bool in_place = (hole < next) ? (home > hole && home <= next) : (home > hole || home <= next);
+        if (!in_place) {
+            sample_live[hole] = sample_live[next];
+            hole = next;
+        }
+        next = (next + 1) % SAMPLING_LIVE;
+    }
+    sample_live[hole].address = NULL;
+}
+
+static HEAP_IRAM_ATTR bool live_add(void *p, size_t size, size_t stack)
+{
+    // If a previous sample at this address is still there, its free was missed while the table was changing
+    const int stale = live_find(p);
+    if (stale >= 0) {
+        live_remove(stale);
+    }
+    if (sample_live_count >= SAMPLING_LIVE_MAX) {
+        return false;
+    }
+
+    size_t idx = live_idx(p);
+    while (sample_live[idx].address != NULL) {
+        idx = (idx + 1) % SAMPLING_LIVE;
+    }
+    sample_live[idx].size = size;
+    sample_live[idx].stack = stack;
+    sample_live[idx].address = p;
+    sample_live_count++;
+    return true;
+}
+
+/* Add a sampled allocation to the profile */
+static HEAP_IRAM_ATTR void record_sample(void *p, size_t size, void **callers)
+{
+    const uint32_t hash = stack_hash(callers);
+
+    portENTER_CRITICAL(&trace_mux);
+
+    if (sampling) {
+        sample_total++;
+        sample_stack_t *stack = stack_find_or_add(hash, callers);
+        if (stack == NULL) {
+            sample_dropped++;
+        } else {
+            stack->alloc_samples++;
+            stack->alloc_bytes += size;
+            if (live_add(p, size, stack - sample_stacks)) {
+                stack->inuse_samples++;
+                stack->inuse_bytes += size;
+            } else {
+                sample_inuse_dropped++;
+            }
+        }
+    }
+
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+/* Remove a block which is about to be freed from the in-use profile, if it was sampled */
+static HEAP_IRAM_ATTR void record_sample_free(void *p)
+{
+    if (p == NULL || sample_live_count == 0 || live_find(p) < 0) {
+        return;
+    }
+
+    portENTER_CRITICAL(&trace_mux);
+    const int idx = live_find(p);
+    if (idx >= 0) {
+        live_remove(idx);
+    }
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+esp_err_t heap_trace_sampling_start(size_t interval)
+{
+    if (interval == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((tracing == TRACING_STARTED) || (tracing == TRACING_ALLOC_PAUSED)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (sample_stacks == NULL) {
+        // The tables stay allocated after stopping, so that the profile can still be dumped
+        sample_stacks = heap_caps_calloc(SAMPLING_STACKS, sizeof(sample_stack_t), MALLOC_CAP_INTERNAL);
+        sample_live = heap_caps_calloc(SAMPLING_LIVE, sizeof(sample_live_t), MALLOC_CAP_INTERNAL);
+        if (sample_stacks == NULL || sample_live == NULL) {
+            heap_caps_free(sample_stacks);
+            heap_caps_free(sample_live);
+            sample_stacks = NULL;
+            sample_live = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    portENTER_CRITICAL(&trace_mux);
+
+    memset(sample_stacks, 0, sizeof(sample_stack_t) * SAMPLING_STACKS);
+    memset(sample_live, 0, sizeof(sample_live_t) * SAMPLING_LIVE);
+    sample_stacks_count = 0;
+    sample_live_count = 0;
+    sample_total = 0;
+    sample_dropped = 0;
+    sample_inuse_dropped = 0;
+    sample_interval = interval;
+
+    const uint32_t seed = esp_cpu_get_cycle_count();
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        sample_rng[core] = (seed ^ (0x9E3779B9UL * (core + 1))) | 1;
+        sample_countdown[core] = sample_next_distance(core);
+    }
+
+    sampling = true;
+
+    portEXIT_CRITICAL(&trace_mux);
+    return ESP_OK;
+}
+
+esp_err_t heap_trace_sampling_stop(void)
+{
+    esp_err_t ret_val = ESP_OK;
+
+    portENTER_CRITICAL(&trace_mux);
+    if (sampling) {
+        sampling = false;
+    } else {
+        ret_val = ESP_ERR_INVALID_STATE;
+    }
+    portEXIT_CRITICAL(&trace_mux);
+    return ret_val;
+}
+
+esp_err_t heap_trace_sampling_summary(heap_trace_sampling_summary_t *summary)
+{
+    if (summary == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *summary = (heap_trace_sampling_summary_t) { 0 };
+
+    portENTER_CRITICAL(&trace_mux);
+    summary->interval = sample_interval;
+    summary->samples = sample_total;
+    summary->stacks = sample_stacks_count;
+    summary->dropped_samples = sample_dropped;
+    summary->inuse_dropped_samples = sample_inuse_dropped;
+    for (size_t i = 0; sample_stacks != NULL && i < SAMPLING_STACKS; i++) {
+        summary->inuse_samples += sample_stacks[i].inuse_samples;
+        summary->inuse_bytes += sample_stacks[i].inuse_bytes;
+    }
+    portEXIT_CRITICAL(&trace_mux);
+
+    return ESP_OK;
+}
+
+void heap_trace_sampling_dump(void)
+{
+    portENTER_CRITICAL(&trace_mux);
+
+    uint32_t inuse_samples = 0;
+    uint32_t alloc_samples = 0;
+    uint64_t inuse_bytes = 0;
+    uint64_t alloc_bytes = 0;
+    for (size_t i = 0; sample_stacks != NULL && i < SAMPLING_STACKS; i++) {
+        inuse_samples += sample_stacks[i].inuse_samples;
+        inuse_bytes += sample_stacks[i].inuse_bytes;
+        alloc_samples += sample_stacks[i].alloc_samples;
+        alloc_bytes += sample_stacks[i].alloc_bytes;
+    }
+
+    // Legacy text format of heap profiles read by pprof, the counts are not scaled
+    esp_rom_printf("====== Heap Trace Sampling Profile ======\n");
+    esp_rom_printf("heap profile: %"PRIu32": %"PRIu64" [%"PRIu32": %"PRIu64"] @ heap_v2/%"PRIu32"\n",
+        inuse_samples, inuse_bytes, alloc_samples, alloc_bytes, (uint32_t)sample_interval);
+
+    for (size_t i = 0; sample_stacks != NULL && i < SAMPLING_STACKS; i++) {
+        const sample_stack_t *stack = &sample_stacks[i];
+        if (stack->hash == 0) {
+            continue;
+        }
+        esp_rom_printf("%"PRIu32": %"PRIu64" [%"PRIu32": %"PRIu64"] @",
+            stack->inuse_samples, stack->inuse_bytes, stack->alloc_samples, stack->alloc_bytes);
+        for (int j = 0; j < STACK_DEPTH && stack->callers[j] != NULL; j++) {
+            esp_rom_printf(" %p", stack->callers[j]);
+        }
+        esp_rom_printf("\n");
+    }
+
+    esp_rom_printf("====== Heap Trace Sampling Summary ======\n");
+    esp_rom_printf("%s, interval %"PRIu32" bytes\n", sampling ? "Running" : "Stopped", (uint32_t)sample_interval);
+    esp_rom_printf("samples: %"PRIu32" (%"PRIu32" call stacks, %"PRIu32" stack table capacity)\n",
+        (uint32_t)sample_total, (uint32_t)sample_stacks_count, (uint32_t)SAMPLING_STACKS);
+    if (sample_dropped != 0) {
+        esp_rom_printf("(NB: %"PRIu32" samples were dropped as the stack table was full.)\n", (uint32_t)sample_dropped);
+    }
+    if (sample_inuse_dropped != 0) {
+        esp_rom_printf("(NB: %"PRIu32" samples are missing from the in-use profile as the live table was full.)\n",
+            (uint32_t)sample_inuse_dropped);
+    }
+    esp_rom_printf("=========================================\n");
+
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+#endif // CONFIG_HEAP_TRACE_SAMPLING
+
 #include "heap_trace.inc"
 
 #endif // CONFIG_HEAP_TRACING_STANDALONE
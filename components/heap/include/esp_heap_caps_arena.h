@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of an arena
+ *
+ * An arena hands out memory from chunks allocated with the given capabilities. Allocating from
+ * an arena only advances a pointer in its current chunk. Memory allocated from an arena cannot
+ * be freed on its own; all of it is released at once by heap_caps_arena_reset() or
+ * heap_caps_arena_destroy().
+ *
+ * The chunks are allocated with heap_caps_malloc(), so they are counted as allocated memory by
+ * heap_caps_get_info() and recorded by heap tracing. A leaked arena shows up as leaked chunks.
+ *
+ * An arena is not thread safe. It must not be used by several tasks at the same time without
+ * external locking.
+ */
+typedef struct heap_caps_arena *heap_caps_arena_handle_t;
+
+/**
+ * @brief Statistics of an arena, see heap_caps_arena_get_info()
+ */
+typedef struct {
+    size_t total_size;              ///< Size of all chunks of the arena, including their headers
+    size_t total_allocated_bytes;   ///< Bytes allocated from the arena since it was created or reset, including alignment padding
+    size_t total_free_bytes;        ///< Bytes which can still be allocated from the current chunk without growing the arena
+    size_t peak_allocated_bytes;    ///< Largest value of total_allocated_bytes since the arena was created
+    size_t allocated_blocks;        ///< Number of allocations since the arena was created or reset
+    size_t chunks;                  ///< Number of chunks of the arena
+} heap_caps_arena_info_t;
+
+/**
+ * @brief Create an arena
+ *
+ * The first chunk of the arena is allocated right away. When a chunk is full, the arena grows
+ * by another chunk of the same size, or of the size of the allocation if that is bigger.
+ *
+ * @param initial_size Size of the chunks of the arena in bytes. The arena itself and the chunk
+ *                     header are stored in the first chunk.
+ * @param caps         Bitwise OR of MALLOC_CAP_* flags indicating the type of memory to allocate the chunks from
+ *
+ * @return Handle of the arena, or NULL if the first chunk cannot be allocated
+ */
+heap_caps_arena_handle_t heap_caps_arena_create(size_t initial_size, uint32_t caps);
+
+/**
+ * @brief Allocate memory from an arena
+ *
+ * The memory is aligned to 8 bytes. It stays valid until the arena is reset or destroyed.
+ *
+ * @param arena Arena to allocate from
+ * @param size  Size in bytes of the memory to allocate
+ *
+ * @return Pointer to the memory, or NULL if the arena needs to grow and no chunk can be allocated
+ */
+void *heap_caps_arena_alloc(heap_caps_arena_handle_t arena, size_t size);
+
+/**
+ * @brief Allocate zero-initialized memory from an arena
+ *
+ * @param arena Arena to allocate from
+ * @param n     Number of elements
+ * @param size  Size of each element in bytes
+ *
+ * @return Pointer to the memory, or NULL on failure
+ */
+void *heap_caps_arena_calloc(heap_caps_arena_handle_t arena, size_t n, size_t size);
+
+/**
+ * @brief Release all memory allocated from an arena
+ *
+ * All chunks except the first one are freed. The arena can be used again afterwards.
+ *
+ * @param arena Arena to reset
+ */
+void heap_caps_arena_reset(heap_caps_arena_handle_t arena);
+
+/**
+ * @brief Destroy an arena and free all of its chunks
+ *
+ * @param arena Arena to destroy, may be NULL
+ */
+void heap_caps_arena_destroy(heap_caps_arena_handle_t arena);
+
+/**
+ * @brief Get statistics of an arena
+ *
+ * @param arena Arena to get the statistics of
+ * @param info  Pointer to a structure filled with the statistics
+ */
+void heap_caps_arena_get_info(heap_caps_arena_handle_t arena, heap_caps_arena_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
@@ -197,6 +197,77 @@ void heap_trace_dump_caps(const uint32_t caps);
  */
 esp_err_t heap_trace_summary(heap_trace_summary_t *summary);
 
+/**
+ * @brief Stores information about the profile of the sampling heap profiler.
+ */
+typedef struct {
+    size_t interval;                 ///< Average number of allocated bytes between two samples
+    size_t samples;                  ///< The number of sampled allocations since the profiler was started
+    size_t stacks;                   ///< The number of distinct call stacks of the sampled allocations
+    size_t inuse_samples;            ///< The number of sampled allocations which haven't been freed yet
+    size_t inuse_bytes;              ///< The size of the sampled allocations which haven't been freed yet
+    size_t dropped_samples;          ///< Samples missing from the profile because the table of call stacks was full
+    size_t inuse_dropped_samples;    ///< Samples missing from the in-use profile because too many sampled allocations were alive
+} heap_trace_sampling_summary_t;
+
+/**
+ * @brief Start the sampling heap profiler.
+ *
+ * Instead of recording each allocation, one allocation is sampled every 'interval' allocated bytes
+ * on average, and the samples are aggregated by the call stack of the allocation. This is cheap
+ * enough to stay enabled in production. The profile is printed by heap_trace_sampling_dump().
+ *
+ * An allocation of N bytes is sampled with a probability of 1 - exp(-N / interval). Tools reading
+ * the profile scale the samples by the inverse of this probability to estimate the real numbers.
+ *
+ * @note Only available if CONFIG_HEAP_TRACE_SAMPLING is enabled in menuconfig. The sampling profiler
+ * and heap_trace_start() can't be used at the same time.
+ *
+ * @note Calling this function while the profiler is running will reset the profile and continue sampling.
+ *
+ * @param interval Average number of allocated bytes between two samples
+ * @return
+ * - ESP_ERR_INVALID_ARG interval is 0.
+ * - ESP_ERR_INVALID_STATE Heap tracing is in progress.
+ * - ESP_ERR_NO_MEM The tables of the profile could not be allocated.
+ * - ESP_OK Sampling is started.
+ */
+esp_err_t heap_trace_sampling_start(size_t interval);
+
+/**
+ * @brief Stop the sampling heap profiler.
+ *
+ * The profile is kept and can still be dumped. Frees of sampled allocations are no longer
+ * accounted to the in-use profile.
+ *
+ * @return
+ * - ESP_ERR_INVALID_STATE The sampling profiler was not running.
+ * - ESP_OK The sampling profiler is stopped.
+ */
+esp_err_t heap_trace_sampling_stop(void);
+
+/**
+ * @brief Dump the profile of the sampling heap profiler to stdout
+ *
+ * The profile is printed in the legacy text format of heap profiles understood by pprof, between
+ * a header and a summary line. components/heap/heap_trace_pprof.py converts it to a symbolized pprof profile.
+ *
+ * @note It is safe to call this function while the profiler is running.
+ */
+void heap_trace_sampling_dump(void);
+
+/**
+ * @brief Get summary information about the profile of the sampling heap profiler
+ *
+ * @note It is safe to call this function while the profiler is running.
+ *
+ * @param[out] summary Summary of the profile
+ * @return
+ * - ESP_ERR_INVALID_ARG summary is NULL.
+ * - ESP_OK Summary returned successfully.
+ */
+esp_err_t heap_trace_sampling_summary(heap_trace_sampling_summary_t *summary);
+
 #ifdef __cplusplus
 }
 #endif
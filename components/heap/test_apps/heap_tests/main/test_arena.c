@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_arena.h"
+#include "esp_memory_utils.h"
+
+TEST_CASE("arena allocates chunks with the requested caps and frees them", "[heap][arena]")
+{
+    const size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DMA);
+
+    heap_caps_arena_handle_t arena = heap_caps_arena_create(1024, MALLOC_CAP_DMA);
+    TEST_ASSERT_NOT_NULL(arena);
+    for (int i = 0; i < 200; i++) {
+        uint8_t *p = heap_caps_arena_alloc(arena, 24);
+        TEST_ASSERT_NOT_NULL(p);
+        TEST_ASSERT_TRUE(esp_ptr_dma_capable(p));
+        memset(p, i, 24);
+    }
+
+    heap_caps_arena_info_t info;
+    heap_caps_arena_get_info(arena, &info);
+    TEST_ASSERT_GREATER_THAN(1, info.chunks);
+    // The chunks are allocated from the heap
+    TEST_ASSERT_LESS_OR_EQUAL(free_before - info.total_size, heap_caps_get_free_size(MALLOC_CAP_DMA));
+
+    heap_caps_arena_reset(arena);
+    heap_caps_arena_get_info(arena, &info);
+    TEST_ASSERT_EQUAL(1, info.chunks);
+
+    heap_caps_arena_destroy(arena);
+    TEST_ASSERT_EQUAL(free_before, heap_caps_get_free_size(MALLOC_CAP_DMA));
+    TEST_ASSERT_TRUE(heap_caps_check_integrity_all(true));
+}
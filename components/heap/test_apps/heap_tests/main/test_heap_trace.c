@@ -268,6 +268,78 @@ TEST_CASE("check for summary value validity", "[heap-trace]") {
     heap_trace_stop();
 }
 
+#ifdef CONFIG_HEAP_TRACE_SAMPLING
+TEST_CASE("sampling profiler with a 1 byte interval samples every allocation", "[heap-trace]")
+{
+    const size_t alloc_size = 64;
+    const size_t num_allocs = 10;
+    void *ptrs[num_allocs];
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, heap_trace_sampling_start(0));
+    TEST_ASSERT_EQUAL(ESP_OK, heap_trace_sampling_start(1));
+
+    // the sampling profiler and heap_trace_start() are exclusive
+    heap_trace_record_t recs[2];
+    heap_trace_init_standalone(recs, 2);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, heap_trace_start(HEAP_TRACE_ALL));
+
+    // the distance between samples is at most ~22 times the interval, each allocation is sampled.
+    // Other tasks may allocate memory meanwhile, so their samples can be counted as well.
+    for (size_t i = 0; i < num_allocs; i++) {
+        ptrs[i] = heap_caps_malloc(alloc_size, MALLOC_CAP_INTERNAL);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+
+    heap_trace_sampling_summary_t summary;
+    TEST_ASSERT_EQUAL(ESP_OK, heap_trace_sampling_summary(&summary));
+    TEST_ASSERT_EQUAL(1, summary.interval);
+    TEST_ASSERT_GREATER_OR_EQUAL(num_allocs, summary.samples);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, summary.stacks);
+    TEST_ASSERT_GREATER_OR_EQUAL(num_allocs, summary.inuse_samples);
+    TEST_ASSERT_GREATER_OR_EQUAL(num_allocs * alloc_size, summary.inuse_bytes);
+    TEST_ASSERT_EQUAL(0, summary.dropped_samples);
+
+    for (size_t i = 0; i < num_allocs; i++) {
+        heap_caps_free(ptrs[i]);
+    }
+
+    // all the test's samples are gone from the in-use profile, at most new ones were added
+    heap_trace_sampling_summary_t after;
+    heap_trace_sampling_summary(&after);
+    TEST_ASSERT_GREATER_OR_EQUAL(summary.samples, after.samples);
+    TEST_ASSERT_LESS_OR_EQUAL(summary.inuse_samples - num_allocs + (after.samples - summary.samples), after.inuse_samples);
+
+    TEST_ASSERT_EQUAL(ESP_OK, heap_trace_sampling_stop());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, heap_trace_sampling_stop());
+    heap_trace_sampling_dump();
+}
+
+TEST_CASE("sampling profiler samples allocations at the configured rate", "[heap-trace]")
+{
+    const size_t interval = 4096;
+    const size_t alloc_size = 64;
+    const size_t num_allocs = 10000;
+
+    TEST_ASSERT_EQUAL(ESP_OK, heap_trace_sampling_start(interval));
+
+    for (size_t i = 0; i < num_allocs; i++) {
+        void *p = heap_caps_malloc(alloc_size, MALLOC_CAP_INTERNAL);
+        TEST_ASSERT_NOT_NULL(p);
+        heap_caps_free(p);
+    }
+
+    heap_trace_sampling_summary_t summary;
+    heap_trace_sampling_summary(&summary);
+    heap_trace_sampling_stop();
+    heap_trace_sampling_dump();
+
+    // num_allocs * (1 - exp(-alloc_size / interval)) = 155 samples expected, the standard deviation is 12
+    printf("%u samples\n", (unsigned)summary.samples);
+    TEST_ASSERT_INT_WITHIN(60, 155, summary.samples);
+    TEST_ASSERT_EQUAL(0, summary.inuse_samples);
+}
+#endif // CONFIG_HEAP_TRACE_SAMPLING
+
 #ifdef CONFIG_SPIRAM
 void* allocate_pointer(uint32_t caps)
 {
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Unlicense OR CC0-1.0
  */
@@ -9,9 +9,11 @@
 
 #include <esp_types.h>
 #include <stdio.h>
+#include <inttypes.h>
 #include "unity.h"
 #include "esp_attr.h"
 #include "esp_heap_caps.h"
+#include "esp_cpu.h"
 #include "spi_flash_mmap.h"
 #include "esp_memory_utils.h"
 #include "esp_private/spi_flash_os.h"
@@ -354,3 +356,48 @@ TEST_CASE("test memory protection features", "[heap][mem_prot]")
     TEST_ASSERT_NULL(iram_ptr);
 #endif // CONFIG_ESP_SYSTEM_MEMPROT_FEATURE
 }
+
+#define CAPS_BENCH_ITERATIONS   1000
+#define CAPS_BENCH_LIVE_BLOCKS  16
+#define CAPS_BENCH_SIZE         512     // bigger than allocations served by the per-core cache
+
+TEST_CASE("heap_caps_malloc latency for DMA, SPIRAM and internal memory", "[heap][benchmark]")
+{
+    const struct {
+        const char *name;
+        uint32_t caps;
+        bool (*check)(const void *p);
+    } bench[] = {
+        { "MALLOC_CAP_INTERNAL", MALLOC_CAP_INTERNAL, esp_ptr_internal },
+        { "MALLOC_CAP_DMA", MALLOC_CAP_DMA, esp_ptr_dma_capable },
+#if CONFIG_SPIRAM
+        { "MALLOC_CAP_SPIRAM", MALLOC_CAP_SPIRAM, esp_ptr_external_ram },
+#endif
+    };
+    void *blocks[CAPS_BENCH_LIVE_BLOCKS] = { 0 };
+
+    for (int b = 0; b < sizeof(bench) / sizeof(bench[0]); b++) {
+        uint32_t alloc_cycles = 0;
+        uint32_t free_cycles = 0;
+
+        for (int i = 0; i < CAPS_BENCH_ITERATIONS; i++) {
+            int n = i % CAPS_BENCH_LIVE_BLOCKS;
+            uint32_t start = esp_cpu_get_cycle_count();
+            heap_caps_free(blocks[n]);
+            uint32_t mid = esp_cpu_get_cycle_count();
+            blocks[n] = heap_caps_malloc(CAPS_BENCH_SIZE, bench[b].caps);
+            uint32_t end = esp_cpu_get_cycle_count();
+
+            TEST_ASSERT_NOT_NULL(blocks[n]);
+            TEST_ASSERT_TRUE(bench[b].check(blocks[n]));
+            free_cycles += mid - start;
+            alloc_cycles += end - mid;
+        }
+        for (int n = 0; n < CAPS_BENCH_LIVE_BLOCKS; n++) {
+            heap_caps_free(blocks[n]);
+            blocks[n] = NULL;
+        }
+        printf("%s: %"PRIu32" cycles per malloc, %"PRIu32" cycles per free\n", bench[b].name,
+               alloc_cycles / CAPS_BENCH_ITERATIONS, free_cycles / CAPS_BENCH_ITERATIONS);
+    }
+}
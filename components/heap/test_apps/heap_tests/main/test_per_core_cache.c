@@ -0,0 +1,135 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+
+#define CACHED_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+#ifdef CONFIG_HEAP_PER_CORE_CACHE
+
+TEST_CASE("per-core cache reuses small blocks and keeps their caps", "[heap]")
+{
+    // The test task is pinned to a core, so the next allocation of the same size class reuses the block
+    uint8_t *p = heap_caps_malloc(40, CACHED_CAPS);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_TRUE(esp_ptr_internal(p));
+    TEST_ASSERT_GREATER_OR_EQUAL(40, heap_caps_get_allocated_size(p));
+    memset(p, 0xAB, 40);
+    heap_caps_free(p);
+
+    uint8_t *q = heap_caps_malloc(33, CACHED_CAPS);
+    TEST_ASSERT_EQUAL_PTR(p, q);
+    heap_caps_free(q);
+
+    // Allocations with other caps do not use the cache
+    uint8_t *dma = heap_caps_malloc(40, MALLOC_CAP_DMA);
+    TEST_ASSERT_NOT_NULL(dma);
+    TEST_ASSERT_TRUE(esp_ptr_dma_capable(dma));
+    heap_caps_free(dma);
+
+    TEST_ASSERT_TRUE(heap_caps_check_integrity_all(true));
+}
+
+TEST_CASE("per-core cache blocks are counted as free memory", "[heap]")
+{
+    void *p[64];
+    const size_t free_before = heap_caps_get_free_size(CACHED_CAPS);
+
+    for (int i = 0; i < sizeof(p) / sizeof(p[0]); i++) {
+        p[i] = heap_caps_malloc(8 + (i % 8) * 8, CACHED_CAPS);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    TEST_ASSERT_LESS_THAN(free_before, heap_caps_get_free_size(CACHED_CAPS));
+    for (int i = 0; i < sizeof(p) / sizeof(p[0]); i++) {
+        heap_caps_free(p[i]);
+    }
+
+    // Querying the free size returns the cached blocks to the heap
+    TEST_ASSERT_EQUAL(free_before, heap_caps_get_free_size(CACHED_CAPS));
+    TEST_ASSERT_TRUE(heap_caps_check_integrity_all(true));
+}
+
+#endif // CONFIG_HEAP_PER_CORE_CACHE
+
+#define BENCH_ITERATIONS    20000
+#define BENCH_LIVE_BLOCKS   32
+#define BENCH_MAX_SIZE      128
+
+typedef struct {
+    SemaphoreHandle_t done;
+    uint32_t seed;
+    uint32_t cycles;
+    bool failed;
+} bench_task_ctx_t;
+
+static void alloc_free_task(void *arg)
+{
+    bench_task_ctx_t *ctx = (bench_task_ctx_t *)arg;
+    void *blocks[BENCH_LIVE_BLOCKS] = { 0 };
+    uint32_t seed = ctx->seed;
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = i % BENCH_LIVE_BLOCKS;
+        seed = seed * 1103515245 + 12345;
+        heap_caps_free(blocks[n]);
+        blocks[n] = heap_caps_malloc(1 + (seed >> 16) % BENCH_MAX_SIZE, MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL);
+        if (blocks[n] == NULL) {
+            ctx->failed = true;
+        }
+    }
+    for (int n = 0; n < BENCH_LIVE_BLOCKS; n++) {
+        heap_caps_free(blocks[n]);
+    }
+    ctx->cycles = esp_cpu_get_cycle_count() - start;
+
+    xSemaphoreGive(ctx->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("small allocations from tasks on all cores", "[heap][benchmark]")
+{
+    bench_task_ctx_t ctx[portNUM_PROCESSORS];
+
+#ifdef CONFIG_HEAP_PER_CORE_CACHE
+    printf("per-core cache: up to %d bytes\n", CONFIG_HEAP_PER_CORE_CACHE_MAX_SIZE);
+#else
+    printf("per-core cache: disabled\n");
+#endif
+    for (int tasks = 1; tasks <= portNUM_PROCESSORS; tasks++) {
+        for (int i = 0; i < tasks; i++) {
+            ctx[i] = (bench_task_ctx_t) {
+                .done = xSemaphoreCreateBinary(),
+                .seed = i + 1,
+            };
+            TEST_ASSERT_NOT_NULL(ctx[i].done);
+        }
+        for (int i = 0; i < tasks; i++) {
+            // Lower priority than the test task, so that all tasks are created before they start on its core
+            TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(alloc_free_task, "alloc_free", 4096, &ctx[i],
+                                                              CONFIG_UNITY_FREERTOS_PRIORITY - 1, NULL, i));
+        }
+        for (int i = 0; i < tasks; i++) {
+            xSemaphoreTake(ctx[i].done, portMAX_DELAY);
+            vSemaphoreDelete(ctx[i].done);
+            TEST_ASSERT_FALSE(ctx[i].failed);
+            printf("%d task(s), core %d: %"PRIu32" cycles per malloc/free pair\n", tasks, i,
+                   ctx[i].cycles / BENCH_ITERATIONS);
+        }
+    }
+    // Let the idle task free the memory of the deleted tasks
+    vTaskDelay(10);
+    TEST_ASSERT_TRUE(heap_caps_check_integrity_all(true));
+}
@@ -1,4 +1,4 @@
-# SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+# SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
 # SPDX-License-Identifier: CC0-1.0
 
 import pytest
@@ -50,6 +50,18 @@ def test_heap_in_flash(dut: Dut) -> None:
     dut.run_all_single_board_cases()
 
 
+@pytest.mark.generic
+@pytest.mark.supported_targets
+@pytest.mark.parametrize(
+    'config',
+    [
+        'per_core_cache'
+    ]
+)
+def test_heap_per_core_cache(dut: Dut) -> None:
+    dut.run_all_single_board_cases()
+
+
 @pytest.mark.generic
 @pytest.mark.esp32
 @pytest.mark.esp32s2
@@ -93,7 +105,8 @@ def test_heap_misc_options(dut: Dut) -> None:
     'config',
     [
         'heap_trace',
-        'heap_trace_hashmap'
+        'heap_trace_hashmap',
+        'heap_trace_sampling'
     ]
 )
 def test_heap_trace_dump(dut: Dut) -> None:
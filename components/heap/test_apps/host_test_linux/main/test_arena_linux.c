@@ -0,0 +1,316 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_arena.h"
+#include "unity.h"
+
+#define ARENA_SIZE 1024
+
+TEST_CASE("arena allocations are aligned and don't overlap", "[heap][arena]")
+{
+    heap_caps_arena_handle_t arena = heap_caps_arena_create(ARENA_SIZE, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(arena);
+    TEST_ASSERT_NULL(heap_caps_arena_alloc(arena, 0));
+
+    uint8_t *blocks[100];
+    for (int i = 0; i < 100; i++) {
+        blocks[i] = heap_caps_arena_alloc(arena, i + 1);
+        TEST_ASSERT_NOT_NULL(blocks[i]);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)blocks[i] % 8);
+        memset(blocks[i], i, i + 1);
+    }
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j <= i; j++) {
+            TEST_ASSERT_EQUAL(i, blocks[i][j]);
+        }
+    }
+
+    heap_caps_arena_info_t info;
+    heap_caps_arena_get_info(arena, &info);
+    TEST_ASSERT_EQUAL(100, info.allocated_blocks);
+    TEST_ASSERT_GREATER_OR_EQUAL(100 * 101 / 2, info.total_allocated_bytes);
+    TEST_ASSERT_GREATER_THAN(1, info.chunks);
+    TEST_ASSERT_GREATER_OR_EQUAL(info.total_allocated_bytes, info.total_size);
+    TEST_ASSERT_EQUAL(info.total_allocated_bytes, info.peak_allocated_bytes);
+
+    heap_caps_arena_destroy(arena);
+}
+
+TEST_CASE("arena gives big allocations a chunk of their own", "[heap][arena]")
+{
+    heap_caps_arena_handle_t arena = heap_caps_arena_create(ARENA_SIZE, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(arena);
+    heap_caps_arena_info_t before;
+    heap_caps_arena_get_info(arena, &before);
+
+    uint8_t *big = heap_caps_arena_alloc(arena, 4 * ARENA_SIZE);
+    TEST_ASSERT_NOT_NULL(big);
+    memset(big, 0x5A, 4 * ARENA_SIZE);
+
+    // The current chunk is still used for small allocations
+    heap_caps_arena_info_t after;
+    heap_caps_arena_get_info(arena, &after);
+    TEST_ASSERT_EQUAL(2, after.chunks);
+    TEST_ASSERT_EQUAL(before.total_free_bytes, after.total_free_bytes);
+    uint32_t *small = heap_caps_arena_calloc(arena, 4, sizeof(uint32_t));
+    TEST_ASSERT_NOT_NULL(small);
+    TEST_ASSERT_EQUAL(0, small[0] | small[1] | small[2] | small[3]);
+
+    heap_caps_arena_destroy(arena);
+}
+
+TEST_CASE("arena reset keeps only the first chunk", "[heap][arena]")
+{
+    heap_caps_arena_handle_t arena = heap_caps_arena_create(ARENA_SIZE, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(arena);
+    heap_caps_arena_info_t fresh;
+    heap_caps_arena_get_info(arena, &fresh);
+    void *first = heap_caps_arena_alloc(arena, 16);
+
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_NOT_NULL(heap_caps_arena_alloc(arena, 40));
+    }
+    heap_caps_arena_reset(arena);
+
+    heap_caps_arena_info_t info;
+    heap_caps_arena_get_info(arena, &info);
+    TEST_ASSERT_EQUAL(1, info.chunks);
+    TEST_ASSERT_EQUAL(fresh.total_size, info.total_size);
+    TEST_ASSERT_EQUAL(fresh.total_free_bytes, info.total_free_bytes);
+    TEST_ASSERT_EQUAL(0, info.total_allocated_bytes);
+    TEST_ASSERT_EQUAL(0, info.allocated_blocks);
+    TEST_ASSERT_GREATER_THAN(40 * 1000, info.peak_allocated_bytes);
+
+    // Memory is reused from the start of the first chunk
+    TEST_ASSERT_EQUAL_PTR(first, heap_caps_arena_alloc(arena, 16));
+
+    heap_caps_arena_destroy(arena);
+    heap_caps_arena_destroy(NULL);
+}
+
+/* JSON parse workload: a parser building a tree of many small nodes, freed all at once */
+
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT,
+} json_type_t;
+
+typedef struct json_node {
+    json_type_t type;
+    char *key;                  // key if the node is a member of an object
+    union {
+        bool boolean;
+        double number;
+        char *string;
+        struct json_node *child;
+    };
+    struct json_node *next;
+} json_node_t;
+
+typedef struct {
+    const char *p;
+    void *(*alloc)(void *ctx, size_t size);
+    void *ctx;
+} json_parser_t;
+
+static void skip_ws(json_parser_t *parser)
+{
+    while (*parser->p == ' ' || *parser->p == '\n' || *parser->p == '\t' || *parser->p == '\r') {
+        parser->p++;
+    }
+}
+
+static char *parse_string(json_parser_t *parser)
+{
+    const char *start = ++parser->p;
+    while (*parser->p != '"' && *parser->p != '\0') {
+        parser->p++;
+    }
+    size_t len = parser->p - start;
+    char *str = parser->alloc(parser->ctx, len + 1);
+    if (str != NULL) {
+        memcpy(str, start, len);
+        str[len] = '\0';
+    }
+    parser->p++;
+    return str;
+}
+
+static json_node_t *parse_value(json_parser_t *parser)
+{
+    skip_ws(parser);
+    json_node_t *node = parser->alloc(parser->ctx, sizeof(json_node_t));
+    if (node == NULL) {
+        return NULL;
+    }
+    memset(node, 0, sizeof(*node));
+
+    char c = *parser->p;
+    if (c == '{' || c == '[') {
+        const char close = (c == '{') ? '}' : ']';
+        json_node_t **tail = &node->child;
+        node->type = (c == '{') ? JSON_OBJECT : JSON_ARRAY;
+        parser->p++;
+        skip_ws(parser);
+        while (*parser->p != close) {
+            char *key = NULL;
+            if (node->type == JSON_OBJECT) {
+                key = parse_string(parser);
+                skip_ws(parser);
+                parser->p++; // ':'
+            }
+            json_node_t *child = parse_value(parser);
+            if (child == NULL) {
+                return NULL;
+            }
+            child->key = key;
+            *tail = child;
+            tail = &child->next;
+            skip_ws(parser);
+            if (*parser->p == ',') {
+                parser->p++;
+                skip_ws(parser);
+            }
+        }
+        parser->p++;
+    } else if (c == '"') {
+        node->type = JSON_STRING;
+        node->string = parse_string(parser);
+    } else if (c == 't' || c == 'f') {
+        node->type = JSON_BOOL;
+        node->boolean = (c == 't');
+        parser->p += node->boolean ? 4 : 5;
+    } else if (c == 'n') {
+        node->type = JSON_NULL;
+        parser->p += 4;
+    } else {
+        char *end;
+        node->type = JSON_NUMBER;
+        node->number = strtod(parser->p, &end);
+        parser->p = end;
+    }
+    return node;
+}
+
+static void json_free(json_node_t *node)
+{
+    while (node != NULL) {
+        json_node_t *next = node->next;
+        free(node->key);
+        if (node->type == JSON_STRING) {
+            free(node->string);
+        } else if (node->type == JSON_ARRAY || node->type == JSON_OBJECT) {
+            json_free(node->child);
+        }
+        free(node);
+        node = next;
+    }
+}
+
+static double json_sum(const json_node_t *node)
+{
+    double sum = 0;
+    for (; node != NULL; node = node->next) {
+        if (node->type == JSON_NUMBER) {
+            sum += node->number;
+        } else if (node->type == JSON_ARRAY || node->type == JSON_OBJECT) {
+            sum += json_sum(node->child);
+        }
+    }
+    return sum;
+}
+
+static void *malloc_alloc(void *ctx, size_t size)
+{
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *arena_alloc(void *ctx, size_t size)
+{
+    return heap_caps_arena_alloc((heap_caps_arena_handle_t)ctx, size);
+}
+
+static char *make_json_document(int records)
+{
+    const size_t max_record_len = 160;
+    char *doc = malloc(records * max_record_len + 3);
+    TEST_ASSERT_NOT_NULL(doc);
+    char *p = doc;
+    *p++ = '[';
+    for (int i = 0; i < records; i++) {
+        p += sprintf(p, "%s{\"id\":%d,\"name\":\"sensor-%d\",\"enabled\":%s,\"unit\":null,"
+                     "\"values\":[%d.5,%d.25,%d,%d]}", i > 0 ? "," : "", i, i, (i % 2) ? "true" : "false",
+                     i, i + 1, i + 2, i + 3);
+    }
+    *p++ = ']';
+    *p = '\0';
+    return doc;
+}
+
+static double get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define JSON_RECORDS        50
+#define JSON_ITERATIONS     2000
+
+TEST_CASE("arena versus malloc/free for a JSON parse workload", "[heap][arena][benchmark]")
+{
+    char *doc = make_json_document(JSON_RECORDS);
+    heap_caps_arena_handle_t arena = heap_caps_arena_create(4096, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(arena);
+    double expected_sum = 0;
+    for (int i = 0; i < JSON_RECORDS; i++) {
+        // id and the four values
+        expected_sum += i + (i + 0.5) + (i + 1.25) + (i + 2) + (i + 3);
+    }
+
+    double start = get_time_ns();
+    for (int i = 0; i < JSON_ITERATIONS; i++) {
+        json_parser_t parser = { .p = doc, .alloc = malloc_alloc };
+        json_node_t *root = parse_value(&parser);
+        TEST_ASSERT_NOT_NULL(root);
+        TEST_ASSERT_EQUAL_DOUBLE(expected_sum, json_sum(root->child));
+        json_free(root);
+    }
+    double malloc_ns = (get_time_ns() - start) / JSON_ITERATIONS;
+
+    heap_caps_arena_info_t info;
+    start = get_time_ns();
+    for (int i = 0; i < JSON_ITERATIONS; i++) {
+        json_parser_t parser = { .p = doc, .alloc = arena_alloc, .ctx = arena };
+        json_node_t *root = parse_value(&parser);
+        TEST_ASSERT_NOT_NULL(root);
+        TEST_ASSERT_EQUAL_DOUBLE(expected_sum, json_sum(root->child));
+        if (i == 0) {
+            heap_caps_arena_get_info(arena, &info);
+        }
+        heap_caps_arena_reset(arena);
+    }
+    double arena_ns = (get_time_ns() - start) / JSON_ITERATIONS;
+
+    printf("JSON document: %zu bytes, %zu allocations of %zu bytes in total per parse\n", strlen(doc),
+           info.allocated_blocks, info.total_allocated_bytes);
+    printf("malloc/free: %.1f us per parse\n", malloc_ns / 1000);
+    printf("arena:       %.1f us per parse\n", arena_ns / 1000);
+
+    heap_caps_arena_destroy(arena);
+    free(doc);
+}
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
 #include "sdkconfig.h"
 #include "esp_heap_caps.h"
 #include "unity.h"
@@ -105,6 +107,69 @@ TEST_CASE("Misc APIs", "[heap]")
     TEST_ASSERT_TRUE(alloc_failed);
 }
 
+#define BENCH_MAX_THREADS   4
+#define BENCH_ITERATIONS    200000
+#define BENCH_LIVE_BLOCKS   32
+#define BENCH_MAX_SIZE      128
+
+typedef struct {
+    uint32_t seed;
+    bool failed;
+} bench_thread_ctx_t;
+
+static void *alloc_free_thread(void *arg)
+{
+    bench_thread_ctx_t *ctx = (bench_thread_ctx_t *)arg;
+    void *blocks[BENCH_LIVE_BLOCKS] = { 0 };
+    uint32_t seed = ctx->seed;
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = i % BENCH_LIVE_BLOCKS;
+        seed = seed * 1103515245 + 12345;
+        heap_caps_free(blocks[n]);
+        blocks[n] = heap_caps_malloc(1 + (seed >> 16) % BENCH_MAX_SIZE, MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL);
+        if (blocks[n] == NULL) {
+            ctx->failed = true;
+        }
+    }
+    for (int n = 0; n < BENCH_LIVE_BLOCKS; n++) {
+        heap_caps_free(blocks[n]);
+    }
+    return NULL;
+}
+
+static double get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Baseline for the "small allocations from tasks on all cores" benchmark of the target heap tests,
+   measured against heap_caps_linux.c, which wraps the system malloc */
+TEST_CASE("small allocations from multiple threads", "[heap][benchmark]")
+{
+    pthread_t threads[BENCH_MAX_THREADS];
+    bench_thread_ctx_t ctx[BENCH_MAX_THREADS];
+
+    for (int count = 1; count <= BENCH_MAX_THREADS; count *= 2) {
+        double start = get_time_ns();
+        for (int i = 0; i < count; i++) {
+            ctx[i] = (bench_thread_ctx_t) {
+                .seed = i + 1,
+            };
+            TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, alloc_free_thread, &ctx[i]));
+        }
+        for (int i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL(0, pthread_join(threads[i], NULL));
+            TEST_ASSERT_FALSE(ctx[i].failed);
+        }
+        // Time per malloc/free pair of all threads together, lower is better
+        double elapsed_ns = get_time_ns() - start;
+        printf("%d thread(s): %.1f ns per malloc/free pair\n", count, elapsed_ns / (count * BENCH_ITERATIONS));
+    }
+}
+
 void app_main(void)
 {
     printf("Running heap linux API host test app");
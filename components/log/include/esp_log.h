@@ -15,6 +15,7 @@
 #include "esp_log_color.h"
 #include "esp_log_buffer.h"
 #include "esp_log_timestamp.h"
+#include "esp_log_tag.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -205,6 +206,41 @@ void esp_log_writev(esp_log_level_t level, const char* tag, const char* format,
         if (_ESP_LOG_ENABLED(level)) ESP_LOG_LEVEL(level, tag, format, ##__VA_ARGS__); \
     } while(0)
 
+/**
+ * Macro to output logs at ESP_LOG_ERROR level with a tag defined by ``ESP_LOG_TAG_DEFINE``.
+ *
+ * With ``CONFIG_LOG_TAG_LEVEL_INTERNED``, the level of the tag is read from the tag itself,
+ * without the tag lookup of ``ESP_LOGE``. This makes messages which are filtered out much cheaper.
+ * Otherwise, this is the same as ``ESP_LOGE`` with the name of the tag.
+ *
+ * @param tag tag defined by ``ESP_LOG_TAG_DEFINE``, whose level can be changed by ``esp_log_level_set`` at runtime.
+ *
+ * @see ``ESP_LOGE``
+ */
+#if CONFIG_LOG_TAG_LEVEL_INTERNED && !BOOTLOADER_BUILD
+#define ESP_TAG_LOGE( tag, format, ... ) ESP_TAG_LOG_LEVEL_LOCAL(ESP_LOG_ERROR,   tag, format, ##__VA_ARGS__)
+/// macro to output logs at ``ESP_LOG_WARN`` level with a tag defined by ``ESP_LOG_TAG_DEFINE``.  @see ``ESP_TAG_LOGE``
+#define ESP_TAG_LOGW( tag, format, ... ) ESP_TAG_LOG_LEVEL_LOCAL(ESP_LOG_WARN,    tag, format, ##__VA_ARGS__)
+/// macro to output logs at ``ESP_LOG_INFO`` level with a tag defined by ``ESP_LOG_TAG_DEFINE``.  @see ``ESP_TAG_LOGE``
+#define ESP_TAG_LOGI( tag, format, ... ) ESP_TAG_LOG_LEVEL_LOCAL(ESP_LOG_INFO,    tag, format, ##__VA_ARGS__)
+/// macro to output logs at ``ESP_LOG_DEBUG`` level with a tag defined by ``ESP_LOG_TAG_DEFINE``.  @see ``ESP_TAG_LOGE``
+#define ESP_TAG_LOGD( tag, format, ... ) ESP_TAG_LOG_LEVEL_LOCAL(ESP_LOG_DEBUG,   tag, format, ##__VA_ARGS__)
+/// macro to output logs at ``ESP_LOG_VERBOSE`` level with a tag defined by ``ESP_LOG_TAG_DEFINE``.  @see ``ESP_TAG_LOGE``
+#define ESP_TAG_LOGV( tag, format, ... ) ESP_TAG_LOG_LEVEL_LOCAL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+
+/** @cond */
+#define ESP_TAG_LOG_LEVEL_LOCAL(level, tag, format, ...) do {           \
+        if (_ESP_LOG_ENABLED(level) && _ESP_LOG_TAG_ENABLED(tag, level)) ESP_LOG_LEVEL(level, (tag).name, format, ##__VA_ARGS__); \
+    } while(0)
+/** @endcond */
+#else // !(CONFIG_LOG_TAG_LEVEL_INTERNED && !BOOTLOADER_BUILD)
+#define ESP_TAG_LOGE( tag, format, ... ) ESP_LOGE((tag).name, format, ##__VA_ARGS__)
+#define ESP_TAG_LOGW( tag, format, ... ) ESP_LOGW((tag).name, format, ##__VA_ARGS__)
+#define ESP_TAG_LOGI( tag, format, ... ) ESP_LOGI((tag).name, format, ##__VA_ARGS__)
+#define ESP_TAG_LOGD( tag, format, ... ) ESP_LOGD((tag).name, format, ##__VA_ARGS__)
+#define ESP_TAG_LOGV( tag, format, ... ) ESP_LOGV((tag).name, format, ##__VA_ARGS__)
+#endif // !(CONFIG_LOG_TAG_LEVEL_INTERNED && !BOOTLOADER_BUILD)
+
 /**
  * @brief Macro to output logs when the cache is disabled. Log at ``ESP_LOG_ERROR`` level.
  *
@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Enable or disable deferred logging at runtime
+ *
+ * Deferred logging is enabled at startup if CONFIG_LOG_DEFERRED is set. While it is disabled,
+ * messages are formatted and output by the task which logs them. Messages which were already
+ * buffered are still output by the output task.
+ *
+ * @note Only available if CONFIG_LOG_DEFERRED is enabled.
+ *
+ * @param enable true to defer the formatting of messages, false to format them immediately.
+ */
+void esp_log_deferred_enable(bool enable);
+
+/**
+ * @brief Output all buffered messages in the context of the calling task
+ *
+ * This can be used before a reset or before entering a sleep mode, to make sure
+ * that no buffered message is lost.
+ *
+ * @note Only available if CONFIG_LOG_DEFERRED is enabled. Must not be called from an ISR.
+ */
+void esp_log_deferred_flush(void);
+
+/**
+ * @brief Get the number of messages which were dropped because the buffer was full
+ *
+ * @note Only available if CONFIG_LOG_DEFERRED is enabled.
+ *
+ * @return Number of dropped messages since startup.
+ */
+uint32_t esp_log_deferred_get_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_log_level.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Log tag defined with ESP_LOG_TAG_DEFINE
+ *
+ * Used with the ESP_TAG_LOGx macros. With CONFIG_LOG_TAG_LEVEL_INTERNED, all tags are placed
+ * by the linker in one table and hold their current log level, so checking whether a message is
+ * enabled doesn't require looking up the tag.
+ */
+typedef struct {
+    esp_log_level_t level;      /*!< Current log level of the tag, updated by esp_log_level_set() */
+    const char *name;           /*!< Name of the tag, as passed to esp_log_level_set() */
+} esp_log_tag_t;
+
+/**
+ * @brief Define a log tag for the ESP_TAG_LOGx macros
+ *
+ * Usage: `ESP_LOG_TAG_DEFINE(s_tag, "my_module");` at file scope, then `ESP_TAG_LOGI(s_tag, "format", ...);`.
+ *
+ * Several files may define tags with the same name, esp_log_level_set() changes the level of all of them.
+ *
+ * @param var   Name of the static variable holding the tag
+ * @param tag   Name of the tag, a string literal
+ */
+#if CONFIG_LOG_TAG_LEVEL_INTERNED && !BOOTLOADER_BUILD
+#define ESP_LOG_TAG_DEFINE(var, tag) \
+    static esp_log_tag_t var __attribute__((section(".esp_log_tags"), used)) = { (esp_log_level_t)CONFIG_LOG_DEFAULT_LEVEL, tag }
+#else
+#define ESP_LOG_TAG_DEFINE(var, tag) \
+    static const esp_log_tag_t var = { (esp_log_level_t)CONFIG_LOG_DEFAULT_LEVEL, tag }
+#endif
+
+#if CONFIG_LOG_TAG_LEVEL_INTERNED || __DOXYGEN__
+
+/**
+ * @brief Get the ID of a tag defined with ESP_LOG_TAG_DEFINE
+ *
+ * Tags are numbered from 0 in the order the linker places them. Tags with the same name defined
+ * in different files have different IDs.
+ *
+ * @note Only available if CONFIG_LOG_TAG_LEVEL_INTERNED is enabled.
+ *
+ * @param tag   Pointer to the tag
+ * @return      ID of the tag, lower than esp_log_tag_count().
+ */
+uint32_t esp_log_tag_id(const esp_log_tag_t *tag);
+
+/**
+ * @brief Get the number of tags defined with ESP_LOG_TAG_DEFINE in the application
+ *
+ * @note Only available if CONFIG_LOG_TAG_LEVEL_INTERNED is enabled.
+ *
+ * @return Number of tags.
+ */
+uint32_t esp_log_tag_count(void);
+
+#endif // CONFIG_LOG_TAG_LEVEL_INTERNED
+
+/** @cond */
+#if CONFIG_LOG_TAG_LEVEL_INTERNED && !BOOTLOADER_BUILD
+#define _ESP_LOG_TAG_ENABLED(tag, log_level) ((tag).level >= (log_level))
+#endif
+/** @endcond */
+
+#ifdef __cplusplus
+}
+#endif
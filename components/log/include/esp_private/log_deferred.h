@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include "esp_log_level.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Store a message in the deferred log buffer of the current CPU core.
+ *
+ * @return true if the message was buffered or dropped, false if it has to be output immediately.
+ */
+bool esp_log_deferred_writev(esp_log_level_t level, const char *format, va_list args);
+
+/**
+ * @brief Output a formatted message with the function set by esp_log_set_vprintf().
+ */
+void esp_log_impl_vprint(const char *format, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
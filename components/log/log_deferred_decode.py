@@ -0,0 +1,177 @@
+#!/usr/bin/env python
+#
+# Decodes the output of deferred logging in binary mode (CONFIG_LOG_DEFERRED_OUTPUT_BINARY).
+#
+# Each deferred message is output as a line "#dl:<base64>" holding the address of the
+# format string and the raw arguments. The format strings and the string arguments stored
+# in flash are read from the ELF file of the application and the messages are formatted
+# like printf() does on the device. Other lines are passed through unchanged.
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import argparse
+import base64
+import binascii
+import re
+import struct
+import sys
+from typing import List
+from typing import Optional
+from typing import Tuple
+
+LINE_PREFIX = '#dl:'
+STRING_MAX_LEN = 64
+
+ENTRY_SEQUENCE = 1
+ENTRY_FORMAT = 2
+ENTRY_ARGS = 3
+
+SHT_PROGBITS = 1
+SHF_ALLOC = 2
+
+CONV_SPEC_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|q|z|t)?([diouxXcpeEfFgGaAs%])')
+
+
+class Elf(object):
+    """ Minimal ELF reader giving access to the contents of the sections loaded in memory """
+    def __init__(self, path: str) -> None:
+        with open(path, 'rb') as f:
+            data = f.read()
+        if data[:4] != b'\x7fELF':
+            raise RuntimeError('{} is not an ELF file'.format(path))
+        is_64bit = data[4] == 2
+        endian = '<' if data[5] == 1 else '>'
+        if is_64bit:
+            shoff, = struct.unpack_from(endian + 'Q', data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x3a)
+            section_fmt = endian + 'IIQQQQ'
+        else:
+            shoff, = struct.unpack_from(endian + 'I', data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x2e)
+            section_fmt = endian + 'IIIIII'
+        self.sections = []  # type: List[Tuple[int, bytes]]
+        for i in range(shnum):
+            _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = struct.unpack_from(section_fmt, data, shoff + i * shentsize)
+            if sh_type == SHT_PROGBITS and sh_flags & SHF_ALLOC and sh_size > 0:
+                self.sections.append((sh_addr, data[sh_offset:sh_offset + sh_size]))
+
+    def read_string(self, address: int) -> Optional[str]:
+        for start, content in self.sections:
+            if start <= address < start + len(content):
+                end = content.find(b'\0', address - start)
+                if end < 0:
+                    end = len(content)
+                return content[address - start:end].decode('utf-8', errors='replace')
+        return None
+
+
+def to_signed(value: int, bits: int) -> int:
+    value &= (1 << bits) - 1
+    return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+
+def format_entry(elf: Elf, words: List[int]) -> str:
+    """ Format a message like printf() on the device, see encode_args() in src/os/log_deferred.c """
+    fmt = elf.read_string(words[ENTRY_FORMAT])
+    if fmt is None:
+        raise ValueError('format string at 0x{:08x} not found in the ELF file'.format(words[ENTRY_FORMAT]))
+    n = ENTRY_ARGS
+    out = []
+    pos = 0
+    for spec in CONV_SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:spec.start()])
+        pos = spec.end()
+        flags, width, precision, length, conv = spec.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        args = []  # type: List[object]
+        for star in (width, precision):
+            if star == '*':
+                args.append(to_signed(words[n], 32))
+                n += 1
+        if conv in 'sc':
+            if conv == 's':
+                if words[n] > STRING_MAX_LEN:
+                    value = elf.read_string(words[n]) or '<0x{:08x}>'.format(words[n])  # type: object
+                    n += 1
+                else:
+                    length_bytes = words[n]
+                    data = b''.join(struct.pack('<I', w) for w in words[n + 1:n + 1 + (length_bytes + 3) // 4])
+                    value = data[:length_bytes].decode('utf-8', errors='replace')
+                    n += 1 + (length_bytes + 3) // 4
+            else:
+                value = chr(words[n] & 0xff)
+                n += 1
+        elif conv in 'eEfFgGaA':
+            value, = struct.unpack('<d', struct.pack('<II', words[n], words[n + 1]))
+            n += 2
+            if conv in 'aA':
+                value = float(value).hex()  # no %a in Python, approximate
+                conv = 's'
+        else:
+            bits = 64 if length in ('ll', 'j', 'q') else 8 if length == 'hh' else 16 if length == 'h' else 32
+            if bits == 64:
+                raw = words[n] | (words[n + 1] << 32)
+                n += 2
+            else:
+                raw = words[n]
+                n += 1
+            if conv == 'p':
+                flags += '#'
+                conv = 'x'
+            if conv in 'di':
+                value = to_signed(raw, bits)
+                conv = 'd'
+            else:
+                value = raw & ((1 << bits) - 1)
+                if conv == 'u':
+                    conv = 'd'
+                elif conv == 'o' and '#' in flags:
+                    # C prefixes octal numbers with '0', Python with '0o'
+                    flags = flags.replace('#', '')
+                    precision = str(max(len('{:o}'.format(value)) + 1, int(precision or 0))) if value else precision
+        py_spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '') + conv
+        out.append(py_spec % tuple(args + [value]))
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode_line(elf: Elf, line: str) -> str:
+    start = line.find(LINE_PREFIX)
+    if start < 0:
+        return line
+    try:
+        data = base64.b64decode(line[start + len(LINE_PREFIX):].strip(), validate=True)
+        words = list(struct.unpack('<{}I'.format(len(data) // 4), data[:len(data) // 4 * 4]))
+        if len(words) <= ENTRY_FORMAT or (words[0] & 0xff) != len(words):
+            raise ValueError('truncated message')
+        return line[:start] + format_entry(elf, words)
+    except (binascii.Error, ValueError, IndexError, TypeError, struct.error) as e:
+        return '{} <undecodable: {}>\n'.format(line.rstrip('\r\n'), e)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Decode the output of deferred logging in binary mode')
+    parser.add_argument('elf', help='ELF file of the application')
+    parser.add_argument('log', nargs='?', default='-', help='Console log to decode, - for stdin (default)')
+    args = parser.parse_args()
+
+    try:
+        elf = Elf(args.elf)
+    except (RuntimeError, OSError, struct.error) as e:
+        print('Error: {}'.format(e), file=sys.stderr)
+        sys.exit(1)
+
+    log = sys.stdin if args.log == '-' else open(args.log, 'r', errors='replace')
+    try:
+        for line in log:
+            sys.stdout.write(decode_line(elf, line))
+            sys.stdout.flush()
+    finally:
+        if log is not sys.stdin:
+            log.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_log_level.h"
+#include "esp_log_tag.h"
+#include "log_interned.h"
+
+/* Table of the tags defined with ESP_LOG_TAG_DEFINE, placed by the linker script */
+extern esp_log_tag_t _esp_log_tags_start[];
+extern esp_log_tag_t _esp_log_tags_end[];
+
+void esp_log_interned_set_level(const char *tag, esp_log_level_t level)
+{
+    const bool all = (strcmp(tag, "*") == 0);
+    for (esp_log_tag_t *it = _esp_log_tags_start; it < _esp_log_tags_end; it++) {
+        if (all || strcmp(it->name, tag) == 0) {
+            it->level = level;
+        }
+    }
+}
+
+uint32_t esp_log_tag_id(const esp_log_tag_t *tag)
+{
+    return tag - _esp_log_tags_start;
+}
+
+uint32_t esp_log_tag_count(void)
+{
+    return _esp_log_tags_end - _esp_log_tags_start;
+}
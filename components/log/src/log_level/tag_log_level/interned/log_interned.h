@@ -0,0 +1,19 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#include "esp_log_level.h"
+
+/**
+ * @brief Set the log level of the interned tags defined with ESP_LOG_TAG_DEFINE.
+ *
+ * All tags with the given name are updated, "*" updates all tags.
+ * Must be called with the log lock taken.
+ *
+ * @param tag The log tag for which to set the log level.
+ * @param level The log level to be set for the specified log tag.
+ */
+void esp_log_interned_set_level(const char *tag, esp_log_level_t level);
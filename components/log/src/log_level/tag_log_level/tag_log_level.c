@@ -25,6 +25,10 @@
 #define CACHE_ENABLED 0
 #endif
 
+#if CONFIG_LOG_TAG_LEVEL_INTERNED
+#include "interned/log_interned.h"
+#endif
+
 #if !CONFIG_LOG_TAG_LEVEL_IMPL_NONE
 
 static inline void log_level_set(const char *tag, esp_log_level_t level);
@@ -43,6 +47,9 @@ static inline void log_level_set(const char *tag, esp_log_level_t level)
         esp_log_linked_list_clean();
 #if CACHE_ENABLED
         esp_log_cache_clean();
+#endif
+#if CONFIG_LOG_TAG_LEVEL_INTERNED
+        esp_log_interned_set_level(tag, level);
 #endif
     } else {
         __attribute__((unused)) bool success = esp_log_linked_list_set_level(tag, level);
@@ -50,6 +57,11 @@ static inline void log_level_set(const char *tag, esp_log_level_t level)
         if (success) {
             esp_log_cache_set_level(tag, level);
         }
+#endif
+#if CONFIG_LOG_TAG_LEVEL_INTERNED
+        if (success) {
+            esp_log_interned_set_level(tag, level);
+        }
 #endif
     }
     esp_log_impl_unlock();
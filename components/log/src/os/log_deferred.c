@@ -0,0 +1,501 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Deferred logging
+ *
+ * esp_log_deferred_writev() doesn't format the message. It walks the conversion specifications of
+ * the format string only to copy the raw arguments into an entry of words, which is appended to
+ * the ring buffer of the current CPU core. The output task formats the entries later, or outputs
+ * them base64-encoded to be formatted on the host with the format strings of the ELF file.
+ *
+ * Writers reserve space in a ring, fill in the entry and then store its header word, which marks
+ * the entry as complete, all in a critical section of the ring: a writer preempted between the
+ * reservation and the header would keep the reader from consuming the following entries. The lock
+ * is only contended when a task has been moved to the other core. All words of the free part of a
+ * ring are zero, the reader clears the words of each entry it consumes before advancing the tail.
+ *
+ * Entry layout:
+ *   word 0: number of words of the entry | level << 8
+ *   word 1: sequence number, used to merge the rings of the cores in order
+ *   word 2: address of the format string, which is in flash
+ *   word 3...: arguments, one word for 32-bit values, two words for 64-bit integers and doubles.
+ *              A string in flash is stored as its address, other strings as their length
+ *              (at most STRING_MAX_LEN, or the precision of the specification) followed by their
+ *              characters.
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_assert.h"
+#include "esp_compiler.h"
+#include "esp_cpu.h"
+#include "esp_memory_utils.h"
+#include "esp_log.h"
+#include "esp_log_deferred.h"
+#include "esp_private/log_lock.h"
+#include "esp_private/log_deferred.h"
+#include "sdkconfig.h"
+
+#define RING_WORDS              (CONFIG_LOG_DEFERRED_BUFFER_SIZE / sizeof(uint32_t))
+#define RING_MASK               (RING_WORDS - 1)
+#define ENTRY_MAX_WORDS         64
+#define ENTRY_HEADER            0
+#define ENTRY_SEQUENCE          1
+#define ENTRY_FORMAT            2
+#define ENTRY_ARGS              3
+#define STRING_MAX_LEN          64
+#define LINE_MAX_LEN            256
+#define OUTPUT_PERIOD_MS        10
+#define BINARY_LINE_PREFIX      "#dl:"
+#define PRECISION_NONE          (-1)
+#define PRECISION_ARG           (-2)    // "%.*s", the precision is the last '*' argument
+
+ESP_STATIC_ASSERT((RING_WORDS & RING_MASK) == 0, "CONFIG_LOG_DEFERRED_BUFFER_SIZE must be a power of two");
+
+typedef struct {
+    portMUX_TYPE lock;              // held by writers from the reservation of an entry until it is published
+    uint32_t head;                  // words reserved by writers, free running
+    uint32_t tail;                  // words consumed by the reader, free running
+    uint32_t words[RING_WORDS];
+} log_ring_t;
+
+typedef enum {
+    ARG_NONE,                       // "%%", no argument
+    ARG_INT,                        // integer of up to 32 bits or pointer, one word
+    ARG_INT64,                      // long long or intmax_t, two words
+    ARG_DOUBLE,                     // two words
+    ARG_STRING,                     // "%s"
+    ARG_UNSUPPORTED,                // the message can't be deferred
+} arg_type_t;
+
+typedef struct {
+    arg_type_t type;
+    int stars;                      // number of '*' width and precision arguments before the value
+    int precision;                  // PRECISION_NONE, PRECISION_ARG or the precision
+    size_t len;                     // length of the specification, including '%'
+} conv_spec_t;
+
+static log_ring_t s_rings[portNUM_PROCESSORS];
+static uint32_t s_sequence;
+static uint32_t s_dropped;
+static uint32_t s_dropped_reported;
+static bool s_enabled = true;
+static TaskHandle_t s_task;
+static uint32_t s_task_state;       // 0: not created, 1: being created, 2: running
+
+/* Parse the conversion specification starting at the '%' at 'p', return the character following it */
+static const char *parse_conv_spec(const char *p, conv_spec_t *spec)
+{
+    const char *start = p++;
+    bool is_64bit = false;
+
+    spec->stars = 0;
+    spec->precision = PRECISION_NONE;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+        p++;
+    }
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->stars++;
+            spec->precision = PRECISION_ARG;
+            p++;
+        } else {
+            spec->precision = 0;
+            while (*p >= '0' && *p <= '9') {
+                spec->precision = MIN(spec->precision * 10 + (*p - '0'), STRING_MAX_LEN);
+                p++;
+            }
+        }
+    }
+    if (*p == 'h') {
+        p += (p[1] == 'h') ? 2 : 1;
+    } else if (*p == 'l') {
+        is_64bit = (p[1] == 'l');
+        p += is_64bit ? 2 : 1;
+    } else if (*p == 'j' || *p == 'q') {
+        is_64bit = true;
+        p++;
+    } else if (*p == 'z' || *p == 't') {
+        p++;
+    }
+
+    switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        spec->type = is_64bit ? ARG_INT64 : ARG_INT;
+        break;
+    case 'p':
+        spec->type = ARG_INT;
+        break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        spec->type = ARG_DOUBLE;
+        break;
+    case 's':
+        spec->type = ARG_STRING;
+        break;
+    case '%':
+        spec->type = ARG_NONE;
+        break;
+    default: // "%n", "%L", wide characters or a truncated specification
+        spec->type = ARG_UNSUPPORTED;
+        return p;
+    }
+    p++;
+    spec->len = p - start;
+    return p;
+}
+
+/* Copy the arguments of a message into 'entry', return the number of words or 0 if it can't be deferred */
+static size_t encode_args(uint32_t *entry, const char *format, va_list args)
+{
+    size_t n = ENTRY_ARGS;
+
+    for (const char *p = format; *p != '\0';) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+        conv_spec_t spec;
+        p = parse_conv_spec(p, &spec);
+        if (spec.type == ARG_UNSUPPORTED || n + spec.stars + 2 > ENTRY_MAX_WORDS) {
+            return 0;
+        }
+        int precision = spec.precision;
+        for (int i = 0; i < spec.stars; i++) {
+            const int value = va_arg(args, int);
+            entry[n++] = value;
+            if (i == spec.stars - 1 && spec.precision == PRECISION_ARG) {
+                precision = value; // a negative precision is taken as if it was omitted
+            }
+        }
+        switch (spec.type) {
+        case ARG_INT:
+            entry[n++] = va_arg(args, uint32_t);
+            break;
+        case ARG_INT64: {
+            const uint64_t value = va_arg(args, uint64_t);
+            memcpy(&entry[n], &value, sizeof(value));
+            n += 2;
+            break;
+        }
+        case ARG_DOUBLE: {
+            const double value = va_arg(args, double);
+            memcpy(&entry[n], &value, sizeof(value));
+            n += 2;
+            break;
+        }
+        case ARG_STRING: {
+            const char *str = va_arg(args, const char *);
+            if (str == NULL) {
+                str = "(null)";
+            }
+            if (esp_ptr_in_drom(str)) {
+                entry[n++] = (uint32_t)str;
+                break;
+            }
+            // The string may change before the message is output, copy it. With a precision, the
+            // string doesn't have to be NUL-terminated, so don't read past the precision.
+            const size_t len = strnlen(str, (precision >= 0) ? MIN(precision, STRING_MAX_LEN) : STRING_MAX_LEN);
+            if (n + 1 + (len + 3) / 4 > ENTRY_MAX_WORDS) {
+                return 0;
+            }
+            entry[n++] = len;
+            if (len > 0) {
+                entry[n + (len - 1) / 4] = 0;
+            }
+            memcpy(&entry[n], str, len);
+            n += (len + 3) / 4;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return n;
+}
+
+static void start_output_task(void);
+
+bool esp_log_deferred_writev(esp_log_level_t level, const char *format, va_list args)
+{
+    // Messages logged before the scheduler starts are output immediately, as well as those
+    // with a format string in RAM, which could be gone before the message is output.
+    if (!s_enabled || !esp_ptr_in_drom(format) || xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return false;
+    }
+    if (unlikely(__atomic_load_n(&s_task_state, __ATOMIC_ACQUIRE) != 2)) {
+        if (xPortInIsrContext()) {
+            return false;
+        }
+        start_output_task();
+        if (__atomic_load_n(&s_task_state, __ATOMIC_ACQUIRE) != 2) {
+            return false;
+        }
+    }
+
+    uint32_t entry[ENTRY_MAX_WORDS];
+    va_list list;
+    va_copy(list, args);
+    const size_t words = encode_args(entry, format, list);
+    va_end(list);
+    if (words == 0) {
+        return false;
+    }
+    entry[ENTRY_SEQUENCE] = __atomic_fetch_add(&s_sequence, 1, __ATOMIC_RELAXED);
+    entry[ENTRY_FORMAT] = (uint32_t)format;
+
+    // A task may be moved to the other core meanwhile, which is fine as the ring is multi-producer
+    log_ring_t *ring = &s_rings[esp_cpu_get_core_id()];
+    portENTER_CRITICAL_SAFE(&ring->lock);
+    const uint32_t head = ring->head;
+    const uint32_t used = head + words - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (used > RING_WORDS) {
+        portEXIT_CRITICAL_SAFE(&ring->lock);
+        __atomic_fetch_add(&s_dropped, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    ring->head = head + words;
+    for (size_t i = 1; i < words; i++) {
+        ring->words[(head + i) & RING_MASK] = entry[i];
+    }
+    // Storing the header publishes the entry
+    __atomic_store_n(&ring->words[head & RING_MASK], words | ((uint32_t)level << 8), __ATOMIC_RELEASE);
+    portEXIT_CRITICAL_SAFE(&ring->lock);
+
+    if (used >= RING_WORDS / 2) {
+        if (xPortInIsrContext()) {
+            vTaskNotifyGiveFromISR(s_task, NULL);
+        } else {
+            xTaskNotifyGive(s_task);
+        }
+    }
+    return true;
+}
+
+/* Remove the oldest complete entry from the rings, return its number of words or 0 if there is none */
+static size_t pop_entry(uint32_t *entry)
+{
+    log_ring_t *oldest = NULL;
+    uint32_t oldest_sequence = 0;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        log_ring_t *ring = &s_rings[core];
+        const uint32_t tail = ring->tail;
+        if (__atomic_load_n(&ring->words[tail & RING_MASK], __ATOMIC_ACQUIRE) == 0) {
+            continue; // empty, or the oldest entry is still being written
+        }
+        const uint32_t sequence = ring->words[(tail + ENTRY_SEQUENCE) & RING_MASK];
+        if (oldest == NULL || (int32_t)(sequence - oldest_sequence) < 0) {
+            oldest = ring;
+            oldest_sequence = sequence;
+        }
+    }
+    if (oldest == NULL) {
+        return 0;
+    }
+
+    const uint32_t tail = oldest->tail;
+    const size_t words = oldest->words[tail & RING_MASK] & 0xff;
+    for (size_t i = 0; i < words; i++) {
+        entry[i] = oldest->words[(tail + i) & RING_MASK];
+        oldest->words[(tail + i) & RING_MASK] = 0;
+    }
+    __atomic_store_n(&oldest->tail, tail + words, __ATOMIC_RELEASE);
+    return words;
+}
+
+static void output(const char *format, ...)
+{
+    va_list list;
+    va_start(list, format);
+    esp_log_impl_vprint(format, list);
+    va_end(list);
+}
+
+#if CONFIG_LOG_DEFERRED_OUTPUT_TEXT
+
+#define FORMAT_ARG(value) ( \
+    (spec.stars == 0) ? snprintf(buf + pos, size - pos, conv, value) : \
+    (spec.stars == 1) ? snprintf(buf + pos, size - pos, conv, stars[0], value) : \
+                        snprintf(buf + pos, size - pos, conv, stars[0], stars[1], value))
+
+/* Format an entry the way vsnprintf() would have formatted the message */
+static size_t format_entry(char *buf, size_t size, const uint32_t *entry)
+{
+    const char *format = (const char *)entry[ENTRY_FORMAT];
+    size_t n = ENTRY_ARGS;
+    size_t pos = 0;
+
+    for (const char *p = format; *p != '\0' && pos < size - 1;) {
+        if (*p != '%') {
+            buf[pos++] = *p++;
+            continue;
+        }
+        conv_spec_t spec;
+        const char *start = p;
+        p = parse_conv_spec(p, &spec);
+        if (spec.type == ARG_NONE) {
+            buf[pos++] = '%';
+            continue;
+        }
+
+        char conv[24];
+        int stars[2] = { 0 };
+        int len = 0;
+        memcpy(conv, start, MIN(spec.len, sizeof(conv) - 1));
+        conv[MIN(spec.len, sizeof(conv) - 1)] = '\0';
+        for (int i = 0; i < spec.stars; i++) {
+            stars[i] = (int)entry[n++];
+        }
+        switch (spec.type) {
+        case ARG_INT:
+            len = FORMAT_ARG(entry[n]);
+            n++;
+            break;
+        case ARG_INT64: {
+            uint64_t value;
+            memcpy(&value, &entry[n], sizeof(value));
+            len = FORMAT_ARG(value);
+            n += 2;
+            break;
+        }
+        case ARG_DOUBLE: {
+            double value;
+            memcpy(&value, &entry[n], sizeof(value));
+            len = FORMAT_ARG(value);
+            n += 2;
+            break;
+        }
+        case ARG_STRING: {
+            if (entry[n] > STRING_MAX_LEN) {
+                len = FORMAT_ARG((const char *)entry[n]);
+                n++;
+            } else {
+                char str[STRING_MAX_LEN + 1];
+                const size_t str_len = entry[n++];
+                memcpy(str, &entry[n], str_len);
+                str[str_len] = '\0';
+                len = FORMAT_ARG(str);
+                n += (str_len + 3) / 4;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        if (len > 0) {
+            pos = MIN(pos + len, size - 1);
+        }
+    }
+    buf[pos] = '\0';
+    return pos;
+}
+
+static void output_entry(const uint32_t *entry, size_t words)
+{
+    char line[LINE_MAX_LEN];
+    const size_t len = format_entry(line, sizeof(line), entry);
+    if (len == sizeof(line) - 1) {
+        line[len - 1] = '\n'; // truncated
+    }
+    output("%s", line);
+}
+
+#else // CONFIG_LOG_DEFERRED_OUTPUT_BINARY
+
+static void output_entry(const uint32_t *entry, size_t words)
+{
+    static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char line[sizeof(BINARY_LINE_PREFIX) + (ENTRY_MAX_WORDS * sizeof(uint32_t) + 2) / 3 * 4 + 1];
+    const uint8_t *bytes = (const uint8_t *)entry;
+    const size_t len = words * sizeof(uint32_t);
+    char *p = line;
+
+    memcpy(p, BINARY_LINE_PREFIX, sizeof(BINARY_LINE_PREFIX) - 1);
+    p += sizeof(BINARY_LINE_PREFIX) - 1;
+    for (size_t i = 0; i < len; i += 3) {
+        const uint32_t triple = (bytes[i] << 16) | ((i + 1 < len ? bytes[i + 1] : 0) << 8) | (i + 2 < len ? bytes[i + 2] : 0);
+        *p++ = base64[(triple >> 18) & 0x3f];
+        *p++ = base64[(triple >> 12) & 0x3f];
+        *p++ = (i + 1 < len) ? base64[(triple >> 6) & 0x3f] : '=';
+        *p++ = (i + 2 < len) ? base64[triple & 0x3f] : '=';
+    }
+    *p++ = '\n';
+    *p = '\0';
+    output("%s", line);
+}
+
+#endif // CONFIG_LOG_DEFERRED_OUTPUT_BINARY
+
+void esp_log_deferred_flush(void)
+{
+    uint32_t entry[ENTRY_MAX_WORDS];
+    size_t words;
+
+    esp_log_impl_lock();
+    while ((words = pop_entry(entry)) != 0) {
+        output_entry(entry, words);
+    }
+    const uint32_t dropped = __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+    if (dropped != s_dropped_reported) {
+        output(LOG_COLOR_W "W (%" PRIu32 ") log: %" PRIu32 " deferred messages dropped, the buffer was full" LOG_RESET_COLOR "\n",
+               esp_log_timestamp(), dropped - s_dropped_reported);
+        s_dropped_reported = dropped;
+    }
+    esp_log_impl_unlock();
+}
+
+static void log_deferred_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(OUTPUT_PERIOD_MS));
+        esp_log_deferred_flush();
+    }
+}
+
+static void start_output_task(void)
+{
+    static StaticTask_t s_task_buffer;
+    static StackType_t s_task_stack[CONFIG_LOG_DEFERRED_TASK_STACK_SIZE];
+    uint32_t expected = 0;
+
+    // The first task logging creates the output task, the stack is static so this can't fail
+    if (__atomic_compare_exchange_n(&s_task_state, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        // The rings are used once the state is 2
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            portMUX_INITIALIZE(&s_rings[core].lock);
+        }
+        s_task = xTaskCreateStatic(log_deferred_task, "log_deferred", CONFIG_LOG_DEFERRED_TASK_STACK_SIZE, NULL,
+                                   CONFIG_LOG_DEFERRED_TASK_PRIORITY, s_task_stack, &s_task_buffer);
+        __atomic_store_n(&s_task_state, 2, __ATOMIC_RELEASE);
+    }
+}
+
+void esp_log_deferred_enable(bool enable)
+{
+    s_enabled = enable;
+}
+
+uint32_t esp_log_deferred_get_dropped(void)
+{
+    return __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+}
@@ -11,6 +11,7 @@
 #include "esp_log.h"
 #include "esp_private/log_lock.h"
 #include "esp_private/log_level.h"
+#include "esp_private/log_deferred.h"
 #include "sdkconfig.h"
 
 static vprintf_like_t s_log_print_func = &vprintf;
@@ -31,10 +32,22 @@ void esp_log_writev(esp_log_level_t level,
 {
     esp_log_level_t level_for_tag = esp_log_level_get_timeout(tag);
     if (ESP_LOG_NONE != level_for_tag && level <= level_for_tag) {
+#if CONFIG_LOG_DEFERRED
+        if (esp_log_deferred_writev(level, format, args)) {
+            return;
+        }
+#endif
         (*s_log_print_func)(format, args);
     }
 }
 
+#if CONFIG_LOG_DEFERRED
+void esp_log_impl_vprint(const char *format, va_list args)
+{
+    (*s_log_print_func)(format, args);
+}
+#endif
+
 void esp_log_write(esp_log_level_t level,
                    const char *tag,
                    const char *format, ...)
@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_log_deferred.h"
+#include "sdkconfig.h"
+
+#if CONFIG_LOG_DEFERRED
+
+static const char * TAG = "deferred";
+
+static char s_output[1024];
+static size_t s_output_len;
+
+static int capture_vprintf(const char *format, va_list args)
+{
+    int len = vsnprintf(s_output + s_output_len, sizeof(s_output) - s_output_len, format, args);
+    if (len > 0) {
+        s_output_len += len;
+        if (s_output_len >= sizeof(s_output)) {
+            s_output_len = sizeof(s_output) - 1;
+        }
+    }
+    return len;
+}
+
+static void clear_output(void)
+{
+    s_output_len = 0;
+    s_output[0] = '\0';
+}
+
+TEST_CASE("deferred log messages are formatted when flushed", "[log][deferred]")
+{
+    esp_log_deferred_flush();
+    vprintf_like_t orig_vprintf = esp_log_set_vprintf(capture_vprintf);
+    clear_output();
+
+    // The RAM string is copied, changing it afterwards doesn't affect the message
+    char name[] = "sensor";
+    int64_t big = -1234567890123LL;
+    double value = 3.25;
+    ESP_LOGI(TAG, "%s: %" PRId64 " %.2f %s %%", name, big, value, "done");
+    name[0] = 'X';
+
+    esp_log_deferred_flush();
+    esp_log_set_vprintf(orig_vprintf);
+    printf("Captured: %s", s_output);
+    TEST_ASSERT_NOT_NULL(strstr(s_output, "deferred: sensor: -1234567890123 3.25 done %"));
+    TEST_ASSERT_EQUAL('\n', s_output[s_output_len - 1]);
+}
+
+TEST_CASE("deferred log messages honour the precision of strings", "[log][deferred]")
+{
+    esp_log_deferred_flush();
+    vprintf_like_t orig_vprintf = esp_log_set_vprintf(capture_vprintf);
+    clear_output();
+
+    // Only the characters within the precision are read, the buffers are not NUL-terminated
+    const char id[4] = { 'a', 'b', 'c', 'd' };
+    const char name[6] = { 's', 'e', 'n', 's', 'o', 'r' };
+    ESP_LOGI(TAG, "[%.*s] [%.3s]", (int)sizeof(id), id, name);
+
+    esp_log_deferred_flush();
+    esp_log_set_vprintf(orig_vprintf);
+    TEST_ASSERT_NOT_NULL(strstr(s_output, "deferred: [abcd] [sen]"));
+}
+
+TEST_CASE("disabled deferred logging outputs messages immediately", "[log][deferred]")
+{
+    esp_log_deferred_flush();
+    vprintf_like_t orig_vprintf = esp_log_set_vprintf(capture_vprintf);
+    clear_output();
+
+    esp_log_deferred_enable(false);
+    ESP_LOGI(TAG, "immediate %d", 42);
+    esp_log_deferred_enable(true);
+
+    esp_log_set_vprintf(orig_vprintf);
+    TEST_ASSERT_NOT_NULL(strstr(s_output, "deferred: immediate 42"));
+}
+
+#define ITERATIONS 50
+
+static uint32_t cycles_per_log(void)
+{
+    const uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < ITERATIONS; i++) {
+        ESP_LOGI(TAG, "some test data, %d, %d, %s", i, ITERATIONS - i, "text");
+    }
+    return (esp_cpu_get_cycle_count() - start) / ITERATIONS;
+}
+
+TEST_CASE("deferred logging benchmark", "[log][deferred]")
+{
+    // Messages are formatted into memory, so that the immediate mode isn't limited by the UART
+    esp_log_deferred_flush();
+    vprintf_like_t orig_vprintf = esp_log_set_vprintf(capture_vprintf);
+    const uint32_t dropped = esp_log_deferred_get_dropped();
+
+    esp_log_deferred_enable(false);
+    clear_output();
+    cycles_per_log(); // warm up the cache
+    clear_output();
+    const uint32_t immediate_cycles = cycles_per_log();
+    esp_log_deferred_enable(true);
+
+    clear_output();
+    const uint32_t deferred_cycles = cycles_per_log();
+    esp_log_deferred_flush();
+
+    esp_log_set_vprintf(orig_vprintf);
+    printf("ESP_LOGI: %"PRIu32" cycles immediate, %"PRIu32" cycles deferred\n", immediate_cycles, deferred_cycles);
+    TEST_ASSERT_EQUAL(dropped, esp_log_deferred_get_dropped());
+    TEST_ASSERT_LESS_THAN(immediate_cycles, deferred_cycles);
+}
+
+#endif // CONFIG_LOG_DEFERRED
@@ -20,6 +20,9 @@
  */
 #define LOG_LOCAL_LEVEL (ESP_LOG_DEBUG)
 #include "esp_log.h"
+#if CONFIG_LOG_DEFERRED
+#include "esp_log_deferred.h"
+#endif
 
 static const char * TAG1 = "ESP_LOG";
 static const char * TAG2 = "ESP_EARLY_LOG";
@@ -77,6 +80,12 @@ TEST_CASE("LOG_LOCAL_LEVEL can be re-defined", "[log]")
      * to raise the log level.
      */
 
+#if CONFIG_LOG_DEFERRED
+    // the output is checked right after each message, so it must not be deferred
+    esp_log_deferred_flush();
+    esp_log_deferred_enable(false);
+#endif
+
     // for ESP_LOGx
     vprintf_like_t old_vprintf = esp_log_set_vprintf(print_to_buffer);
     reset_buffer();
@@ -119,6 +128,9 @@ TEST_CASE("LOG_LOCAL_LEVEL can be re-defined", "[log]")
     TEST_ASSERT_NOT_NULL(strstr(get_buffer(), "There is an error log"));
     esp_log_set_vprintf(old_vprintf);
     esp_log_level_set("*", ESP_LOG_INFO);
+#if CONFIG_LOG_DEFERRED
+    esp_log_deferred_enable(true);
+#endif
 
     // for ESP_EARLY_LOGx
     esp_rom_install_channel_putc(1, putc_to_buffer);
@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#if CONFIG_LOG_TAG_LEVEL_INTERNED
+
+ESP_LOG_TAG_DEFINE(s_tag, "interned");
+ESP_LOG_TAG_DEFINE(s_tag_same_name, "interned");
+ESP_LOG_TAG_DEFINE(s_other_tag, "interned_other");
+
+static const char *TAG = "string_tag";
+
+static int s_output_count;
+
+static int count_vprintf(const char *format, va_list args)
+{
+    s_output_count++;
+    return 0;
+}
+
+TEST_CASE("interned tags follow esp_log_level_set", "[log][tag]")
+{
+    TEST_ASSERT_GREATER_OR_EQUAL(3, esp_log_tag_count());
+    TEST_ASSERT_NOT_EQUAL(esp_log_tag_id(&s_tag), esp_log_tag_id(&s_tag_same_name));
+    TEST_ASSERT_LESS_THAN(esp_log_tag_count(), esp_log_tag_id(&s_other_tag));
+
+    vprintf_like_t orig_vprintf = esp_log_set_vprintf(count_vprintf);
+    s_output_count = 0;
+
+    esp_log_level_set("interned", ESP_LOG_WARN);
+    ESP_TAG_LOGI(s_tag, "filtered out");
+    ESP_TAG_LOGI(s_tag_same_name, "filtered out");
+    ESP_TAG_LOGW(s_tag, "output");
+    ESP_TAG_LOGI(s_other_tag, "output");
+    TEST_ASSERT_EQUAL(2, s_output_count);
+
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    ESP_TAG_LOGW(s_tag, "filtered out");
+    ESP_TAG_LOGW(s_other_tag, "filtered out");
+    ESP_TAG_LOGE(s_other_tag, "output");
+    TEST_ASSERT_EQUAL(3, s_output_count);
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+    esp_log_set_vprintf(orig_vprintf);
+    TEST_ASSERT_EQUAL(ESP_LOG_INFO, s_tag.level);
+}
+
+#define ITERATIONS 1000
+
+TEST_CASE("interned tag versus tag cache for filtered out messages", "[log][tag]")
+{
+    // Both tags are in the cache after the first call
+    esp_log_level_set(TAG, ESP_LOG_WARN);
+    esp_log_level_set("interned", ESP_LOG_WARN);
+    ESP_LOGI(TAG, "filtered out");
+    ESP_TAG_LOGI(s_tag, "filtered out");
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < ITERATIONS; i++) {
+        ESP_LOGI(TAG, "some test data, %d, %d, %d", i, ITERATIONS - i, 12);
+    }
+    const uint32_t cache_cycles = (esp_cpu_get_cycle_count() - start) / ITERATIONS;
+
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < ITERATIONS; i++) {
+        ESP_TAG_LOGI(s_tag, "some test data, %d, %d, %d", i, ITERATIONS - i, 12);
+    }
+    const uint32_t interned_cycles = (esp_cpu_get_cycle_count() - start) / ITERATIONS;
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+    printf("Filtered out ESP_LOGI: %"PRIu32" cycles with the tag cache, %"PRIu32" cycles with an interned tag\n",
+           cache_cycles, interned_cycles);
+    TEST_ASSERT_LESS_THAN(cache_cycles, interned_cycles);
+}
+
+#endif // CONFIG_LOG_TAG_LEVEL_INTERNED
@@ -1,4 +1,4 @@
-# SPDX-FileCopyrightText: 2023 Espressif Systems (Shanghai) CO LTD
+# SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
 # SPDX-License-Identifier: Unlicense OR CC0-1.0
 
 import pytest
@@ -7,5 +7,13 @@ from pytest_embedded import Dut
 
 @pytest.mark.esp32
 @pytest.mark.generic
+@pytest.mark.parametrize(
+    'config',
+    [
+        'default',
+        'deferred',
+        'interned',
+    ]
+)
 def test_esp_log(dut: Dut) -> None:
     dut.run_all_single_board_cases()
@@ -15,6 +15,10 @@
 #include "sdkconfig.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+#include "lwip/api.h"
+#include "lwip/priv/sockets_priv.h"
+#endif
 
 #ifndef CONFIG_VFS_SUPPORT_IO
 #error This file should only be built when CONFIG_VFS_SUPPORT_IO=y
@@ -52,6 +56,88 @@ static void *lwip_get_socket_select_semaphore(void)
      */
     return (void *) sys_thread_sem_get();
 }
+
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+
+// Watches of epoll instances, indexed by socket number
+static esp_vfs_epoll_watch_t *s_epoll_watches[CONFIG_LWIP_MAX_SOCKETS];
+static portMUX_TYPE s_epoll_lock = portMUX_INITIALIZER_UNLOCKED;
+// Callback of lwip sockets, which updates the state of the socket and wakes up select()
+static netconn_callback s_socket_event_callback;
+
+/**
+ * @brief Replaces the callback of the netconn of watched sockets,
+ * notifies the epoll instance after the socket callback updated the state of the socket
+ */
+static void lwip_epoll_event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len)
+{
+    s_socket_event_callback(conn, evt, len);
+
+    // conn->socket is negative until the netconn is bound to a socket
+    const int s = conn->socket - LWIP_SOCKET_OFFSET;
+    if (s >= 0 && s < CONFIG_LWIP_MAX_SOCKETS) {
+        portENTER_CRITICAL(&s_epoll_lock);
+        if (s_epoll_watches[s]) {
+            esp_vfs_epoll_notify(s_epoll_watches[s]);
+        }
+        portEXIT_CRITICAL(&s_epoll_lock);
+    }
+}
+
+static int lwip_epoll_watch(int fd, esp_vfs_epoll_watch_t *watch)
+{
+    const int s = fd - LWIP_SOCKET_OFFSET;
+    if (s < 0 || s >= CONFIG_LWIP_MAX_SOCKETS) {
+        errno = EBADF;
+        return -1;
+    }
+    if (watch) {
+        struct lwip_sock *sock = lwip_socket_dbg_get_socket(fd);
+        if (sock == NULL || sock->conn == NULL || sock->conn->callback == NULL) {
+            errno = EBADF;
+            return -1;
+        }
+        // All sockets use the same callback, the wrapper is left in place when the watch is removed
+        if (sock->conn->callback != lwip_epoll_event_callback) {
+            s_socket_event_callback = sock->conn->callback;
+            sock->conn->callback = lwip_epoll_event_callback;
+        }
+    }
+    portENTER_CRITICAL(&s_epoll_lock);
+    s_epoll_watches[s] = watch;
+    portEXIT_CRITICAL(&s_epoll_lock);
+    return 0;
+}
+
+static int lwip_epoll_poll(int fd)
+{
+    fd_set readfds;
+    fd_set writefds;
+    fd_set errorfds;
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
+    FD_ZERO(&errorfds);
+    FD_SET(fd, &readfds);
+    FD_SET(fd, &writefds);
+    FD_SET(fd, &errorfds);
+    struct timeval timeout = { 0 };
+    if (lwip_select(fd + 1, &readfds, &writefds, &errorfds, &timeout) < 0) {
+        return -1;
+    }
+    int ret = 0;
+    if (FD_ISSET(fd, &readfds)) {
+        ret |= POLLIN;
+    }
+    if (FD_ISSET(fd, &writefds)) {
+        ret |= POLLOUT;
+    }
+    if (FD_ISSET(fd, &errorfds)) {
+        ret |= POLLERR;
+    }
+    return ret;
+}
+
+#endif // CONFIG_VFS_SUPPORT_EPOLL
 #else // CONFIG_VFS_SUPPORT_SELECT
 
 int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds, struct timeval *timeout)
@@ -100,6 +186,10 @@ void esp_vfs_lwip_sockets_register(void)
         .stop_socket_select = &lwip_stop_socket_select,
         .stop_socket_select_isr = &lwip_stop_socket_select_isr,
 #endif // CONFIG_VFS_SUPPORT_SELECT
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+        .epoll_watch = &lwip_epoll_watch,
+        .epoll_poll = &lwip_epoll_poll,
+#endif // CONFIG_VFS_SUPPORT_EPOLL
     };
     /* Non-LWIP file descriptors are from 0 to (LWIP_SOCKET_OFFSET-1). LWIP
      * file descriptors are registered from LWIP_SOCKET_OFFSET to
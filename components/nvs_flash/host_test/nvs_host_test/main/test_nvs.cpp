@@ -17,6 +17,7 @@
 #include <string.h>
 #include <string>
 #include <random>
+#include <chrono>
 #include "test_fixtures.hpp"
 
 #define TEST_ESP_ERR(rc, res) CHECK((rc) == (res))
@@ -3408,6 +3409,397 @@ TEST_CASE("nvs find key tests", "[nvs]")
     nvs_close(handle_2);
     TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
 }
+
+TEST_CASE("benchmark key lookup in large storage", "[nvs]")
+{
+    const uint32_t NVS_FLASH_SECTOR_COUNT = 64;
+    const size_t KEY_COUNT = (NVS_FLASH_SECTOR_COUNT - 2) * 100;
+    PartitionEmulationFixture f(0, NVS_FLASH_SECTOR_COUNT);
+    nvs::Storage storage(f.part());
+    TEST_ESP_OK(storage.init(0, NVS_FLASH_SECTOR_COUNT));
+
+    char key[16];
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(storage.writeItem(1, key, static_cast<uint32_t>(i)));
+    }
+
+    // Storage uses the key index if it is enabled
+    esp_partition_clear_stats();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        uint32_t value;
+        TEST_ESP_OK(storage.readItem(1, key, value));
+        CHECK(value == i);
+    }
+    TEST_ESP_ERR(storage.findKey(1, "missing", nullptr), ESP_ERR_NVS_NOT_FOUND);
+    auto indexElapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    const size_t indexReadOps = esp_partition_get_read_ops();
+
+    // Same lookups querying the HashList of every page in turn, as Storage does without the key index
+    nvs::Page pages[NVS_FLASH_SECTOR_COUNT];
+    for (uint32_t i = 0; i < NVS_FLASH_SECTOR_COUNT; ++i) {
+        TEST_ESP_OK(pages[i].load(f.part(), i));
+    }
+    esp_partition_clear_stats();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        uint32_t value;
+        size_t page = 0;
+        while (page < NVS_FLASH_SECTOR_COUNT && pages[page].readItem(1, key, value) != ESP_OK) {
+            ++page;
+        }
+        REQUIRE(page < NVS_FLASH_SECTOR_COUNT);
+        CHECK(value == i);
+    }
+    auto scanElapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    s_perf << "Time to read " << KEY_COUNT << " keys from " << NVS_FLASH_SECTOR_COUNT << " sectors: " << indexElapsed.count()
+           << " us (" << indexReadOps << "R) through Storage, " << scanElapsed.count() << " us (" << esp_partition_get_read_ops()
+           << "R) scanning page hash lists, key index RAM: " << storage.getKeyIndexMemoryUsage() << " bytes" << std::endl;
+}
+
+TEST_CASE("nvs batch stages writes until commit", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 10);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 10));
+
+    nvs_handle_t handle;
+    nvs_handle_t reader;
+    TEST_ESP_OK(nvs_open("batch", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_open("batch", NVS_READONLY, &reader));
+    TEST_ESP_OK(nvs_set_u32(handle, "count", 1));
+    TEST_ESP_OK(nvs_set_str(handle, "gone", "bye"));
+
+    TEST_ESP_ERR(nvs_batch_begin(reader), ESP_ERR_NVS_READ_ONLY);
+    TEST_ESP_ERR(nvs_batch_commit(handle), ESP_ERR_NVS_INVALID_STATE);
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_ERR(nvs_batch_begin(handle), ESP_ERR_NVS_INVALID_STATE);
+
+    esp_partition_clear_stats();
+    for (uint32_t i = 2; i <= 10; ++i) {
+        TEST_ESP_OK(nvs_set_u32(handle, "count", i));
+    }
+    TEST_ESP_OK(nvs_set_str(handle, "name", "batched"));
+    TEST_ESP_OK(nvs_erase_key(handle, "gone"));
+    TEST_ESP_ERR(nvs_erase_key(handle, "gone"), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_ERR(nvs_erase_key(handle, "missing"), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_ERR(nvs_erase_all(handle), ESP_ERR_NVS_INVALID_STATE);
+    CHECK(esp_partition_get_write_ops() == 0);
+
+    // staged values are only visible through the handle holding the batch
+    uint32_t value;
+    char str[16];
+    size_t len = sizeof(str);
+    TEST_ESP_OK(nvs_get_u32(handle, "count", &value));
+    CHECK(value == 10);
+    TEST_ESP_OK(nvs_get_u32(reader, "count", &value));
+    CHECK(value == 1);
+    TEST_ESP_OK(nvs_get_str(handle, "name", str, &len));
+    CHECK(strcmp(str, "batched") == 0);
+    TEST_ESP_ERR(nvs_get_str(reader, "name", str, &len), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_ERR(nvs_get_str(handle, "gone", str, &len), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_OK(nvs_get_str(reader, "gone", str, &len));
+
+    TEST_ESP_OK(nvs_commit(handle));
+    TEST_ESP_ERR(nvs_batch_commit(handle), ESP_ERR_NVS_INVALID_STATE);
+    TEST_ESP_OK(nvs_get_u32(reader, "count", &value));
+    CHECK(value == 10);
+    len = sizeof(str);
+    TEST_ESP_OK(nvs_get_str(reader, "name", str, &len));
+    CHECK(strcmp(str, "batched") == 0);
+    TEST_ESP_ERR(nvs_get_str(reader, "gone", str, &len), ESP_ERR_NVS_NOT_FOUND);
+
+    // an aborted batch doesn't touch the storage
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_OK(nvs_set_u32(handle, "count", 11));
+    TEST_ESP_OK(nvs_batch_abort(handle));
+    TEST_ESP_ERR(nvs_batch_abort(handle), ESP_ERR_NVS_INVALID_STATE);
+    TEST_ESP_OK(nvs_get_u32(handle, "count", &value));
+    CHECK(value == 10);
+
+    nvs_close(reader);
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+    // only the last staged value of each key has been written
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 10));
+    TEST_ESP_OK(nvs_open("batch", NVS_READONLY, &reader));
+    TEST_ESP_OK(nvs_get_u32(reader, "count", &value));
+    CHECK(value == 10);
+    size_t used_entries;
+    TEST_ESP_OK(nvs_get_used_entry_count(reader, &used_entries));
+    CHECK(used_entries == 3);
+    nvs_close(reader);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("recovery from power-off during batch commit", "[nvs]")
+{
+    const size_t KEY_COUNT = 100;
+    const uint32_t NVS_FLASH_SECTOR_COUNT = 5;
+    char key[16];
+
+    for (size_t errDelay = 0; ; ++errDelay) {
+        INFO(errDelay);
+        PartitionEmulationFixture f(0, NVS_FLASH_SECTOR_COUNT);
+        {
+            nvs::Storage storage(f.part());
+            TEST_ESP_OK(storage.init(0, NVS_FLASH_SECTOR_COUNT));
+            for (size_t i = 0; i < KEY_COUNT; ++i) {
+                snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+                TEST_ESP_OK(storage.writeItem(1, key, static_cast<uint32_t>(0)));
+            }
+        }
+
+        esp_err_t err;
+        {
+            nvs::Storage storage(f.part());
+            TEST_ESP_OK(storage.init(0, NVS_FLASH_SECTOR_COUNT));
+            nvs::WriteBatch batch;
+            const uint32_t one = 1;
+            for (size_t i = 0; i < KEY_COUNT; ++i) {
+                snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+                TEST_ESP_OK(batch.set(nvs::ItemType::U32, key, &one, sizeof(one)));
+            }
+            esp_partition_fail_after(errDelay, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+            err = storage.writeBatch(1, batch);
+            esp_partition_fail_after(SIZE_MAX, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        }
+
+        // every key holds either the old or the new value, exactly once
+        nvs::Storage storage(f.part());
+        TEST_ESP_OK(storage.init(0, NVS_FLASH_SECTOR_COUNT));
+        size_t usedEntries;
+        TEST_ESP_OK(storage.calcEntriesInNamespace(1, usedEntries));
+        CHECK(usedEntries == KEY_COUNT);
+        TEST_ESP_OK(storage.calcEntriesInNamespace(0, usedEntries));
+        CHECK(usedEntries == 0);
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            uint32_t value;
+            TEST_ESP_OK(storage.readItem(1, key, value));
+            CHECK(value <= 1);
+            if (err == ESP_OK) {
+                CHECK(value == 1);
+            }
+        }
+
+        if (err == ESP_OK) {
+            break;
+        }
+    }
+}
+
+TEST_CASE("benchmark batched writes", "[nvs]")
+{
+    const size_t KEY_COUNT = 32;
+    const uint32_t NVS_FLASH_SECTOR_COUNT = 10;
+    PartitionEmulationFixture f(0, NVS_FLASH_SECTOR_COUNT);
+    nvs::Storage storage(f.part());
+    TEST_ESP_OK(storage.init(0, NVS_FLASH_SECTOR_COUNT));
+
+    char key[16];
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(storage.writeItem(1, key, static_cast<uint32_t>(0)));
+    }
+
+    esp_partition_clear_stats();
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(storage.writeItem(1, key, static_cast<uint32_t>(1)));
+    }
+    const size_t singleWriteOps = esp_partition_get_write_ops();
+    const size_t singleWriteBytes = esp_partition_get_write_bytes();
+
+    nvs::WriteBatch batch;
+    const uint32_t two = 2;
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(batch.set(nvs::ItemType::U32, key, &two, sizeof(two)));
+    }
+    esp_partition_clear_stats();
+    TEST_ESP_OK(storage.writeBatch(1, batch));
+    const size_t batchWriteOps = esp_partition_get_write_ops();
+    const size_t batchWriteBytes = esp_partition_get_write_bytes();
+    CHECK(batchWriteOps < singleWriteOps);
+
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        uint32_t value;
+        TEST_ESP_OK(storage.readItem(1, key, value));
+        CHECK(value == 2);
+    }
+
+    s_perf << "Flash writes to update " << KEY_COUNT << " keys: " << singleWriteOps << " (" << singleWriteBytes
+           << " bytes) one by one, " << batchWriteOps << " (" << batchWriteBytes << " bytes) as a batch" << std::endl;
+}
+
+TEST_CASE("value cache evicts least recently used values", "[nvs]")
+{
+    nvs::ValueCache cache;
+    TEST_ESP_OK(cache.init(2));
+
+    const uint32_t values[] = {1, 2, 3};
+    size_t size;
+    CHECK(cache.find(1, nvs::ItemType::U32, "a", size) == nullptr);
+    cache.insert(1, nvs::ItemType::U32, "a", &values[0], sizeof(uint32_t));
+    cache.insert(1, nvs::ItemType::U32, "b", &values[1], sizeof(uint32_t));
+
+    // "a" becomes the most recently used one, so inserting "c" evicts "b"
+    const uint8_t* cached = cache.find(1, nvs::ItemType::U32, "a", size);
+    REQUIRE(cached != nullptr);
+    CHECK(size == sizeof(uint32_t));
+    CHECK(memcmp(cached, &values[0], size) == 0);
+    cache.insert(1, nvs::ItemType::U32, "c", &values[2], sizeof(uint32_t));
+    CHECK(cache.find(1, nvs::ItemType::U32, "b", size) == nullptr);
+    CHECK(cache.find(1, nvs::ItemType::U32, "c", size) != nullptr);
+
+    // lookups match the namespace and the type, invalidation drops all types
+    CHECK(cache.find(2, nvs::ItemType::U32, "a", size) == nullptr);
+    CHECK(cache.find(1, nvs::ItemType::I32, "a", size) == nullptr);
+    cache.invalidate(1, "a");
+    CHECK(cache.find(1, nvs::ItemType::U32, "a", size) == nullptr);
+    cache.invalidateNamespace(1);
+    CHECK(cache.find(1, nvs::ItemType::U32, "c", size) == nullptr);
+
+    // values larger than MAX_VALUE_SIZE are not cached
+    char str[nvs::ValueCache::MAX_VALUE_SIZE + 1];
+    memset(str, 'x', sizeof(str));
+    cache.insert(1, nvs::ItemType::SZ, "long", str, sizeof(str));
+    CHECK(cache.find(1, nvs::ItemType::SZ, "long", size) == nullptr);
+
+    nvs_cache_stats_t stats;
+    cache.fillStats(stats);
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 7);
+    CHECK(stats.used_entries == 0);
+    CHECK(stats.total_entries == 2);
+}
+
+#ifndef CONFIG_NVS_ASSERT_ERROR_CHECK
+TEST_CASE("reads into larger buffers give the same result with and without cached values", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 5);
+    nvs::Storage storage(f.part());
+    TEST_ESP_OK(storage.init(0, 5));
+
+    const uint8_t blob[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    TEST_ESP_OK(storage.writeItem(1, nvs::ItemType::BLOB, "blob", blob, sizeof(blob)));
+    TEST_ESP_OK(storage.writeItem(1, nvs::ItemType::SZ, "str", "value", strlen("value") + 1));
+
+    // the first read of each value comes from flash, the exact size read caches the blob
+    uint8_t buf[16];
+    for (int i = 0; i < 2; ++i) {
+        TEST_ESP_ERR(storage.readItem(1, nvs::ItemType::BLOB, "blob", buf, sizeof(buf)), ESP_FAIL);
+        TEST_ESP_OK(storage.readItem(1, nvs::ItemType::BLOB, "blob", buf, sizeof(blob)));
+        CHECK(memcmp(buf, blob, sizeof(blob)) == 0);
+
+        char str[16];
+        TEST_ESP_OK(storage.readItem(1, nvs::ItemType::SZ, "str", str, sizeof(str)));
+        CHECK(strcmp(str, "value") == 0);
+    }
+}
+#endif // CONFIG_NVS_ASSERT_ERROR_CHECK
+
+TEST_CASE("reads return current values after writes and erases", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 5);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 5));
+
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("cached", NVS_READWRITE, &handle));
+    uint32_t value;
+    char str[16];
+    size_t len = sizeof(str);
+
+    TEST_ESP_OK(nvs_set_u32(handle, "flag", 1));
+    TEST_ESP_OK(nvs_set_str(handle, "name", "first"));
+    TEST_ESP_OK(nvs_get_u32(handle, "flag", &value));
+    TEST_ESP_OK(nvs_get_str(handle, "name", str, &len));
+
+    TEST_ESP_OK(nvs_set_u32(handle, "flag", 2));
+    TEST_ESP_OK(nvs_get_u32(handle, "flag", &value));
+    CHECK(value == 2);
+    TEST_ESP_OK(nvs_set_str(handle, "name", "second"));
+    len = sizeof(str);
+    TEST_ESP_OK(nvs_get_str(handle, "name", str, &len));
+    CHECK(strcmp(str, "second") == 0);
+    CHECK(len == strlen("second") + 1);
+
+    // nvs_get_str looks the size up before the value, but is counted as a single lookup
+    nvs_cache_stats_t before;
+    nvs_cache_stats_t after;
+    TEST_ESP_OK(nvs_get_cache_stats(NULL, &before));
+    len = sizeof(str);
+    TEST_ESP_OK(nvs_get_str(handle, "name", str, &len));
+    TEST_ESP_OK(nvs_get_cache_stats(NULL, &after));
+    if (before.total_entries > 0) {
+        CHECK(after.hits + after.misses == before.hits + before.misses + 1);
+    }
+
+    // same key with another type
+    TEST_ESP_OK(nvs_set_u8(handle, "flag", 3));
+    TEST_ESP_ERR(nvs_get_u32(handle, "flag", &value), ESP_ERR_NVS_NOT_FOUND);
+
+    TEST_ESP_OK(nvs_erase_key(handle, "flag"));
+    uint8_t value_u8;
+    TEST_ESP_ERR(nvs_get_u8(handle, "flag", &value_u8), ESP_ERR_NVS_NOT_FOUND);
+
+    TEST_ESP_OK(nvs_erase_all(handle));
+    len = sizeof(str);
+    TEST_ESP_ERR(nvs_get_str(handle, "name", str, &len), ESP_ERR_NVS_NOT_FOUND);
+
+    nvs_cache_stats_t stats;
+    TEST_ESP_OK(nvs_get_cache_stats(NULL, &stats));
+    CHECK(stats.used_entries <= stats.total_entries);
+    TEST_ESP_ERR(nvs_get_cache_stats(NULL, NULL), ESP_ERR_INVALID_ARG);
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("benchmark reading hot keys", "[nvs]")
+{
+    const uint32_t NVS_FLASH_SECTOR_COUNT = 16;
+    const size_t KEY_COUNT = 1000;
+    const size_t HOT_KEY_COUNT = 8;
+    const size_t READ_COUNT = 20000;
+    PartitionEmulationFixture f(0, NVS_FLASH_SECTOR_COUNT);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, NVS_FLASH_SECTOR_COUNT));
+
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("hot", NVS_READWRITE, &handle));
+    char key[16];
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(nvs_set_u32(handle, key, i));
+    }
+
+    // the hot keys were written first, so they live on the first pages
+    esp_partition_clear_stats();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < READ_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i % HOT_KEY_COUNT));
+        uint32_t value;
+        TEST_ESP_OK(nvs_get_u32(handle, key, &value));
+        CHECK(value == i % HOT_KEY_COUNT);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    nvs_cache_stats_t stats;
+    TEST_ESP_OK(nvs_get_cache_stats(NULL, &stats));
+    s_perf << "Time to read " << HOT_KEY_COUNT << " hot keys " << READ_COUNT << " times: " << elapsed.count() << " us ("
+           << esp_partition_get_read_ops() << "R), value cache hits: " << stats.hits << ", misses: " << stats.misses
+           << ", size: " << stats.total_entries << std::endl;
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
 /* Add new tests above */
 /* This test has to be the final one */
 
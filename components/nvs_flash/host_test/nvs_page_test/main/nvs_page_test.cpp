@@ -6,6 +6,7 @@
 static const char* TAG = "nvs_page_host_test";
 
 #include <stdio.h>
+#include <chrono>
 #include "unity.h"
 #include "test_fixtures.hpp"
 #include "esp_log.h"
@@ -918,6 +919,76 @@ void test_Page_calcEntries__invalid()
     TEST_ASSERT_EQUAL(0, nvsStats.namespace_count);
 }
 
+template<typename TList>
+static void fill_hash_list(TList& list, Item* items)
+{
+    for (size_t i = 0; i < Page::ENTRY_COUNT; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, list.insert(items[i], i));
+    }
+}
+
+template<typename TList>
+static double benchmark_hash_list(Item* items, size_t iterations, size_t& checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        TList list;
+        fill_hash_list(list, items);
+        // look up every item from the beginning of the page, like Page::findItem does
+        for (size_t i = 0; i < Page::ENTRY_COUNT; ++i) {
+            checksum += list.find(0, items[i]);
+        }
+        // erase in the order items become obsolete when they're rewritten
+        for (size_t i = 0; i < Page::ENTRY_COUNT; ++i) {
+            uint32_t hash;
+            TEST_ASSERT_TRUE(list.erase(i, &hash));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void test_HashList_compact_equivalent_and_benchmark()
+{
+    Item items[Page::ENTRY_COUNT];
+    for (size_t i = 0; i < Page::ENTRY_COUNT; ++i) {
+        char key[Item::MAX_KEY_LENGTH + 1];
+        snprintf(key, sizeof(key), "key_%d", (int) (i % 100));
+        // every key past the 100th is a second copy, as found on pages with not yet erased duplicates
+        items[i] = Item(1, ItemType::U32, 1, key);
+    }
+
+    HashList hashList;
+    CompactHashList compactHashList;
+    fill_hash_list(hashList, items);
+    fill_hash_list(compactHashList, items);
+    for (size_t start = 0; start < Page::ENTRY_COUNT; start += 5) {
+        for (size_t i = 0; i < Page::ENTRY_COUNT; ++i) {
+            TEST_ASSERT_EQUAL(hashList.find(start, items[i]), compactHashList.find(start, items[i]));
+        }
+    }
+    for (size_t i = 0; i < Page::ENTRY_COUNT; i += 3) {
+        uint32_t hash = 0;
+        uint32_t compactHash = 0;
+        TEST_ASSERT_TRUE(hashList.erase(i, &hash));
+        TEST_ASSERT_TRUE(compactHashList.erase(i, &compactHash));
+        TEST_ASSERT_EQUAL(hash, compactHash);
+        TEST_ASSERT_FALSE(compactHashList.erase(i));
+    }
+    for (size_t i = 0; i < Page::ENTRY_COUNT; ++i) {
+        TEST_ASSERT_EQUAL(hashList.find(0, items[i]), compactHashList.find(0, items[i]));
+    }
+
+    const size_t iterations = 2000;
+    size_t checksum = 0;
+    size_t compactChecksum = 0;
+    double listTime = benchmark_hash_list<HashList>(items, iterations, checksum);
+    double compactTime = benchmark_hash_list<CompactHashList>(items, iterations, compactChecksum);
+    TEST_ASSERT_EQUAL(checksum, compactChecksum);
+    printf("HashList: %.1f ms, CompactHashList: %.1f ms (%d pages filled, searched and erased)\n",
+           listTime, compactTime, (int) iterations);
+}
+
 int main(int argc, char **argv)
 {
 #define TEMPORARILY_DISABLED(x)
@@ -977,6 +1048,7 @@ int main(int argc, char **argv)
     RUN_TEST(test_Page_calcEntries__active_wo_blob);
     RUN_TEST(test_Page_calcEntries__active_with_blob);
     RUN_TEST(test_Page_calcEntries__invalid);
+    RUN_TEST(test_HashList_compact_equivalent_and_benchmark);
     int failures = UNITY_END();
     return failures;
 }
@@ -576,6 +576,63 @@ esp_err_t nvs_erase_all(nvs_handle_t handle);
  */
 esp_err_t nvs_commit(nvs_handle_t handle);
 
+/**
+ * @brief      Start staging changes made through the handle
+ *
+ * After this call, nvs_set_*, nvs_set_str, nvs_set_blob and nvs_erase_key only update a copy
+ * of the changes kept in RAM, and nvs_get_* functions called with the same handle return the
+ * staged values. The changes are written by nvs_batch_commit or nvs_commit.
+ *
+ * Setting the same key several times within a batch writes only the last value to flash.
+ * When committing, new values are appended before any superseded entry is erased, and the
+ * superseded entries are erased with one write per word of the page entry state table.
+ * If power is lost while committing, every key of the batch holds either its old or its new
+ * value after the next nvs_flash_init.
+ *
+ * nvs_erase_all is not allowed while a batch is open. Iterators (nvs_entry_find) do not see
+ * staged changes.
+ *
+ * @param[in]  handle  Storage handle obtained with nvs_open.
+ *                     Handles that were opened read only cannot be used.
+ *
+ * @return
+ *             - ESP_OK if the batch has been started
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_READ_ONLY if handle was opened as read only
+ *             - ESP_ERR_NVS_INVALID_STATE if a batch has already been started on this handle
+ *             - ESP_ERR_NO_MEM if memory could not be allocated
+ */
+esp_err_t nvs_batch_begin(nvs_handle_t handle);
+
+/**
+ * @brief      Write the changes staged since nvs_batch_begin and end the batch
+ *
+ * The batch ends even if writing fails. In that case some of the staged changes may have
+ * been written.
+ *
+ * @param[in]  handle  Storage handle obtained with nvs_open.
+ *
+ * @return
+ *             - ESP_OK if the changes have been written successfully
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_INVALID_STATE if no batch has been started on this handle
+ *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if there is not enough space to save the values
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_batch_commit(nvs_handle_t handle);
+
+/**
+ * @brief      Drop the changes staged since nvs_batch_begin and end the batch
+ *
+ * @param[in]  handle  Storage handle obtained with nvs_open.
+ *
+ * @return
+ *             - ESP_OK on success
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_INVALID_STATE if no batch has been started on this handle
+ */
+esp_err_t nvs_batch_abort(nvs_handle_t handle);
+
 /**
  * @brief      Close the storage handle and free any allocated resources
  *
@@ -635,6 +692,34 @@ typedef struct {
  */
 esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats);
 
+/**
+ * @note Info about the value cache of an NVS partition, see CONFIG_NVS_VALUE_CACHE.
+ */
+typedef struct {
+    size_t hits;              /**< Number of lookups answered from the cache. */
+    size_t misses;            /**< Number of lookups which had to read flash. */
+    size_t used_entries;      /**< Number of values currently cached. */
+    size_t total_entries;     /**< Number of values the cache can hold, 0 if the cache is disabled. */
+} nvs_cache_stats_t;
+
+/**
+ * @brief      Fill structure nvs_cache_stats_t with the value cache statistics of a partition.
+ *
+ * Counters are reset when the partition is initialized.
+ *
+ * @param[in]   part_name   Partition name NVS in the partition table.
+ *                          If pass a NULL than will use NVS_DEFAULT_PART_NAME ("nvs").
+ *
+ * @param[out]  cache_stats Returns filled structure nvs_cache_stats_t.
+ *
+ * @return
+ *             - ESP_OK if cache_stats has been filled.
+ *             - ESP_ERR_NVS_NOT_INITIALIZED if the storage driver is not initialized.
+ *               Return param cache_stats will be filled 0.
+ *             - ESP_ERR_INVALID_ARG if cache_stats is equal to NULL.
+ */
+esp_err_t nvs_get_cache_stats(const char *part_name, nvs_cache_stats_t *cache_stats);
+
 /**
  * @brief      Calculate all entries in a namespace.
  *
@@ -213,6 +213,45 @@ public:
      */
     virtual esp_err_t commit() = 0;
 
+    /**
+     * @brief      Starts staging writes and erasures done through this handle.
+     *
+     * Until \c commit_batch (or \c commit) is called, set and erase calls only update a RAM copy owned by the
+     * handle, get calls return the staged values. Setting a key several times within a batch only writes the
+     * last value to flash. The new items are appended before any superseded item is erased, so after a power
+     * loss during the commit every key holds either its old or its new value.
+     *
+     * @note compare to \ref nvs_batch_begin in nvs.h
+     *
+     * @return
+     *             - ESP_OK if the batch has been started
+     *             - ESP_ERR_NVS_READ_ONLY if the handle was opened as read only
+     *             - ESP_ERR_NVS_INVALID_STATE if a batch has already been started on this handle
+     *             - ESP_ERR_NO_MEM if memory for the batch could not be allocated
+     */
+    virtual esp_err_t begin_batch() = 0;
+
+    /**
+     * @brief      Writes all changes staged since \c begin_batch and ends the batch.
+     *
+     * The batch ends even if writing fails, in which case some of the staged changes may have been written.
+     *
+     * @return
+     *             - ESP_OK if all staged changes have been written
+     *             - ESP_ERR_NVS_INVALID_STATE if no batch has been started on this handle
+     *             - other error codes from the underlying storage driver
+     */
+    virtual esp_err_t commit_batch() = 0;
+
+    /**
+     * @brief      Drops all changes staged since \c begin_batch and ends the batch.
+     *
+     * @return
+     *             - ESP_OK on success
+     *             - ESP_ERR_NVS_INVALID_STATE if no batch has been started on this handle
+     */
+    virtual esp_err_t abort_batch() = 0;
+
     /**
      * @brief      Calculate all entries in the scope of the handle.
      *
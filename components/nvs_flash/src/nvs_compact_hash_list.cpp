@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include "nvs_compact_hash_list.hpp"
+#include "nvs_page.hpp"
+
+namespace nvs
+{
+
+CompactHashList::CompactHashList()
+{
+    static_assert(SLOT_COUNT == Page::ENTRY_COUNT, "one slot per page entry is needed");
+}
+
+CompactHashList::~CompactHashList()
+{
+    clear();
+}
+
+void CompactHashList::clear()
+{
+    delete[] mHashes;
+    mHashes = nullptr;
+    mCount = 0;
+}
+
+esp_err_t CompactHashList::insert(const Item& item, size_t index)
+{
+    if (index >= SLOT_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!mHashes) {
+        mHashes = new (std::nothrow) uint32_t[SLOT_COUNT];
+        if (!mHashes) {
+            return ESP_ERR_NO_MEM;
+        }
+        std::fill_n(mHashes, SLOT_COUNT, EMPTY_SLOT);
+    }
+
+    if (mHashes[index] == EMPTY_SLOT) {
+        ++mCount;
+    }
+    mHashes[index] = item.calculateCrc32WithoutValue() & 0xffffff;
+    return ESP_OK;
+}
+
+bool CompactHashList::erase(size_t index, uint32_t* erasedHash)
+{
+    if (!mHashes || index >= SLOT_COUNT || mHashes[index] == EMPTY_SLOT) {
+        return false;
+    }
+
+    if (erasedHash) {
+        *erasedHash = mHashes[index];
+    }
+    mHashes[index] = EMPTY_SLOT;
+    if (--mCount == 0) {
+        clear();
+    }
+    return true;
+}
+
+size_t CompactHashList::find(size_t start, const Item& item)
+{
+    if (!mHashes) {
+        return SIZE_MAX;
+    }
+
+    const uint32_t hash_24 = item.calculateCrc32WithoutValue() & 0xffffff;
+    for (size_t index = start; index < SLOT_COUNT; ++index) {
+        if (mHashes[index] == hash_24) {
+            return index;
+        }
+    }
+    return SIZE_MAX;
+}
+
+} // namespace nvs
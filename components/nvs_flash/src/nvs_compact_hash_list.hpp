@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef nvs_compact_hash_list_h
+#define nvs_compact_hash_list_h
+
+#include "nvs.h"
+#include "nvs_types.hpp"
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+/**
+ * Drop-in replacement for HashList which keeps the hashes of one page in a single flat array.
+ *
+ * The array has one slot per page entry and is indexed by the entry index, so erase() doesn't have to search
+ * and find() is a linear scan over contiguous memory. The array is allocated when the first item is inserted
+ * and freed when the last one is erased.
+ */
+class CompactHashList
+{
+public:
+    CompactHashList();
+    ~CompactHashList();
+
+    esp_err_t insert(const Item& item, size_t index);
+    bool erase(const size_t index, uint32_t* erasedHash = nullptr);
+    size_t find(size_t start, const Item& item);
+    void clear();
+
+    /**
+     * Calls func(index, hash) for every stored hash.
+     */
+    template<typename TFunc>
+    void forEach(TFunc func)
+    {
+        for (size_t index = 0; mHashes && index < SLOT_COUNT; ++index) {
+            if (mHashes[index] != EMPTY_SLOT) {
+                func(index, mHashes[index]);
+            }
+        }
+    }
+
+private:
+    CompactHashList(const CompactHashList& other);
+    const CompactHashList& operator= (const CompactHashList& rhs);
+
+protected:
+    static const size_t SLOT_COUNT = 126; // Page::ENTRY_COUNT
+    static const uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    uint32_t* mHashes = nullptr;
+    size_t mCount = 0;
+}; // class CompactHashList
+
+} // namespace nvs
+
+
+#endif /* nvs_compact_hash_list_h */
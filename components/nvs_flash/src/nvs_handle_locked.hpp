@@ -49,6 +49,12 @@ public:
 
     esp_err_t commit() override;
 
+    esp_err_t begin_batch() override;
+
+    esp_err_t commit_batch() override;
+
+    esp_err_t abort_batch() override;
+
     esp_err_t get_used_entry_count(size_t& usedEntries) override;
 
 protected:
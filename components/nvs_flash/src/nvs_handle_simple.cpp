@@ -10,6 +10,7 @@
 namespace nvs {
 
 NVSHandleSimple::~NVSHandleSimple() {
+    delete mBatch;
     NVSPartitionManager::get_instance()->close_handle(this);
 }
 
@@ -18,6 +19,10 @@ esp_err_t NVSHandleSimple::set_typed_item(ItemType datatype, const char *key, co
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
 
+    if (mBatch) {
+        return mBatch->set(datatype, key, data, dataSize);
+    }
+
     return mStoragePtr->writeItem(mNsIndex, datatype, key, data, dataSize);
 }
 
@@ -25,6 +30,13 @@ esp_err_t NVSHandleSimple::get_typed_item(ItemType datatype, const char *key, vo
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
 
+    if (mBatch) {
+        const WriteBatch::Entry* entry = mBatch->find(key);
+        if (entry) {
+            return read_staged_item(entry, datatype, data, dataSize);
+        }
+    }
+
     return mStoragePtr->readItem(mNsIndex, datatype, key, data, dataSize);
 }
 
@@ -33,6 +45,10 @@ esp_err_t NVSHandleSimple::set_string(const char *key, const char* str)
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
 
+    if (mBatch) {
+        return mBatch->set(nvs::ItemType::SZ, key, str, strlen(str) + 1);
+    }
+
     return mStoragePtr->writeItem(mNsIndex, nvs::ItemType::SZ, key, str, strlen(str) + 1);
 }
 
@@ -41,6 +57,10 @@ esp_err_t NVSHandleSimple::set_blob(const char *key, const void* blob, size_t le
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
 
+    if (mBatch) {
+        return mBatch->set(nvs::ItemType::BLOB, key, blob, len);
+    }
+
     return mStoragePtr->writeItem(mNsIndex, nvs::ItemType::BLOB, key, blob, len);
 }
 
@@ -48,20 +68,31 @@ esp_err_t NVSHandleSimple::get_string(const char *key, char* out_str, size_t len
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
 
-    return mStoragePtr->readItem(mNsIndex, nvs::ItemType::SZ, key, out_str, len);
+    return get_typed_item(nvs::ItemType::SZ, key, out_str, len);
 }
 
 esp_err_t NVSHandleSimple::get_blob(const char *key, void* out_blob, size_t len)
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
 
-    return mStoragePtr->readItem(mNsIndex, nvs::ItemType::BLOB, key, out_blob, len);
+    return get_typed_item(nvs::ItemType::BLOB, key, out_blob, len);
 }
 
 esp_err_t NVSHandleSimple::get_item_size(ItemType datatype, const char *key, size_t &size)
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
 
+    if (mBatch) {
+        const WriteBatch::Entry* entry = mBatch->find(key);
+        if (entry) {
+            if (entry->isErase() || entry->mDatatype != datatype) {
+                return ESP_ERR_NVS_NOT_FOUND;
+            }
+            size = entry->mDataSize;
+            return ESP_OK;
+        }
+    }
+
     return mStoragePtr->getItemDataSize(mNsIndex, datatype, key, size);
 }
 
@@ -70,9 +101,18 @@ esp_err_t NVSHandleSimple::find_key(const char* key, nvs_type_t &nvstype)
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
 
     nvs::ItemType datatype;
-    esp_err_t err = mStoragePtr->findKey(mNsIndex, key, &datatype);
-    if(err != ESP_OK)
-        return err;
+    esp_err_t err;
+    const WriteBatch::Entry* entry = mBatch ? mBatch->find(key) : nullptr;
+    if (entry) {
+        if (entry->isErase())
+            return ESP_ERR_NVS_NOT_FOUND;
+        datatype = entry->mDatatype;
+        err = ESP_OK;
+    } else {
+        err = mStoragePtr->findKey(mNsIndex, key, &datatype);
+        if(err != ESP_OK)
+            return err;
+    }
 
     if(datatype == ItemType::BLOB_IDX || datatype == ItemType::BLOB)
         datatype = ItemType::BLOB_DATA;
@@ -87,6 +127,14 @@ esp_err_t NVSHandleSimple::erase_item(const char* key)
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
 
+    if (mBatch) {
+        const WriteBatch::Entry* entry = mBatch->find(key);
+        if (entry ? entry->isErase() : mStoragePtr->findKey(mNsIndex, key, nullptr) == ESP_ERR_NVS_NOT_FOUND) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        return mBatch->erase(key);
+    }
+
     return mStoragePtr->eraseItem(mNsIndex, key);
 }
 
@@ -94,6 +142,7 @@ esp_err_t NVSHandleSimple::erase_all()
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mBatch) return ESP_ERR_NVS_INVALID_STATE;
 
     return mStoragePtr->eraseNamespace(mNsIndex);
 }
@@ -102,6 +151,64 @@ esp_err_t NVSHandleSimple::commit()
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
 
+    if (mBatch) {
+        return commit_batch();
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::begin_batch()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mBatch) return ESP_ERR_NVS_INVALID_STATE;
+
+    mBatch = new (std::nothrow) WriteBatch;
+    if (!mBatch) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::commit_batch()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBatch) return ESP_ERR_NVS_INVALID_STATE;
+
+    esp_err_t err = mStoragePtr->writeBatch(mNsIndex, *mBatch);
+    delete mBatch;
+    mBatch = nullptr;
+    return err;
+}
+
+esp_err_t NVSHandleSimple::abort_batch()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBatch) return ESP_ERR_NVS_INVALID_STATE;
+
+    delete mBatch;
+    mBatch = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::read_staged_item(const WriteBatch::Entry* entry, ItemType datatype, void* data, size_t dataSize)
+{
+    if (entry->isErase() || entry->mDatatype != datatype) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    if (!isVariableLengthType(datatype)) {
+        if (dataSize != entry->mDataSize) {
+            return ESP_ERR_NVS_TYPE_MISMATCH;
+        }
+    } else if (dataSize < entry->mDataSize) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+
+    if (entry->mDataSize > 0) {
+        memcpy(data, entry->mData, entry->mDataSize);
+    }
     return ESP_OK;
 }
 
@@ -32,7 +32,8 @@ public:
         mStoragePtr(StoragePtr),
         mNsIndex(nsIndex),
         mReadOnly(readOnly),
-        valid(1)
+        valid(1),
+        mBatch(nullptr)
     { }
 
     ~NVSHandleSimple();
@@ -59,6 +60,12 @@ public:
 
     esp_err_t commit() override;
 
+    esp_err_t begin_batch() override;
+
+    esp_err_t commit_batch() override;
+
+    esp_err_t abort_batch() override;
+
     esp_err_t get_used_entry_count(size_t &usedEntries) override;
 
     esp_err_t getItemDataSize(ItemType datatype, const char *key, size_t &dataSize);
@@ -80,6 +87,8 @@ public:
     Storage *get_storage() const;
 
 private:
+    esp_err_t read_staged_item(const WriteBatch::Entry* entry, ItemType datatype, void* data, size_t dataSize);
+
     /**
      * The underlying storage's object.
      */
@@ -101,6 +110,11 @@ private:
      * Upon opening, a handle is valid. It becomes invalid if the underlying storage is de-initialized.
      */
     uint8_t valid;
+
+    /**
+     * Changes staged since begin_batch(), nullptr if no batch has been started.
+     */
+    WriteBatch *mBatch;
 };
 
 } // nvs
@@ -65,7 +65,7 @@ esp_err_t HashList::insert(const Item& item, size_t index)
     return ESP_OK;
 }
 
-bool HashList::erase(size_t index)
+bool HashList::erase(size_t index, uint32_t* erasedHash)
 {
     for (auto it = mBlockList.begin(); it != mBlockList.end();) {
         bool haveEntries = false;
@@ -73,6 +73,9 @@ bool HashList::erase(size_t index)
         for (size_t i = 0; i < it->mCount; ++i) {
             if (it->mNodes[i].mIndex == index) {
                 it->mNodes[i].mIndex = 0xff;
+                if (erasedHash && !foundIndex) {
+                    *erasedHash = it->mNodes[i].mHash;
+                }
                 foundIndex = true;
                 /* found the item and removed it */
             }
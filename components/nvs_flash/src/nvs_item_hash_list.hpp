@@ -22,10 +22,25 @@ public:
     ~HashList();
 
     esp_err_t insert(const Item& item, size_t index);
-    bool erase(const size_t index);
+    bool erase(const size_t index, uint32_t* erasedHash = nullptr);
     size_t find(size_t start, const Item& item);
     void clear();
 
+    /**
+     * Calls func(index, hash) for every stored hash.
+     */
+    template<typename TFunc>
+    void forEach(TFunc func)
+    {
+        for (auto it = mBlockList.begin(); it != mBlockList.end(); ++it) {
+            for (size_t i = 0; i < it->mCount; ++i) {
+                if (it->mNodes[i].mIndex != 0xff) {
+                    func(it->mNodes[i].mIndex, it->mNodes[i].mHash);
+                }
+            }
+        }
+    }
+
 private:
     HashList(const HashList& other);
     const HashList& operator= (const HashList& rhs);
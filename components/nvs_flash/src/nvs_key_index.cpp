@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nvs_key_index.hpp"
+#include "nvs_page.hpp"
+
+namespace nvs
+{
+
+KeyIndex::KeyIndex()
+{
+}
+
+KeyIndex::~KeyIndex()
+{
+    clear();
+    delete[] mBuckets;
+}
+
+esp_err_t KeyIndex::init(size_t pageCount)
+{
+    clear();
+    delete[] mBuckets;
+    mBuckets = nullptr;
+    mBucketCount = 0;
+
+    // aim for a handful of keys per bucket on a reasonably filled partition
+    size_t bucketCount = 16;
+    while (bucketCount < pageCount * 16) {
+        bucketCount <<= 1;
+    }
+
+    mBuckets = new (std::nothrow) KeyIndexBucket[bucketCount];
+    if (!mBuckets) {
+        return ESP_ERR_NO_MEM;
+    }
+    mBucketCount = bucketCount;
+    mValid = true;
+    return ESP_OK;
+}
+
+void KeyIndex::clear()
+{
+    for (size_t i = 0; i < mBucketCount; ++i) {
+        KeyIndexNode* node = mBuckets[i].mHead;
+        while (node) {
+            KeyIndexNode* next = node->mNext;
+            delete node;
+            node = next;
+        }
+        mBuckets[i].mHead = nullptr;
+    }
+    mNodeCount = 0;
+    mValid = false;
+}
+
+void KeyIndex::insert(const Item& item, Page* page)
+{
+    insert(hashOf(item), page);
+}
+
+void KeyIndex::insert(uint32_t hash_24, Page* page)
+{
+    if (!mValid) {
+        return;
+    }
+
+    KeyIndexBucket& bucket = mBuckets[bucketOf(hash_24)];
+    for (KeyIndexNode* node = bucket.mHead; node; node = node->mNext) {
+        if (node->mHash == hash_24 && node->mPage == page) {
+            // a saturated counter is never decremented, the page just stays a candidate
+            if (node->mCount < 0xff) {
+                ++node->mCount;
+            }
+            return;
+        }
+    }
+
+    KeyIndexNode* node = new (std::nothrow) KeyIndexNode;
+    if (!node) {
+        // the index can't be trusted to be complete anymore, so stop using it altogether
+        clear();
+        return;
+    }
+    node->mPage = page;
+    node->mHash = hash_24;
+    node->mCount = 1;
+    node->mNext = bucket.mHead;
+    bucket.mHead = node;
+    ++mNodeCount;
+}
+
+void KeyIndex::erase(uint32_t hash, const Page* page)
+{
+    if (!mValid) {
+        return;
+    }
+
+    KeyIndexNode** link = &mBuckets[bucketOf(hash)].mHead;
+    while (*link) {
+        KeyIndexNode* node = *link;
+        if (node->mHash == hash && node->mPage == page) {
+            if (node->mCount == 0xff) {
+                return;
+            }
+            if (--node->mCount == 0) {
+                *link = node->mNext;
+                delete node;
+                --mNodeCount;
+            }
+            return;
+        }
+        link = &node->mNext;
+    }
+}
+
+void KeyIndex::erasePage(const Page* page)
+{
+    if (!mValid) {
+        return;
+    }
+
+    for (size_t i = 0; i < mBucketCount; ++i) {
+        KeyIndexNode** link = &mBuckets[i].mHead;
+        while (*link) {
+            KeyIndexNode* node = *link;
+            if (node->mPage == page) {
+                *link = node->mNext;
+                delete node;
+                --mNodeCount;
+            } else {
+                link = &node->mNext;
+            }
+        }
+    }
+}
+
+size_t KeyIndex::find(const Item& item, Page** pages, size_t maxPages) const
+{
+    if (!mValid) {
+        return SIZE_MAX;
+    }
+
+    const uint32_t hash_24 = hashOf(item);
+    size_t count = 0;
+    for (KeyIndexNode* node = mBuckets[bucketOf(hash_24)].mHead; node; node = node->mNext) {
+        if (node->mHash != hash_24) {
+            continue;
+        }
+        if (count == maxPages) {
+            return SIZE_MAX;
+        }
+
+        // keep the candidates in the same order as the page list, i.e. by ascending sequence number
+        uint32_t seqNumber = UINT32_MAX;
+        node->mPage->getSeqNumber(seqNumber);
+        size_t pos = count;
+        while (pos > 0) {
+            uint32_t otherSeqNumber = UINT32_MAX;
+            pages[pos - 1]->getSeqNumber(otherSeqNumber);
+            if (otherSeqNumber <= seqNumber) {
+                break;
+            }
+            pages[pos] = pages[pos - 1];
+            --pos;
+        }
+        pages[pos] = node->mPage;
+        ++count;
+    }
+    return count;
+}
+
+size_t KeyIndex::getMemoryUsage() const
+{
+    return mBucketCount * sizeof(KeyIndexBucket) + mNodeCount * sizeof(KeyIndexNode);
+}
+
+} // namespace nvs
@@ -0,0 +1,93 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef nvs_key_index_hpp
+#define nvs_key_index_hpp
+
+#include "nvs.h"
+#include "nvs_types.hpp"
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+class Page;
+
+/**
+ * Partition-wide index which maps the 24-bit hash of <namespace index, key, chunk index> to the pages
+ * holding items with that hash.
+ *
+ * The index mirrors the contents of the per-page HashList objects: whenever a page adds or removes a hash,
+ * it notifies the index. The index may therefore report a page which no longer contains the requested item
+ * (hash collision or stale entry), but it never omits a page which does. Callers must still verify the item
+ * using Page::findItem.
+ *
+ * If the index runs out of memory, it marks itself invalid and callers fall back to scanning all pages.
+ */
+class KeyIndex
+{
+public:
+    KeyIndex();
+    ~KeyIndex();
+
+    esp_err_t init(size_t pageCount);
+    void clear();
+
+    void insert(const Item& item, Page* page);
+    void insert(uint32_t hash, Page* page);
+    void erase(uint32_t hash, const Page* page);
+    void erasePage(const Page* page);
+
+    /**
+     * Collects the pages which may contain items with the same hash as \c item.
+     *
+     * @return number of pages written to \c pages, or SIZE_MAX if the index is invalid or there are more
+     *         candidate pages than \c maxPages.
+     */
+    size_t find(const Item& item, Page** pages, size_t maxPages) const;
+
+    bool isValid() const
+    {
+        return mValid;
+    }
+
+    size_t getMemoryUsage() const;
+
+    static uint32_t hashOf(const Item& item)
+    {
+        return item.calculateCrc32WithoutValue() & 0xffffff;
+    }
+
+private:
+    KeyIndex(const KeyIndex& other);
+    const KeyIndex& operator= (const KeyIndex& rhs);
+
+protected:
+    struct KeyIndexNode : public ExceptionlessAllocatable {
+        KeyIndexNode* mNext;
+        Page* mPage;
+        uint32_t mHash  : 24;
+        uint32_t mCount : 8;
+    };
+
+    struct KeyIndexBucket : public ExceptionlessAllocatable {
+        KeyIndexNode* mHead = nullptr;
+    };
+
+    size_t bucketOf(uint32_t hash) const
+    {
+        return hash & (mBucketCount - 1);
+    }
+
+    KeyIndexBucket* mBuckets = nullptr;
+    size_t mBucketCount = 0;
+    size_t mNodeCount = 0;
+    bool mValid = false;
+}; // class KeyIndex
+
+} // namespace nvs
+
+#endif /* nvs_key_index_hpp */
@@ -200,7 +200,7 @@ esp_err_t Page::writeItem(uint8_t nsIndex, ItemType datatype, const char* key, c
     // write first item
     size_t span = (totalSize + ENTRY_SIZE - 1) / ENTRY_SIZE;
     item = Item(nsIndex, datatype, span, key, chunkIdx);
-    err = mHashList.insert(item, mNextFreeEntry);
+    err = insertHash(item, mNextFreeEntry);
 
     if (err != ESP_OK) {
         return err;
@@ -387,7 +387,7 @@ esp_err_t Page::eraseEntryAndSpan(size_t index)
             return rc;
         }
         if (item.calculateCrc32() != item.crc32) {
-            mHashList.erase(index);
+            eraseHash(index);
             rc = alterEntryState(index, EntryState::ERASED);
             --mUsedEntryCount;
             ++mErasedEntryCount;
@@ -395,7 +395,7 @@ esp_err_t Page::eraseEntryAndSpan(size_t index)
                 return rc;
             }
         } else {
-            mHashList.erase(index);
+            eraseHash(index);
             span = item.span;
             for (ptrdiff_t i = index + span - 1; i >= static_cast<ptrdiff_t>(index); --i) {
                 rc = mEntryTable.get(i, &state);
@@ -437,6 +437,116 @@ esp_err_t Page::eraseEntryAndSpan(size_t index)
     return ESP_OK;
 }
 
+esp_err_t Page::eraseEntries(const size_t* indices, size_t count)
+{
+    const size_t wordCount = mEntryTable.byteSize() / sizeof(uint32_t);
+    NVS_ASSERT_OR_RETURN(wordCount <= 32, ESP_FAIL);
+    uint32_t dirtyWords = 0;
+    bool firstUsedErased = false;
+
+    for (size_t n = 0; n < count; ++n) {
+        const size_t index = indices[n];
+        NVS_ASSERT_OR_RETURN(index < ENTRY_COUNT, ESP_FAIL);
+
+        EntryState state;
+        esp_err_t err = mEntryTable.get(index, &state);
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        size_t span = 1;
+        if (state == EntryState::WRITTEN) {
+            Item item;
+            err = readEntry(index, item);
+            if (err != ESP_OK) {
+                return err;
+            }
+            if (item.calculateCrc32() == item.crc32) {
+                span = item.span;
+                NVS_ASSERT_OR_RETURN(index + span <= ENTRY_COUNT, ESP_FAIL);
+                for (size_t i = index; i < index + span; ++i) {
+                    err = mEntryTable.get(i, &state);
+                    if (err != ESP_OK) {
+                        return err;
+                    }
+                    if (state == EntryState::WRITTEN) {
+                        --mUsedEntryCount;
+                    }
+                    ++mErasedEntryCount;
+                }
+            } else {
+                --mUsedEntryCount;
+                ++mErasedEntryCount;
+            }
+            eraseHash(index);
+        }
+
+        for (size_t i = index; i < index + span; ++i) {
+            err = mEntryTable.set(i, EntryState::ERASED);
+            if (err != ESP_OK) {
+                return err;
+            }
+            dirtyWords |= 1u << mEntryTable.getWordIndex(i);
+        }
+
+        if (index == mFirstUsedEntry) {
+            firstUsedErased = true;
+        }
+        if (index + span > mNextFreeEntry) {
+            mNextFreeEntry = index + span;
+        }
+    }
+
+    // Same order as alterEntryRangeState: the word holding the first entry of an item is written last
+    for (ptrdiff_t i = wordCount - 1; i >= 0; --i) {
+        if (!(dirtyWords & (1u << i))) {
+            continue;
+        }
+        uint32_t word = mEntryTable.data()[i];
+        auto rc = mPartition->write_raw(mBaseAddress + ENTRY_TABLE_OFFSET + static_cast<uint32_t>(i) * 4,
+                &word, sizeof(word));
+        if (rc != ESP_OK) {
+            mState = PageState::INVALID;
+            return rc;
+        }
+    }
+
+    if (firstUsedErased) {
+        return updateFirstUsedEntry(mFirstUsedEntry, 1);
+    }
+    return ESP_OK;
+}
+
+void Page::setKeyIndex(KeyIndex* keyIndex)
+{
+    mKeyIndex = keyIndex;
+    if (mKeyIndex) {
+        mHashList.forEach([this](size_t, uint32_t hash) {
+            mKeyIndex->insert(hash, this);
+        });
+    }
+}
+
+esp_err_t Page::insertHash(const Item& item, size_t index)
+{
+    auto err = mHashList.insert(item, index);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (mKeyIndex) {
+        mKeyIndex->insert(item, this);
+    }
+    return ESP_OK;
+}
+
+void Page::eraseHash(size_t index)
+{
+    uint32_t hash;
+    if (mHashList.erase(index, &hash) && mKeyIndex) {
+        mKeyIndex->erase(hash, this);
+    }
+}
+
 esp_err_t Page::updateFirstUsedEntry(size_t index, size_t span)
 {
     NVS_ASSERT_OR_RETURN(index == mFirstUsedEntry, ESP_FAIL);
@@ -493,7 +603,7 @@ esp_err_t Page::copyItems(Page& other)
             return err;
         }
 
-        err = other.mHashList.insert(entry, other.mNextFreeEntry);
+        err = other.insertHash(entry, other.mNextFreeEntry);
         if (err != ESP_OK) {
             return err;
         }
@@ -651,7 +761,7 @@ esp_err_t Page::mLoadEntryTable()
                 continue;
             }
 
-            err = mHashList.insert(item, i);
+            err = insertHash(item, i);
             if (err != ESP_OK) {
                 mState = PageState::INVALID;
                 return err;
@@ -733,7 +843,7 @@ esp_err_t Page::mLoadEntryTable()
 
             NVS_ASSERT_OR_RETURN(item.span > 0, ESP_FAIL);
 
-            err = mHashList.insert(item, i);
+            err = insertHash(item, i);
             if (err != ESP_OK) {
                 mState = PageState::INVALID;
                 return err;
@@ -1033,6 +1143,9 @@ esp_err_t Page::erase()
     mNextFreeEntry = INVALID_ENTRY;
     mState = PageState::UNINITIALIZED;
     mHashList.clear();
+    if (mKeyIndex) {
+        mKeyIndex->erasePage(this);
+    }
     return ESP_OK;
 }
 
@@ -1063,6 +1176,17 @@ size_t Page::getVarDataTailroom() const
     return ((mNextFreeEntry < (ENTRY_COUNT-1)) ? ((ENTRY_COUNT - mNextFreeEntry - 1) * ENTRY_SIZE): 0);
 }
 
+size_t Page::getFreeEntryCount() const
+{
+    if (mState == PageState::UNINITIALIZED) {
+        return ENTRY_COUNT;
+    }
+    if (mState != PageState::ACTIVE || mNextFreeEntry >= ENTRY_COUNT) {
+        return 0;
+    }
+    return ENTRY_COUNT - mNextFreeEntry;
+}
+
 const char* Page::pageStateToName(PageState ps)
 {
     switch (ps) {
@@ -16,6 +16,8 @@
 #include "compressed_enum_table.hpp"
 #include "intrusive_list.h"
 #include "nvs_item_hash_list.hpp"
+#include "nvs_compact_hash_list.hpp"
+#include "nvs_key_index.hpp"
 #include "nvs_memory_management.hpp"
 #include "partition.hpp"
 
@@ -100,6 +102,12 @@ public:
 
     esp_err_t eraseEntryAndSpan(size_t index);
 
+    /**
+     * Erases several items at once. Each word of the entry state table is written at most once.
+     * Indices must point to the first entry of items on this page and must be unique.
+     */
+    esp_err_t eraseEntries(const size_t* indices, size_t count);
+
     template<typename T>
     esp_err_t writeItem(uint8_t nsIndex, const char* key, const T& value)
     {
@@ -135,6 +143,8 @@ public:
     }
     size_t getVarDataTailroom() const ;
 
+    size_t getFreeEntryCount() const;
+
     esp_err_t markFull();
 
     esp_err_t markFreeing();
@@ -147,6 +157,11 @@ public:
 
     esp_err_t calcEntries(nvs_stats_t &nvsStats);
 
+    /**
+     * Attaches the partition-wide key index and adds the hashes of the items already loaded to it.
+     */
+    void setKeyIndex(KeyIndex* keyIndex);
+
 protected:
 
     class Header
@@ -192,6 +207,10 @@ protected:
 
     esp_err_t updateFirstUsedEntry(size_t index, size_t span);
 
+    esp_err_t insertHash(const Item& item, size_t index);
+
+    void eraseHash(size_t index);
+
     static constexpr size_t getAlignmentForType(ItemType type)
     {
         return static_cast<uint8_t>(type) & 0x0f;
@@ -222,7 +241,16 @@ protected:
     /**
      * This hash list stores hashes of namespace index, key, and ChunkIndex for quick lookup when searching items.
      */
+#ifdef CONFIG_NVS_COMPACT_HASH_LIST
+    CompactHashList mHashList;
+#else
     HashList mHashList;
+#endif
+
+    /**
+     * Optional partition-wide index which is kept in sync with mHashList, see KeyIndex.
+     */
+    KeyIndex* mKeyIndex = nullptr;
 
     Partition *mPartition;
 
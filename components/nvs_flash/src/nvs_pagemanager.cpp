@@ -4,9 +4,80 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include "nvs_pagemanager.hpp"
+#include "nvs_platform.hpp"
 
 namespace nvs
 {
+
+#ifdef CONFIG_NVS_PARALLEL_PAGE_LOAD
+namespace {
+
+struct ParallelPageLoad {
+    Page* pages;
+    Partition* partition;
+    uint32_t baseSector;
+    uint32_t sectorCount;
+    size_t workerCount;
+    uint32_t failedPage[MAX_PARALLEL_WORKERS];
+    esp_err_t err[MAX_PARALLEL_WORKERS];
+};
+
+void loadPagesWorker(void* arg, size_t worker)
+{
+    ParallelPageLoad* load = static_cast<ParallelPageLoad*>(arg);
+    load->failedPage[worker] = UINT32_MAX;
+    load->err[worker] = ESP_OK;
+
+    // pages are interleaved, so that free pages (which are read completely) are spread among the workers
+    for (uint32_t i = worker; i < load->sectorCount; i += load->workerCount) {
+        auto err = load->pages[i].load(load->partition, load->baseSector + i);
+        if (err != ESP_OK) {
+            load->failedPage[worker] = i;
+            load->err[worker] = err;
+            return;
+        }
+    }
+}
+
+} // namespace
+#endif // CONFIG_NVS_PARALLEL_PAGE_LOAD
+
+esp_err_t PageManager::loadPages(Partition *partition, uint32_t baseSector, uint32_t sectorCount)
+{
+#ifdef CONFIG_NVS_PARALLEL_PAGE_LOAD
+    // pages are independent of each other until they are put into the page lists
+    size_t workerCount = std::min(get_parallel_worker_count(), static_cast<size_t>(sectorCount));
+    if (workerCount > 1) {
+        ParallelPageLoad load;
+        load.pages = mPages.get();
+        load.partition = partition;
+        load.baseSector = baseSector;
+        load.sectorCount = sectorCount;
+        load.workerCount = workerCount;
+        run_parallel(loadPagesWorker, &load, workerCount);
+
+        // report the error of the lowest failed page, which is where the sequential load would have stopped
+        uint32_t failedPage = UINT32_MAX;
+        esp_err_t err = ESP_OK;
+        for (size_t worker = 0; worker < workerCount; ++worker) {
+            if (load.failedPage[worker] < failedPage) {
+                failedPage = load.failedPage[worker];
+                err = load.err[worker];
+            }
+        }
+        return err;
+    }
+#endif // CONFIG_NVS_PARALLEL_PAGE_LOAD
+
+    for (uint32_t i = 0; i < sectorCount; ++i) {
+        auto err = mPages[i].load(partition, baseSector + i);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
 esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t sectorCount)
 {
     if (partition == nullptr) {
@@ -21,11 +92,22 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
 
     if (!mPages) return ESP_ERR_NO_MEM;
 
-    for (uint32_t i = 0; i < sectorCount; ++i) {
-        auto err = mPages[i].load(partition, baseSector + i);
-        if (err != ESP_OK) {
-            return err;
+    auto err = loadPages(partition, baseSector, sectorCount);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+#ifdef CONFIG_NVS_GLOBAL_KEY_INDEX
+    // If the index can't be allocated, lookups just fall back to scanning all pages.
+    // Pages are added in sector order, so the index doesn't depend on the order in which the pages were loaded.
+    if (mKeyIndex.init(sectorCount) == ESP_OK) {
+        for (uint32_t i = 0; i < sectorCount; ++i) {
+            mPages[i].setKeyIndex(&mKeyIndex);
         }
+    }
+#endif // CONFIG_NVS_GLOBAL_KEY_INDEX
+
+    for (uint32_t i = 0; i < sectorCount; ++i) {
         uint32_t seqNumber;
         if (mPages[i].getSeqNumber(seqNumber) != ESP_OK) {
             mFreePageList.push_back(&mPages[i]);
@@ -18,6 +18,7 @@
 #include <list>
 #include "nvs_types.hpp"
 #include "nvs_page.hpp"
+#include "nvs_key_index.hpp"
 #include "partition.hpp"
 #include "intrusive_list.h"
 
@@ -54,6 +55,11 @@ public:
 
     esp_err_t requestNewPage();
 
+    size_t getFreePageCount() const
+    {
+        return mFreePageList.size();
+    }
+
     esp_err_t fillStats(nvs_stats_t& nvsStats);
 
     uint32_t getBaseSector()
@@ -61,14 +67,22 @@ public:
         return mBaseSector;
     }
 
+    const KeyIndex& getKeyIndex() const
+    {
+        return mKeyIndex;
+    }
+
 protected:
     friend class Iterator;
 
     esp_err_t activatePage();
 
+    esp_err_t loadPages(Partition *partition, uint32_t baseSector, uint32_t sectorCount);
+
     TPageList mPageList;
     TPageList mFreePageList;
     std::unique_ptr<Page[]> mPages;
+    KeyIndex mKeyIndex;
     uint32_t mBaseSector;
     uint32_t mPageCount;
     uint32_t mSeqNumber;
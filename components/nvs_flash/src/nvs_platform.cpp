@@ -7,14 +7,73 @@
 
 using namespace nvs;
 
+namespace {
+
+struct ParallelCall {
+    void (*func)(void* arg, size_t worker);
+    void* arg;
+    size_t worker;
+};
+
+} // namespace
+
 #ifdef LINUX_TARGET
+
+#include <pthread.h>
+#include <unistd.h>
+
 Lock::Lock() {}
 Lock::~Lock() {}
 esp_err_t nvs::Lock::init() {return ESP_OK;}
 void Lock::uninit() {}
+
+static void* parallel_thread(void* ctx)
+{
+    ParallelCall* call = static_cast<ParallelCall*>(ctx);
+    call->func(call->arg, call->worker);
+    return nullptr;
+}
+
+void nvs::run_parallel(void (*func)(void* arg, size_t worker), void* arg, size_t workerCount)
+{
+    ParallelCall calls[MAX_PARALLEL_WORKERS];
+    pthread_t threads[MAX_PARALLEL_WORKERS];
+    bool started[MAX_PARALLEL_WORKERS] = {};
+
+    for (size_t worker = 1; worker < workerCount; ++worker) {
+        if (worker < MAX_PARALLEL_WORKERS) {
+            calls[worker] = {func, arg, worker};
+            started[worker] = pthread_create(&threads[worker], nullptr, parallel_thread, &calls[worker]) == 0;
+        }
+        if (!started[worker]) {
+            func(arg, worker);
+        }
+    }
+
+    func(arg, 0);
+
+    for (size_t worker = 1; worker < workerCount && worker < MAX_PARALLEL_WORKERS; ++worker) {
+        if (started[worker]) {
+            pthread_join(threads[worker], nullptr);
+        }
+    }
+}
+
+size_t nvs::get_parallel_worker_count()
+{
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpuCount < 1) {
+        return 1;
+    }
+    return (size_t) cpuCount < MAX_PARALLEL_WORKERS ? (size_t) cpuCount : MAX_PARALLEL_WORKERS;
+}
+
 #else
 
 #include "sys/lock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 Lock::Lock()
 {
@@ -47,4 +106,63 @@ void Lock::uninit()
 
 _lock_t Lock::mSemaphore = 0;
 
+namespace {
+
+const uint32_t PARALLEL_TASK_STACK_SIZE = 4096;
+
+struct ParallelTaskCall : public ParallelCall {
+    SemaphoreHandle_t done;
+};
+
+} // namespace
+
+static void parallel_task(void* ctx)
+{
+    ParallelTaskCall* call = static_cast<ParallelTaskCall*>(ctx);
+    call->func(call->arg, call->worker);
+    xSemaphoreGive(call->done);
+    vTaskDelete(NULL);
+}
+
+void nvs::run_parallel(void (*func)(void* arg, size_t worker), void* arg, size_t workerCount)
+{
+    ParallelTaskCall calls[MAX_PARALLEL_WORKERS];
+    size_t startedCount = 0;
+
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(MAX_PARALLEL_WORKERS, 0);
+    const BaseType_t coreId = xPortGetCoreID();
+
+    for (size_t worker = 1; worker < workerCount; ++worker) {
+        bool started = false;
+        if (done && worker < MAX_PARALLEL_WORKERS) {
+            calls[worker].func = func;
+            calls[worker].arg = arg;
+            calls[worker].worker = worker;
+            calls[worker].done = done;
+            started = xTaskCreatePinnedToCore(parallel_task, "nvs_worker", PARALLEL_TASK_STACK_SIZE, &calls[worker],
+                                              uxTaskPriorityGet(NULL), NULL,
+                                              (coreId + worker) % CONFIG_FREERTOS_NUMBER_OF_CORES) == pdPASS;
+        }
+        if (started) {
+            ++startedCount;
+        } else {
+            func(arg, worker);
+        }
+    }
+
+    func(arg, 0);
+
+    for (size_t i = 0; i < startedCount; ++i) {
+        xSemaphoreTake(done, portMAX_DELAY);
+    }
+    if (done) {
+        vSemaphoreDelete(done);
+    }
+}
+
+size_t nvs::get_parallel_worker_count()
+{
+    return CONFIG_FREERTOS_NUMBER_OF_CORES < MAX_PARALLEL_WORKERS ? CONFIG_FREERTOS_NUMBER_OF_CORES : MAX_PARALLEL_WORKERS;
+}
+
 #endif
@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include <cstddef>
 #include "esp_err.h"
 
 namespace nvs
@@ -21,4 +22,22 @@ namespace nvs
         static _lock_t mSemaphore;
 #endif
     };
+
+    /**
+     * Maximum number of workers used by run_parallel.
+     */
+    const size_t MAX_PARALLEL_WORKERS = 4;
+
+    /**
+     * Calls func(arg, worker) for every worker in [0, workerCount) and returns once all the calls have returned.
+     *
+     * The call for worker 0 runs in the calling task. The other calls run in threads on the Linux target and in tasks
+     * pinned to the other cores otherwise. If a thread or task can't be created, its call runs in the calling task.
+     */
+    void run_parallel(void (*func)(void* arg, size_t worker), void* arg, size_t workerCount);
+
+    /**
+     * Returns the number of workers which may actually run at the same time in run_parallel.
+     */
+    size_t get_parallel_worker_count();
 } // namespace nvs
@@ -38,6 +38,9 @@ NVS_GUARD_SYSVIEW_MACRO_EXPANSION_PUSH();
 namespace nvs
 {
 
+// Key of the namespace-index item which marks a batch being written, see Storage::writeBatch
+static const char BATCH_MARKER_KEY[] = "nvs:batch";
+
 Storage::~Storage()
 {
     clearNamespaces();
@@ -187,7 +190,15 @@ esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
         return err;
     }
 
+#ifdef CONFIG_NVS_VALUE_CACHE
+    // reads still work without the cache, so running out of memory here is not fatal
+    if (mValueCache.init(CONFIG_NVS_VALUE_CACHE_SIZE) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to allocate value cache");
+    }
+#endif
+
     // load namespaces list
+    bool batchInterrupted = false;
     clearNamespaces();
     std::fill_n(mNamespaceUsage.data(), mNamespaceUsage.byteSize() / 4, 0);
     for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
@@ -208,6 +219,12 @@ esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
                 delete entry;
                 return err;
             }
+            if (entry->mIndex == Page::NS_ANY && strcmp(entry->mName, BATCH_MARKER_KEY) == 0) {
+                batchInterrupted = true;
+                delete entry;
+                itemIndex += item.span;
+                continue;
+            }
             if (mNamespaceUsage.set(entry->mIndex, true) != ESP_OK) {
                 delete entry;
                 return ESP_FAIL;
@@ -223,6 +240,15 @@ esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
         return ESP_FAIL;
     }
 
+    // power went off while a batch was written, drop the items it superseded
+    if (batchInterrupted) {
+        err = eraseBatchLeftovers();
+        if (err != ESP_OK) {
+            mState = StorageState::INVALID;
+            return err;
+        }
+    }
+
     // Populate list of multi-page index entries.
     TBlobIndexList blobIdxList;
     err = populateBlobIndices(blobIdxList);
@@ -255,6 +281,24 @@ bool Storage::isValid() const
 
 esp_err_t Storage::findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx, VerOffset chunkStart)
 {
+    // Same restrictions as for the page hash list apply, see Page::findItem
+    if (nsIndex != Page::NS_ANY && key != nullptr && (datatype != ItemType::BLOB_DATA || chunkIdx != Page::CHUNK_ANY)) {
+        Page* candidates[KEY_INDEX_MAX_CANDIDATES];
+        size_t count = mPageManager.getKeyIndex().find(Item(nsIndex, datatype, 0, key, chunkIdx),
+                candidates, KEY_INDEX_MAX_CANDIDATES);
+        if (count != SIZE_MAX) {
+            for (size_t i = 0; i < count; ++i) {
+                size_t itemIndex = 0;
+                auto err = candidates[i]->findItem(nsIndex, datatype, key, itemIndex, item, chunkIdx, chunkStart);
+                if (err == ESP_OK) {
+                    page = candidates[i];
+                    return ESP_OK;
+                }
+            }
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+
     for (auto it = std::begin(mPageManager); it != std::end(mPageManager); ++it) {
         size_t itemIndex = 0;
         auto err = it->findItem(nsIndex, datatype, key, itemIndex, item, chunkIdx, chunkStart);
@@ -381,6 +425,8 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
     bool matchedTypePageFound = false;
     Item item;
 
+    mValueCache.invalidate(nsIndex, key);
+
     esp_err_t err;
     if (datatype == ItemType::BLOB) {
         err = findItem(nsIndex, ItemType::BLOB_IDX, key, findPage, item);
@@ -470,28 +516,8 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
             return ESP_OK;
         }
 
-        Page& page = getCurrentPage();
-        err = page.writeItem(nsIndex, datatype, key, data, dataSize);
-        if (err == ESP_ERR_NVS_PAGE_FULL) {
-            if (page.state() != Page::PageState::FULL) {
-                err = page.markFull();
-                if (err != ESP_OK) {
-                    return err;
-                }
-            }
-            err = mPageManager.requestNewPage();
-            if (err != ESP_OK) {
-                return err;
-            }
-
-            err = getCurrentPage().writeItem(nsIndex, datatype, key, data, dataSize);
-            if (err == ESP_ERR_NVS_PAGE_FULL) {
-                return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
-            }
-            if (err != ESP_OK) {
-                return err;
-            }
-        } else if (err != ESP_OK) {
+        err = appendItem(nsIndex, datatype, key, data, dataSize);
+        if (err != ESP_OK) {
             return err;
         }
     }
@@ -526,11 +552,266 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
     return ESP_OK;
 }
 
+esp_err_t Storage::appendItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize)
+{
+    Page& page = getCurrentPage();
+    auto err = page.writeItem(nsIndex, datatype, key, data, dataSize);
+    if (err == ESP_ERR_NVS_PAGE_FULL) {
+        if (page.state() != Page::PageState::FULL) {
+            err = page.markFull();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        err = mPageManager.requestNewPage();
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        err = getCurrentPage().writeItem(nsIndex, datatype, key, data, dataSize);
+        if (err == ESP_ERR_NVS_PAGE_FULL) {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+    }
+    return err;
+}
+
+esp_err_t Storage::writeBatch(uint8_t nsIndex, WriteBatch& batch)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    // Find the items superseded by the batch. Blobs keep their own versioning scheme, so they (and anything
+    // replacing a blob) go through the regular writeItem/eraseItem path after the batch.
+    size_t appendCount = 0;
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+        mValueCache.invalidate(nsIndex, it->mKey);
+        it->mMode = WriteBatch::Entry::Mode::APPEND;
+        it->mOldPage = nullptr;
+        it->mOldIndex = 0;
+
+        if (it->mDatatype == ItemType::BLOB) {
+            it->mMode = WriteBatch::Entry::Mode::SLOW_PATH;
+            continue;
+        }
+
+        Page* findPage = nullptr;
+        Item item;
+#ifdef CONFIG_NVS_LEGACY_DUP_KEYS_COMPATIBILITY
+        auto err = findItem(nsIndex, it->isErase() ? ItemType::ANY : it->mDatatype, it->mKey, findPage, item);
+#else
+        auto err = findItem(nsIndex, ItemType::ANY, it->mKey, findPage, item);
+#endif
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            if (it->isErase()) {
+                it->mMode = WriteBatch::Entry::Mode::SKIP;
+            } else {
+                ++appendCount;
+            }
+            continue;
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        if (item.datatype == ItemType::BLOB || item.datatype == ItemType::BLOB_IDX || item.datatype == ItemType::BLOB_DATA) {
+            it->mMode = WriteBatch::Entry::Mode::SLOW_PATH;
+            continue;
+        }
+
+        if (!it->isErase() && item.datatype == it->mDatatype &&
+                findPage->cmpItem(nsIndex, it->mDatatype, it->mKey, it->mData, it->mDataSize) == ESP_OK) {
+            it->mMode = WriteBatch::Entry::Mode::SKIP;
+            continue;
+        }
+
+        size_t itemIndex = 0;
+        err = findPage->findItem(nsIndex, item.datatype, it->mKey, itemIndex, item);
+        if (err != ESP_OK) {
+            return err;
+        }
+        it->mOldPage = findPage;
+        it->mOldIndex = itemIndex;
+        if (!it->isErase()) {
+            ++appendCount;
+        }
+    }
+
+    Page* markerPage = nullptr;
+    size_t markerIndex = 0;
+    if (appendCount > 0) {
+        // Make sure that writing the batch never triggers garbage collection, since that would move the
+        // superseded items. Otherwise write the entries one by one.
+        size_t freeEntries = getCurrentPage().getFreeEntryCount();
+        size_t newPages = 0;
+        auto reserve = [&](size_t span) {
+            if (span > freeEntries) {
+                ++newPages;
+                freeEntries = Page::ENTRY_COUNT;
+            }
+            freeEntries -= span;
+        };
+        reserve(1);
+        for (auto it = batch.begin(); it != batch.end(); ++it) {
+            if (it->mMode == WriteBatch::Entry::Mode::APPEND && !it->isErase()) {
+                reserve(isVariableLengthType(it->mDatatype) ? 1 + (it->mDataSize + Page::ENTRY_SIZE - 1) / Page::ENTRY_SIZE : 1);
+            }
+        }
+
+        if (mPageManager.getFreePageCount() < newPages + 1) {
+            for (auto it = batch.begin(); it != batch.end(); ++it) {
+                if (it->mMode == WriteBatch::Entry::Mode::APPEND) {
+                    it->mMode = WriteBatch::Entry::Mode::SLOW_PATH;
+                }
+            }
+        } else {
+            // While the marker exists, Storage::init keeps only the last copy of duplicated keys
+            uint8_t marker = Page::NS_ANY;
+            auto err = appendItem(Page::NS_INDEX, ItemType::U8, BATCH_MARKER_KEY, &marker, sizeof(marker));
+            if (err != ESP_OK) {
+                return err;
+            }
+            markerPage = &getCurrentPage();
+            Item item;
+            err = markerPage->findItem(Page::NS_INDEX, ItemType::U8, BATCH_MARKER_KEY, markerIndex, item);
+            if (err != ESP_OK) {
+                return err;
+            }
+
+            for (auto it = batch.begin(); it != batch.end(); ++it) {
+                if (it->mMode == WriteBatch::Entry::Mode::APPEND && !it->isErase()) {
+                    // on failure, the marker is left in place and Storage::init cleans up
+                    err = appendItem(nsIndex, it->mDatatype, it->mKey, it->mData, it->mDataSize);
+                    if (err != ESP_OK) {
+                        return err;
+                    }
+                }
+            }
+        }
+    }
+
+    // Erase the superseded items page by page, so that each entry state table word is written only once
+    for (auto pageIt = mPageManager.begin(); pageIt != mPageManager.end(); ++pageIt) {
+        Page* page = pageIt;
+        size_t indices[BATCH_ERASE_CHUNK];
+        size_t count = 0;
+        for (auto it = batch.begin(); it != batch.end(); ++it) {
+            if (it->mMode != WriteBatch::Entry::Mode::APPEND || it->mOldPage != page) {
+                continue;
+            }
+            indices[count++] = it->mOldIndex;
+            if (count == BATCH_ERASE_CHUNK) {
+                auto err = page->eraseEntries(indices, count);
+                if (err != ESP_OK) {
+                    return ESP_ERR_NVS_REMOVE_FAILED;
+                }
+                count = 0;
+            }
+        }
+        if (count > 0) {
+            auto err = page->eraseEntries(indices, count);
+            if (err != ESP_OK) {
+                return ESP_ERR_NVS_REMOVE_FAILED;
+            }
+        }
+    }
+
+    if (markerPage) {
+        auto err = markerPage->eraseEntryAndSpan(markerIndex);
+        if (err != ESP_OK) {
+            return ESP_ERR_NVS_REMOVE_FAILED;
+        }
+    }
+
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+        if (it->mMode != WriteBatch::Entry::Mode::SLOW_PATH) {
+            continue;
+        }
+        esp_err_t err;
+        if (it->isErase()) {
+            err = eraseItem(nsIndex, ItemType::ANY, it->mKey);
+            if (err == ESP_ERR_NVS_NOT_FOUND) {
+                err = ESP_OK;
+            }
+        } else {
+            err = writeItem(nsIndex, it->mDatatype, it->mKey, it->mData, it->mDataSize);
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+#ifdef DEBUG_STORAGE
+    debugCheck();
+#endif
+    return ESP_OK;
+}
+
+esp_err_t Storage::eraseBatchLeftovers()
+{
+    auto isBlobType = [](ItemType datatype) -> bool {
+        return datatype == ItemType::BLOB || datatype == ItemType::BLOB_IDX || datatype == ItemType::BLOB_DATA;
+    };
+
+    // Keep the last copy of every key written by the interrupted batch. Pages are ordered by sequence
+    // number and items within a page by index, so the last copy is the most recent one.
+    for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
+        size_t itemIndex = 0;
+        Item item;
+        while (it->findItem(Page::NS_ANY, ItemType::ANY, nullptr, itemIndex, item) == ESP_OK) {
+            const size_t span = item.span;
+            if (item.nsIndex != Page::NS_INDEX && !isBlobType(item.datatype)) {
+#ifdef CONFIG_NVS_LEGACY_DUP_KEYS_COMPATIBILITY
+                const ItemType dupType = item.datatype;
+#else
+                const ItemType dupType = ItemType::ANY;
+#endif
+                bool duplicated = false;
+                for (auto dupIt = it; dupIt != mPageManager.end() && !duplicated; ++dupIt) {
+                    size_t dupIndex = (dupIt == it) ? itemIndex + span : 0;
+                    Item dupItem;
+                    while (dupIt->findItem(item.nsIndex, dupType, item.key, dupIndex, dupItem) == ESP_OK) {
+                        if (!isBlobType(dupItem.datatype)) {
+                            duplicated = true;
+                            break;
+                        }
+                        dupIndex += dupItem.span;
+                    }
+                }
+                if (duplicated) {
+                    auto err = it->eraseEntryAndSpan(itemIndex);
+                    if (err != ESP_OK) {
+                        return err;
+                    }
+                }
+            }
+            itemIndex += span;
+        }
+    }
+
+    for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
+        size_t itemIndex = 0;
+        Item item;
+        while (it->findItem(Page::NS_INDEX, ItemType::U8, BATCH_MARKER_KEY, itemIndex, item) == ESP_OK) {
+            auto err = it->eraseEntryAndSpan(itemIndex);
+            if (err != ESP_OK) {
+                return err;
+            }
+            itemIndex += item.span;
+        }
+    }
+    return ESP_OK;
+}
+
 esp_err_t Storage::createOrOpenNamespace(const char* nsName, bool canCreate, uint8_t& nsIndex)
 {
     if (mState != StorageState::ACTIVE) {
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
+    if (strncmp(nsName, BATCH_MARKER_KEY, Item::MAX_KEY_LENGTH) == 0) {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
     auto it = std::find_if(mNamespaces.begin(), mNamespaces.end(), [=] (const NamespaceEntry& e) -> bool {
         return strncmp(nsName, e.mName, sizeof(e.mName) - 1) == 0;
     });
@@ -677,11 +958,25 @@ esp_err_t Storage::readItem(uint8_t nsIndex, ItemType datatype, const char* key,
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    if (mValueCache.isEnabled()) {
+        size_t cachedSize;
+        const uint8_t* cached = mValueCache.find(nsIndex, datatype, key, cachedSize);
+        // size mismatches are left to the regular path, which reports the right error.
+        // Strings may be read into a larger buffer, blobs and integers need the exact size.
+        if (cached && (datatype == ItemType::SZ ? dataSize >= cachedSize : dataSize == cachedSize)) {
+            memcpy(data, cached, cachedSize);
+            return ESP_OK;
+        }
+    }
+
     Item item;
     Page* findPage = nullptr;
     if (datatype == ItemType::BLOB) {
         auto err = readMultiPageBlob(nsIndex, key, data, dataSize);
         if (err != ESP_ERR_NVS_NOT_FOUND) {
+            if (err == ESP_OK) {
+                mValueCache.insert(nsIndex, datatype, key, data, dataSize);
+            }
             return err;
         } // else check if the blob is stored with earlier version format without index
     }
@@ -690,8 +985,11 @@ esp_err_t Storage::readItem(uint8_t nsIndex, ItemType datatype, const char* key,
     if (err != ESP_OK) {
         return err;
     }
-    return findPage->readItem(nsIndex, datatype, key, data, dataSize);
-
+    err = findPage->readItem(nsIndex, datatype, key, data, dataSize);
+    if (err == ESP_OK) {
+        mValueCache.insert(nsIndex, datatype, key, data, isVariableLengthType(datatype) ? item.varLength.dataSize : dataSize);
+    }
+    return err;
 }
 
 esp_err_t Storage::eraseMultiPageBlob(uint8_t nsIndex, const char* key, VerOffset chunkStart)
@@ -768,6 +1066,8 @@ esp_err_t Storage::eraseItem(uint8_t nsIndex, ItemType datatype, const char* key
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    mValueCache.invalidate(nsIndex, key);
+
     if (datatype == ItemType::BLOB) {
         return eraseMultiPageBlob(nsIndex, key);
     }
@@ -792,6 +1092,8 @@ esp_err_t Storage::eraseNamespace(uint8_t nsIndex)
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    mValueCache.invalidateNamespace(nsIndex);
+
     for (auto it = std::begin(mPageManager); it != std::end(mPageManager); ++it) {
         while (true) {
             auto err = it->eraseItem(nsIndex, ItemType::ANY, nullptr);
@@ -833,6 +1135,15 @@ esp_err_t Storage::getItemDataSize(uint8_t nsIndex, ItemType datatype, const cha
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    if (mValueCache.isEnabled() && isVariableLengthType(datatype)) {
+        // the size is queried before reading the value, the read is the lookup which is counted
+        size_t cachedSize;
+        if (mValueCache.find(nsIndex, datatype, key, cachedSize, false)) {
+            dataSize = cachedSize;
+            return ESP_OK;
+        }
+    }
+
     Item item;
     Page* findPage = nullptr;
     auto err = findItem(nsIndex, datatype, key, findPage, item);
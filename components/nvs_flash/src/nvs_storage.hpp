@@ -13,6 +13,8 @@
 #include "nvs_types.hpp"
 #include "nvs_page.hpp"
 #include "nvs_pagemanager.hpp"
+#include "nvs_write_batch.hpp"
+#include "nvs_value_cache.hpp"
 #include "nvs_memory_management.hpp"
 #include "partition.hpp"
 
@@ -55,6 +57,17 @@ class Storage : public intrusive_list_node<Storage>, public ExceptionlessAllocat
 
     typedef intrusive_list<BlobIndexNode> TBlobIndexList;
 
+    /**
+     * Maximum number of pages taken from the key index for a single lookup.
+     * If more pages share the hash, findItem falls back to scanning all pages.
+     */
+    static const size_t KEY_INDEX_MAX_CANDIDATES = 8;
+
+    /**
+     * Number of superseded items of one page erased by a single Page::eraseEntries call in writeBatch.
+     */
+    static const size_t BATCH_ERASE_CHUNK = 16;
+
 public:
     ~Storage();
 
@@ -99,6 +112,8 @@ public:
 
     esp_err_t eraseNamespace(uint8_t nsIndex);
 
+    esp_err_t writeBatch(uint8_t nsIndex, WriteBatch& batch);
+
     const Partition *getPart() const
     {
         return mPartition;
@@ -126,8 +141,18 @@ public:
 
     void debugCheck();
 
+    size_t getKeyIndexMemoryUsage() const
+    {
+        return mPageManager.getKeyIndex().getMemoryUsage();
+    }
+
     esp_err_t fillStats(nvs_stats_t& nvsStats);
 
+    void fillCacheStats(nvs_cache_stats_t& cacheStats) const
+    {
+        mValueCache.fillStats(cacheStats);
+    }
+
     esp_err_t calcEntriesInNamespace(uint8_t nsIndex, size_t& usedEntries);
 
     bool findEntry(nvs_opaque_iterator_t* it, const char* name);
@@ -153,12 +178,17 @@ protected:
 
     void fillEntryInfo(Item &item, nvs_entry_info_t &info);
 
+    esp_err_t appendItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize);
+
+    esp_err_t eraseBatchLeftovers();
+
     esp_err_t findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx = Page::CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
 
 protected:
     Partition *mPartition;
     size_t mPageCount;
     PageManager mPageManager;
+    ValueCache mValueCache;
     TNamespaces mNamespaces;
     CompressedEnumTable<bool, 1, 256> mNamespaceUsage;
     StorageState mState = StorageState::INVALID;
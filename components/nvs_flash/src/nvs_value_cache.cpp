@@ -0,0 +1,155 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstring>
+#include "nvs_value_cache.hpp"
+
+namespace nvs
+{
+
+ValueCache::ValueCache()
+{
+}
+
+ValueCache::~ValueCache()
+{
+    mLru.clear();
+    delete[] mEntries;
+}
+
+esp_err_t ValueCache::init(size_t capacity)
+{
+    mLru.clear();
+    delete[] mEntries;
+    mEntries = nullptr;
+    mCapacity = 0;
+    mUsedCount = 0;
+    mHits = 0;
+    mMisses = 0;
+
+    if (capacity == 0) {
+        return ESP_OK;
+    }
+
+    mEntries = new (std::nothrow) CacheEntry[capacity];
+    if (!mEntries) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+        mLru.push_back(&mEntries[i]);
+    }
+    mCapacity = capacity;
+    return ESP_OK;
+}
+
+void ValueCache::clear()
+{
+    for (auto it = mLru.begin(); it != mLru.end(); ++it) {
+        it->mUsed = false;
+    }
+    mUsedCount = 0;
+}
+
+const uint8_t* ValueCache::find(uint8_t nsIndex, ItemType datatype, const char* key, size_t& dataSize, bool countLookup)
+{
+    if (!mCapacity) {
+        return nullptr;
+    }
+
+    for (auto it = mLru.begin(); it != mLru.end() && it->mUsed; ++it) {
+        if (it->mNsIndex != nsIndex || it->mDatatype != datatype
+                || strncmp(key, it->mKey, Item::MAX_KEY_LENGTH) != 0) {
+            continue;
+        }
+        CacheEntry* entry = it;
+        if (entry != &mLru.front()) {
+            mLru.erase(entry);
+            mLru.push_front(entry);
+        }
+        if (countLookup) {
+            ++mHits;
+        }
+        dataSize = entry->mDataSize;
+        return entry->mData;
+    }
+    if (countLookup) {
+        ++mMisses;
+    }
+    return nullptr;
+}
+
+void ValueCache::insert(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize)
+{
+    if (!mCapacity || dataSize > MAX_VALUE_SIZE) {
+        return;
+    }
+
+    // replaces a stale copy of the same key, otherwise the least recently used or an unused entry
+    invalidate(nsIndex, key);
+    CacheEntry* entry = &mLru.back();
+    if (!entry->mUsed) {
+        ++mUsedCount;
+    }
+    entry->mUsed = true;
+    entry->mNsIndex = nsIndex;
+    entry->mDatatype = datatype;
+    entry->mDataSize = static_cast<uint8_t>(dataSize);
+    strncpy(entry->mKey, key, sizeof(entry->mKey) - 1);
+    entry->mKey[sizeof(entry->mKey) - 1] = 0;
+    memcpy(entry->mData, data, dataSize);
+    mLru.erase(entry);
+    mLru.push_front(entry);
+}
+
+void ValueCache::invalidate(uint8_t nsIndex, const char* key)
+{
+    if (!mCapacity) {
+        return;
+    }
+
+    auto it = mLru.begin();
+    while (it != mLru.end() && it->mUsed) {
+        CacheEntry* entry = it;
+        ++it;
+        if (entry->mNsIndex == nsIndex && strncmp(key, entry->mKey, Item::MAX_KEY_LENGTH) == 0) {
+            release(entry);
+        }
+    }
+}
+
+void ValueCache::invalidateNamespace(uint8_t nsIndex)
+{
+    if (!mCapacity) {
+        return;
+    }
+
+    auto it = mLru.begin();
+    while (it != mLru.end() && it->mUsed) {
+        CacheEntry* entry = it;
+        ++it;
+        if (entry->mNsIndex == nsIndex) {
+            release(entry);
+        }
+    }
+}
+
+void ValueCache::release(CacheEntry* entry)
+{
+    entry->mUsed = false;
+    --mUsedCount;
+    mLru.erase(entry);
+    mLru.push_back(entry);
+}
+
+void ValueCache::fillStats(nvs_cache_stats_t& stats) const
+{
+    stats.hits = mHits;
+    stats.misses = mMisses;
+    stats.used_entries = mUsedCount;
+    stats.total_entries = mCapacity;
+}
+
+} // namespace nvs
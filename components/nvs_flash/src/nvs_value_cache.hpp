@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef nvs_value_cache_hpp
+#define nvs_value_cache_hpp
+
+#include "nvs.h"
+#include "nvs_handle.hpp"
+#include "nvs_types.hpp"
+#include "nvs_memory_management.hpp"
+#include "intrusive_list.h"
+
+namespace nvs
+{
+
+/**
+ * Bounded least-recently-used cache of small values read through Storage.
+ *
+ * The cache holds copies of values, keyed by <namespace index, data type, key>. Storage inserts values after
+ * reading them from flash and invalidates them whenever the key is written or erased. All entries are allocated
+ * once in init(), a cache initialized with zero capacity does nothing.
+ */
+class ValueCache
+{
+public:
+    /**
+     * Largest value (in bytes) kept in the cache. Larger strings and blobs are always read from flash.
+     */
+    static const size_t MAX_VALUE_SIZE = 32;
+
+    ValueCache();
+    ~ValueCache();
+
+    esp_err_t init(size_t capacity);
+    void clear();
+
+    /**
+     * Looks up a value. On a hit, the entry becomes the most recently used one.
+     * Lookups which are part of a larger read pass \c countLookup = false,
+     * so that each read is counted once in the hit and miss statistics.
+     *
+     * @return pointer to the cached value and its size in \c dataSize, or nullptr on a miss
+     */
+    const uint8_t* find(uint8_t nsIndex, ItemType datatype, const char* key, size_t& dataSize, bool countLookup = true);
+
+    void insert(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize);
+
+    /**
+     * Drops the cached values of \c key regardless of their type.
+     */
+    void invalidate(uint8_t nsIndex, const char* key);
+
+    void invalidateNamespace(uint8_t nsIndex);
+
+    bool isEnabled() const
+    {
+        return mCapacity > 0;
+    }
+
+    void fillStats(nvs_cache_stats_t& stats) const;
+
+private:
+    ValueCache(const ValueCache& other);
+    const ValueCache& operator= (const ValueCache& rhs);
+
+protected:
+    struct CacheEntry : public intrusive_list_node<CacheEntry>, public ExceptionlessAllocatable {
+    public:
+        bool mUsed = false;
+        uint8_t mNsIndex;
+        ItemType mDatatype;
+        uint8_t mDataSize;
+        char mKey[Item::MAX_KEY_LENGTH + 1];
+        uint8_t mData[MAX_VALUE_SIZE];
+    };
+
+    typedef intrusive_list<CacheEntry> TEntryList;
+
+    void release(CacheEntry* entry);
+
+    CacheEntry* mEntries = nullptr;
+    TEntryList mLru;    // most recently used entries first, unused entries at the end
+    size_t mCapacity = 0;
+    size_t mUsedCount = 0;
+    size_t mHits = 0;
+    size_t mMisses = 0;
+}; // class ValueCache
+
+} // namespace nvs
+
+#endif /* nvs_value_cache_hpp */
@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstring>
+#include "nvs_write_batch.hpp"
+#include "nvs_page.hpp"
+
+namespace nvs
+{
+
+WriteBatch::~WriteBatch()
+{
+    clear();
+}
+
+esp_err_t WriteBatch::set(ItemType datatype, const char* key, const void* data, size_t dataSize)
+{
+    if (datatype == ItemType::ANY) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // reject what Page::writeItem would reject, so that the commit doesn't fail half-way for these reasons
+    if (datatype == ItemType::SZ && dataSize > Page::CHUNK_MAX_SIZE) {
+        return ESP_ERR_NVS_VALUE_TOO_LONG;
+    }
+
+    if (!isVariableLengthType(datatype) && dataSize > 8) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return stage(datatype, key, data, dataSize);
+}
+
+esp_err_t WriteBatch::erase(const char* key)
+{
+    return stage(ItemType::ANY, key, nullptr, 0);
+}
+
+esp_err_t WriteBatch::stage(ItemType datatype, const char* key, const void* data, size_t dataSize)
+{
+    if (strlen(key) > Item::MAX_KEY_LENGTH) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+
+    uint8_t* copy = nullptr;
+    if (dataSize > 0) {
+        copy = static_cast<uint8_t*>(std::malloc(dataSize));
+        if (!copy) {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(copy, data, dataSize);
+    }
+
+    Entry* entry = find(key);
+    if (!entry) {
+        entry = new (std::nothrow) Entry;
+        if (!entry) {
+            std::free(copy);
+            return ESP_ERR_NO_MEM;
+        }
+        strncpy(entry->mKey, key, sizeof(entry->mKey) - 1);
+        entry->mKey[sizeof(entry->mKey) - 1] = 0;
+        mEntries.push_back(entry);
+        ++mEntryCount;
+    } else {
+        std::free(entry->mData);
+    }
+
+    entry->mDatatype = datatype;
+    entry->mData = copy;
+    entry->mDataSize = dataSize;
+    return ESP_OK;
+}
+
+WriteBatch::Entry* WriteBatch::find(const char* key)
+{
+    for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+        if (strncmp(key, it->mKey, sizeof(it->mKey) - 1) == 0) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+void WriteBatch::clear()
+{
+    mEntries.clearAndFreeNodes();
+    mEntryCount = 0;
+}
+
+} // namespace nvs
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef nvs_write_batch_hpp
+#define nvs_write_batch_hpp
+
+#include "nvs.h"
+#include "nvs_handle.hpp"
+#include "nvs_types.hpp"
+#include "nvs_memory_management.hpp"
+#include "intrusive_list.h"
+
+namespace nvs
+{
+
+class Page;
+
+/**
+ * Set of writes and erasures staged on a handle between nvs_batch_begin and nvs_batch_commit.
+ *
+ * Every key is staged at most once: staging a key again replaces the previously staged value, so only the
+ * last value of each key ends up in flash. The batch owns copies of all staged values.
+ */
+class WriteBatch : public ExceptionlessAllocatable
+{
+public:
+    struct Entry : public intrusive_list_node<Entry>, public ExceptionlessAllocatable {
+    public:
+        enum class Mode : uint8_t {
+            APPEND,     // written after the batch marker, superseded item erased together with the others
+            SLOW_PATH,  // written or erased one by one after the batch, like a regular set/erase call
+            SKIP,       // nothing to do, e.g. the value is already stored
+        };
+
+        ~Entry()
+        {
+            std::free(mData);
+        }
+
+        bool isErase() const
+        {
+            return mDatatype == ItemType::ANY;
+        }
+
+        char mKey[Item::MAX_KEY_LENGTH + 1];
+        ItemType mDatatype; // ItemType::ANY marks a staged erasure
+        size_t mDataSize = 0;
+        uint8_t* mData = nullptr;
+
+        // used by Storage::writeBatch
+        Mode mMode = Mode::APPEND;
+        Page* mOldPage = nullptr;
+        size_t mOldIndex = 0;
+    };
+
+    typedef intrusive_list<Entry> TEntryList;
+
+    ~WriteBatch();
+
+    esp_err_t set(ItemType datatype, const char* key, const void* data, size_t dataSize);
+
+    esp_err_t erase(const char* key);
+
+    Entry* find(const char* key);
+
+    void clear();
+
+    size_t size() const
+    {
+        return mEntryCount;
+    }
+
+    TEntryList::iterator begin()
+    {
+        return mEntries.begin();
+    }
+
+    TEntryList::iterator end()
+    {
+        return mEntries.end();
+    }
+
+protected:
+    esp_err_t stage(ItemType datatype, const char* key, const void* data, size_t dataSize);
+
+    TEntryList mEntries;
+    size_t mEntryCount = 0;
+}; // class WriteBatch
+
+} // namespace nvs
+
+#endif /* nvs_write_batch_hpp */
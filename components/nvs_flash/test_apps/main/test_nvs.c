@@ -17,6 +17,7 @@
 #include "esp_log.h"
 #include "esp_partition.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "spi_flash_mmap.h"
 
 #include "nvs.h"
@@ -136,6 +137,52 @@ TEST_CASE("flash erase deinitializes initialized partition", "[nvs]")
     nvs_flash_deinit();
 }
 
+TEST_CASE("measure nvs_flash_init time", "[nvs]")
+{
+    // number of keys written before measuring, spread over several pages
+    const int key_count = 300;
+    const int init_count = 5;
+
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        err = nvs_flash_init();
+    }
+    TEST_ESP_OK(err);
+
+    nvs_handle_t handle;
+    char key_name[sizeof("keyXXXXX ")];
+    TEST_ESP_OK(nvs_open("init_time", NVS_READWRITE, &handle));
+    for (int i = 0; i < key_count; ++i) {
+        snprintf(key_name, sizeof(key_name), "key%05d", i);
+        TEST_ESP_OK(nvs_set_i32(handle, key_name, i));
+    }
+    TEST_ESP_OK(nvs_commit(handle));
+    nvs_close(handle);
+
+    nvs_stats_t stats;
+    TEST_ESP_OK(nvs_get_stats(NULL, &stats));
+    TEST_ESP_OK(nvs_flash_deinit());
+
+    int64_t total_time = 0;
+    for (int i = 0; i < init_count; ++i) {
+        int64_t start = esp_timer_get_time();
+        TEST_ESP_OK(nvs_flash_init());
+        total_time += esp_timer_get_time() - start;
+        TEST_ESP_OK(nvs_flash_deinit());
+    }
+
+#ifdef CONFIG_NVS_PARALLEL_PAGE_LOAD
+    const char *load_mode = "parallel";
+#else
+    const char *load_mode = "sequential";
+#endif
+    ESP_LOGI(TAG, "nvs_flash_init: %" PRId64 " us on average (%s page load, %d used of %d entries)",
+             total_time / init_count, load_mode, (int) stats.used_entries, (int) stats.total_entries);
+
+    TEST_ESP_OK(nvs_flash_erase());
+}
+
 #ifndef CONFIG_NVS_ENCRYPTION
 // NOTE: `nvs_flash_init_partition_ptr` does not support NVS encryption
 TEST_CASE("nvs_flash_init_partition_ptr() works correctly", "[nvs]")
@@ -18,6 +18,14 @@ def test_nvs_flash(dut: IdfDut) -> None:
     dut.expect_unity_test_output(timeout=120)
 
 
+@pytest.mark.esp32
+@pytest.mark.parametrize('config', ['parallel_page_load'], indirect=True)
+def test_nvs_flash_parallel_page_load(dut: IdfDut) -> None:
+    dut.expect_exact('Press ENTER to see the list of tests')
+    dut.write('![nvs_encr_hmac]')
+    dut.expect_unity_test_output(timeout=120)
+
+
 @pytest.mark.esp32c3
 @pytest.mark.nvs_encr_hmac
 @pytest.mark.parametrize('config', ['nvs_encr_hmac_esp32c3'], indirect=True)
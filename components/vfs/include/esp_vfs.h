@@ -77,6 +77,11 @@ typedef struct
     void *sem;              /*!< semaphore instance */
 } esp_vfs_select_sem_t;
 
+/**
+ * @brief Registration of a file descriptor in an epoll instance, see esp_vfs_epoll_notify()
+ */
+typedef struct esp_vfs_epoll_watch esp_vfs_epoll_watch_t;
+
 /**
  * @brief VFS definition structure
  *
@@ -257,6 +262,12 @@ typedef struct
     /** get_socket_select_semaphore returns semaphore allocated in the socket driver; set only for the socket driver */
     esp_err_t (*end_select)(void *end_select_args);
 #endif // CONFIG_VFS_SUPPORT_SELECT || defined __DOXYGEN__
+#if CONFIG_VFS_SUPPORT_EPOLL || defined __DOXYGEN__
+    /** epoll_watch is called with a watch when the FD is added to an epoll instance and with NULL when it is removed; the driver calls esp_vfs_epoll_notify() with the watch when the FD may have become ready */
+    int (*epoll_watch)(int fd, esp_vfs_epoll_watch_t *watch);
+    /** epoll_poll returns the current readiness of the FD as a combination of POLLIN, POLLOUT and POLLERR, or -1 with errno set; it must not block */
+    int (*epoll_poll)(int fd);
+#endif // CONFIG_VFS_SUPPORT_EPOLL || defined __DOXYGEN__
 } esp_vfs_t;
 
 /**
@@ -445,6 +456,33 @@ void esp_vfs_select_triggered(esp_vfs_select_sem_t sem);
  */
 void esp_vfs_select_triggered_isr(esp_vfs_select_sem_t sem, BaseType_t *woken);
 
+#if CONFIG_VFS_SUPPORT_EPOLL || defined __DOXYGEN__
+
+/**
+ * @brief Notification from a VFS driver that a watched file descriptor may have become ready
+ *
+ * The driver calls this function after data arrived, space became available or an error occurred
+ * on a file descriptor registered by the epoll_watch call. The readiness is read back with epoll_poll
+ * by esp_vfs_epoll_wait(), so the driver doesn't need to report when the file descriptor stops
+ * being ready. Spurious notifications are allowed.
+ *
+ * The function can be called from a critical section. After epoll_watch was called with NULL,
+ * the driver must not call it with the previous watch anymore.
+ *
+ * @param watch watch which was passed to the driver by the epoll_watch call
+ */
+void esp_vfs_epoll_notify(esp_vfs_epoll_watch_t *watch);
+
+/**
+ * @brief Notification from a VFS driver that a watched file descriptor may have become ready (ISR version)
+ *
+ * @param watch watch which was passed to the driver by the epoll_watch call
+ * @param woken is set to pdTRUE if the function wakes up a task with higher priority
+ */
+void esp_vfs_epoll_notify_isr(esp_vfs_epoll_watch_t *watch, BaseType_t *woken);
+
+#endif // CONFIG_VFS_SUPPORT_EPOLL || defined __DOXYGEN__
+
 /**
  *
  * @brief Implements the VFS layer of POSIX pread()
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/poll.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VFS_EPOLLIN     POLLIN      /*!< The file descriptor is readable */
+#define ESP_VFS_EPOLLOUT    POLLOUT     /*!< The file descriptor is writable */
+#define ESP_VFS_EPOLLERR    POLLERR     /*!< An error occurred, always reported */
+
+#define ESP_VFS_EPOLL_CTL_ADD   1       /*!< Add a file descriptor to the epoll instance */
+#define ESP_VFS_EPOLL_CTL_DEL   2       /*!< Remove a file descriptor from the epoll instance */
+#define ESP_VFS_EPOLL_CTL_MOD   3       /*!< Change the events of a file descriptor in the epoll instance */
+
+/**
+ * @brief User data stored with a file descriptor and returned by esp_vfs_epoll_wait()
+ */
+typedef union {
+    void *ptr;          /*!< Pointer */
+    int fd;             /*!< File descriptor */
+    uint32_t u32;       /*!< 32-bit value */
+} esp_vfs_epoll_data_t;
+
+/**
+ * @brief Events of a file descriptor
+ */
+typedef struct {
+    uint32_t events;                /*!< Combination of ESP_VFS_EPOLLIN, ESP_VFS_EPOLLOUT and ESP_VFS_EPOLLERR */
+    esp_vfs_epoll_data_t data;      /*!< User data */
+} esp_vfs_epoll_event_t;
+
+/**
+ * @brief Create an epoll instance
+ *
+ * The instance keeps the list of the watched file descriptors which are ready, so the cost of
+ * esp_vfs_epoll_wait() depends on the number of ready file descriptors, not on the number of
+ * watched ones. Close the returned file descriptor with close() to destroy the instance.
+ *
+ * @note Only available if CONFIG_VFS_SUPPORT_EPOLL is enabled.
+ *
+ * @return The file descriptor of the instance, or -1 with errno set to ENFILE if
+ *         CONFIG_VFS_EPOLL_MAX_INSTANCES instances are open or to ENOMEM.
+ */
+int esp_vfs_epoll_create(void);
+
+/**
+ * @brief Add, change or remove a file descriptor watched by an epoll instance
+ *
+ * The same semantics as man(2) epoll_ctl, level-triggered. Only file descriptors of the drivers which
+ * implement epoll_watch and epoll_poll can be watched: sockets, eventfd and UART (with the UART
+ * driver installed). A file descriptor can be watched by one epoll instance at a time. Closing
+ * the file descriptor removes it from the instance.
+ *
+ * @param epfd      File descriptor of the epoll instance
+ * @param op        ESP_VFS_EPOLL_CTL_ADD, ESP_VFS_EPOLL_CTL_MOD or ESP_VFS_EPOLL_CTL_DEL
+ * @param fd        File descriptor to watch
+ * @param event     Events to watch and user data, ignored for ESP_VFS_EPOLL_CTL_DEL
+ *
+ * @return 0 if successful, -1 with errno set otherwise: EBADF or EINVAL if epfd or fd is not valid,
+ *         EPERM if the driver of fd doesn't support epoll, EEXIST if fd is already watched,
+ *         ENOENT if fd isn't watched by this instance, ENOMEM.
+ */
+int esp_vfs_epoll_ctl(int epfd, int op, int fd, const esp_vfs_epoll_event_t *event);
+
+/**
+ * @brief Wait until some of the file descriptors watched by an epoll instance are ready
+ *
+ * @param epfd          File descriptor of the epoll instance
+ * @param events        Array filled with the events of the ready file descriptors
+ * @param maxevents     Size of the array
+ * @param timeout_ms    Timeout in milliseconds, -1 to wait forever, 0 to return immediately
+ *
+ * @note If epfd is closed by another task meanwhile, the call returns -1 with errno set to EBADF.
+ *
+ * @return The number of ready file descriptors (0 if the timeout expired), or -1 with errno set
+ *         to EBADF or EINVAL.
+ */
+int esp_vfs_epoll_wait(int epfd, esp_vfs_epoll_event_t *events, int maxevents, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
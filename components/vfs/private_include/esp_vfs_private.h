@@ -72,6 +72,34 @@ const vfs_entry_t *get_vfs_for_path(const char *path);
  */
 const vfs_entry_t *get_vfs_for_index(int index);
 
+/**
+ * Get vfs entry for the given global file descriptor.
+ *
+ * @param fd Global file descriptor.
+ *
+ * @return Pointer to the `vfs_entry_t` of the file descriptor, NULL if it isn't open.
+ */
+const vfs_entry_t *get_vfs_for_fd(int fd);
+
+/**
+ * Get the file descriptor local to the VFS driver for the given global file descriptor.
+ *
+ * @param vfs VFS entry returned by get_vfs_for_fd().
+ * @param fd Global file descriptor.
+ *
+ * @return Local file descriptor, -1 if vfs is NULL or fd isn't valid.
+ */
+int get_local_fd(const vfs_entry_t *vfs, int fd);
+
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+/**
+ * Remove the file descriptor from the epoll instance watching it, called when it is closed.
+ *
+ * @param fd Global file descriptor.
+ */
+void esp_vfs_epoll_remove_fd(int fd);
+#endif // CONFIG_VFS_SUPPORT_EPOLL
+
 #ifdef __cplusplus
 }
 #endif
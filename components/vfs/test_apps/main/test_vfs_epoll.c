@@ -0,0 +1,332 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/select.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "esp_cpu.h"
+#include "esp_vfs.h"
+#include "esp_vfs_epoll.h"
+#include "esp_vfs_eventfd.h"
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#include "lwip/sockets.h"
+#include "test_utils.h"
+#include "sdkconfig.h"
+
+#if CONFIG_VFS_SUPPORT_EPOLL
+
+static void signal_fd(int fd)
+{
+    uint64_t val = 1;
+    TEST_ASSERT_EQUAL(sizeof(val), write(fd, &val, sizeof(val)));
+}
+
+static void clear_fd(int fd)
+{
+    uint64_t val;
+    TEST_ASSERT_EQUAL(sizeof(val), read(fd, &val, sizeof(val)));
+}
+
+static const char message[] = "Hello world!";
+
+// UDP socket bound to an ephemeral port of the loopback interface, its address is returned in 'addr'
+static int open_udp_socket(struct sockaddr_in *addr)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    const struct sockaddr_in saddr = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, bind(fd, (const struct sockaddr *) &saddr, sizeof(saddr)));
+    socklen_t len = sizeof(*addr);
+    TEST_ASSERT_EQUAL(0, getsockname(fd, (struct sockaddr *) addr, &len));
+    return fd;
+}
+
+static void send_message(int fd, const struct sockaddr_in *addr)
+{
+    TEST_ASSERT_EQUAL(sizeof(message), sendto(fd, message, sizeof(message), 0,
+                                              (const struct sockaddr *) addr, sizeof(*addr)));
+}
+
+TEST_CASE("epoll reports ready eventfds", "[vfs][epoll]")
+{
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+    int fd0 = eventfd(0, 0);
+    int fd1 = eventfd(0, EFD_SUPPORT_ISR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd1);
+
+    int epfd = esp_vfs_epoll_create();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, epfd);
+    esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN, .data.u32 = 100 };
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, fd0, &event));
+    event.data.u32 = 101;
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, fd1, &event));
+    TEST_ASSERT_EQUAL(-1, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, fd1, &event));
+    TEST_ASSERT_EQUAL(EEXIST, errno);
+    TEST_ASSERT_EQUAL(-1, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, epfd, &event));
+
+    esp_vfs_epoll_event_t events[4];
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 4, 0));
+
+    // Level-triggered: reported until the eventfd is read
+    signal_fd(fd1);
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 4, 0));
+        TEST_ASSERT_EQUAL(ESP_VFS_EPOLLIN, events[0].events);
+        TEST_ASSERT_EQUAL(101, events[0].data.u32);
+    }
+    clear_fd(fd1);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 4, 0));
+
+    // Eventfds are always writable
+    event.events = ESP_VFS_EPOLLIN | ESP_VFS_EPOLLOUT;
+    event.data.u32 = 200;
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_MOD, fd0, &event));
+    signal_fd(fd0);
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 4, 0));
+    TEST_ASSERT_EQUAL(ESP_VFS_EPOLLIN | ESP_VFS_EPOLLOUT, events[0].events);
+    TEST_ASSERT_EQUAL(200, events[0].data.u32);
+
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_DEL, fd0, NULL));
+    TEST_ASSERT_EQUAL(-1, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_DEL, fd0, NULL));
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 4, 0));
+
+    // Closing a watched fd removes it from the instance
+    TEST_ASSERT_EQUAL(0, close(fd1));
+    fd1 = eventfd(0, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd1);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, fd1, &event));
+
+    TEST_ASSERT_EQUAL(0, close(epfd));
+    TEST_ASSERT_EQUAL(-1, esp_vfs_epoll_wait(epfd, events, 4, 0));
+    TEST_ASSERT_EQUAL(EBADF, errno);
+    TEST_ASSERT_EQUAL(0, close(fd0));
+    TEST_ASSERT_EQUAL(0, close(fd1));
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+}
+
+static void signal_task(void *arg)
+{
+    int fd = *((int *)arg);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    signal_fd(fd);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("epoll wait is woken up by another task", "[vfs][epoll]")
+{
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+    int fd = eventfd(0, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    int epfd = esp_vfs_epoll_create();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, epfd);
+    esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN, .data.fd = fd };
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, fd, &event));
+
+    xTaskCreate(signal_task, "signal_task", 2048, &fd, 5, NULL);
+    esp_vfs_epoll_event_t events[1];
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 1, 2000));
+    TEST_ASSERT_EQUAL(fd, events[0].data.fd);
+
+    clear_fd(fd);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 1, 50));
+
+    TEST_ASSERT_EQUAL(0, close(epfd));
+    TEST_ASSERT_EQUAL(0, close(fd));
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+}
+
+static void close_task(void *arg)
+{
+    int epfd = *((int *)arg);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL(0, close(epfd));
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("epoll wait returns when the instance is closed by another task", "[vfs][epoll]")
+{
+    int epfd = esp_vfs_epoll_create();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, epfd);
+
+    xTaskCreate(close_task, "close_task", 2048, &epfd, 5, NULL);
+    esp_vfs_epoll_event_t events[1];
+    TEST_ASSERT_EQUAL(-1, esp_vfs_epoll_wait(epfd, events, 1, 2000));
+    TEST_ASSERT_EQUAL(EBADF, errno);
+
+    // the instance was freed by the wait, a new one can be created
+    epfd = esp_vfs_epoll_create();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, epfd);
+    TEST_ASSERT_EQUAL(0, close(epfd));
+}
+
+TEST_CASE("epoll reports ready lwip sockets", "[vfs][epoll]")
+{
+    test_case_uses_tcpip();
+    struct sockaddr_in rx_addr;
+    struct sockaddr_in tx_addr;
+    int rx = open_udp_socket(&rx_addr);
+    int tx = open_udp_socket(&tx_addr);
+
+    int epfd = esp_vfs_epoll_create();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, epfd);
+    esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN, .data.fd = rx };
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, rx, &event));
+    event = (esp_vfs_epoll_event_t) { .events = ESP_VFS_EPOLLOUT, .data.fd = tx };
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, tx, &event));
+
+    // Only the sending socket is ready, it is writable
+    esp_vfs_epoll_event_t events[4];
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 4, 0));
+    TEST_ASSERT_EQUAL(tx, events[0].data.fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_EPOLLOUT, events[0].events);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_DEL, tx, NULL));
+
+    // The datagram is delivered by the TCP/IP task, which notifies the watch of the receiving socket
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 4, 0));
+    send_message(tx, &rx_addr);
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 4, 1000));
+    TEST_ASSERT_EQUAL(rx, events[0].data.fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_EPOLLIN, events[0].events);
+
+    char recv_message[sizeof(message)];
+    TEST_ASSERT_EQUAL(sizeof(message), recv(rx, recv_message, sizeof(recv_message), 0));
+    TEST_ASSERT_EQUAL_STRING(message, recv_message);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 4, 0));
+
+    // Closing a watched socket removes it from the instance
+    TEST_ASSERT_EQUAL(0, close(rx));
+    send_message(tx, &rx_addr);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 4, 50));
+
+    TEST_ASSERT_EQUAL(0, close(epfd));
+    TEST_ASSERT_EQUAL(0, close(tx));
+}
+
+TEST_CASE("epoll reports ready UART", "[vfs][epoll]")
+{
+    uart_config_t uart_config = {
+        .baud_rate = 115200,
+        .data_bits = UART_DATA_8_BITS,
+        .parity    = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    TEST_ESP_OK(uart_driver_install(UART_NUM_1, 256, 256, 0, NULL, 0));
+    TEST_ESP_OK(uart_param_config(UART_NUM_1, &uart_config));
+    TEST_ESP_OK(uart_set_loop_back(UART_NUM_1, true));
+    int fd = open("/dev/uart/1", O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    uart_vfs_dev_use_driver(UART_NUM_1);
+
+    int epfd = esp_vfs_epoll_create();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, epfd);
+    esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN, .data.fd = fd };
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, fd, &event));
+    esp_vfs_epoll_event_t events[1];
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 1, 0));
+
+    // The received data is notified from the UART interrupt
+    TEST_ASSERT_EQUAL(sizeof(message), write(fd, message, sizeof(message)));
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 1, 1000));
+    TEST_ASSERT_EQUAL(fd, events[0].data.fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_EPOLLIN, events[0].events);
+
+    char recv_message[sizeof(message)];
+    TEST_ASSERT_EQUAL(sizeof(message), read(fd, recv_message, sizeof(recv_message)));
+    TEST_ASSERT_EQUAL_STRING(message, recv_message);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 1, 0));
+
+    TEST_ASSERT_EQUAL(0, close(epfd));
+    uart_vfs_dev_use_nonblocking(UART_NUM_1);
+    TEST_ASSERT_EQUAL(0, close(fd));
+    TEST_ESP_OK(uart_driver_delete(UART_NUM_1));
+}
+
+#define BENCHMARK_MAX_FDS   32
+#define BENCHMARK_SOCKETS   4
+#define ITERATIONS          100
+
+TEST_CASE("epoll wait versus select with one ready fd", "[vfs][epoll]")
+{
+    // The fds are eventfds and UDP sockets, the ready one is a socket with a received datagram
+    test_case_uses_tcpip();
+    esp_vfs_eventfd_config_t config = { .max_fds = BENCHMARK_MAX_FDS };
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+    int fds[BENCHMARK_MAX_FDS + BENCHMARK_SOCKETS];
+    const int counts[] = { 4, 16, BENCHMARK_MAX_FDS };
+    uint32_t epoll_cycles[3];
+    uint32_t select_cycles[3];
+    struct sockaddr_in addr;
+    int sender = open_udp_socket(&addr);
+
+    for (int c = 0; c < 3; c++) {
+        const int count = counts[c] + BENCHMARK_SOCKETS;
+        int epfd = esp_vfs_epoll_create();
+        TEST_ASSERT_GREATER_OR_EQUAL(0, epfd);
+        int max_fd = 0;
+        for (int i = 0; i < count; i++) {
+            fds[i] = (i < counts[c]) ? eventfd(0, 0) : open_udp_socket(&addr);
+            TEST_ASSERT_GREATER_OR_EQUAL(0, fds[i]);
+            max_fd = fds[i] > max_fd ? fds[i] : max_fd;
+            esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN, .data.fd = fds[i] };
+            TEST_ASSERT_EQUAL(0, esp_vfs_epoll_ctl(epfd, ESP_VFS_EPOLL_CTL_ADD, fds[i], &event));
+        }
+        esp_vfs_epoll_event_t events[4];
+        TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epfd, events, 4, 0));
+        // 'addr' is the address of the last socket
+        send_message(sender, &addr);
+        TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 4, 1000));
+        TEST_ASSERT_EQUAL(fds[count - 1], events[0].data.fd);
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        for (int i = 0; i < ITERATIONS; i++) {
+            TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epfd, events, 4, 0));
+        }
+        epoll_cycles[c] = (esp_cpu_get_cycle_count() - start) / ITERATIONS;
+
+        struct timeval zero_time = { 0 };
+        fd_set read_fds;
+        start = esp_cpu_get_cycle_count();
+        for (int i = 0; i < ITERATIONS; i++) {
+            FD_ZERO(&read_fds);
+            for (int j = 0; j < count; j++) {
+                FD_SET(fds[j], &read_fds);
+            }
+            TEST_ASSERT_EQUAL(1, select(max_fd + 1, &read_fds, NULL, NULL, &zero_time));
+        }
+        select_cycles[c] = (esp_cpu_get_cycle_count() - start) / ITERATIONS;
+
+        printf("%d fds (%d sockets): esp_vfs_epoll_wait %"PRIu32" cycles, select %"PRIu32" cycles\n",
+               count, BENCHMARK_SOCKETS, epoll_cycles[c], select_cycles[c]);
+        for (int i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL(0, close(fds[i]));
+        }
+        TEST_ASSERT_EQUAL(0, close(epfd));
+    }
+    TEST_ASSERT_EQUAL(0, close(sender));
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+
+    // The cost of select() grows with the number of fds, the cost of esp_vfs_epoll_wait() doesn't
+    TEST_ASSERT_LESS_THAN(select_cycles[2], epoll_cycles[2]);
+    TEST_ASSERT_LESS_THAN(epoll_cycles[0] * 2, epoll_cycles[2]);
+}
+
+#endif // CONFIG_VFS_SUPPORT_EPOLL
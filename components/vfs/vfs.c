@@ -327,7 +327,7 @@ static inline bool fd_valid(int fd)
     return (fd < MAX_FDS) && (fd >= 0);
 }
 
-static const vfs_entry_t *get_vfs_for_fd(int fd)
+const vfs_entry_t *get_vfs_for_fd(int fd)
 {
     const vfs_entry_t *vfs = NULL;
     if (fd_valid(fd)) {
@@ -337,7 +337,7 @@ static const vfs_entry_t *get_vfs_for_fd(int fd)
     return vfs;
 }
 
-static inline int get_local_fd(const vfs_entry_t *vfs, int fd)
+int get_local_fd(const vfs_entry_t *vfs, int fd)
 {
     int local_fd = -1;
 
@@ -565,6 +565,9 @@ int esp_vfs_close(struct _reent *r, int fd)
         __errno_r(r) = EBADF;
         return -1;
     }
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+    esp_vfs_epoll_remove_fd(fd);
+#endif // CONFIG_VFS_SUPPORT_EPOLL
     int ret;
     CHECK_AND_CALL(ret, r, vfs, close, local_fd);
 
@@ -0,0 +1,463 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/lock.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_vfs.h"
+#include "esp_vfs_epoll.h"
+#include "esp_vfs_private.h"
+#include "sdkconfig.h"
+
+/*
+ * About the ready list
+ *
+ * Each watched file descriptor has one esp_vfs_epoll_watch_t, which the VFS driver gets through
+ * its epoll_watch function. When the file descriptor may have become ready, the driver calls
+ * esp_vfs_epoll_notify(), which appends the watch to the ready list of the instance unless it is
+ * already there, and wakes up esp_vfs_epoll_wait().
+ *
+ * esp_vfs_epoll_wait() only goes through the ready list and asks the driver for the current
+ * readiness of each watch with epoll_poll. The watches which are still ready are reported and
+ * appended to the list again (level-triggered), the others are dropped until the driver notifies
+ * them again. Drivers don't need to report when a file descriptor stops being ready, and the cost
+ * of esp_vfs_epoll_wait() doesn't depend on the number of watched file descriptors.
+ */
+struct esp_vfs_epoll_watch {
+    struct epoll_instance_t     *instance;
+    const vfs_entry_t           *vfs;
+    int                         fd;         // global FD
+    int                         local_fd;
+    uint32_t                    events;     // watched events, ESP_VFS_EPOLLERR is always reported
+    esp_vfs_epoll_data_t        data;
+    bool                        ready;      // watch is in the ready list
+    struct esp_vfs_epoll_watch  *next_ready;
+};
+
+typedef struct epoll_instance_t {
+    // protects the ready list, taken by the notifications from drivers
+    portMUX_TYPE            lock;
+    esp_vfs_epoll_watch_t   *ready_head;
+    esp_vfs_epoll_watch_t   *ready_tail;
+    // given when a watch is appended to the ready list
+    SemaphoreHandle_t       sem;
+    // serializes going through the ready list with changes and removal of watches
+    _lock_t                 wait_lock;
+    // number of esp_vfs_epoll_wait() calls using the instance, protected by s_lock
+    int                     users;
+    // set under wait_lock when the epoll file descriptor is closed
+    bool                    closed;
+} epoll_instance_t;
+
+static esp_vfs_id_t s_epoll_vfs_id = -1;
+static epoll_instance_t *s_instances[CONFIG_VFS_EPOLL_MAX_INSTANCES];
+static esp_vfs_epoll_watch_t *s_watches[MAX_FDS];
+// protects s_instances, s_watches and the number of users of the instances
+static _lock_t s_lock;
+
+static inline bool ready_list_push(epoll_instance_t *instance, esp_vfs_epoll_watch_t *watch)
+{
+    if (watch->ready) {
+        return false;
+    }
+    watch->ready = true;
+    watch->next_ready = NULL;
+    if (instance->ready_tail) {
+        instance->ready_tail->next_ready = watch;
+    } else {
+        instance->ready_head = watch;
+    }
+    instance->ready_tail = watch;
+    return true;
+}
+
+static inline esp_vfs_epoll_watch_t *ready_list_pop(epoll_instance_t *instance)
+{
+    esp_vfs_epoll_watch_t *watch = instance->ready_head;
+    if (watch) {
+        instance->ready_head = watch->next_ready;
+        if (instance->ready_head == NULL) {
+            instance->ready_tail = NULL;
+        }
+        watch->ready = false;
+    }
+    return watch;
+}
+
+static void ready_list_remove(epoll_instance_t *instance, esp_vfs_epoll_watch_t *watch)
+{
+    if (!watch->ready) {
+        return;
+    }
+    esp_vfs_epoll_watch_t *prev = NULL;
+    for (esp_vfs_epoll_watch_t *it = instance->ready_head; it != NULL; prev = it, it = it->next_ready) {
+        if (it == watch) {
+            if (prev) {
+                prev->next_ready = watch->next_ready;
+            } else {
+                instance->ready_head = watch->next_ready;
+            }
+            if (instance->ready_tail == watch) {
+                instance->ready_tail = prev;
+            }
+            break;
+        }
+    }
+    watch->ready = false;
+}
+
+void esp_vfs_epoll_notify(esp_vfs_epoll_watch_t *watch)
+{
+    epoll_instance_t *instance = watch->instance;
+
+    portENTER_CRITICAL_SAFE(&instance->lock);
+    const bool pushed = ready_list_push(instance, watch);
+    portEXIT_CRITICAL_SAFE(&instance->lock);
+
+    if (pushed) {
+        xSemaphoreGive(instance->sem);
+    }
+}
+
+void esp_vfs_epoll_notify_isr(esp_vfs_epoll_watch_t *watch, BaseType_t *woken)
+{
+    epoll_instance_t *instance = watch->instance;
+
+    portENTER_CRITICAL_ISR(&instance->lock);
+    const bool pushed = ready_list_push(instance, watch);
+    portEXIT_CRITICAL_ISR(&instance->lock);
+
+    if (pushed) {
+        xSemaphoreGiveFromISR(instance->sem, woken);
+    }
+}
+
+static epoll_instance_t *get_instance(int epfd)
+{
+    const vfs_entry_t *vfs = get_vfs_for_fd(epfd);
+    const int local_fd = get_local_fd(vfs, epfd);
+    if (vfs == NULL || local_fd < 0 || local_fd >= CONFIG_VFS_EPOLL_MAX_INSTANCES || vfs->offset != s_epoll_vfs_id) {
+        return NULL;
+    }
+    return s_instances[local_fd];
+}
+
+static void free_instance(epoll_instance_t *instance)
+{
+    vSemaphoreDelete(instance->sem);
+    _lock_close(&instance->wait_lock);
+    free(instance);
+}
+
+// called with s_lock held
+static void remove_watch(esp_vfs_epoll_watch_t *watch)
+{
+    epoll_instance_t *instance = watch->instance;
+
+    // After this call the driver doesn't notify the watch anymore
+    watch->vfs->vfs.epoll_watch(watch->local_fd, NULL);
+
+    _lock_acquire(&instance->wait_lock);
+    portENTER_CRITICAL(&instance->lock);
+    ready_list_remove(instance, watch);
+    portEXIT_CRITICAL(&instance->lock);
+    _lock_release(&instance->wait_lock);
+
+    s_watches[watch->fd] = NULL;
+    free(watch);
+}
+
+void esp_vfs_epoll_remove_fd(int fd)
+{
+    if (s_watches[fd] == NULL) { // single read -> no locking is required for FDs which aren't watched
+        return;
+    }
+    _lock_acquire(&s_lock);
+    if (s_watches[fd] != NULL) {
+        remove_watch(s_watches[fd]);
+    }
+    _lock_release(&s_lock);
+}
+
+static int epoll_close(int local_fd)
+{
+    if (local_fd < 0 || local_fd >= CONFIG_VFS_EPOLL_MAX_INSTANCES) {
+        errno = EBADF;
+        return -1;
+    }
+
+    _lock_acquire(&s_lock);
+    epoll_instance_t *instance = s_instances[local_fd];
+    if (instance == NULL) {
+        _lock_release(&s_lock);
+        errno = EBADF;
+        return -1;
+    }
+    for (int fd = 0; fd < MAX_FDS; ++fd) {
+        if (s_watches[fd] != NULL && s_watches[fd]->instance == instance) {
+            remove_watch(s_watches[fd]);
+        }
+    }
+    s_instances[local_fd] = NULL;
+
+    // esp_vfs_epoll_wait() calls still using the instance return, the last one frees it
+    _lock_acquire(&instance->wait_lock);
+    instance->closed = true;
+    _lock_release(&instance->wait_lock);
+    const bool unused = instance->users == 0;
+    if (!unused) {
+        xSemaphoreGive(instance->sem);
+    }
+    _lock_release(&s_lock);
+
+    if (unused) {
+        free_instance(instance);
+    }
+    return 0;
+}
+
+int esp_vfs_epoll_create(void)
+{
+    int ret = -1;
+
+    _lock_acquire(&s_lock);
+    if (s_epoll_vfs_id == -1) {
+        esp_vfs_t vfs = {
+            .flags = ESP_VFS_FLAG_DEFAULT,
+            .close = &epoll_close,
+        };
+        if (esp_vfs_register_with_id(&vfs, NULL, &s_epoll_vfs_id) != ESP_OK) {
+            s_epoll_vfs_id = -1;
+            errno = ENOMEM;
+            goto out;
+        }
+    }
+
+    int local_fd = 0;
+    while (local_fd < CONFIG_VFS_EPOLL_MAX_INSTANCES && s_instances[local_fd] != NULL) {
+        ++local_fd;
+    }
+    if (local_fd == CONFIG_VFS_EPOLL_MAX_INSTANCES) {
+        errno = ENFILE;
+        goto out;
+    }
+
+    epoll_instance_t *instance = heap_caps_calloc(1, sizeof(epoll_instance_t), VFS_MALLOC_FLAGS);
+    if (instance == NULL) {
+        errno = ENOMEM;
+        goto out;
+    }
+    instance->sem = xSemaphoreCreateBinary();
+    if (instance->sem == NULL) {
+        free(instance);
+        errno = ENOMEM;
+        goto out;
+    }
+    portMUX_INITIALIZE(&instance->lock);
+    _lock_init(&instance->wait_lock);
+
+    int fd;
+    if (esp_vfs_register_fd_with_local_fd(s_epoll_vfs_id, local_fd, /*permanent=*/false, &fd) != ESP_OK) {
+        free_instance(instance);
+        errno = ENFILE;
+        goto out;
+    }
+    s_instances[local_fd] = instance;
+    ret = fd;
+
+out:
+    _lock_release(&s_lock);
+    return ret;
+}
+
+int esp_vfs_epoll_ctl(int epfd, int op, int fd, const esp_vfs_epoll_event_t *event)
+{
+    if ((op == ESP_VFS_EPOLL_CTL_ADD || op == ESP_VFS_EPOLL_CTL_MOD) && event == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    const vfs_entry_t *vfs = get_vfs_for_fd(fd);
+    const int local_fd = get_local_fd(vfs, fd);
+    if (vfs == NULL || local_fd < 0) {
+        errno = EBADF;
+        return -1;
+    }
+
+    int ret = 0;
+    _lock_acquire(&s_lock);
+    epoll_instance_t *instance = get_instance(epfd);
+    esp_vfs_epoll_watch_t *watch = s_watches[fd];
+    if (instance == NULL) {
+        errno = EBADF;
+        ret = -1;
+        goto out;
+    }
+    if (fd == epfd) {
+        errno = EINVAL;
+        ret = -1;
+        goto out;
+    }
+
+    switch (op) {
+    case ESP_VFS_EPOLL_CTL_ADD:
+        if (watch != NULL) {
+            errno = EEXIST;
+            ret = -1;
+            break;
+        }
+        if (vfs->vfs.epoll_watch == NULL || vfs->vfs.epoll_poll == NULL) {
+            errno = EPERM;
+            ret = -1;
+            break;
+        }
+        watch = heap_caps_calloc(1, sizeof(esp_vfs_epoll_watch_t), VFS_MALLOC_FLAGS);
+        if (watch == NULL) {
+            errno = ENOMEM;
+            ret = -1;
+            break;
+        }
+        watch->instance = instance;
+        watch->vfs = vfs;
+        watch->fd = fd;
+        watch->local_fd = local_fd;
+        watch->events = event->events;
+        watch->data = event->data;
+        if (vfs->vfs.epoll_watch(local_fd, watch) != 0) {
+            free(watch);
+            ret = -1;
+            break;
+        }
+        s_watches[fd] = watch;
+        // The next esp_vfs_epoll_wait() polls the current readiness
+        esp_vfs_epoll_notify(watch);
+        break;
+    case ESP_VFS_EPOLL_CTL_MOD:
+        if (watch == NULL || watch->instance != instance) {
+            errno = ENOENT;
+            ret = -1;
+            break;
+        }
+        _lock_acquire(&instance->wait_lock);
+        watch->events = event->events;
+        watch->data = event->data;
+        _lock_release(&instance->wait_lock);
+        esp_vfs_epoll_notify(watch);
+        break;
+    case ESP_VFS_EPOLL_CTL_DEL:
+        if (watch == NULL || watch->instance != instance) {
+            errno = ENOENT;
+            ret = -1;
+            break;
+        }
+        remove_watch(watch);
+        break;
+    default:
+        errno = EINVAL;
+        ret = -1;
+        break;
+    }
+
+out:
+    _lock_release(&s_lock);
+    return ret;
+}
+
+// Polls the watches which are in the ready list when the function is called, each at most once
+static int collect_ready(epoll_instance_t *instance, esp_vfs_epoll_event_t *events, int maxevents)
+{
+    int count = 0;
+
+    portENTER_CRITICAL(&instance->lock);
+    const esp_vfs_epoll_watch_t *last = instance->ready_tail;
+    portEXIT_CRITICAL(&instance->lock);
+
+    while (last != NULL && count < maxevents) {
+        portENTER_CRITICAL(&instance->lock);
+        esp_vfs_epoll_watch_t *watch = ready_list_pop(instance);
+        portEXIT_CRITICAL(&instance->lock);
+        if (watch == NULL) {
+            break;
+        }
+
+        int revents = watch->vfs->vfs.epoll_poll(watch->local_fd);
+        if (revents < 0) {
+            revents = ESP_VFS_EPOLLERR;
+        }
+        revents &= watch->events | ESP_VFS_EPOLLERR;
+        if (revents != 0) {
+            events[count].events = revents;
+            events[count].data = watch->data;
+            ++count;
+            portENTER_CRITICAL(&instance->lock);
+            ready_list_push(instance, watch);
+            portEXIT_CRITICAL(&instance->lock);
+        }
+
+        if (watch == last) {
+            break;
+        }
+    }
+    return count;
+}
+
+int esp_vfs_epoll_wait(int epfd, esp_vfs_epoll_event_t *events, int maxevents, int timeout_ms)
+{
+    if (events == NULL || maxevents <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    // the instance stays allocated while it is used, even if epfd is closed meanwhile
+    _lock_acquire(&s_lock);
+    epoll_instance_t *instance = get_instance(epfd);
+    if (instance != NULL) {
+        ++instance->users;
+    }
+    _lock_release(&s_lock);
+    if (instance == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+
+    TickType_t ticks_to_wait = portMAX_DELAY;
+    if (timeout_ms >= 0) {
+        ticks_to_wait = (timeout_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    }
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    int count;
+    while (true) {
+        _lock_acquire(&instance->wait_lock);
+        const bool closed = instance->closed;
+        count = closed ? 0 : collect_ready(instance, events, maxevents);
+        _lock_release(&instance->wait_lock);
+        if (closed) {
+            // wake up the next call waiting on the closed instance
+            xSemaphoreGive(instance->sem);
+            errno = EBADF;
+            count = -1;
+            break;
+        }
+        if (count > 0 || xTaskCheckForTimeOut(&timeout, &ticks_to_wait) == pdTRUE) {
+            break;
+        }
+        xSemaphoreTake(instance->sem, ticks_to_wait);
+    }
+
+    _lock_acquire(&s_lock);
+    const bool release = --instance->users == 0 && instance->closed;
+    _lock_release(&s_lock);
+    if (release) {
+        free_instance(instance);
+    }
+    return count;
+}
@@ -59,6 +59,10 @@ typedef struct {
     volatile uint64_t       value;
     // a double-linked list for all pending select args with this fd
     event_select_args_t     *select_args;
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+    // the epoll instance watching this fd
+    esp_vfs_epoll_watch_t   *epoll_watch;
+#endif
     _lock_t                 lock;
     // only for event fds that support ISR.
     portMUX_TYPE            data_spin_lock;
@@ -76,6 +80,11 @@ static void trigger_select_for_event(event_context_t *event)
         esp_vfs_select_triggered(select_args->signal_sem);
         select_args = select_args->next_in_fd;
     }
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+    if (event->epoll_watch) {
+        esp_vfs_epoll_notify(event->epoll_watch);
+    }
+#endif
 }
 
 static void trigger_select_for_event_isr(event_context_t *event, BaseType_t *task_woken)
@@ -87,6 +96,11 @@ static void trigger_select_for_event_isr(event_context_t *event, BaseType_t *tas
         *task_woken = (local_woken || *task_woken);
         select_args = select_args->next_in_fd;
     }
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+    if (event->epoll_watch) {
+        esp_vfs_epoll_notify_isr(event->epoll_watch, task_woken);
+    }
+#endif
 }
 
 #ifdef CONFIG_VFS_SUPPORT_SELECT
@@ -218,6 +232,67 @@ static esp_err_t event_end_select(void *end_select_args)
 }
 #endif // CONFIG_VFS_SUPPORT_SELECT
 
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+static int event_epoll_watch(int fd, esp_vfs_epoll_watch_t *watch)
+{
+    int ret = 0;
+
+    if (fd >= s_event_size) {
+        errno = EBADF;
+        return -1;
+    }
+
+    _lock_acquire_recursive(&s_events[fd].lock);
+    if (s_events[fd].support_isr) {
+        portENTER_CRITICAL(&s_events[fd].data_spin_lock);
+    }
+
+    if (s_events[fd].fd == fd || watch == NULL) {
+        s_events[fd].epoll_watch = watch;
+    } else {
+        errno = EBADF;
+        ret = -1;
+    }
+
+    if (s_events[fd].support_isr) {
+        portEXIT_CRITICAL(&s_events[fd].data_spin_lock);
+    }
+    _lock_release_recursive(&s_events[fd].lock);
+
+    return ret;
+}
+
+static int event_epoll_poll(int fd)
+{
+    // event fds are always writable
+    int ret = POLLOUT;
+
+    if (fd >= s_event_size) {
+        errno = EBADF;
+        return -1;
+    }
+
+    _lock_acquire_recursive(&s_events[fd].lock);
+    if (s_events[fd].support_isr) {
+        portENTER_CRITICAL(&s_events[fd].data_spin_lock);
+    }
+
+    if (s_events[fd].fd != fd) {
+        errno = EBADF;
+        ret = -1;
+    } else if (s_events[fd].is_set) {
+        ret |= POLLIN;
+    }
+
+    if (s_events[fd].support_isr) {
+        portEXIT_CRITICAL(&s_events[fd].data_spin_lock);
+    }
+    _lock_release_recursive(&s_events[fd].lock);
+
+    return ret;
+}
+#endif // CONFIG_VFS_SUPPORT_EPOLL
+
 static ssize_t signal_event_fd_from_isr(int fd, const void *data, size_t size)
 {
     BaseType_t task_woken = pdFALSE;
@@ -375,6 +450,10 @@ esp_err_t esp_vfs_eventfd_register(const esp_vfs_eventfd_config_t *config)
 #ifdef CONFIG_VFS_SUPPORT_SELECT
         .start_select = &event_start_select,
         .end_select   = &event_end_select,
+#endif
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+        .epoll_watch  = &event_epoll_watch,
+        .epoll_poll   = &event_epoll_poll,
 #endif
     };
     return esp_vfs_register_with_id(&vfs, NULL, &s_eventfd_vfs_id);
@@ -433,6 +512,9 @@ int eventfd(unsigned int initval, int flags)
             s_events[i].is_set = false;
             s_events[i].value = initval;
             s_events[i].select_args = NULL;
+#ifdef CONFIG_VFS_SUPPORT_EPOLL
+            s_events[i].epoll_watch = NULL;
+#endif
             if (support_isr) {
                 portEXIT_CRITICAL(&s_events[i].data_spin_lock);
             }